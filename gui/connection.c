@@ -18,18 +18,23 @@
  */
 
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "connection.h"
 #include "window.h"
 
 static struct Window* getWindow(struct Connection* conn, unsigned int windowId);
 static void handleMessage(struct Connection* conn, unsigned int type,
-        size_t length, void* msg);
-static bool sendOutput(struct Connection* conn, const void* buffer,
-        size_t size);
+        size_t length, void* msg, int fd);
+static void queueOutput(struct Connection* conn,
+        const struct gui_msg_header* header, const void* msg);
 
 static void handleCloseWindow(struct Connection* conn, size_t length,
         struct gui_msg_close_window* msg);
@@ -37,39 +42,41 @@ static void handleCreateWindow(struct Connection* conn, size_t length,
         struct gui_msg_create_window* msg);
 static void handleHideWindow(struct Connection* conn, size_t length,
         struct gui_msg_hide_window* msg);
-static void handleRedrawWindow(struct Connection* conn, size_t length,
-        struct gui_msg_redraw_window* msg);
-static void handleRedrawWindowPart(struct Connection* conn, size_t length,
-        struct gui_msg_redraw_window_part* msg);
 static void handleResizeWindow(struct Connection* conn, size_t length,
         struct gui_msg_resize_window* msg);
 static void handleSetRelativeMouse(struct Connection* conn, size_t length,
         struct gui_msg_set_relative_mouse* msg);
 static void handleSetWindowBackground(struct Connection* conn, size_t length,
         struct gui_msg_set_window_background* msg);
+static void handleSetWindowBuffer(struct Connection* conn, size_t length,
+        struct gui_msg_set_window_buffer* msg, int fd);
 static void handleSetWindowCursor(struct Connection* conn, size_t length,
         struct gui_msg_set_window_cursor* msg);
 static void handleSetWindowTitle(struct Connection* conn, size_t length,
         struct gui_msg_set_window_title* msg);
 static void handleShowWindow(struct Connection* conn, size_t length,
         struct gui_msg_show_window* msg);
+static void handleUpdateWindow(struct Connection* conn, size_t length,
+        struct gui_msg_update_window* msg);
 
+// The output buffer contains whole messages so that each of them can be sent
+// as a single packet.
 bool flushConnectionBuffer(struct Connection* conn) {
     while (conn->outputBuffered) {
-        size_t copySize = conn->outputBufferSize - conn->outputBufferOffset;
-        if (conn->outputBuffered < copySize) copySize = conn->outputBuffered;
-        ssize_t written = write(conn->fd,
-                conn->outputBuffer + conn->outputBufferOffset, copySize);
-        if (written < 0) {
+        char* message = conn->outputBuffer + conn->outputBufferOffset;
+        struct gui_msg_header header;
+        memcpy(&header, message, sizeof(header));
+        size_t size = sizeof(header) + header.length;
+        if (write(conn->fd, message, size) < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
             return false;
         }
-        conn->outputBufferOffset = (conn->outputBufferOffset + written) %
-                conn->outputBufferSize;
-        conn->outputBuffered -= written;
+        conn->outputBufferOffset += size;
+        conn->outputBuffered -= size;
     }
 
     conn->outputBufferOffset = 0;
+    updateConnectionEvents(conn);
     return true;
 }
 
@@ -80,7 +87,7 @@ static struct Window* getWindow(struct Connection* conn,
 }
 
 static void handleMessage(struct Connection* conn, unsigned int type,
-        size_t length, void* msg) {
+        size_t length, void* msg, int fd) {
     switch (type) {
     case GUI_MSG_CLOSE_WINDOW:
         handleCloseWindow(conn, length, msg);
@@ -91,12 +98,6 @@ static void handleMessage(struct Connection* conn, unsigned int type,
     case GUI_MSG_HIDE_WINDOW:
         handleHideWindow(conn, length, msg);
         break;
-    case GUI_MSG_REDRAW_WINDOW:
-        handleRedrawWindow(conn, length, msg);
-        break;
-    case GUI_MSG_REDRAW_WINDOW_PART:
-        handleRedrawWindowPart(conn, length, msg);
-        break;
     case GUI_MSG_RESIZE_WINDOW:
         handleResizeWindow(conn, length, msg);
         break;
@@ -106,6 +107,9 @@ static void handleMessage(struct Connection* conn, unsigned int type,
     case GUI_MSG_SET_WINDOW_BACKGROUND:
         handleSetWindowBackground(conn, length, msg);
         break;
+    case GUI_MSG_SET_WINDOW_BUFFER:
+        handleSetWindowBuffer(conn, length, msg, fd);
+        break;
     case GUI_MSG_SET_WINDOW_CURSOR:
         handleSetWindowCursor(conn, length, msg);
         break;
@@ -115,43 +119,98 @@ static void handleMessage(struct Connection* conn, unsigned int type,
     case GUI_MSG_SHOW_WINDOW:
         handleShowWindow(conn, length, msg);
         break;
+    case GUI_MSG_UPDATE_WINDOW:
+        handleUpdateWindow(conn, length, msg);
+        break;
     }
 }
 
-bool receiveMessage(struct Connection* conn) {
-    while (conn->headerReceived < sizeof(struct gui_msg_header)) {
-        ssize_t bytesRead = read(conn->fd,
-                (char*) &conn->headerBuffer + conn->headerReceived,
-                sizeof(struct gui_msg_header) - conn->headerReceived);
-        if (bytesRead < 0) {
-            return errno == EAGAIN || errno == EWOULDBLOCK;
+static void queueOutput(struct Connection* conn,
+        const struct gui_msg_header* header, const void* msg) {
+    size_t size = sizeof(*header) + header->length;
+    size_t end = conn->outputBufferOffset + conn->outputBuffered;
+
+    if (size > conn->outputBufferSize - end) {
+        // Move the pending messages to the beginning of the buffer.
+        if (conn->outputBufferOffset) {
+            memmove(conn->outputBuffer,
+                    conn->outputBuffer + conn->outputBufferOffset,
+                    conn->outputBuffered);
+            conn->outputBufferOffset = 0;
+            end = conn->outputBuffered;
+        }
+
+        if (size > conn->outputBufferSize - end) {
+            char* newBuffer = realloc(conn->outputBuffer, end + size);
+            if (!newBuffer) dxui_panic(context, "realloc");
+            conn->outputBuffer = newBuffer;
+            conn->outputBufferSize = end + size;
         }
-        conn->headerReceived += bytesRead;
     }
 
-    size_t length = conn->headerBuffer.length;
+    memcpy(conn->outputBuffer + end, header, sizeof(*header));
+    memcpy(conn->outputBuffer + end + sizeof(*header), msg, header->length);
+    conn->outputBuffered += size;
+    updateConnectionEvents(conn);
+}
 
-    if (!conn->messageBuffer) {
-        conn->messageBuffer = malloc(length);
-        if (!conn->messageBuffer) dxui_panic(context, "malloc");
+bool receiveMessage(struct Connection* conn) {
+    // Each message is received as a single packet. Look at the header first
+    // to make sure that the buffer is large enough for the whole message.
+    struct gui_msg_header header;
+    ssize_t bytesRead = recv(conn->fd, &header, sizeof(header), MSG_PEEK);
+    if (bytesRead < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if (bytesRead == 0) return false;
+    if ((size_t) bytesRead < sizeof(header)) {
+        // Discard the malformed packet.
+        recv(conn->fd, &header, sizeof(header), 0);
+        return true;
     }
 
-    while (conn->messageReceived < length) {
-        ssize_t bytesRead = read(conn->fd,
-                conn->messageBuffer + conn->messageReceived,
-                length - conn->messageReceived);
-        if (bytesRead < 0) {
-            return errno == EAGAIN || errno == EWOULDBLOCK;
-        }
-        conn->messageReceived += bytesRead;
+    if (header.length > conn->messageBufferSize) {
+        char* newBuffer = realloc(conn->messageBuffer, header.length);
+        if (!newBuffer) dxui_panic(context, "realloc");
+        conn->messageBuffer = newBuffer;
+        conn->messageBufferSize = header.length;
+    }
+
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = conn->messageBuffer;
+    iov[1].iov_len = header.length;
+    struct msghdr msg = {0};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    // Window buffers are passed as file descriptors.
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    bytesRead = recvmsg(conn->fd, &msg, MSG_CMSG_CLOEXEC);
+    if (bytesRead < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
     }
 
-    handleMessage(conn, conn->headerBuffer.type, length, conn->messageBuffer);
-    free(conn->messageBuffer);
-    conn->messageBuffer = NULL;
-    conn->messageReceived = 0;
-    conn->headerReceived = 0;
+    int fd = -1;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len >= (socklen_t) CMSG_LEN(sizeof(int))) {
+        memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
 
+    handleMessage(conn, header.type, bytesRead - sizeof(header),
+            conn->messageBuffer, fd);
+    if (fd >= 0) {
+        close(fd);
+    }
     return true;
 }
 
@@ -160,63 +219,19 @@ void sendEvent(struct Connection* conn, unsigned int type, size_t length,
     struct gui_msg_header header;
     header.type = type;
     header.length = length;
-    sendOutput(conn, &header, sizeof(header));
-    sendOutput(conn, msg, length);
-}
 
-static bool sendOutput(struct Connection* conn, const void* buffer,
-        size_t size) {
-    const char* buf = buffer;
     if (!conn->outputBuffered) {
-        while (size) {
-            ssize_t written = write(conn->fd, buf, size);
-            if (written < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
-                return false;
-            }
-            buf += written;
-            size -= written;
-        }
-    }
-
-    if (size) {
-        if (size < conn->outputBufferSize - conn->outputBuffered) {
-            size_t offset = (conn->outputBufferOffset + conn->outputBuffered) %
-                    conn->outputBufferSize;
-            size_t copySize = conn->outputBufferSize - offset;
-            if (size < copySize) copySize = size;
-            memcpy(conn->outputBuffer + offset, buf, copySize);
-            buf += copySize;
-
-            if (size - copySize) {
-                memcpy(conn->outputBuffer, buf, size - copySize);
-            }
-
-            conn->outputBuffered += size;
-        } else {
-            char* newBuffer = malloc(conn->outputBuffered + size);
-            if (!newBuffer) dxui_panic(context, "malloc");
-            size_t copySize = conn->outputBufferSize - conn->outputBufferOffset;
-            if (conn->outputBuffered < copySize) {
-                copySize = conn->outputBuffered;
-            }
-            memcpy(newBuffer, conn->outputBuffer + conn->outputBufferOffset,
-                    copySize);
-            if (conn->outputBuffered > copySize) {
-                memcpy(newBuffer + copySize, conn->outputBuffer,
-                        conn->outputBuffered - copySize);
-            }
-            memcpy(newBuffer + conn->outputBuffered, buf, size);
-
-            free(conn->outputBuffer);
-            conn->outputBuffer = newBuffer;
-            conn->outputBuffered += size;
-            conn->outputBufferOffset = 0;
-            conn->outputBufferSize = conn->outputBuffered;
-        }
+        struct iovec iov[2];
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        iov[1].iov_base = msg;
+        iov[1].iov_len = length;
+        if (writev(conn->fd, iov, 2) >= 0) return;
+        // Broken connections are closed once the hangup is noticed.
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return;
     }
 
-    return true;
+    queueOutput(conn, &header, msg);
 }
 
 static void handleCloseWindow(struct Connection* conn, size_t length,
@@ -271,28 +286,6 @@ static void handleHideWindow(struct Connection* conn, size_t length,
     hideWindow(window);
 }
 
-static void handleRedrawWindow(struct Connection* conn, size_t length,
-        struct gui_msg_redraw_window* msg) {
-    if (length < sizeof(*msg)) return;
-    size_t lfbSize = msg->height * msg->width * sizeof(dxui_color);
-    if (length < sizeof(*msg) + lfbSize) return;
-    struct Window* window = getWindow(conn, msg->window_id);
-    if (!window) return;
-    redrawWindow(window, msg->width, msg->height, msg->lfb);
-}
-
-static void handleRedrawWindowPart(struct Connection* conn, size_t length,
-        struct gui_msg_redraw_window_part* msg) {
-    if (length < sizeof(*msg)) return;
-    size_t lfbSize = ((msg->height - 1) * msg->pitch + msg->width) *
-            sizeof(dxui_color);
-    if (length < sizeof(*msg) + lfbSize) return;
-    struct Window* window = getWindow(conn, msg->window_id);
-    if (!window) return;
-    redrawWindowPart(window, msg->x, msg->y, msg->width, msg->height,
-            msg->pitch, msg->lfb);
-}
-
 static void handleResizeWindow(struct Connection* conn, size_t length,
         struct gui_msg_resize_window* msg) {
     if (length < sizeof(*msg)) return;
@@ -321,6 +314,28 @@ static void handleSetWindowBackground(struct Connection* conn, size_t length,
     setWindowBackground(window, msg->color);
 }
 
+static void handleSetWindowBuffer(struct Connection* conn, size_t length,
+        struct gui_msg_set_window_buffer* msg, int fd) {
+    if (length < sizeof(*msg) || fd < 0) return;
+    struct Window* window = getWindow(conn, msg->window_id);
+    if (!window) return;
+    if (msg->width > INT_MAX || msg->height > INT_MAX) return;
+    if (msg->height && msg->width > SIZE_MAX / sizeof(dxui_color) /
+            msg->height) {
+        return;
+    }
+
+    // The compositor reads the window contents in place. The client cannot
+    // shrink the shared memory object while it is mapped.
+    size_t size = (size_t) msg->width * msg->height * sizeof(dxui_color);
+    if (size == 0) size = sizeof(dxui_color);
+    dxui_color* lfb = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (lfb == MAP_FAILED) return;
+
+    dxui_dim dim = { msg->width, msg->height };
+    setWindowBuffer(window, dim, lfb, size);
+}
+
 static void handleSetWindowCursor(struct Connection* conn, size_t length,
         struct gui_msg_set_window_cursor* msg) {
     if (length < sizeof(*msg)) return;
@@ -348,3 +363,21 @@ static void handleShowWindow(struct Connection* conn, size_t length,
     if (!window) return;
     showWindow(window);
 }
+
+static void handleUpdateWindow(struct Connection* conn, size_t length,
+        struct gui_msg_update_window* msg) {
+    if (length < sizeof(*msg)) return;
+    struct Window* window = getWindow(conn, msg->window_id);
+    if (!window) return;
+    unsigned int width = window->clientDim.width;
+    unsigned int height = window->clientDim.height;
+    if (msg->x >= width || msg->y >= height) return;
+
+    dxui_rect rect;
+    rect.x = msg->x;
+    rect.y = msg->y;
+    rect.width = msg->width < width - msg->x ? msg->width : width - msg->x;
+    rect.height = msg->height < height - msg->y ? msg->height :
+            height - msg->y;
+    updateWindow(window, rect);
+}
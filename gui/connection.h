@@ -30,19 +30,19 @@ struct Connection {
     size_t index;
     struct Window** windows;
     size_t windowsAllocated;
-    struct gui_msg_header headerBuffer;
-    size_t headerReceived;
     char* messageBuffer;
-    size_t messageReceived;
+    size_t messageBufferSize;
     char* outputBuffer;
     size_t outputBuffered;
     size_t outputBufferOffset;
     size_t outputBufferSize;
+    bool pollingOutput;
 };
 
 bool flushConnectionBuffer(struct Connection* conn);
 bool receiveMessage(struct Connection* conn);
 void sendEvent(struct Connection* conn, unsigned int type, size_t length,
         void* msg);
+void updateConnectionEvents(struct Connection* conn);
 
 #endif
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 
@@ -30,7 +31,7 @@
 static struct Connection** connections;
 static size_t connectionsAllocated;
 static size_t numConnections;
-static struct pollfd* pfd;
+static int epollFd;
 static int serverFd;
 
 static void acceptConnections(void);
@@ -46,13 +47,13 @@ static void acceptConnections(void) {
     connection->fd = fd;
     connection->windows = NULL;
     connection->windowsAllocated = 0;
-    connection->headerReceived = 0;
     connection->messageBuffer = NULL;
-    connection->messageReceived = 0;
+    connection->messageBufferSize = 0;
     connection->outputBuffer = NULL;
     connection->outputBuffered = 0;
     connection->outputBufferOffset = 0;
     connection->outputBufferSize = 0;
+    connection->pollingOutput = false;
     addConnection(connection);
 
     struct gui_event_status msg;
@@ -70,16 +71,17 @@ static void addConnection(struct Connection* connection) {
         connections = reallocarray(connections, connectionsAllocated,
                 2 * sizeof(struct Connection*));
         if (!connections) dxui_panic(context, "realloc");
-        pfd = reallocarray(pfd, 1 + 2 * connectionsAllocated + DXUI_POLL_NFDS,
-                sizeof(struct pollfd));
-        if (!pfd) dxui_panic(context, "realloc");
         connectionsAllocated *= 2;
     }
 
     connections[connection->index] = connection;
-    pfd[connection->index + 1].fd = connection->fd;
-    pfd[connection->index + 1].events = POLLIN | POLLOUT;
-    pfd[connection->index + 1].revents = 0;
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = connection;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, connection->fd, &event) < 0) {
+        dxui_panic(context, "epoll_ctl");
+    }
 }
 
 void broadcastStatusEvent(void) {
@@ -97,7 +99,7 @@ static void closeConnection(struct Connection* connection) {
     numConnections--;
     connections[connection->index] = connections[numConnections];
     connections[connection->index]->index = connection->index;
-    pfd[connection->index + 1] = pfd[numConnections + 1];
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
 
     for (size_t i = 0; i < connection->windowsAllocated; i++) {
         if (connection->windows[i]) {
@@ -112,7 +114,7 @@ static void closeConnection(struct Connection* connection) {
 }
 
 void initializeServer(void) {
-    serverFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    serverFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
     if (serverFd < 0) dxui_panic(context, "socket");
     struct sockaddr_un addr;
     addr.sun_family = AF_UNIX;
@@ -132,42 +134,67 @@ void initializeServer(void) {
     connections = malloc(connectionsAllocated * sizeof(struct Connection*));
     if (!connections) dxui_panic(context, "malloc");
 
-    pfd = malloc((1 + connectionsAllocated + DXUI_POLL_NFDS) *
-            sizeof(struct pollfd));
-    if (!pfd) dxui_panic(context, "malloc");
+    // Connections are watched with an event queue so that only connections
+    // that have become ready need to be looked at.
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) dxui_panic(context, "epoll_create1");
 
-    pfd[0].fd = serverFd;
-    pfd[0].events = POLLIN;
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, serverFd, &event) < 0) {
+        dxui_panic(context, "epoll_ctl");
+    }
 }
 
 void pollEvents(void) {
-    int result = dxui_poll(context, pfd, 1 + numConnections, -1);
+    struct pollfd pfd[1 + DXUI_POLL_NFDS];
+    pfd[0].fd = epollFd;
+    pfd[0].events = POLLIN;
+
+    int result = dxui_poll(context, pfd, 1, -1);
     if (result < 0 && errno != EINTR) {
         for (struct Window* win = topWindow; win; win = win->below) {
             closeWindow(win);
         }
         exit(0);
-    } else if (result >= 1) {
-        if (pfd[0].revents & POLLIN) {
+    } else if (result < 1 || !(pfd[0].revents & POLLIN)) {
+        return;
+    }
+
+    struct epoll_event events[64];
+    int numEvents = epoll_wait(epollFd, events, 64, 0);
+
+    for (int i = 0; i < numEvents; i++) {
+        struct Connection* connection = events[i].data.ptr;
+        if (!connection) {
             acceptConnections();
+            continue;
         }
 
-        for (size_t i = 0; i < numConnections; i++) {
-            if (pfd[1 + i].revents & POLLIN) {
-                if (!receiveMessage(connections[i])) {
-                    closeConnection(connections[i]);
-                    i--;
-                    continue;
-                }
-            }
-            if (pfd[1 + i].revents & POLLOUT &&
-                    connections[i]->outputBuffered) {
-                flushConnectionBuffer(connections[i]);
-            } else if (pfd[1 + i].revents & POLLHUP) {
-                closeConnection(connections[i]);
-                i--;
+        if (events[i].events & EPOLLIN) {
+            if (!receiveMessage(connection)) {
+                closeConnection(connection);
+                continue;
             }
         }
+        if (events[i].events & EPOLLOUT && connection->outputBuffered) {
+            flushConnectionBuffer(connection);
+        } else if (events[i].events & EPOLLHUP) {
+            closeConnection(connection);
+        }
+    }
+}
+
+void updateConnectionEvents(struct Connection* connection) {
+    bool pollOutput = connection->outputBuffered != 0;
+    if (pollOutput == connection->pollingOutput) return;
+
+    struct epoll_event event;
+    event.events = pollOutput ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.ptr = connection;
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->fd, &event) == 0) {
+        connection->pollingOutput = pollOutput;
     }
 }
 
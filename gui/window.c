@@ -19,6 +19,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 
 #include "connection.h"
 #include "window.h"
@@ -74,6 +75,7 @@ struct Window* addWindow(int x, int y, int width, int height, const char* title,
     window->rect = chooseWindowRect(x, y, width, height);
     window->titleLfb = NULL;
     window->lfb = NULL;
+    window->lfbSize = 0;
     window->clientDim = (dxui_dim) {0, 0};
     window->relativeMouse = false;
     window->visible = false;
@@ -155,7 +157,9 @@ void closeWindow(struct Window* window) {
     }
     window->connection->windows[window->id] = NULL;
     free(window->titleLfb);
-    free(window->lfb);
+    if (window->lfb) {
+        munmap(window->lfb, window->lfbSize);
+    }
     free(window);
 }
 
@@ -312,6 +316,19 @@ void setWindowBackground(struct Window* window, dxui_color color) {
     addDamageRect(window->rect);
 }
 
+void setWindowBuffer(struct Window* window, dxui_dim dim, dxui_color* lfb,
+        size_t lfbSize) {
+    if (window->lfb) {
+        munmap(window->lfb, window->lfbSize);
+    }
+    window->lfb = lfb;
+    window->lfbSize = lfbSize;
+    window->clientDim = dim;
+    if (window->visible) {
+        addDamageRect(getClientRect(window));
+    }
+}
+
 void setWindowCursor(struct Window* window, int cursor) {
     window->cursor = cursor;
 }
@@ -336,3 +353,13 @@ void showWindow(struct Window* window) {
     window->visible = true;
     addDamageRect(window->rect);
 }
+
+void updateWindow(struct Window* window, dxui_rect rect) {
+    rect = dxui_rect_crop(rect, window->clientDim);
+    if (window->visible && rect.width > 0 && rect.height > 0) {
+        dxui_rect clientRect = getClientRect(window);
+        rect.x += clientRect.x;
+        rect.y += clientRect.y;
+        addDamageRect(rect);
+    }
+}
@@ -33,7 +33,9 @@ struct Window {
     dxui_rect rect;
     dxui_color* titleLfb;
     dxui_dim titleDim;
+    // The client contents are read directly from memory shared with the client.
     dxui_color* lfb;
+    size_t lfbSize;
     dxui_dim clientDim;
     bool relativeMouse;
     bool visible;
@@ -65,17 +67,16 @@ void closeWindow(struct Window* window);
 dxui_rect getClientRect(struct Window* window);
 void hideWindow(struct Window* window);
 void moveWindowToTop(struct Window* window);
-void redrawWindow(struct Window* window, int width, int height,
-        dxui_color* lfb);
-void redrawWindowPart(struct Window* window, int x, int y, int width,
-        int height, size_t pitch, dxui_color* lfb);
 dxui_color renderClientArea(struct Window* window, int x, int y);
 dxui_color renderWindowDecoration(struct Window* window, int x, int y);
 void resizeClientRect(struct Window* window, dxui_dim dim);
 void resizeWindow(struct Window* window, dxui_rect rect);
 void setWindowBackground(struct Window* window, dxui_color color);
+void setWindowBuffer(struct Window* window, dxui_dim dim, dxui_color* lfb,
+        size_t lfbSize);
 void setWindowCursor(struct Window* window, int cursor);
 void setWindowTitle(struct Window* window, const char* title);
 void showWindow(struct Window* window);
+void updateWindow(struct Window* window, dxui_rect rect);
 
 #endif
@@ -24,12 +24,14 @@
 #include <dennix/winsize.h>
 
 /* Devctl numbers that are defined by default in <devctl.h> and <sys/ioctl.h>
-   are defined here. More devctl numbers are defined in <dennix/display.h>. */
+   are defined here. More devctl numbers are defined in <dennix/display.h> and
+   <dennix/trace.h>. */
 
 #define TIOCSCTTY _DEVCTL(_IOCTL_VOID, 0)
 
 /* _IOCTL_INT 0 is used in <dennix/display.h>. */
 #define TCFLSH _DEVCTL(_IOCTL_INT, 1)
+/* _IOCTL_INT 2 is used in <dennix/trace.h>. */
 
 #define TIOCGWINSZ _DEVCTL(_IOCTL_PTR, 0) /* (struct winsize*) */
 #define TIOCGPGRP _DEVCTL(_IOCTL_PTR, 1) /* (pid_t*) */
@@ -37,5 +39,6 @@
 /* _IOCTL_PTR 3 - 6 are used in <dennix/display.h>. */
 #define TIOCGPATH _DEVCTL(_IOCTL_PTR, 7) /* (char*) */
 #define TIOCSWINSZ _DEVCTL(_IOCTL_PTR, 8) /* (const struct winsize*) */
+/* _IOCTL_PTR 9 is used in <dennix/trace.h>. */
 
 #endif
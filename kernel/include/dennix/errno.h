@@ -98,5 +98,6 @@
 #define EWOULDBLOCK 76
 #define EXDEV 77
 #define ESOCKTNOSUPPORT 78
+#define ETOOMANYREFS 79
 
 #endif
@@ -40,6 +40,8 @@
 #define F_GETFL 4
 #define F_SETFL 5
 #define F_DUPFD_CLOFORK 6
+#define F_GETPIPE_SZ 7
+#define F_SETPIPE_SZ 8
 
 #define FD_CLOEXEC (1 << 0)
 #define FD_CLOFORK (1 << 1)
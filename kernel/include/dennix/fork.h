@@ -24,6 +24,8 @@
 
 #define RFPROC (1 << 0)
 #define RFFDG (1 << 1)
+#define RFTHREAD (1 << 2)
+#define RFVFORK (1 << 3)
 
 #define _RFFORK (RFPROC | RFFDG)
 
@@ -20,17 +20,34 @@
 #ifndef KERNEL_ADDRESSSPACE_H
 #define KERNEL_ADDRESSSPACE_H
 
+#include <sys/types.h>
 #include <dennix/mman.h>
 #include <dennix/kernel/kthread.h>
 #include <dennix/kernel/memorysegment.h>
+#include <dennix/kernel/refcount.h>
 
 #define PROT_WRITE_COMBINING (1 << 17)
+// Memory allocated by mapMemory with this flag is zero-filled.
+#define PROT_ZERO (1 << 20)
+// Memory allocated by mapMemory with this flag must use large pages.
+#define PROT_LARGE_PAGES (1 << 21)
+
+#ifdef __x86_64__
+// All usable physical memory is mapped at this address.
+#  define DIRECT_MAP 0xFFFFC00000000000
+#  define DIRECT_MAP_SIZE 0x3F0000000000
+#  define LARGE_PAGESIZE 0x200000
+#  define LARGE_PAGE_ALIGNED(value) !((value) & (LARGE_PAGESIZE - 1))
+#endif
+
+class Vnode;
 
 class AddressSpace : public ConstructorMayFail {
 public:
     AddressSpace();
     ~AddressSpace();
     void activate();
+    MemorySegment* copySegments(size_t* count);
     AddressSpace* fork();
     paddr_t getPhysicalAddress(vaddr_t virtualAddress);
     vaddr_t mapAt(vaddr_t virtualAddress, paddr_t physicalAddress,
@@ -40,32 +57,89 @@ public:
     vaddr_t mapMemory(size_t size, int protection);
     vaddr_t mapMemory(vaddr_t virtualAddress, size_t size, int protection);
     vaddr_t mapPhysical(paddr_t physicalAddress, size_t size, int protection);
+    vaddr_t mapPhysical(vaddr_t virtualAddress, paddr_t physicalAddress,
+            size_t size, int protection);
+    vaddr_t mapShared(const Reference<Vnode>& vnode, off_t offset, size_t size,
+            int protection);
     vaddr_t mapUnaligned(paddr_t physicalAddress, size_t size, int protection,
             vaddr_t& mapping, size_t& mapSize);
-    void unmapMemory(vaddr_t virtualAddress, size_t size);
+    bool swapIn(vaddr_t virtualAddress);
+    bool unmapMemory(vaddr_t virtualAddress, size_t size);
     void unmapPhysical(vaddr_t firstVirtualAddress, size_t size);
 private:
+    struct SharedMapping {
+        SharedMapping* next;
+        vaddr_t address;
+        size_t size;
+        off_t offset;
+        int protection;
+        Reference<Vnode> vnode;
+    };
+
+    void freeRange(vaddr_t virtualAddress, size_t size);
+#ifdef __x86_64__
+    uintptr_t* getPageDirectoryEntry(vaddr_t virtualAddress, bool allocate);
+    uintptr_t* getPageTableEntry(vaddr_t virtualAddress, bool allocate);
+#endif
+    void invalidateTlb(vaddr_t virtualAddress, size_t size);
     bool isActive();
+#ifdef __x86_64__
+    bool mapLargeAt(vaddr_t virtualAddress, paddr_t physicalAddress,
+            int protection);
+#endif
     vaddr_t mapMemoryInternal(vaddr_t virtualAddress, size_t size,
             int protection);
+    bool mapPhysicalInternal(vaddr_t virtualAddress, paddr_t physicalAddress,
+            size_t size, int protection);
+    vaddr_t mapSharedInternal(vaddr_t virtualAddress,
+            const Reference<Vnode>& vnode, off_t offset, size_t size,
+            int protection);
+    uintptr_t readPageTableEntry(vaddr_t virtualAddress);
+#ifdef __x86_64__
+    bool splitLargePage(uintptr_t* entry, vaddr_t virtualAddress);
+#endif
+    bool swapOutPage(vaddr_t virtualAddress);
+    size_t swapOutPages(size_t count);
     void unmap(vaddr_t virtualAddress);
+#ifdef __x86_64__
+    paddr_t unmapLargePage(vaddr_t virtualAddress);
+#endif
+    void unmapRange(vaddr_t virtualAddress, size_t size);
+    bool unmapShared(vaddr_t virtualAddress, size_t size,
+            SharedMapping** released);
+    paddr_t unmapWithoutInvalidation(vaddr_t virtualAddress);
+    void writePageTableEntry(vaddr_t virtualAddress, uintptr_t entry);
 public:
     MemorySegment* firstSegment;
+    MemorySegment* segmentTree;
+    // Pages are only swapped out once the kernel no longer accesses them
+    // through other mappings.
+    bool swappable;
 private:
     AddressSpace* prev;
     AddressSpace* next;
     kthread_mutex_t mutex;
-    vaddr_t mappingArea;
+    SharedMapping* firstSharedMapping;
+    vaddr_t swapHand;
 #ifdef __i386__
+    vaddr_t mappingArea;
     paddr_t pageDir;
 #elif defined(__x86_64__)
     paddr_t pml4;
 #endif
 public:
+    static void copyPage(paddr_t destination, paddr_t source);
     static void initialize();
+#ifdef __x86_64__
+    static void mapDirect(paddr_t physicalAddress, size_t size);
+#endif
+    static void reclaimFrames(size_t frames);
+    static void zeroPage(paddr_t physicalAddress);
     static bool patSupported;
 private:
     static AddressSpace* activeAddressSpace;
+    static kthread_mutex_t listMutex;
+    static AddressSpace* reclaimCursor;
 };
 
 // Global variable for the kernel's address space
@@ -30,12 +30,16 @@ protected:
     BlockCacheDevice(mode_t mode, dev_t dev);
 public:
     void freeUnusedBlocks();
+    off_t getDeviceOffset(off_t offset, BlockCacheDevice** device) override;
     bool isSeekable() override;
     ssize_t pread(void* buffer, size_t size, off_t offset, int flags) override;
+    ssize_t preadv(const struct iovec* iov, int iovcnt, off_t offset,
+            int flags) override;
     ssize_t pwrite(const void* buffer, size_t size, off_t offset, int flags)
             override;
+    ssize_t pwritev(const struct iovec* iov, int iovcnt, off_t offset,
+            int flags) override;
     paddr_t reclaimCache() override;
-protected:
     virtual bool readUncached(void* buffer, size_t size, off_t offset,
             int flags) = 0;
     virtual bool writeUncached(const void* buffer, size_t size, off_t offset,
@@ -59,9 +63,13 @@ private:
     Block* freeList;
     Block* leastRecentlyUsed;
     Block* mostRecentlyUsed;
+    Block* pinnedBlock;
     WorkerJob workerJob;
 private:
+    ssize_t readBlocks(void* buffer, size_t size, off_t offset, int flags);
     void useBlock(Block* block);
+    ssize_t writeBlocks(const void* buffer, size_t size, off_t offset,
+            int flags);
 };
 
 #endif
@@ -22,18 +22,24 @@
 
 #include <dennix/kernel/kernel.h>
 
+// A circular buffer built from a ring of pages. Pages are only allocated when
+// data is first written to them.
 class CircularBuffer {
 public:
     CircularBuffer();
-    CircularBuffer(char* buffer, size_t size);
-    void initialize(char* buffer, size_t size);
+    ~CircularBuffer();
     size_t bytesAvailable();
-    size_t spaceAvailable();
+    size_t capacity();
+    size_t discard(size_t size);
+    size_t peek(void* buf, size_t size, size_t offset);
     size_t read(void* buf, size_t size);
+    bool reserve(size_t size);
+    bool resize(size_t size);
+    size_t spaceAvailable();
     size_t write(const void* buf, size_t size);
 private:
-    char* buffer;
-    size_t bufferSize;
+    char** pages;
+    size_t numPages;
     size_t readPosition;
     size_t bytesStored;
 };
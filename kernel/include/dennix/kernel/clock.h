@@ -38,6 +38,7 @@ private:
     struct timespec value;
 };
 
+struct timespec timespecMinus(struct timespec ts1, struct timespec ts2);
 struct timespec timespecPlus(struct timespec ts1, struct timespec ts2);
 bool timespecLess(struct timespec ts1, struct timespec ts2);
 
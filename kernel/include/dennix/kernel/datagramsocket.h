@@ -0,0 +1,75 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/kernel/datagramsocket.h
+ * Unix domain datagram sockets.
+ */
+
+#ifndef KERNEL_DATAGRAMSOCKET_H
+#define KERNEL_DATAGRAMSOCKET_H
+
+#include <dennix/un.h>
+#include <dennix/kernel/socket.h>
+
+// The default and maximum sizes for SO_RCVBUF and SO_SNDBUF. The send buffer
+// size limits the size of a single datagram.
+#define DATAGRAM_SOCKET_DEFAULT_BUFFER (256 * 1024)
+#define DATAGRAM_SOCKET_MAX_BUFFER (16 * 1024 * 1024)
+
+class DatagramSocket : public Socket {
+private:
+    struct Datagram {
+        Datagram* next;
+        struct sockaddr_un sender;
+        // The rights of a datagram are kept in the queue of the socket.
+        bool hasRights;
+        size_t size;
+        // The data follows the header.
+    };
+public:
+    DatagramSocket(mode_t mode);
+    ~DatagramSocket();
+    int bind(const struct sockaddr* address, socklen_t length, int flags)
+            override;
+    int connect(const struct sockaddr* address, socklen_t length, int flags)
+            override;
+    int getsockopt(int level, int name, void* restrict value,
+            socklen_t* restrict length) override;
+    short poll() override;
+    ssize_t read(void* buffer, size_t size, int flags) override;
+    ssize_t readv(const struct iovec* iov, int iovcnt, int flags) override;
+    ssize_t recvmsg(struct msghdr* msg, int flags, int fileFlags) override;
+    ssize_t sendmsg(const struct msghdr* msg, int flags, int fileFlags)
+            override;
+    int setsockopt(int level, int name, const void* value, socklen_t length)
+            override;
+    ssize_t write(const void* buffer, size_t size, int flags) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, int flags) override;
+private:
+    bool enqueue(Datagram* datagram, SocketRights* rights, int fileFlags);
+private:
+    kthread_mutex_t socketMutex;
+    kthread_cond_t receiveCond;
+    kthread_cond_t sendCond;
+    struct sockaddr_un boundAddress;
+    struct sockaddr_un peerAddress;
+    Datagram* firstDatagram;
+    Datagram* lastDatagram;
+    size_t bytesQueued;
+    size_t receiveBufferSize;
+    size_t sendBufferSize;
+};
+
+#endif
@@ -29,7 +29,8 @@ public:
     ~DirectoryVnode();
     Reference<Vnode> getChildNode(const char* name) override;
     Reference<Vnode> getChildNode(const char* path, size_t length) override;
-    size_t getDirectoryEntries(void** buffer, int flags) override;
+    ssize_t getDirectoryEntries(void* buffer, size_t size, off_t* offset,
+            int flags) override;
     int link(const char* name, const Reference<Vnode>& vnode) override;
     off_t lseek(off_t offset, int whence) override;
     int mkdir(const char* name, mode_t mode) override;
@@ -30,6 +30,7 @@ public:
     DynamicArray() {
         allocatedSize = 0;
         buffer = nullptr;
+        freeSlots = nullptr;
     }
 
     ~DynamicArray() {
@@ -37,6 +38,7 @@ public:
             buffer[i].~T();
         }
         free(buffer);
+        free(freeSlots);
     }
 
     TSize add(const T& obj) {
@@ -44,20 +46,24 @@ public:
     }
 
     TSize addAt(TSize index, const T& obj) {
-        TSize i;
-        for (i = index; i < allocatedSize; i++) {
-            if (!buffer[i]) {
-                buffer[i] = obj;
-                return i;
+        TSize i = findFree(index);
+        if (i >= allocatedSize) {
+            // Grow geometrically so that adding many entries is not quadratic.
+            TSize newSize;
+            if (__builtin_add_overflow(i, 1, &newSize)) {
+                return (TSize) -1;
             }
+            TSize doubledSize;
+            if (!__builtin_mul_overflow(allocatedSize, 2, &doubledSize) &&
+                    doubledSize > newSize) {
+                newSize = doubledSize;
+            }
+            if (newSize < 8) newSize = 8;
+            if (!resize(newSize)) return (TSize) -1;
         }
 
-        TSize newSize;
-        if (__builtin_add_overflow(i, 1, &newSize)) {
-            return (TSize) -1;
-        }
-        if (!resize(newSize)) return (TSize) -1;
         buffer[i] = obj;
+        markUsed(i);
         return i;
     }
 
@@ -66,8 +72,10 @@ public:
             buffer[i].~T();
         }
         free(buffer);
+        free(freeSlots);
         allocatedSize = 0;
         buffer = nullptr;
+        freeSlots = nullptr;
     }
 
     TSize insert(TSize index, const T& obj) {
@@ -81,6 +89,7 @@ public:
         }
 
         buffer[index] = obj;
+        markUsed(index);
         return index;
     }
 
@@ -91,17 +100,34 @@ public:
         return (TSize) -1;
     }
 
+    // Entries must be freed using this function rather than by assigning to
+    // them so that the slot can be found again by add().
     void remove(TSize index) {
         buffer[index] = T();
+        freeSlots[index / bitsPerWord] |= 1UL << (index % bitsPerWord);
     }
 
     bool resize(TSize size) {
         assert(size > allocatedSize);
+        size_t oldWords = ((size_t) allocatedSize + bitsPerWord - 1) /
+                bitsPerWord;
+        size_t newWords = ((size_t) size + bitsPerWord - 1) / bitsPerWord;
+        if (newWords > oldWords) {
+            unsigned long* newFreeSlots = (unsigned long*) reallocarray(
+                    freeSlots, newWords, sizeof(unsigned long));
+            if (!newFreeSlots) return false;
+            freeSlots = newFreeSlots;
+            for (size_t i = oldWords; i < newWords; i++) {
+                freeSlots[i] = 0;
+            }
+        }
+
         T* newBuffer = (T*) reallocarray(buffer, (size_t) size, sizeof(T));
         if (!newBuffer) return false;
         buffer = newBuffer;
         for (TSize i = allocatedSize; i < size; i++) {
             new (&buffer[i]) T();
+            freeSlots[i / bitsPerWord] |= 1UL << (i % bitsPerWord);
         }
         allocatedSize = size;
         return true;
@@ -112,10 +138,44 @@ public:
         return buffer[index];
     }
 
+private:
+    // Returns the lowest free index that is not less than index. A set bit in
+    // freeSlots only means that the slot might be free because entries can
+    // also be filled through operator[], so each candidate is checked.
+    TSize findFree(TSize index) {
+        if (index >= allocatedSize) return index;
+
+        size_t numWords = ((size_t) allocatedSize + bitsPerWord - 1) /
+                bitsPerWord;
+        size_t word = index / bitsPerWord;
+        unsigned long mask = ~0UL << (index % bitsPerWord);
+
+        for (; word < numWords; word++) {
+            unsigned long bits = freeSlots[word] & mask;
+            mask = ~0UL;
+
+            while (bits) {
+                size_t bit = __builtin_ctzl(bits);
+                TSize i = word * bitsPerWord + bit;
+                if (!buffer[i]) return i;
+                freeSlots[word] &= ~(1UL << bit);
+                bits &= bits - 1;
+            }
+        }
+
+        return allocatedSize;
+    }
+
+    void markUsed(TSize index) {
+        freeSlots[index / bitsPerWord] &= ~(1UL << (index % bitsPerWord));
+    }
+
 public:
     TSize allocatedSize;
 private:
     T* buffer;
+    unsigned long* freeSlots;
+    static const size_t bitsPerWord = sizeof(unsigned long) * 8;
 };
 
 #endif
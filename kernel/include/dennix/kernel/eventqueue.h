@@ -0,0 +1,76 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/kernel/eventqueue.h
+ * Event queues.
+ */
+
+#ifndef KERNEL_EVENTQUEUE_H
+#define KERNEL_EVENTQUEUE_H
+
+#include <dennix/epoll.h>
+#include <dennix/kernel/hashtable.h>
+#include <dennix/kernel/vnode.h>
+
+class EventQueue;
+class FileDescription;
+
+class EventRegistration : public EventListener {
+public:
+    EventRegistration(EventQueue* queue, FileDescription* descr, int fd,
+            const struct epoll_event* event);
+    int hashKey() { return fd; }
+    void onEvent() override;
+public:
+    EventQueue* queue;
+    FileDescription* descr;
+    int fd;
+    struct epoll_event event;
+    bool enabled;
+    bool queued;
+    EventRegistration* nextInHashTable;
+    EventRegistration* prevReady;
+    EventRegistration* nextReady;
+    EventRegistration* prevInDescription;
+    EventRegistration* nextInDescription;
+};
+
+class EventQueue : public Vnode {
+public:
+    EventQueue();
+    ~EventQueue();
+    int control(int op, int fd, FileDescription* descr,
+            const struct epoll_event* event);
+    bool isEventQueue() override;
+    short poll() override;
+    int wait(struct epoll_event* events, int maxEvents,
+            const struct timespec* endTime);
+    static void removeRegistrations(FileDescription* descr);
+private:
+    int collectEvents(struct epoll_event* events, int maxEvents);
+    void enqueue(EventRegistration* registration);
+    void removeRegistration(EventRegistration* registration);
+    void unlinkReady(EventRegistration* registration);
+private:
+    EventRegistration* registrationBuckets[64];
+    HashTable<EventRegistration, int> registrations;
+    EventRegistration* firstReady;
+    EventRegistration* lastReady;
+    kthread_mutex_t readyMutex;
+    kthread_cond_t readyCond;
+    friend EventRegistration;
+};
+
+#endif
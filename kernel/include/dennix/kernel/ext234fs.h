@@ -225,6 +225,8 @@ public:
     void dropVnodeReference(ino_t ino);
     void finishDropVnodeReference();
     uint64_t getBlockGroup(ino_t ino);
+    off_t getDeviceOffset(const Inode* inode, off_t offset,
+            BlockCacheDevice** blockDevice);
     struct timespec getInodeATime(const Inode* inode);
     struct timespec getInodeCTime(const Inode* inode);
     struct timespec getInodeMTime(const Inode* inode);
@@ -290,7 +292,10 @@ public:
     int ftruncate(off_t length) override;
     Reference<Vnode> getChildNode(const char* name) override;
     Reference<Vnode> getChildNode(const char* path, size_t length) override;
-    size_t getDirectoryEntries(void** buffer, int flags) override;
+    off_t getDeviceOffset(off_t offset, BlockCacheDevice** blockDevice)
+            override;
+    ssize_t getDirectoryEntries(void* buffer, size_t size, off_t* offset,
+            int flags) override;
     char* getLinkTarget() override;
     ino_t hashKey() { return stats.st_ino; }
     bool isSeekable() override;
@@ -26,15 +26,28 @@ class FileVnode : public Vnode, public ConstructorMayFail {
 public:
     FileVnode(const void* data, size_t size, mode_t mode, dev_t dev);
     ~FileVnode();
+    bool addSharedMapping(off_t offset, size_t size) override;
     int ftruncate(off_t length) override;
     bool isSeekable() override;
+    paddr_t getSharedPage(off_t offset) override;
     off_t lseek(off_t offset, int whence) override;
     short poll() override;
     ssize_t pread(void* buffer, size_t size, off_t offset, int flags) override;
     ssize_t pwrite(const void* buffer, size_t size, off_t offset, int flags)
             override;
-public:
-    char* data;
+    void removeSharedMapping() override;
+private:
+    char* getPage(size_t index, bool allocate);
+    void freePages(size_t firstPage);
+    ssize_t writeData(const char* buffer, size_t size, off_t offset);
+private:
+    // File contents are stored in a radix tree of pages. Pages that have
+    // never been written are not allocated and read as zeros.
+    vaddr_t* pageTree;
+    unsigned int treeLevels;
+    // The file cannot shrink while it is mapped shared because the mapped
+    // pages must stay allocated.
+    size_t sharedMappings;
 };
 
 #endif
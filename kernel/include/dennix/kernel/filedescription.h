@@ -22,6 +22,8 @@
 
 #include <dennix/kernel/vnode.h>
 
+class EventRegistration;
+
 class FileDescription : public ReferenceCounted {
 public:
     FileDescription(const Reference<Vnode>& vnode, int flags);
@@ -35,15 +37,22 @@ public:
     off_t lseek(off_t offset, int whence);
     Reference<FileDescription> openat(const char* path, int flags,
             mode_t mode);
+    ssize_t preadv(const struct iovec* iov, int iovcnt, off_t offset);
+    ssize_t pwritev(const struct iovec* iov, int iovcnt, off_t offset);
     ssize_t read(void* buffer, size_t size);
+    ssize_t readv(const struct iovec* iov, int iovcnt);
+    ssize_t recvmsg(struct msghdr* msg, int flags);
+    ssize_t sendmsg(const struct msghdr* msg, int flags);
+    ssize_t splice(const Reference<FileDescription>& out, off_t* inOffset,
+            off_t* outOffset, size_t size, int flags);
     int tcgetattr(struct termios* result);
     int tcsetattr(int flags, const struct termios* termio);
     ssize_t write(const void* buffer, size_t size);
+    ssize_t writev(const struct iovec* iov, int iovcnt);
 public:
     Reference<Vnode> vnode;
+    EventRegistration* eventRegistrations;
 private:
-    void* dents;
-    size_t dentsSize;
     off_t offset;
     int fileFlags;
 };
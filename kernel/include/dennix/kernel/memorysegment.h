@@ -23,33 +23,42 @@
 #include <dennix/kernel/kernel.h>
 
 #define SEG_NOUNMAP (1 << 16)
+#define SEG_SHARED (1 << 18)
+#define SEG_VDSO (1 << 19)
 
 class MemorySegment {
 public:
-    MemorySegment(vaddr_t address, size_t size, int flags, MemorySegment* prev,
-            MemorySegment* next);
+    MemorySegment(vaddr_t address, size_t size, int flags);
 public:
     vaddr_t address;
     size_t size;
     int flags;
     MemorySegment* prev;
     MemorySegment* next;
+    // Segments are kept in an AVL tree ordered by address. Each node stores
+    // the largest free space following any segment in its subtree.
+    MemorySegment* parent;
+    MemorySegment* left;
+    MemorySegment* right;
+    size_t maxGap;
+    int height;
 public:
-    static bool addSegment(MemorySegment* firstSegment, vaddr_t address,
-            size_t size, int protection);
+    static void addSegment(MemorySegment** tree, MemorySegment* newSegment);
+    static bool addSegment(MemorySegment** tree, vaddr_t address, size_t size,
+            int protection);
     static void deallocateSegment(MemorySegment* segment);
-    static void removeSegment(MemorySegment* firstSegment, vaddr_t address,
+    static void removeSegment(MemorySegment** tree, vaddr_t address,
             size_t size);
-    static vaddr_t findAndAddNewSegment(MemorySegment* firstSegment,
-            size_t size, int protection);
+    static vaddr_t findAndAddNewSegment(MemorySegment** tree, size_t size,
+            int protection, size_t alignment = PAGESIZE);
+    static MemorySegment* getSegment(MemorySegment* tree, vaddr_t address);
 private:
-    static void addSegment(MemorySegment* firstSegment,
-            MemorySegment* newSegment);
     static MemorySegment* allocateSegment(vaddr_t address, size_t size,
             int flags);
-    static MemorySegment* findFreeSegment(MemorySegment* firstSegment,
-            size_t size);
-    static bool verifySegmentList();
+    static MemorySegment* findFreeSegment(MemorySegment* tree, size_t size);
+    static void releaseSegment(MemorySegment* segment);
+    static void removeFromTree(MemorySegment** tree, MemorySegment* segment);
+    static bool reserveSegments();
 };
 
 #endif
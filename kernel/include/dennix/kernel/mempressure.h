@@ -0,0 +1,37 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/kernel/mempressure.h
+ * Memory pressure device.
+ */
+
+#ifndef KERNEL_MEMPRESSURE_H
+#define KERNEL_MEMPRESSURE_H
+
+#include <dennix/kernel/vnode.h>
+
+class MemoryPressureDevice : public Vnode {
+public:
+    MemoryPressureDevice();
+    short poll() override;
+    ssize_t read(void* buffer, size_t size, int flags) override;
+    void setPressure(bool pressure);
+private:
+    bool pressure;
+};
+
+extern Reference<MemoryPressureDevice> memoryPressureDevice;
+
+#endif
@@ -25,6 +25,8 @@
 class Partition : public Vnode {
 public:
     Partition(const Reference<Vnode>& device, off_t offset, size_t size);
+    off_t getDeviceOffset(off_t offset, BlockCacheDevice** blockDevice)
+            override;
     bool isSeekable() override;
     off_t lseek(off_t offset, int whence) override;
     short poll() override;
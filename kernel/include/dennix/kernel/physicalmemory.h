@@ -23,12 +23,21 @@
 #include <dennix/kernel/multiboot2.h>
 
 namespace PhysicalMemory {
+void fillZeroedPool();
+size_t getAvailableFrames();
 void initialize(const multiboot_info* multiboot);
+#ifdef __x86_64__
+paddr_t popLargeReserved(bool zeroed = false);
+#endif
 paddr_t popPageFrame();
 paddr_t popPageFrame32();
-paddr_t popReserved();
+paddr_t popReserved(bool zeroed = false);
+#ifdef __x86_64__
+void pushLargeFrame(paddr_t physicalAddress);
+#endif
 void pushPageFrame(paddr_t physicalAddress);
 bool reserveFrames(size_t frames);
+void startReclaimThread();
 void unreserveFrames(size_t frames);
 }
 
@@ -23,6 +23,11 @@
 #include <dennix/kernel/circularbuffer.h>
 #include <dennix/kernel/vnode.h>
 
+// The default and maximum capacity of a pipe. The capacity can be changed
+// using F_SETPIPE_SZ.
+#define PIPE_DEFAULT_SIZE (64 * 1024)
+#define PIPE_MAX_SIZE (1024 * 1024)
+
 class PipeVnode : public Vnode, public ConstructorMayFail {
 private:
     // The pipe needs to reference count the read and write ends separately.
@@ -33,14 +38,18 @@ private:
     class WriteEnd;
 public:
     PipeVnode(Reference<Vnode>& readPipe, Reference<Vnode>& writePipe);
+    int fcntl(int cmd, int param) override;
     short poll() override;
     ssize_t read(void* buffer, size_t size, int flags) override;
+    ssize_t readv(const struct iovec* iov, int iovcnt, int flags) override;
     ssize_t write(const void* buffer, size_t size, int flags) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, int flags) override;
     virtual ~PipeVnode();
+private:
+    size_t writeWatermark();
 private:
     Vnode* readEnd;
     Vnode* writeEnd;
-    char pipeBuffer[PIPE_BUF];
     CircularBuffer circularBuffer;
     kthread_cond_t readCond;
     kthread_cond_t writeCond;
@@ -35,6 +35,27 @@ struct FdTableEntry {
     operator bool() { return descr; }
 };
 
+struct ProcessInfo {
+    char name[32];
+    pid_t pid;
+    pid_t ppid;
+    pid_t pgid;
+    pid_t sid;
+    char state;
+    const char* waitChannel;
+    size_t threads;
+    struct timespec userTime;
+    struct timespec systemTime;
+    size_t residentSize;
+    ThreadCounters counters;
+};
+
+// A thread waiting for a vfork child to stop using its address space.
+struct VforkWaiter {
+    Thread* thread;
+    bool done;
+};
+
 class Process {
     friend Thread;
 public:
@@ -43,8 +64,10 @@ public:
     int addFileDescriptor(const Reference<FileDescription>& descr, int flags);
     unsigned int alarm(unsigned int seconds);
     int close(int fd);
+    pid_t createThread(regfork_t* registers);
     int dup3(int fd1, int fd2, int flags);
     void exit(int status);
+    NORETURN void exitThread();
     int execute(Reference<Vnode>& vnode, char* const argv[],
             char* const envp[]);
     int fcntl(int fd, int cmd, int param);
@@ -52,13 +75,15 @@ public:
     bool isParentOf(Process* process);
     void raiseSignal(siginfo_t siginfo);
     void raiseSignalForGroup(siginfo_t siginfo);
-    Process* regfork(int flags, regfork_t* registers);
+    pid_t regfork(int flags, regfork_t* registers);
     int setpgid(pid_t pgid);
     pid_t setsid();
     void terminateBySignal(siginfo_t siginfo);
     Process* waitpid(pid_t pid, int flags);
 private:
+    void releaseVforkParent();
     void removeFromGroup();
+    bool stopOtherThreads();
     void terminate();
 public:
     AddressSpace* addressSpace;
@@ -68,6 +93,7 @@ public:
     Clock cpuClock;
     Reference<FileDescription> cwdFd;
     Thread mainThread;
+    char name[32];
     pid_t pid;
     pid_t pgid;
     pid_t sid;
@@ -78,10 +104,14 @@ public:
     siginfo_t terminationStatus;
     mode_t umask;
     Clock userCpuClock;
+    vaddr_t vdso;
 private:
+    kthread_mutex_t addressSpaceMutex;
     struct timespec alarmTime;
     kthread_mutex_t childrenMutex;
     kthread_mutex_t groupMutex;
+    ThreadCounters exitedThreadCounters;
+    bool exiting;
     DynamicArray<FdTableEntry, int> fdTable;
     Process* firstChild;
     Process* nextChild;
@@ -90,11 +120,19 @@ private:
     Process* prevInGroup;
     Process* nextInGroup;
     bool terminated;
+    size_t threadCount;
+    DynamicArray<Thread*, pid_t> threads;
+    kthread_mutex_t threadsMutex;
+    // Set while a vfork child still uses the address space of its parent.
+    VforkWaiter* vforkWaiter;
 public:
     static bool addProcess(Process* process);
     static Process* current() { return Thread::current()->process; }
     static Process* get(pid_t pid);
     static Process* getGroup(pid_t pgid);
+    static bool getInfo(pid_t pid, ProcessInfo* info);
+    static MemorySegment* getSegments(pid_t pid, size_t* count);
+    static pid_t nextPid(pid_t pid);
     static Process* initProcess;
 private:
     static int copyArguments(char* const argv[], char* const envp[],
@@ -0,0 +1,39 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/kernel/procfs.h
+ * Process information filesystem.
+ */
+
+#ifndef KERNEL_PROCFS_H
+#define KERNEL_PROCFS_H
+
+#include <dennix/kernel/directory.h>
+#include <dennix/kernel/filesystem.h>
+
+class ProcFS : public FileSystem {
+public:
+    Reference<Vnode> getRootDir() override;
+    void initialize(const Reference<DirectoryVnode>& rootDir);
+    bool onUnmount() override;
+private:
+    Reference<Vnode> rootDir;
+public:
+    static const dev_t dev;
+};
+
+extern ProcFS procFS;
+
+#endif
@@ -33,7 +33,8 @@ public:
     DevPts();
     Reference<Vnode> getChildNode(const char* name) override;
     Reference<Vnode> getChildNode(const char* path, size_t length) override;
-    size_t getDirectoryEntries(void** buffer, int flags) override;
+    ssize_t getDirectoryEntries(void* buffer, size_t size, off_t* offset,
+            int flags) override;
     Reference<Vnode> open(const char* name, int flags, mode_t mode) override;
 };
 
@@ -20,13 +20,66 @@
 #ifndef KERNEL_SOCKET_H
 #define KERNEL_SOCKET_H
 
-#include <dennix/kernel/vnode.h>
+#include <dennix/kernel/filedescription.h>
+
+// The maximum number of file descriptors that can be passed in one message.
+#define SOCKET_MAX_RIGHTS 253
+// The maximum number of passed file descriptions that can be queued in a
+// socket.
+#define SOCKET_MAX_QUEUED_RIGHTS 1024
+// Garbage collection is started when more sockets than this are in flight.
+#define SOCKET_GC_THRESHOLD 128
+
+// File descriptions that are passed over a socket using SCM_RIGHTS.
+struct SocketRights {
+    ~SocketRights() { delete[] files; }
+    SocketRights* next;
+    // Stream sockets attach the rights to the byte at this stream offset.
+    uint64_t offset;
+    size_t count;
+    Reference<FileDescription>* files;
+};
 
 class Socket : public Vnode {
 protected:
-    Socket(int type, mode_t mode) : Vnode(S_IFSOCK | mode, 0), type(type) {};
+    Socket(int type, mode_t mode);
+    ~Socket();
+    int bindAddress(const struct sockaddr* address, socklen_t length);
+    bool checkRights(const SocketRights* rights);
+    SocketRights* dequeueRights();
+    static bool getRights(const struct msghdr* msg, SocketRights** rights);
+    static void putRights(struct msghdr* msg, SocketRights* rights,
+            int flags);
+    void queueRights(SocketRights* rights);
+    static Reference<Socket> resolveAddress(const struct sockaddr* address,
+            socklen_t length);
+public:
+    static void collectGarbage();
+    bool isSocket() override;
 public:
     const int type;
+protected:
+    // Rights that have been sent to this socket but not yet received. The
+    // queue is protected by the inflight mutex, but only the receiver removes
+    // rights from it. Rights of garbage sockets are removed by collectGarbage.
+    SocketRights* firstRights;
+    SocketRights* lastRights;
+    size_t queuedRights;
+private:
+    static void addInflight(const SocketRights* rights);
+    static void removeInflight(const SocketRights* rights);
+private:
+    // The number of times a file description of this socket is queued in any
+    // socket. Sockets that are in flight are kept in a list.
+    size_t inflight;
+    FileDescription* inflightDescription;
+    Socket* prevInflight;
+    Socket* nextInflight;
+    // State used during garbage collection.
+    Socket* nextGarbage;
+    size_t gcReferences;
+    bool gcCandidate;
+    bool gcReachable;
 };
 
 #endif
@@ -14,7 +14,7 @@
  */
 
 /* kernel/include/dennix/kernel/streamsocket.h
- * Unix domain stream sockets.
+ * Unix domain stream and sequenced packet sockets.
  */
 
 #ifndef KERNEL_STREAMSOCKET_H
@@ -24,14 +24,18 @@
 #include <dennix/kernel/circularbuffer.h>
 #include <dennix/kernel/socket.h>
 
-class StreamSocket : public Socket, public ConstructorMayFail {
+// The default and maximum sizes for SO_RCVBUF and SO_SNDBUF.
+#define STREAM_SOCKET_DEFAULT_BUFFER (1024 * 1024)
+#define STREAM_SOCKET_MAX_BUFFER (16 * 1024 * 1024)
+
+class StreamSocket : public Socket {
 private:
     struct ConnectionMutex : public ReferenceCounted {
         kthread_mutex_t mutex = KTHREAD_MUTEX_INITIALIZER;
     };
 public:
-    StreamSocket(mode_t mode);
-    StreamSocket(mode_t mode, const Reference<StreamSocket>& peer,
+    StreamSocket(int type, mode_t mode);
+    StreamSocket(int type, mode_t mode, const Reference<StreamSocket>& peer,
             const Reference<ConnectionMutex>& connection);
     ~StreamSocket();
     Reference<Vnode> accept(struct sockaddr* address, socklen_t* length,
@@ -40,12 +44,29 @@ public:
             override;
     int connect(const struct sockaddr* address, socklen_t length, int flags)
             override;
+    static bool createPair(int type, mode_t mode,
+            Reference<StreamSocket>& first, Reference<StreamSocket>& second);
+    int getsockopt(int level, int name, void* restrict value,
+            socklen_t* restrict length) override;
     int listen(int backlog) override;
     short poll() override;
     ssize_t read(void* buffer, size_t size, int flags) override;
+    ssize_t readv(const struct iovec* iov, int iovcnt, int flags) override;
+    ssize_t recvmsg(struct msghdr* msg, int flags, int fileFlags) override;
+    ssize_t sendmsg(const struct msghdr* msg, int flags, int fileFlags)
+            override;
+    int setsockopt(int level, int name, const void* value, socklen_t length)
+            override;
     ssize_t write(const void* buffer, size_t size, int flags) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, int flags) override;
 private:
     bool addConnection(const Reference<StreamSocket>& socket);
+    bool resizeReceiveBuffer();
+    ssize_t sendPacket(const struct msghdr* msg, size_t size,
+            SocketRights*& rights, int flags, int fileFlags);
+    ssize_t sendStream(const struct msghdr* msg, SocketRights*& rights,
+            int flags, int fileFlags);
+    bool waitForConnection(int flags);
 private:
     kthread_mutex_t socketMutex;
     kthread_cond_t acceptCond;
@@ -57,13 +78,18 @@ private:
     Reference<StreamSocket> firstConnection;
     Reference<StreamSocket> lastConnection;
     Reference<StreamSocket> nextConnection;
+    size_t receiveBufferSize;
+    size_t sendBufferSize;
 private:
     Reference<ConnectionMutex> connectionMutex;
     kthread_cond_t receiveCond;
     kthread_cond_t sendCond;
     StreamSocket* peer;
-    char* receiveBuffer;
     CircularBuffer circularBuffer;
+    // The number of bytes that have ever been read from and written to the
+    // circular buffer. These are used to find the data that rights belong to.
+    uint64_t readOffset;
+    uint64_t writeOffset;
 };
 
 #endif
@@ -0,0 +1,42 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/kernel/swap.h
+ * Swapping of anonymous memory.
+ */
+
+#ifndef KERNEL_SWAP_H
+#define KERNEL_SWAP_H
+
+#include <dennix/kernel/vnode.h>
+
+// Swap slots are stored in page table entries in place of the frame number.
+#ifdef __i386__
+#  define SWAP_MAX_SLOTS ((size_t) 1 << 20)
+#else
+#  define SWAP_MAX_SLOTS ((size_t) 1 << 40)
+#endif
+
+namespace Swap {
+bool activate(const Reference<Vnode>& vnode);
+size_t allocateSlot();
+void freeSlot(size_t slot);
+void getUsage(size_t* total, size_t* free);
+bool isEnabled();
+bool readPage(size_t slot, paddr_t physicalAddress);
+bool writePage(size_t slot, paddr_t physicalAddress);
+}
+
+#endif
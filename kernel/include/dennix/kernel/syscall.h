@@ -29,9 +29,12 @@
 #include <dennix/timespec.h>
 #include <dennix/kernel/kernel.h>
 
+struct epoll_event;
 struct fchownatParams;
 struct meminfo;
 struct __mmapRequest;
+struct iovec;
+struct spliceParams;
 struct stat;
 
 namespace Syscall {
@@ -46,11 +49,18 @@ int clock_nanosleep(clockid_t clockid, int flags,
 int close(int fd);
 size_t confstr(int name, char* buffer, size_t size);
 int connect(int fd, const struct sockaddr* address, socklen_t length);
+ssize_t copy_file_range(struct spliceParams* params);
 int devctl(int fd, int command, void* restrict data, size_t size,
         int* restrict info);
 int dup3(int fd1, int fd2, int flags);
+int epoll_create1(int flags);
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event* event);
+int epoll_pwait2(int epfd, struct epoll_event* events, int maxEvents,
+        const struct timespec* timeout, const sigset_t* sigmask);
 int execve(const char* path, char* const argv[], char* const envp[]);
 NORETURN void exit(int status);
+NORETURN void exit_thread(void* unmapAddress, size_t unmapSize,
+        int* clearAddress);
 int fchdir(int);
 int fchdirat(int fd, const char* path);
 int fchmod(int fd, mode_t mode);
@@ -64,12 +74,15 @@ int fstat(int fd, struct stat* result);
 int fstatat(int fd, const char* restrict path, struct stat* restrict result,
         int flags);
 int ftruncate(int fd, off_t length);
+int futex(int* address, int op, int value, const struct timespec* timeout);
 int futimens(int fd, const struct timespec ts[2]);
 ssize_t getdents(int fd, void* buffer, size_t size, int flags);
 int getentropy(void* buffer, size_t size);
 pid_t getpid();
 pid_t getpgid(pid_t pid);
 int getrusagens(int who, struct rusagens* usage);
+int getsockopt(int fd, int level, int name, void* restrict value,
+        socklen_t* restrict length);
 int isatty(int fd);
 int kill(pid_t pid, int signal);
 int linkat(int oldFd, const char* oldPath, int newFd, const char* newPath,
@@ -86,19 +99,31 @@ int openat(int fd, const char* path, int flags, mode_t mode);
 int pipe2(int fd[2], int flags);
 int ppoll(struct pollfd fds[], nfds_t nfds, const struct timespec* timeout,
         const sigset_t* sigmask);
+ssize_t preadv(int fd, const struct iovec* iov, int iovcnt, off_t offset);
+ssize_t pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset);
 ssize_t read(int fd, void* buffer, size_t size);
 ssize_t readlinkat(int fd, const char* restrict path, char* restrict buffer,
         size_t size);
+ssize_t readv(int fd, const struct iovec* iov, int iovcnt);
+ssize_t recvmsg(int fd, struct msghdr* msg, int flags);
 int renameat(int oldFd, const char* oldPath, int newFd, const char* newPath);
 pid_t regfork(int flags, regfork_t* registers);
+ssize_t sendfile(int outFd, int inFd, off_t* offset, size_t count);
+ssize_t sendmsg(int fd, const struct msghdr* msg, int flags);
+int set_thread_pointer(void* pointer);
 int setpgid(pid_t pid, pid_t pgid);
 pid_t setsid();
+int setsockopt(int fd, int level, int name, const void* value,
+        socklen_t length);
 int sigaction(int signal, const struct sigaction* restrict action,
         struct sigaction* restrict old);
 int sigprocmask(int how, const sigset_t* restrict set, sigset_t* restrict old);
 int sigtimedwait(const sigset_t* set, siginfo_t* info,
         const struct timespec* timeout);
 int socket(int domain, int type, int protocol);
+int socketpair(int domain, int type, int protocol, int fd[2]);
+ssize_t splice(struct spliceParams* params);
+int swapon(const char* path);
 int symlinkat(const char* targetPath, int fd, const char* linkPath);
 int tcgetattr(int fd, struct termios* result);
 int tcsetattr(int fd, int flags, const struct termios* termio);
@@ -108,6 +133,7 @@ int unmount(const char* mountPath);
 int utimensat(int fd, const char* path, const struct timespec ts[2], int flags);
 pid_t waitpid(pid_t pid, int* status, int flags);
 ssize_t write(int fd, const void* buffer, size_t size);
+ssize_t writev(int fd, const struct iovec* iov, int iovcnt);
 
 void badSyscall();
 
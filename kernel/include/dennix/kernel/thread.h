@@ -25,6 +25,7 @@
 #include <dennix/kernel/interrupts.h>
 #include <dennix/kernel/kernel.h>
 #include <dennix/kernel/kthread.h>
+#include <dennix/kernel/worker.h>
 
 class Process;
 
@@ -33,6 +34,26 @@ struct PendingSignal {
     PendingSignal* next;
 };
 
+// Statistics that are exposed in /proc. These are only updated by the thread
+// itself so that no locking is needed.
+struct ThreadCounters {
+    uint64_t blockReadBytes;
+    uint64_t blockWriteBytes;
+    uint64_t involuntarySwitches;
+    uint64_t pageFaults;
+    uint64_t syscalls;
+    uint64_t voluntarySwitches;
+
+    void add(const ThreadCounters& other) {
+        blockReadBytes += other.blockReadBytes;
+        blockWriteBytes += other.blockWriteBytes;
+        involuntarySwitches += other.involuntarySwitches;
+        pageFaults += other.pageFaults;
+        syscalls += other.syscalls;
+        voluntarySwitches += other.voluntarySwitches;
+    }
+};
+
 class Thread {
 public:
     Thread(Process* process);
@@ -41,20 +62,29 @@ public:
     void raiseSignal(siginfo_t siginfo);
     int sigtimedwait(const sigset_t* set, siginfo_t* info,
             const struct timespec* timeout);
+    NORETURN void terminate(bool destroy);
     void updateContext(vaddr_t newKernelStack, InterruptContext* newContext,
             const __fpu_t* newFpuEnv);
     void updatePendingSignals();
+    void wake();
 private:
     void checkSigalarm(bool scheduling);
+    bool isRunnable(const struct timespec& now);
     void raiseSignalUnlocked(siginfo_t siginfo);
 public:
+    ThreadCounters counters;
     Clock cpuClock;
     __fpu_t fpuEnv;
     Process* process;
     sigset_t returnSignalMask;
     sigset_t signalMask;
+    pid_t tid;
+    vaddr_t tlsBase;
+    // Describes what the thread is currently blocked on or is null.
+    const char* waitChannel;
 private:
     bool contextChanged;
+    WorkerJob deleteJob;
     InterruptContext* interruptContext;
     vaddr_t kernelStack;
     Thread* next;
@@ -62,18 +92,42 @@ private:
     Thread* prev;
     kthread_mutex_t signalMutex;
     kthread_cond_t signalCond;
+    bool sleeping;
+    struct timespec wakeTime;
 public:
     static void addThread(Thread* thread);
+    static Thread* createKernelThread(void (*function)(void));
     static Thread* current() { return _current; }
     static Thread* idleThread;
     static void initializeIdleThread();
     static void removeThread(Thread* thread);
-    static InterruptContext* schedule(InterruptContext* context);
+    static InterruptContext* schedule(InterruptContext* context,
+            bool voluntary);
+    static void sleep(const struct timespec* wakeTime);
 private:
     static Thread* _current;
 };
 
+class AutoWaitChannel {
+public:
+    AutoWaitChannel(const char* name) {
+        thread = Thread::current();
+        if (thread) {
+            thread->waitChannel = name;
+        }
+    }
+
+    ~AutoWaitChannel() {
+        if (thread) {
+            thread->waitChannel = nullptr;
+        }
+    }
+private:
+    Thread* thread;
+};
+
 void setKernelStack(uintptr_t stack);
+void setThreadPointer(uintptr_t pointer);
 extern "C" {
 extern __fpu_t initFpu;
 }
@@ -0,0 +1,48 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/kernel/trace.h
+ * Kernel tracing.
+ */
+
+#ifndef KERNEL_TRACE_H
+#define KERNEL_TRACE_H
+
+#include <dennix/trace.h>
+#include <dennix/kernel/vnode.h>
+
+// Bitmask of enabled events. This is checked by the TRACE macro so that
+// disabled tracepoints only cost a memory access and a branch.
+extern "C" volatile unsigned int traceEvents;
+
+#define TRACE(type, arg0, arg1) do { \
+    if (unlikely(traceEvents & (1U << (type)))) { \
+        Trace::record((type), (arg0), (arg1)); \
+    } \
+} while (0)
+
+class TraceDevice : public Vnode {
+public:
+    TraceDevice();
+    int devctl(int command, void* restrict data, size_t size,
+            int* restrict info) override;
+    ssize_t read(void* buffer, size_t size, int flags) override;
+};
+
+namespace Trace {
+void record(unsigned int type, unsigned long arg0, unsigned long arg1);
+}
+
+#endif
@@ -0,0 +1,35 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/kernel/vdso.h
+ * Virtual dynamic shared object.
+ */
+
+#ifndef KERNEL_VDSO_H
+#define KERNEL_VDSO_H
+
+#include <dennix/vdso.h>
+#include <dennix/kernel/addressspace.h>
+
+namespace Vdso {
+void initialize();
+vaddr_t map(AddressSpace* addressSpace, pid_t pid);
+bool setPid(AddressSpace* addressSpace, vaddr_t vdso, pid_t pid);
+// This must be called with interrupts disabled.
+void updateClocks(const struct timespec& monotonic,
+        const struct timespec& realtime);
+}
+
+#endif
@@ -22,16 +22,31 @@
 
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <dennix/stat.h>
 #include <dennix/kernel/kthread.h>
 #include <dennix/kernel/refcount.h>
 
+class BlockCacheDevice;
 class FileSystem;
 
+class EventListener {
+public:
+    // Called when the state of a watched vnode might have changed. This is
+    // called with the vnode locked and must not block.
+    virtual void onEvent() = 0;
+    virtual ~EventListener() {}
+public:
+    EventListener* prevListener;
+    EventListener* nextListener;
+};
+
 class Vnode : public ReferenceCounted {
 public:
     virtual Reference<Vnode> accept(struct sockaddr* address,
             socklen_t* length, int fileFlags);
+    void addEventListener(EventListener* listener);
+    virtual bool addSharedMapping(off_t offset, size_t size);
     virtual int bind(const struct sockaddr* address, socklen_t length,
             int flags);
     virtual int chmod(mode_t mode);
@@ -40,31 +55,52 @@ public:
             int flags);
     virtual int devctl(int command, void* restrict data, size_t size,
             int* restrict info);
+    virtual int fcntl(int cmd, int param);
     virtual int ftruncate(off_t length);
     virtual Reference<Vnode> getChildNode(const char* path);
     virtual Reference<Vnode> getChildNode(const char* path, size_t length);
-    virtual size_t getDirectoryEntries(void** buffer, int flags);
+    virtual ssize_t getDirectoryEntries(void* buffer, size_t size,
+            off_t* offset, int flags);
+    virtual off_t getDeviceOffset(off_t offset, BlockCacheDevice** device);
     virtual char* getLinkTarget();
+    virtual paddr_t getSharedPage(off_t offset);
+    virtual int getsockopt(int level, int name, void* restrict value,
+            socklen_t* restrict length);
     virtual int isatty();
+    virtual bool isEventQueue();
     virtual bool isSeekable();
+    virtual bool isSocket();
     virtual int link(const char* name, const Reference<Vnode>& vnode);
     virtual int listen(int backlog);
     virtual off_t lseek(off_t offset, int whence);
     virtual int mkdir(const char* name, mode_t mode);
     virtual int mount(FileSystem* filesystem);
+    void notifyEventListeners();
     virtual void onLink();
     virtual bool onUnlink(bool force);
     virtual Reference<Vnode> open(const char* name, int flags, mode_t mode);
     virtual long pathconf(int name);
     virtual short poll();
     virtual ssize_t pread(void* buffer, size_t size, off_t offset, int flags);
+    virtual ssize_t preadv(const struct iovec* iov, int iovcnt, off_t offset,
+            int flags);
     virtual ssize_t pwrite(const void* buffer, size_t size, off_t offset,
                 int flags);
+    virtual ssize_t pwritev(const struct iovec* iov, int iovcnt, off_t offset,
+            int flags);
     virtual ssize_t read(void* buffer, size_t size, int flags);
     virtual ssize_t readlink(char* buffer, size_t size);
+    virtual ssize_t readv(const struct iovec* iov, int iovcnt, int flags);
+    virtual ssize_t recvmsg(struct msghdr* msg, int flags, int fileFlags);
+    void removeEventListener(EventListener* listener);
+    virtual void removeSharedMapping();
     virtual int rename(const Reference<Vnode>& oldDirectory,
             const char* oldName, const char* newName);
     virtual Reference<Vnode> resolve();
+    virtual ssize_t sendmsg(const struct msghdr* msg, int flags,
+            int fileFlags);
+    virtual int setsockopt(int level, int name, const void* value,
+            socklen_t length);
     virtual int stat(struct stat* result);
     struct stat stat();
     virtual int symlink(const char* linkTarget, const char* name);
@@ -76,6 +112,7 @@ public:
     void updateTimestampsLocked(bool access, bool status, bool modification);
     virtual int utimens(struct timespec atime, struct timespec mtime);
     virtual ssize_t write(const void* buffer, size_t size, int flags);
+    virtual ssize_t writev(const struct iovec* iov, int iovcnt, int flags);
     virtual ~Vnode();
 protected:
     Vnode(mode_t mode, dev_t dev);
@@ -83,6 +120,9 @@ protected:
 public:
     kthread_mutex_t mutex;
     struct stat stats;
+private:
+    EventListener* firstListener;
+    kthread_mutex_t listenerMutex;
 };
 
 Reference<Vnode> resolvePath(const Reference<Vnode>& vnode, const char* path,
@@ -90,5 +130,7 @@ Reference<Vnode> resolvePath(const Reference<Vnode>& vnode, const char* path,
 Reference<Vnode> resolvePathExceptLastComponent(const Reference<Vnode>& vnode,
         const char* path, const char** lastComponent,
         bool followFinalSymlink = false);
+bool addDirectoryEntry(void* buffer, size_t size, size_t* used, ino_t ino,
+        unsigned char type, const char* name, size_t nameLength);
 
 #endif
@@ -20,16 +20,27 @@
 #ifndef KERNEL_WORKER_H
 #define KERNEL_WORKER_H
 
+#include <dennix/kernel/clock.h>
 #include <dennix/kernel/kernel.h>
 
+#define WORKER_PRIORITY_HIGH 0
+#define WORKER_PRIORITY_NORMAL 1
+#define WORKER_PRIORITY_LOW 2
+#define WORKER_PRIORITIES 3
+
 struct WorkerJob {
     void (*func)(void*);
     void* context;
     struct WorkerJob* next;
+    int priority;
+    // The time at which a delayed job becomes ready.
+    struct timespec time;
 };
 
 namespace WorkerThread {
-void addJob(WorkerJob* job);
+void addDelayedJob(WorkerJob* job, const struct timespec* delay,
+        int priority = WORKER_PRIORITY_NORMAL);
+void addJob(WorkerJob* job, int priority = WORKER_PRIORITY_NORMAL);
 void initialize();
 }
 
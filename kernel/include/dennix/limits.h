@@ -22,6 +22,7 @@
 
 #define FILESIZEBITS 64
 #define _GETENTROPY_MAX 256
+#define IOV_MAX 1024
 #define PAGESIZE 0x1000
 #define PAGE_SIZE PAGESIZE
 #define PIPE_BUF 4096
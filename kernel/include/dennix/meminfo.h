@@ -24,7 +24,8 @@ struct meminfo {
     __SIZE_TYPE__ mem_total;
     __SIZE_TYPE__ mem_free;
     __SIZE_TYPE__ mem_available;
-    __SIZE_TYPE__ __reserved;
+    __SIZE_TYPE__ swap_total;
+    __SIZE_TYPE__ swap_free;
 };
 
 #endif
@@ -21,6 +21,7 @@
 #define _DENNIX_SOCKET_H
 
 #include <dennix/types.h>
+#include <dennix/uio.h>
 
 struct sockaddr {
     __sa_family_t sa_family;
@@ -42,5 +43,55 @@ struct sockaddr_storage {
 #define _SOCK_FLAGS (SOCK_CLOEXEC | SOCK_CLOFORK | SOCK_NONBLOCK)
 
 #define SOCK_STREAM (1 << 3)
+#define SOCK_SEQPACKET (1 << 4)
+#define SOCK_DGRAM (1 << 5)
+
+#define SOL_SOCKET 1
+
+#define SO_RCVBUF 1
+#define SO_SNDBUF 2
+
+#define MSG_CTRUNC (1 << 0)
+#define MSG_DONTWAIT (1 << 1)
+#define MSG_EOR (1 << 2)
+#define MSG_NOSIGNAL (1 << 3)
+#define MSG_PEEK (1 << 4)
+#define MSG_TRUNC (1 << 5)
+#define MSG_CMSG_CLOEXEC (1 << 6)
+#define MSG_CMSG_CLOFORK (1 << 7)
+
+#define SCM_RIGHTS 1
+
+struct msghdr {
+    void* msg_name;
+    __socklen_t msg_namelen;
+    struct iovec* msg_iov;
+    int msg_iovlen;
+    void* msg_control;
+    __socklen_t msg_controllen;
+    int msg_flags;
+};
+
+struct cmsghdr {
+    __socklen_t cmsg_len;
+    int cmsg_level;
+    int cmsg_type;
+};
+
+#define _CMSG_ALIGN(length) \
+    (((length) + sizeof(int) - 1) & ~(sizeof(int) - 1))
+#define CMSG_SPACE(length) \
+    (_CMSG_ALIGN(sizeof(struct cmsghdr)) + _CMSG_ALIGN(length))
+#define CMSG_LEN(length) (_CMSG_ALIGN(sizeof(struct cmsghdr)) + (length))
+#define CMSG_DATA(cmsg) \
+    ((unsigned char*) (cmsg) + _CMSG_ALIGN(sizeof(struct cmsghdr)))
+#define CMSG_FIRSTHDR(mhdr) \
+    ((__SIZE_TYPE__) (mhdr)->msg_controllen >= sizeof(struct cmsghdr) ? \
+    (struct cmsghdr*) (mhdr)->msg_control : (struct cmsghdr*) 0)
+#define CMSG_NXTHDR(mhdr, cmsg) \
+    ((char*) (cmsg) + _CMSG_ALIGN((cmsg)->cmsg_len) + \
+    sizeof(struct cmsghdr) > (char*) (mhdr)->msg_control + \
+    (mhdr)->msg_controllen ? (struct cmsghdr*) 0 : \
+    (struct cmsghdr*) ((char*) (cmsg) + _CMSG_ALIGN((cmsg)->cmsg_len)))
 
 #endif
@@ -83,7 +83,26 @@
 #define SYSCALL_FSSYNC 60
 #define SYSCALL_FCHOWN 61
 #define SYSCALL_SETSID 62
+#define SYSCALL_READV 63
+#define SYSCALL_WRITEV 64
+#define SYSCALL_PREADV 65
+#define SYSCALL_PWRITEV 66
+#define SYSCALL_SENDFILE 67
+#define SYSCALL_COPY_FILE_RANGE 68
+#define SYSCALL_SPLICE 69
+#define SYSCALL_EPOLL_CREATE1 70
+#define SYSCALL_EPOLL_CTL 71
+#define SYSCALL_EPOLL_PWAIT2 72
+#define SYSCALL_GETSOCKOPT 73
+#define SYSCALL_SETSOCKOPT 74
+#define SYSCALL_SOCKETPAIR 75
+#define SYSCALL_RECVMSG 76
+#define SYSCALL_SENDMSG 77
+#define SYSCALL_FUTEX 78
+#define SYSCALL_EXIT_THREAD 79
+#define SYSCALL_SET_THREAD_POINTER 80
+#define SYSCALL_SWAPON 81
 
-#define NUM_SYSCALLS 63
+#define NUM_SYSCALLS 82
 
 #endif
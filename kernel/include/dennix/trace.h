@@ -0,0 +1,57 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/trace.h
+ * Kernel tracing.
+ */
+
+#ifndef _DENNIX_TRACE_H
+#define _DENNIX_TRACE_H
+
+#define TRACE_SYSCALL_ENTER 0 /* arg0: syscall number */
+#define TRACE_SYSCALL_EXIT 1 /* arg0: return value */
+#define TRACE_SCHEDULE 2 /* arg0: next pid, arg1: next tid */
+#define TRACE_PAGE_FAULT 3 /* arg0: address, arg1: instruction pointer */
+#define TRACE_BLOCK_HIT 4 /* arg0: block number */
+#define TRACE_BLOCK_MISS 5 /* arg0: block number */
+#define TRACE_ATA_SUBMIT 6 /* arg0: channel, arg1: sector count */
+#define TRACE_ATA_COMPLETE 7 /* arg0: channel, arg1: error */
+#define TRACE_IRQ 8 /* arg0: irq */
+#define TRACE_NUM_EVENTS 9
+
+#ifndef __ASSEMBLER__
+#include <dennix/devctl.h>
+
+/* Set the mask of enabled events. The previous mask is returned in info. */
+#define TRACE_SET_EVENTS _DEVCTL(_IOCTL_INT, 2)
+/* Get information about the trace buffer. */
+#define TRACE_GET_INFO _DEVCTL(_IOCTL_PTR, 9)
+
+struct trace_event {
+    __UINT64_TYPE__ te_timestamp; /* in cpu cycles */
+    unsigned int te_type;
+    __pid_t te_pid;
+    __pid_t te_tid;
+    unsigned long te_arg0;
+    unsigned long te_arg1;
+};
+
+struct trace_info {
+    __UINT64_TYPE__ ti_frequency; /* cpu cycles per second */
+    __UINT64_TYPE__ ti_lost; /* events that were overwritten before reading */
+};
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/include/dennix/vdso.h
+ * Virtual dynamic shared object.
+ */
+
+#ifndef _DENNIX_VDSO_H
+#define _DENNIX_VDSO_H
+
+/* The kernel maps the vDSO into every process and passes its address to the
+   program entry point. The first page is shared by all processes and starts
+   with struct vdso_clocks, the second page is private to the process. */
+#define VDSO_SIZE 0x2000
+#define VDSO_SYSCALL 0x800 /* i686 only: system call entry point */
+#define VDSO_PROCESS 0x1000 /* struct vdso_process */
+
+#ifndef __ASSEMBLER__
+#include <dennix/timespec.h>
+
+struct vdso_clocks {
+    /* Odd while the kernel is updating the clocks. */
+    unsigned long vc_sequence;
+    struct timespec vc_monotonic;
+    struct timespec vc_realtime;
+};
+
+struct vdso_process {
+    __pid_t vp_pid; /* 0 if the pid must be obtained using the syscall */
+};
+#endif
+
+#endif
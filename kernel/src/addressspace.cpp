@@ -17,23 +17,87 @@
  * Address space class.
  */
 
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 #include <dennix/kernel/addressspace.h>
 #include <dennix/kernel/physicalmemory.h>
+#include <dennix/kernel/swap.h>
+#include <dennix/kernel/vnode.h>
 
 #define PAGE_PRESENT (1 << 0)
 #define PAGE_WRITABLE (1 << 1)
 #define PAGE_USER (1 << 2)
+#define PAGE_ACCESSED (1 << 5)
+// Entries of pages that have been swapped out are not present and contain the
+// swap slot instead of the physical address.
+#define PAGE_SWAPPED (1 << 9)
+#define SWAP_ENTRY(slot) ((uintptr_t) (slot) << 12 | PAGE_SWAPPED)
+#define SWAP_SLOT(entry) ((entry) >> 12)
+
+// Invalidating more pages than this one by one is slower than flushing the
+// whole TLB.
+#define INVLPG_THRESHOLD 32
+// Number of pages that are unmapped before the TLB is invalidated and their
+// frames are freed.
+#define UNMAP_BATCH 64
 
 static AddressSpace _kernelSpace;
 AddressSpace* const kernelSpace = &_kernelSpace;
 AddressSpace* AddressSpace::activeAddressSpace;
+kthread_mutex_t AddressSpace::listMutex = KTHREAD_MUTEX_INITIALIZER;
 bool AddressSpace::patSupported;
+AddressSpace* AddressSpace::reclaimCursor;
+
+static inline bool isSwappable(const MemorySegment* segment) {
+    return !(segment->flags & (SEG_NOUNMAP | SEG_SHARED | SEG_VDSO));
+}
+
+void AddressSpace::invalidateTlb(vaddr_t virtualAddress, size_t size) {
+    // Inactive address spaces have no entries in the TLB.
+    if (!isActive()) return;
+
+    if (size / PAGESIZE > INVLPG_THRESHOLD) {
+        // The kernel does not use global pages, so this flushes everything.
+        uintptr_t cr3;
+        asm volatile ("mov %%cr3, %0; mov %0, %%cr3" : "=r"(cr3) :: "memory");
+    } else {
+        for (size_t i = 0; i < size; i += PAGESIZE) {
+            asm volatile ("invlpg (%0)" :: "r"(virtualAddress + i) : "memory");
+        }
+    }
+}
 
 bool AddressSpace::isActive() {
     return this == kernelSpace || this == activeAddressSpace;
 }
 
+MemorySegment* AddressSpace::copySegments(size_t* count) {
+    AutoLock lock(&mutex);
+
+    size_t segmentCount = 0;
+    for (MemorySegment* segment = firstSegment; segment;
+            segment = segment->next) {
+        if (!(segment->flags & SEG_NOUNMAP)) segmentCount++;
+    }
+
+    // Allocate one extra entry so that the result is never a null pointer
+    // unless the allocation failed.
+    MemorySegment* result = (MemorySegment*) reallocarray(nullptr,
+            segmentCount + 1, sizeof(MemorySegment));
+    if (!result) return nullptr;
+
+    size_t i = 0;
+    for (MemorySegment* segment = firstSegment; segment;
+            segment = segment->next) {
+        if (segment->flags & SEG_NOUNMAP) continue;
+        memcpy(&result[i++], segment, sizeof(MemorySegment));
+    }
+
+    *count = segmentCount;
+    return result;
+}
+
 static kthread_mutex_t forkMutex = KTHREAD_MUTEX_INITIALIZER;
 
 AddressSpace* AddressSpace::fork() {
@@ -43,7 +107,7 @@ AddressSpace* AddressSpace::fork() {
     if (!result) return nullptr;
     MemorySegment* segment = firstSegment->next;
     while (segment) {
-        if (!(segment->flags & SEG_NOUNMAP)) {
+        if (!(segment->flags & (SEG_NOUNMAP | SEG_SHARED))) {
             // Copy the segment
             size_t size = segment->size;
             if (!result->mapMemory(segment->address, size, segment->flags)) {
@@ -51,35 +115,64 @@ AddressSpace* AddressSpace::fork() {
                 return nullptr;
             }
 
-            vaddr_t source = kernelSpace->mapFromOtherAddressSpace(this,
-                    segment->address, size, PROT_READ);
-            if (!source) {
+            bool copied = true;
+            kthread_mutex_lock(&mutex);
+            kthread_mutex_lock(&result->mutex);
+            for (size_t i = 0; i < size && copied; i += PAGESIZE) {
+                vaddr_t address = segment->address + i;
+                paddr_t destination = result->getPhysicalAddress(address);
+                paddr_t source = getPhysicalAddress(address);
+                if (source) {
+                    copyPage(destination, source);
+                    continue;
+                }
+
+                // Pages that are swapped out are read directly into the copy.
+                uintptr_t entry = readPageTableEntry(address);
+                if (entry & PAGE_SWAPPED) {
+                    copied = Swap::readPage(SWAP_SLOT(entry), destination);
+                }
+            }
+            kthread_mutex_unlock(&result->mutex);
+            kthread_mutex_unlock(&mutex);
+
+            if (!copied) {
                 delete result;
                 return nullptr;
             }
-
-            vaddr_t dest = kernelSpace->mapFromOtherAddressSpace(result,
-                    segment->address, size, PROT_WRITE);
-            if (!dest) {
-                kernelSpace->unmapPhysical(source, size);
+        } else if (segment->flags & SEG_VDSO) {
+            // The vDSO page is shared by all processes.
+            kthread_mutex_lock(&mutex);
+            paddr_t physicalAddress = getPhysicalAddress(segment->address);
+            kthread_mutex_unlock(&mutex);
+            if (!result->mapPhysical(segment->address, physicalAddress,
+                    segment->size, segment->flags)) {
                 delete result;
                 return nullptr;
             }
-
-            memcpy((void*) dest, (const void*) source, size);
-            kernelSpace->unmapPhysical(source, size);
-            kernelSpace->unmapPhysical(dest, size);
         }
         segment = segment->next;
     }
 
+    // Shared mappings refer to the same memory in both address spaces.
+    SharedMapping* mapping = firstSharedMapping;
+    while (mapping) {
+        if (!result->mapSharedInternal(mapping->address, mapping->vnode,
+                mapping->offset, mapping->size, mapping->protection)) {
+            delete result;
+            return nullptr;
+        }
+        mapping = mapping->next;
+    }
+
+    result->swappable = true;
     return result;
 }
 
 vaddr_t AddressSpace::mapFromOtherAddressSpace(AddressSpace* sourceSpace,
         vaddr_t sourceVirtualAddress, size_t size, int protection) {
     kthread_mutex_lock(&mutex);
-    vaddr_t destination = MemorySegment::findAndAddNewSegment(firstSegment,
+    vaddr_t destination = MemorySegment::findAndAddNewSegment(&segmentTree,
             size, protection);
     kthread_mutex_unlock(&mutex);
     if (!destination) return 0;
@@ -94,7 +187,7 @@ vaddr_t AddressSpace::mapFromOtherAddressSpace(AddressSpace* sourceSpace,
             for (size_t j = 0; j < i; j += PAGESIZE) {
                 unmap(destination + j);
             }
-            MemorySegment::removeSegment(firstSegment, destination, size);
+            MemorySegment::removeSegment(&segmentTree, destination, size);
             return 0;
         }
         kthread_mutex_unlock(&mutex);
@@ -107,52 +200,98 @@ vaddr_t AddressSpace::mapFromOtherAddressSpace(AddressSpace* sourceSpace,
 vaddr_t AddressSpace::mapMemoryInternal(vaddr_t virtualAddress, size_t size,
         int protection) {
     size_t pages = size / PAGESIZE;
+    bool zeroed = protection & PROT_ZERO;
+#ifdef __x86_64__
+    bool largePagesOnly = protection & PROT_LARGE_PAGES;
+#endif
+    protection &= ~(PROT_ZERO | PROT_LARGE_PAGES);
 
     if (!PhysicalMemory::reserveFrames(pages)) {
-        MemorySegment::removeSegment(firstSegment, virtualAddress, size);
+        MemorySegment::removeSegment(&segmentTree, virtualAddress, size);
         return 0;
     }
 
-    for (size_t i = 0; i < pages; i++) {
-        paddr_t physicalAddress = PhysicalMemory::popReserved();
-        if (unlikely(!mapAt(virtualAddress + i * PAGESIZE, physicalAddress,
-                protection))) {
-            PhysicalMemory::unreserveFrames(pages - i - 1);
-            kthread_mutex_unlock(&mutex);
-            PhysicalMemory::pushPageFrame(physicalAddress);
-            kthread_mutex_lock(&mutex);
-
-            for (size_t j = 0; j < i; j++) {
-                physicalAddress = getPhysicalAddress(virtualAddress +
-                        j * PAGESIZE);
-                unmap(virtualAddress + j * PAGESIZE);
-
+    size_t mapped = 0;
+    while (mapped < size) {
+        vaddr_t address = virtualAddress + mapped;
+        size_t remainingPages = (size - mapped) / PAGESIZE;
+
+#ifdef __x86_64__
+        // Aligned parts of the region are mapped using large pages when
+        // possible.
+        if (LARGE_PAGE_ALIGNED(address) && size - mapped >= LARGE_PAGESIZE) {
+            paddr_t physicalAddress = PhysicalMemory::popLargeReserved(zeroed);
+            if (physicalAddress) {
+                if (likely(mapLargeAt(address, physicalAddress,
+                        protection))) {
+                    mapped += LARGE_PAGESIZE;
+                    continue;
+                }
+
+                PhysicalMemory::unreserveFrames(remainingPages -
+                        LARGE_PAGESIZE / PAGESIZE);
                 kthread_mutex_unlock(&mutex);
-                PhysicalMemory::pushPageFrame(physicalAddress);
+                PhysicalMemory::pushLargeFrame(physicalAddress);
                 kthread_mutex_lock(&mutex);
+                break;
             }
-            MemorySegment::removeSegment(firstSegment, virtualAddress, size);
-            return 0;
         }
+
+        if (largePagesOnly) {
+            PhysicalMemory::unreserveFrames(remainingPages);
+            break;
+        }
+#endif
+
+        paddr_t physicalAddress = PhysicalMemory::popReserved(zeroed);
+        if (unlikely(!mapAt(address, physicalAddress, protection))) {
+            PhysicalMemory::unreserveFrames(remainingPages - 1);
+            kthread_mutex_unlock(&mutex);
+            PhysicalMemory::pushPageFrame(physicalAddress);
+            kthread_mutex_lock(&mutex);
+            break;
+        }
+        mapped += PAGESIZE;
+    }
+
+    if (mapped < size) {
+        freeRange(virtualAddress, mapped);
+        MemorySegment::removeSegment(&segmentTree, virtualAddress, size);
+        return 0;
     }
 
     return virtualAddress;
 }
 
 vaddr_t AddressSpace::mapMemory(size_t size, int protection) {
+    if (this != kernelSpace) {
+        reclaimFrames(size / PAGESIZE);
+    }
+
     AutoLock lock(&mutex);
-    vaddr_t virtualAddress = MemorySegment::findAndAddNewSegment(firstSegment,
-            size, protection);
+    size_t alignment = PAGESIZE;
+#ifdef __x86_64__
+    // Align large regions so that they can be mapped using large pages.
+    if (size >= LARGE_PAGESIZE) {
+        alignment = LARGE_PAGESIZE;
+    }
+#endif
+    vaddr_t virtualAddress = MemorySegment::findAndAddNewSegment(&segmentTree,
+            size, protection & ~(PROT_ZERO | PROT_LARGE_PAGES), alignment);
     if (!virtualAddress) return 0;
     return mapMemoryInternal(virtualAddress, size, protection);
 }
 
 vaddr_t AddressSpace::mapMemory(vaddr_t virtualAddress, size_t size,
         int protection) {
+    if (this != kernelSpace) {
+        reclaimFrames(size / PAGESIZE);
+    }
+
     AutoLock lock(&mutex);
 
-    if (!MemorySegment::addSegment(firstSegment, virtualAddress, size,
-            protection)) {
+    if (!MemorySegment::addSegment(&segmentTree, virtualAddress, size,
+            protection & ~(PROT_ZERO | PROT_LARGE_PAGES))) {
         return 0;
     }
     return mapMemoryInternal(virtualAddress, size, protection);
@@ -162,19 +301,116 @@ vaddr_t AddressSpace::mapPhysical(paddr_t physicalAddress, size_t size,
         int protection) {
     AutoLock lock(&mutex);
 
-    vaddr_t virtualAddress = MemorySegment::findAndAddNewSegment(firstSegment,
-            size, protection);
+    size_t alignment = PAGESIZE;
+#ifdef __x86_64__
+    if (size >= LARGE_PAGESIZE && LARGE_PAGE_ALIGNED(physicalAddress)) {
+        alignment = LARGE_PAGESIZE;
+    }
+#endif
+    vaddr_t virtualAddress = MemorySegment::findAndAddNewSegment(&segmentTree,
+            size, protection, alignment);
     if (!virtualAddress) return 0;
+    if (!mapPhysicalInternal(virtualAddress, physicalAddress, size,
+            protection)) {
+        MemorySegment::removeSegment(&segmentTree, virtualAddress, size);
+        return 0;
+    }
+
+    return virtualAddress;
+}
+
+vaddr_t AddressSpace::mapPhysical(vaddr_t virtualAddress,
+        paddr_t physicalAddress, size_t size, int protection) {
+    AutoLock lock(&mutex);
+
+    if (!MemorySegment::addSegment(&segmentTree, virtualAddress, size,
+            protection)) {
+        return 0;
+    }
+    if (!mapPhysicalInternal(virtualAddress, physicalAddress, size,
+            protection)) {
+        MemorySegment::removeSegment(&segmentTree, virtualAddress, size);
+        return 0;
+    }
+
+    return virtualAddress;
+}
+
+bool AddressSpace::mapPhysicalInternal(vaddr_t virtualAddress,
+        paddr_t physicalAddress, size_t size, int protection) {
     for (size_t i = 0; i < size; i += PAGESIZE) {
+#ifdef __x86_64__
+        if (LARGE_PAGE_ALIGNED(virtualAddress + i) &&
+                LARGE_PAGE_ALIGNED(physicalAddress + i) &&
+                size - i >= LARGE_PAGESIZE && mapLargeAt(virtualAddress + i,
+                physicalAddress + i, protection)) {
+            i += LARGE_PAGESIZE - PAGESIZE;
+            continue;
+        }
+#endif
+
         if (!mapAt(virtualAddress + i, physicalAddress + i, protection)) {
+            unmapRange(virtualAddress, i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+vaddr_t AddressSpace::mapShared(const Reference<Vnode>& vnode, off_t offset,
+        size_t size, int protection) {
+    return mapSharedInternal(0, vnode, offset, size, protection);
+}
+
+vaddr_t AddressSpace::mapSharedInternal(vaddr_t virtualAddress,
+        const Reference<Vnode>& vnode, off_t offset, size_t size,
+        int protection) {
+    SharedMapping* mapping = new SharedMapping();
+    if (!mapping) return 0;
+    if (!vnode->addSharedMapping(offset, size)) {
+        delete mapping;
+        return 0;
+    }
+
+    AutoLock lock(&mutex);
+    int flags = protection | SEG_SHARED;
+    if (!virtualAddress) {
+        virtualAddress = MemorySegment::findAndAddNewSegment(&segmentTree,
+                size, flags);
+    } else if (!MemorySegment::addSegment(&segmentTree, virtualAddress, size,
+            flags)) {
+        virtualAddress = 0;
+    }
+
+    if (!virtualAddress) {
+        vnode->removeSharedMapping();
+        delete mapping;
+        return 0;
+    }
+
+    for (size_t i = 0; i < size; i += PAGESIZE) {
+        paddr_t physicalAddress = vnode->getSharedPage(offset + i);
+        if (!physicalAddress ||
+                !mapAt(virtualAddress + i, physicalAddress, protection)) {
             for (size_t j = 0; j < i; j += PAGESIZE) {
                 unmap(virtualAddress + j);
             }
-            MemorySegment::removeSegment(firstSegment, virtualAddress, size);
+            MemorySegment::removeSegment(&segmentTree, virtualAddress, size);
+            vnode->removeSharedMapping();
+            delete mapping;
+            errno = ENOMEM;
             return 0;
         }
     }
 
+    mapping->address = virtualAddress;
+    mapping->size = size;
+    mapping->offset = offset;
+    mapping->protection = protection;
+    mapping->vnode = vnode;
+    mapping->next = firstSharedMapping;
+    firstSharedMapping = mapping;
     return virtualAddress;
 }
 
@@ -189,33 +425,324 @@ vaddr_t AddressSpace::mapUnaligned(paddr_t physicalAddress, size_t size,
     return mapping + offset;
 }
 
-void AddressSpace::unmap(vaddr_t virtualAddress) {
-    mapAt(virtualAddress, 0, 0);
+// Swaps out pages of user address spaces until the given number of frames is
+// available. Address spaces that are currently locked are skipped.
+void AddressSpace::reclaimFrames(size_t frames) {
+    if (!Swap::isEnabled()) return;
+    size_t available = PhysicalMemory::getAvailableFrames();
+    if (available >= frames) return;
+    size_t needed = frames - available;
+
+    kthread_mutex_lock(&listMutex);
+    size_t addressSpaces = 0;
+    for (AddressSpace* addressSpace = kernelSpace->next; addressSpace;
+            addressSpace = addressSpace->next) {
+        addressSpaces++;
+    }
+    kthread_mutex_unlock(&listMutex);
+
+    // Continue where the last reclaim stopped so that all address spaces
+    // lose pages evenly.
+    for (size_t i = 0; i < addressSpaces && needed > 0; i++) {
+        kthread_mutex_lock(&listMutex);
+        AddressSpace* addressSpace = reclaimCursor ? reclaimCursor :
+                kernelSpace->next;
+        if (!addressSpace) {
+            kthread_mutex_unlock(&listMutex);
+            return;
+        }
+        reclaimCursor = addressSpace->next;
+        // The address space cannot be deleted while it is locked because the
+        // destructor needs to lock it as well.
+        bool locked = addressSpace->swappable &&
+                kthread_mutex_trylock(&addressSpace->mutex) == 0;
+        kthread_mutex_unlock(&listMutex);
+        if (!locked) continue;
+
+        needed -= addressSpace->swapOutPages(needed);
+        kthread_mutex_unlock(&addressSpace->mutex);
+    }
 }
 
-void AddressSpace::unmapMemory(vaddr_t virtualAddress, size_t size) {
-    AutoLock lock(&mutex);
+// Reads a page back in after it was swapped out. This is called on page faults
+// and returns false if the page was not swapped out.
+bool AddressSpace::swapIn(vaddr_t virtualAddress) {
+    if (!PhysicalMemory::reserveFrames(1)) {
+        reclaimFrames(1);
+        if (!PhysicalMemory::reserveFrames(1)) return false;
+    }
 
-    for (size_t i = 0; i < size; i += PAGESIZE) {
-        paddr_t physicalAddress = getPhysicalAddress(virtualAddress + i);
-        unmap(virtualAddress + i);
+    kthread_mutex_lock(&mutex);
+    uintptr_t entry = readPageTableEntry(virtualAddress);
+    MemorySegment* segment = MemorySegment::getSegment(segmentTree,
+            virtualAddress);
+    if (entry & PAGE_PRESENT || !(entry & PAGE_SWAPPED) || !segment) {
+        kthread_mutex_unlock(&mutex);
+        PhysicalMemory::unreserveFrames(1);
+        // Another thread might have swapped in the page in the meantime.
+        return entry & PAGE_PRESENT;
+    }
 
-        // Unlock the mutex because PhysicalMemory::pushPageFrame may need to
-        // map pages.
+    size_t slot = SWAP_SLOT(entry);
+    paddr_t physicalAddress = PhysicalMemory::popReserved();
+    if (!Swap::readPage(slot, physicalAddress) ||
+            !mapAt(virtualAddress, physicalAddress, segment->flags)) {
         kthread_mutex_unlock(&mutex);
         PhysicalMemory::pushPageFrame(physicalAddress);
-        kthread_mutex_lock(&mutex);
+        return false;
+    }
+
+    Swap::freeSlot(slot);
+    kthread_mutex_unlock(&mutex);
+    return true;
+}
+
+// Swaps out a page unless it was accessed since it was last visited, in which
+// case it gets a second chance. The mutex must be held.
+bool AddressSpace::swapOutPage(vaddr_t virtualAddress) {
+    uintptr_t entry = readPageTableEntry(virtualAddress);
+    if (!(entry & PAGE_PRESENT)) return false;
+    if (entry & PAGE_ACCESSED) {
+        writePageTableEntry(virtualAddress, entry & ~PAGE_ACCESSED);
+        invalidateTlb(virtualAddress, PAGESIZE);
+        return false;
+    }
+
+    size_t slot = Swap::allocateSlot();
+    if (!slot) return false;
+    paddr_t physicalAddress = getPhysicalAddress(virtualAddress);
+
+    // The page is unmapped before it is written so that it cannot be modified
+    // anymore. Threads accessing it will wait for the mutex in swapIn.
+    writePageTableEntry(virtualAddress, SWAP_ENTRY(slot));
+    invalidateTlb(virtualAddress, PAGESIZE);
+    if (!Swap::writePage(slot, physicalAddress)) {
+        writePageTableEntry(virtualAddress, entry);
+        Swap::freeSlot(slot);
+        return false;
+    }
+
+    PhysicalMemory::pushPageFrame(physicalAddress);
+    return true;
+}
+
+// Swaps out up to the given number of anonymous pages using the clock
+// algorithm. Returns the number of pages swapped out. The mutex must be held.
+size_t AddressSpace::swapOutPages(size_t count) {
+    size_t pages = 0;
+    for (MemorySegment* segment = firstSegment; segment;
+            segment = segment->next) {
+        if (isSwappable(segment)) pages += segment->size / PAGESIZE;
+    }
+
+    size_t swapped = 0;
+    MemorySegment* segment = firstSegment;
+    // Every page is visited at most twice so that pages whose accessed bit is
+    // cleared in the first round can be swapped out in the second one.
+    size_t visited = 0;
+    while (visited < 2 * pages && swapped < count) {
+        if (!segment) {
+            segment = firstSegment;
+            swapHand = 0;
+            continue;
+        }
+        if (!isSwappable(segment) ||
+                segment->address + segment->size <= swapHand) {
+            segment = segment->next;
+            continue;
+        }
+
+        if (swapHand < segment->address) {
+            swapHand = segment->address;
+        }
+        if (swapOutPage(swapHand)) {
+            swapped++;
+        }
+        swapHand += PAGESIZE;
+        visited++;
+    }
+
+    return swapped;
+}
+
+void AddressSpace::unmap(vaddr_t virtualAddress) {
+    mapAt(virtualAddress, 0, 0);
+}
+
+bool AddressSpace::unmapMemory(vaddr_t virtualAddress, size_t size) {
+    kthread_mutex_lock(&mutex);
+
+    SharedMapping* released = nullptr;
+    if (firstSharedMapping && !unmapShared(virtualAddress, size, &released)) {
+        kthread_mutex_unlock(&mutex);
+        return false;
+    }
+
+    freeRange(virtualAddress, size);
+    MemorySegment::removeSegment(&segmentTree, virtualAddress, size);
+    kthread_mutex_unlock(&mutex);
+
+    // Dropping the last reference to a vnode may free its memory, so this is
+    // done without holding the mutex.
+    while (released) {
+        SharedMapping* next = released->next;
+        released->vnode->removeSharedMapping();
+        delete released;
+        released = next;
     }
 
-    MemorySegment::removeSegment(firstSegment, virtualAddress, size);
+    return true;
+}
+
+// Unmaps all shared pages in the given range and updates the shared mappings
+// accordingly. Mappings that are no longer mapped at all are moved to the
+// released list. This only fails when a mapping would need to be split and
+// memory cannot be allocated, in which case nothing is changed.
+bool AddressSpace::unmapShared(vaddr_t virtualAddress, size_t size,
+        SharedMapping** released) {
+    vaddr_t end = virtualAddress + size;
+
+    SharedMapping** link = &firstSharedMapping;
+    while (*link) {
+        SharedMapping* mapping = *link;
+        vaddr_t mappingEnd = mapping->address + mapping->size;
+        if (mappingEnd <= virtualAddress || mapping->address >= end) {
+            link = &mapping->next;
+            continue;
+        }
+
+        if (mapping->address < virtualAddress && mappingEnd > end) {
+            // Unmapping from the middle of a mapping splits it in two.
+            SharedMapping* tail = new SharedMapping();
+            if (!tail) return false;
+            tail->address = end;
+            tail->size = mappingEnd - end;
+            tail->offset = mapping->offset + (end - mapping->address);
+            tail->protection = mapping->protection;
+            if (!mapping->vnode->addSharedMapping(tail->offset, tail->size)) {
+                delete tail;
+                return false;
+            }
+            tail->vnode = mapping->vnode;
+            tail->next = mapping->next;
+            mapping->next = tail;
+            mapping->size = virtualAddress - mapping->address;
+
+            for (vaddr_t address = virtualAddress; address < end;
+                    address += PAGESIZE) {
+                unmapWithoutInvalidation(address);
+            }
+            invalidateTlb(virtualAddress, size);
+            // Mappings do not overlap, so no other mapping can be affected.
+            return true;
+        }
+
+        vaddr_t first = mapping->address > virtualAddress ?
+                mapping->address : virtualAddress;
+        vaddr_t last = mappingEnd < end ? mappingEnd : end;
+        for (vaddr_t address = first; address < last; address += PAGESIZE) {
+            unmapWithoutInvalidation(address);
+        }
+        invalidateTlb(first, last - first);
+
+        if (first == mapping->address && last == mappingEnd) {
+            *link = mapping->next;
+            mapping->next = *released;
+            *released = mapping;
+            continue;
+        }
+
+        if (first == mapping->address) {
+            mapping->offset += last - first;
+            mapping->address = last;
+            mapping->size = mappingEnd - last;
+        } else {
+            mapping->size = first - mapping->address;
+        }
+        link = &mapping->next;
+    }
+
+    return true;
 }
 
 void AddressSpace::unmapPhysical(vaddr_t virtualAddress, size_t size) {
     AutoLock lock(&mutex);
+    unmapRange(virtualAddress, size);
+    MemorySegment::removeSegment(&segmentTree, virtualAddress, size);
+}
 
+// Unmaps memory without freeing it.
+void AddressSpace::unmapRange(vaddr_t virtualAddress, size_t size) {
     for (size_t i = 0; i < size; i += PAGESIZE) {
-        unmap(virtualAddress + i);
+#ifdef __x86_64__
+        if (size - i >= LARGE_PAGESIZE &&
+                unmapLargePage(virtualAddress + i)) {
+            i += LARGE_PAGESIZE - PAGESIZE;
+            continue;
+        }
+#endif
+        unmapWithoutInvalidation(virtualAddress + i);
     }
+    invalidateTlb(virtualAddress, size);
+}
 
-    MemorySegment::removeSegment(firstSegment, virtualAddress, size);
+// Unmaps memory and frees the frames. The mutex must be held and is temporarily
+// released.
+void AddressSpace::freeRange(vaddr_t virtualAddress, size_t size) {
+    paddr_t frames[UNMAP_BATCH];
+    size_t offset = 0;
+
+    while (offset < size) {
+        size_t batchStart = offset;
+        size_t count = 0;
+#ifdef __x86_64__
+        paddr_t largeFrame = 0;
+#endif
+
+        while (offset < size && count < UNMAP_BATCH) {
+#ifdef __x86_64__
+            if (size - offset >= LARGE_PAGESIZE) {
+                largeFrame = unmapLargePage(virtualAddress + offset);
+                if (largeFrame) {
+                    offset += LARGE_PAGESIZE;
+                    break;
+                }
+            }
+#endif
+            if (Swap::isEnabled()) {
+                vaddr_t address = virtualAddress + offset;
+                uintptr_t entry = readPageTableEntry(address);
+                if (entry & PAGE_SWAPPED) {
+                    writePageTableEntry(address, 0);
+                    Swap::freeSlot(SWAP_SLOT(entry));
+                    offset += PAGESIZE;
+                    continue;
+                }
+            }
+
+            paddr_t physicalAddress =
+                    unmapWithoutInvalidation(virtualAddress + offset);
+            // Shared pages have already been unmapped and must not be freed.
+            if (physicalAddress) {
+                frames[count++] = physicalAddress;
+            }
+            offset += PAGESIZE;
+        }
+
+        // The frames can only be reused once no stale TLB entries remain.
+        invalidateTlb(virtualAddress + batchStart, offset - batchStart);
+
+        // Unlock the mutex because PhysicalMemory::pushPageFrame may need to
+        // map pages.
+        kthread_mutex_unlock(&mutex);
+        for (size_t i = 0; i < count; i++) {
+            PhysicalMemory::pushPageFrame(frames[i]);
+        }
+#ifdef __x86_64__
+        if (largeFrame) {
+            PhysicalMemory::pushLargeFrame(largeFrame);
+        }
+#endif
+        kthread_mutex_lock(&mutex);
+    }
 }
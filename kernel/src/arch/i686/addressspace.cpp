@@ -39,21 +39,21 @@ extern symbol_t kernelReadOnlyEnd;
 extern symbol_t kernelVirtualEnd;
 }
 
-static kthread_mutex_t listMutex = KTHREAD_MUTEX_INITIALIZER;
 static char _kernelMappingArea[PAGESIZE] ALIGNED(PAGESIZE);
+// There is no room for a direct map of physical memory, so copyPage and
+// zeroPage temporarily map pages here with interrupts disabled.
+static char pageWindow[2][PAGESIZE] ALIGNED(PAGESIZE);
 
 // We need to create the initial kernel segments at compile time because
 // they are needed before memory allocations are possible.
 static MemorySegment segments[] = {
-    MemorySegment(0, 0xC0000000, PROT_NONE, nullptr, &segments[1]),
+    MemorySegment(0, 0xC0000000, PROT_NONE),
     MemorySegment((vaddr_t) &kernelVirtualBegin, (vaddr_t) &kernelReadOnlyEnd -
-            (vaddr_t) &kernelVirtualBegin, PROT_READ | PROT_EXEC, &segments[0],
-            &segments[2]),
+            (vaddr_t) &kernelVirtualBegin, PROT_READ | PROT_EXEC),
     MemorySegment((vaddr_t) &kernelReadOnlyEnd, (vaddr_t) &kernelVirtualEnd -
-            (vaddr_t) &kernelReadOnlyEnd, PROT_READ | PROT_WRITE, &segments[1],
-            &segments[3]),
-    MemorySegment(RECURSIVE_MAPPING, -RECURSIVE_MAPPING, PROT_READ | PROT_WRITE,
-            &segments[2], nullptr),
+            (vaddr_t) &kernelReadOnlyEnd, PROT_READ | PROT_WRITE),
+    MemorySegment(RECURSIVE_MAPPING, -RECURSIVE_MAPPING,
+            PROT_READ | PROT_WRITE),
 };
 
 static inline void addressToIndex(
@@ -73,25 +73,34 @@ static inline int protectionToFlags(int protection) {
 }
 
 AddressSpace::AddressSpace() {
+    firstSharedMapping = nullptr;
+    swappable = false;
+    swapHand = 0;
+
     if (this == kernelSpace) {
         pageDir = (paddr_t) &kernelPageDirectory;
         mappingArea = (vaddr_t) _kernelMappingArea;
         firstSegment = segments;
+        segmentTree = nullptr;
         prev = nullptr;
         next = nullptr;
     } else {
         pageDir = PhysicalMemory::popPageFrame();
         if (!pageDir) FAIL_CONSTRUCTOR;
 
-        firstSegment = new MemorySegment(0, PAGESIZE, PROT_NONE | SEG_NOUNMAP,
-                nullptr, nullptr);
-        if (!firstSegment) FAIL_CONSTRUCTOR;
-        if (!MemorySegment::addSegment(firstSegment, 0xC0000000, -0xC0000000,
+        firstSegment = nullptr;
+        segmentTree = nullptr;
+        if (!MemorySegment::addSegment(&segmentTree, 0, PAGESIZE,
+                PROT_NONE | SEG_NOUNMAP)) {
+            FAIL_CONSTRUCTOR;
+        }
+        firstSegment = segmentTree;
+        if (!MemorySegment::addSegment(&segmentTree, 0xC0000000, -0xC0000000,
                 PROT_NONE | SEG_NOUNMAP)) {
             FAIL_CONSTRUCTOR;
         }
         mappingArea = MemorySegment::findAndAddNewSegment(
-                kernelSpace->firstSegment, PAGESIZE, PROT_NONE);
+                &kernelSpace->segmentTree, PAGESIZE, PROT_NONE);
         if (!mappingArea) FAIL_CONSTRUCTOR;
 
         AutoLock lock(&listMutex);
@@ -123,6 +132,9 @@ AddressSpace::~AddressSpace() {
         if (next) {
             next->prev = prev;
         }
+        if (reclaimCursor == this) {
+            reclaimCursor = next;
+        }
         kthread_mutex_unlock(&listMutex);
     }
 
@@ -148,19 +160,24 @@ AddressSpace::~AddressSpace() {
             }
         }
         kernelSpace->unmap(mappingArea);
-        MemorySegment::removeSegment(kernelSpace->firstSegment, mappingArea,
+        MemorySegment::removeSegment(&kernelSpace->segmentTree, mappingArea,
                 PAGESIZE);
     }
-    if (firstSegment) {
-        if (firstSegment->next) {
-            MemorySegment::deallocateSegment(firstSegment->next);
-        }
-        delete firstSegment;
+    // Only the segments that must not be unmapped are left.
+    currentSegment = firstSegment;
+    while (currentSegment) {
+        MemorySegment* next = currentSegment->next;
+        MemorySegment::deallocateSegment(currentSegment);
+        currentSegment = next;
     }
     PhysicalMemory::pushPageFrame(pageDir);
 }
 
 void AddressSpace::initialize() {
+    for (MemorySegment& segment : segments) {
+        MemorySegment::addSegment(&kernelSpace->segmentTree, &segment);
+    }
+
     // Unmap the bootstrap sections
     vaddr_t p = (vaddr_t) &bootstrapBegin;
 
@@ -191,6 +208,40 @@ void AddressSpace::initialize() {
     }
 }
 
+static inline uintptr_t disableInterrupts() {
+    uintptr_t eflags;
+    asm volatile ("pushf; pop %0; cli" : "=r"(eflags) :: "memory");
+    return eflags;
+}
+
+static inline void restoreInterrupts(uintptr_t eflags) {
+    if (eflags & 0x200) {
+        asm volatile ("sti" ::: "memory");
+    }
+}
+
+void AddressSpace::copyPage(paddr_t destination, paddr_t source) {
+    uintptr_t eflags = disableInterrupts();
+    void* dest = (void*) kernelSpace->mapAt((vaddr_t) pageWindow[0],
+            destination, PROT_WRITE);
+    const void* src = (const void*) kernelSpace->mapAt((vaddr_t) pageWindow[1],
+            source, PROT_READ);
+    size_t count = PAGESIZE / sizeof(uint32_t);
+    asm volatile ("rep movsl" : "+D"(dest), "+S"(src), "+c"(count)
+            :: "memory");
+    restoreInterrupts(eflags);
+}
+
+void AddressSpace::zeroPage(paddr_t physicalAddress) {
+    uintptr_t eflags = disableInterrupts();
+    void* page = (void*) kernelSpace->mapAt((vaddr_t) pageWindow[0],
+            physicalAddress, PROT_WRITE);
+    size_t count = PAGESIZE / sizeof(uint32_t);
+    asm volatile ("rep stosl" : "+D"(page), "+c"(count) : "a"(0)
+            : "memory");
+    restoreInterrupts(eflags);
+}
+
 void AddressSpace::activate() {
     activeAddressSpace = this;
     asm ("mov %0, %%cr3" :: "r"(pageDir));
@@ -199,29 +250,9 @@ void AddressSpace::activate() {
 paddr_t AddressSpace::getPhysicalAddress(vaddr_t virtualAddress) {
     if (this == kernelSpace && virtualAddress < 0xC0000000) return 0;
 
-    size_t pdIndex;
-    size_t ptIndex;
-    addressToIndex(virtualAddress, pdIndex, ptIndex);
-
-    if (isActive()) {
-        uintptr_t* pageDirectory = (uintptr_t*) CURRENT_PAGE_DIR_MAPPING;
-        if (!pageDirectory[pdIndex]) return 0;
-        uintptr_t* pageTable =
-                (uintptr_t*) (RECURSIVE_MAPPING + PAGESIZE * pdIndex);
-        return pageTable[ptIndex] & ~PAGE_MISALIGN;
-    } else {
-        uintptr_t* pageDirectory = (uintptr_t*) kernelSpace->mapAt(mappingArea,
-                pageDir, PROT_READ);
-        uintptr_t pdEntry = pageDirectory[pdIndex];
-        kernelSpace->unmap(mappingArea);
-        if (!pdEntry) return 0;
-
-        uintptr_t* pageTable = (uintptr_t*) kernelSpace->mapAt(mappingArea,
-                pdEntry & ~PAGE_MISALIGN, PROT_READ);
-        paddr_t result = pageTable[ptIndex] & ~PAGE_MISALIGN;
-        kernelSpace->unmap(mappingArea);
-        return result;
-    }
+    uintptr_t entry = readPageTableEntry(virtualAddress);
+    if (!(entry & PAGE_PRESENT)) return 0;
+    return entry & ~PAGE_MISALIGN;
 }
 
 vaddr_t AddressSpace::mapAt(
@@ -308,3 +339,80 @@ vaddr_t AddressSpace::mapAt(
 
     return virtualAddress;
 }
+
+// Returns the page table entry for the given address or 0 if there is no page
+// table for it.
+uintptr_t AddressSpace::readPageTableEntry(vaddr_t virtualAddress) {
+    size_t pdIndex;
+    size_t ptIndex;
+    addressToIndex(virtualAddress, pdIndex, ptIndex);
+
+    if (isActive()) {
+        uintptr_t* pageDirectory = (uintptr_t*) CURRENT_PAGE_DIR_MAPPING;
+        if (!pageDirectory[pdIndex]) return 0;
+        uintptr_t* pageTable =
+                (uintptr_t*) (RECURSIVE_MAPPING + PAGESIZE * pdIndex);
+        return pageTable[ptIndex];
+    } else {
+        uintptr_t* pageDirectory = (uintptr_t*) kernelSpace->mapAt(mappingArea,
+                pageDir, PROT_READ);
+        uintptr_t pdEntry = pageDirectory[pdIndex];
+        kernelSpace->unmap(mappingArea);
+        if (!pdEntry) return 0;
+
+        uintptr_t* pageTable = (uintptr_t*) kernelSpace->mapAt(mappingArea,
+                pdEntry & ~PAGE_MISALIGN, PROT_READ);
+        uintptr_t result = pageTable[ptIndex];
+        kernelSpace->unmap(mappingArea);
+        return result;
+    }
+}
+
+paddr_t AddressSpace::unmapWithoutInvalidation(vaddr_t virtualAddress) {
+    size_t pdIndex;
+    size_t ptIndex;
+    addressToIndex(virtualAddress, pdIndex, ptIndex);
+
+    if (isActive()) {
+        uintptr_t* pageDirectory = (uintptr_t*) CURRENT_PAGE_DIR_MAPPING;
+        if (!pageDirectory[pdIndex]) return 0;
+        uintptr_t* pageTable =
+                (uintptr_t*) (RECURSIVE_MAPPING + PAGESIZE * pdIndex);
+        paddr_t result = pageTable[ptIndex] & ~PAGE_MISALIGN;
+        pageTable[ptIndex] = 0;
+        return result;
+    }
+
+    // Inactive address spaces have no entries in the TLB.
+    paddr_t result = getPhysicalAddress(virtualAddress);
+    if (result) {
+        mapAt(virtualAddress, 0, 0);
+    }
+    return result;
+}
+
+// Replaces an entry in an existing page table without invalidating the TLB.
+void AddressSpace::writePageTableEntry(vaddr_t virtualAddress,
+        uintptr_t entry) {
+    size_t pdIndex;
+    size_t ptIndex;
+    addressToIndex(virtualAddress, pdIndex, ptIndex);
+
+    if (isActive()) {
+        uintptr_t* pageTable =
+                (uintptr_t*) (RECURSIVE_MAPPING + PAGESIZE * pdIndex);
+        pageTable[ptIndex] = entry;
+        return;
+    }
+
+    uintptr_t* pageDirectory = (uintptr_t*) kernelSpace->mapAt(mappingArea,
+            pageDir, PROT_READ);
+    uintptr_t pdEntry = pageDirectory[pdIndex];
+    kernelSpace->unmap(mappingArea);
+    assert(pdEntry);
+
+    uintptr_t* pageTable = (uintptr_t*) kernelSpace->mapAt(mappingArea,
+            pdEntry & ~PAGE_MISALIGN, PROT_READ | PROT_WRITE);
+    pageTable[ptIndex] = entry;
+    kernelSpace->unmap(mappingArea);
+}
@@ -164,6 +164,26 @@ gdt_entry gdt[] = {
 
     // Task State Segment
     GDT_ENTRY_TSS(/*(uintptr_t) &tss*/ 0L, sizeof(tss) - 1),
+
+#ifdef __i386__
+    // Thread Pointer Segment, the base is changed on every context switch.
+    GDT_ENTRY(0, 0xFFFFFFF,
+            GDT_PRESENT | GDT_SEGMENT | GDT_RING3 | GDT_READ_WRITE,
+            GDT_GRANULARITY_4K | GDT_MODE),
+#elif defined(__x86_64__)
+    // sysret expects the user data segment to be directly followed by the user
+    // code segment, so these are duplicated here.
+    // User Data Segment
+    GDT_ENTRY(0, 0xFFFFFFF,
+            GDT_PRESENT | GDT_SEGMENT | GDT_RING3 | GDT_READ_WRITE,
+            GDT_GRANULARITY_4K | GDT_MODE),
+
+    // User Code Segment
+    GDT_ENTRY(0, 0xFFFFFFF,
+            GDT_PRESENT | GDT_SEGMENT | GDT_RING3 | GDT_EXECUTABLE |
+            GDT_READ_WRITE,
+            GDT_GRANULARITY_4K | GDT_MODE),
+#endif
 };
 
 uint16_t gdt_size = sizeof(gdt) - 1;
@@ -177,3 +197,21 @@ void setKernelStack(uintptr_t stack) {
     tss.rsp0_high = stack >> 32;
 #endif
 }
+
+// Userspace finds its thread structure through %gs on i686 and through %fs on
+// x86_64.
+void setThreadPointer(uintptr_t pointer) {
+#ifdef __i386__
+    gdt_entry* entry = &gdt[6];
+    entry->base_low = pointer & 0xFFFF;
+    entry->base_middle = (pointer >> 16) & 0xFF;
+    entry->base_high = (pointer >> 24) & 0xFF;
+    // Reload the segment register so that the CPU sees the new base.
+    asm volatile ("mov %0, %%gs" :: "r"(0x33));
+#elif defined(__x86_64__)
+    // Loading a null selector might clear the base, so do it first.
+    asm volatile ("mov %0, %%fs" :: "r"(0));
+    asm volatile ("wrmsr" :: "a"(pointer & 0xFFFFFFFF), "d"(pointer >> 32),
+            "c"(0xC0000100));
+#endif
+}
@@ -23,9 +23,12 @@
 #include <dennix/kernel/console.h>
 #include <dennix/kernel/panic.h>
 #include <dennix/kernel/portio.h>
+#include <dennix/kernel/process.h>
 #include <dennix/kernel/registers.h>
 #include <dennix/kernel/signal.h>
+#include <dennix/kernel/swap.h>
 #include <dennix/kernel/thread.h>
+#include <dennix/kernel/trace.h>
 
 #define PIC1_COMMAND 0x20
 #define PIC1_DATA 0x21
@@ -215,6 +218,33 @@ static const char* exceptionName(unsigned int exception) {
     }
 }
 
+// Handles page faults on pages that have been swapped out.
+static bool handlePageFault(const InterruptContext* context) {
+    // Protection violations are never caused by swapping.
+    if (!Swap::isEnabled() || context->error & 1) return false;
+    AddressSpace* addressSpace = Process::current()->addressSpace;
+    if (addressSpace == kernelSpace) return false;
+
+    vaddr_t address;
+    asm ("mov %%cr2, %0" : "=r"(address));
+
+    // Reading the page from disk can take a while, so interrupts are enabled
+    // unless the faulting code had them disabled.
+#ifdef __i386__
+    bool interruptsEnabled = context->eflags & 0x200;
+#else
+    bool interruptsEnabled = context->rflags & 0x200;
+#endif
+    if (interruptsEnabled) Interrupts::enable();
+    bool swappedIn = addressSpace->swapIn(address & ~PAGE_MISALIGN);
+    if (interruptsEnabled) Interrupts::disable();
+
+    if (swappedIn) {
+        Thread::current()->counters.pageFaults++;
+    }
+    return swappedIn;
+}
+
 static bool handleUserspaceException(const InterruptContext* context) {
     siginfo_t siginfo = {};
     switch (context->interrupt) {
@@ -243,9 +273,12 @@ static bool handleUserspaceException(const InterruptContext* context) {
         siginfo.si_addr = (void*) context->INSTRUCTION_POINTER;
         break;
     case EX_PAGE_FAULT:
+        Thread::current()->counters.pageFaults++;
         siginfo.si_signo = SIGSEGV;
         siginfo.si_code = SEGV_MAPERR;
         asm ("mov %%cr2, %0" : "=r"(siginfo.si_addr));
+        TRACE(TRACE_PAGE_FAULT, (uintptr_t) siginfo.si_addr,
+                context->INSTRUCTION_POINTER);
         break;
     case EX_X87_FLOATING_POINT_EXCEPTION:
     case EX_SIMD_FLOATING_POINT_EXCEPTION:
@@ -263,7 +296,9 @@ static bool handleUserspaceException(const InterruptContext* context) {
 
 extern "C" InterruptContext* handleInterrupt(InterruptContext* context) {
     InterruptContext* newContext = context;
-    if (context->interrupt <= 31 && context->cs != 0x8) {
+    if (context->interrupt == EX_PAGE_FAULT && handlePageFault(context)) {
+        // The page has been swapped in and the instruction can be retried.
+    } else if (context->interrupt <= 31 && context->cs != 0x8) {
         if (!handleUserspaceException(context)) goto handleKernelException;
     } else if (context->interrupt <= 31) { // CPU Exception
 handleKernelException:
@@ -273,6 +308,7 @@ handleKernelException:
     } else if (context->interrupt <= 47 || context->interrupt >= 51) {
         int irq = context->interrupt <= 47 ? context->interrupt - 32 :
                 context->interrupt - 51 + 16;
+        TRACE(TRACE_IRQ, irq, 0);
         IrqHandler* handler = irqHandlers[irq];
         while (handler) {
             handler->func(handler->user, context);
@@ -281,7 +317,7 @@ handleKernelException:
 
         if (irq == Interrupts::timerIrq) {
             console->display->update();
-            newContext = Thread::schedule(context);
+            newContext = Thread::schedule(context, false);
         }
 
         // Send End of Interrupt
@@ -296,7 +332,7 @@ handleKernelException:
             outb(PIC1_COMMAND, PIC_EOI);
         }
     } else if (context->interrupt == 0x31) {
-        newContext = Thread::schedule(context);
+        newContext = Thread::schedule(context, true);
     } else if (context->interrupt == 0x32) {
         newContext = Signal::sigreturn(context);
     }
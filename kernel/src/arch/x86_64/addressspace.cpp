@@ -20,6 +20,7 @@
 #include <assert.h>
 #include <string.h>
 #include <dennix/kernel/addressspace.h>
+#include <dennix/kernel/panic.h>
 #include <dennix/kernel/physicalmemory.h>
 
 #define RECURSIVE_MAPPING 0xFFFFFF0000000000
@@ -35,8 +36,11 @@
 #define PAGE_WRITABLE (1 << 1)
 #define PAGE_USER (1 << 2)
 #define PAGE_WRITE_COMBINING (1 << 7)
+#define PAGE_LARGE (1 << 7)
+#define PAGE_LARGE_WRITE_COMBINING (1 << 12)
 #define PAGE_NO_EXECUTE (1UL << 63)
 #define PAGE_FLAGS 0xFFF0000000000FFF
+#define LARGE_PAGE_FLAGS (PAGE_FLAGS | (LARGE_PAGESIZE - 1))
 
 extern "C" {
 extern symbol_t bootstrapBegin;
@@ -48,23 +52,23 @@ extern symbol_t kernelReadOnlyEnd;
 extern symbol_t kernelVirtualEnd;
 }
 
-static kthread_mutex_t listMutex = KTHREAD_MUTEX_INITIALIZER;
-static char _kernelMappingArea[PAGESIZE] ALIGNED(PAGESIZE);
+#define DIRECT_MAPPED(physicalAddress) \
+        ((uintptr_t*) (DIRECT_MAP + (physicalAddress)))
+
 
 // We need to create the initial kernel segments at compile time because
 // they are needed before memory allocations are possible.
 static MemorySegment segments[] = {
-    MemorySegment(0, 0xFFFF800000000000, PROT_NONE, nullptr, &segments[1]),
-    MemorySegment(RECURSIVE_MAPPING, -RECURSIVE_MAPPING, PROT_READ | PROT_WRITE,
-            &segments[0], &segments[2]),
+    MemorySegment(0, 0xFFFF800000000000, PROT_NONE),
+    MemorySegment(DIRECT_MAP, DIRECT_MAP_SIZE, PROT_READ | PROT_WRITE),
+    MemorySegment(RECURSIVE_MAPPING, -RECURSIVE_MAPPING,
+            PROT_READ | PROT_WRITE),
     MemorySegment((vaddr_t) &kernelVirtualBegin, (vaddr_t) &kernelExecEnd -
-            (vaddr_t) &kernelVirtualBegin, PROT_EXEC, &segments[1],
-            &segments[3]),
+            (vaddr_t) &kernelVirtualBegin, PROT_EXEC),
     MemorySegment((vaddr_t) &kernelExecEnd, (vaddr_t) &kernelReadOnlyEnd -
-            (vaddr_t) &kernelExecEnd, PROT_READ, &segments[2], &segments[4]),
+            (vaddr_t) &kernelExecEnd, PROT_READ),
     MemorySegment((vaddr_t) &kernelReadOnlyEnd, (vaddr_t) &kernelVirtualEnd -
-            (vaddr_t) &kernelReadOnlyEnd, PROT_READ | PROT_WRITE, &segments[3],
-            nullptr),
+            (vaddr_t) &kernelReadOnlyEnd, PROT_READ | PROT_WRITE),
 };
 
 struct PageIndex {
@@ -97,29 +101,59 @@ static inline uintptr_t protectionToFlags(int protection) {
     return flags;
 }
 
+// Returns the table referenced by an entry of a paging structure and allocates
+// it if necessary. The table is accessed through the recursive mapping if the
+// address space is active and through the direct map otherwise.
+static uintptr_t* getTable(uintptr_t* entry, vaddr_t recursiveAddress,
+        bool active, bool allocate, uintptr_t tableFlags) {
+    if (*entry) {
+        if (active) return (uintptr_t*) recursiveAddress;
+        return DIRECT_MAPPED(*entry & ~PAGE_FLAGS);
+    }
+    if (!allocate) return nullptr;
+
+    paddr_t physicalAddress = PhysicalMemory::popPageFrame();
+    if (!physicalAddress) return nullptr;
+    *entry = physicalAddress | tableFlags;
+
+    uintptr_t* table;
+    if (active) {
+        table = (uintptr_t*) recursiveAddress;
+        asm ("invlpg (%0)" :: "r"(table));
+    } else {
+        table = DIRECT_MAPPED(physicalAddress);
+    }
+    memset(table, 0, PAGESIZE);
+    return table;
+}
+
 AddressSpace::AddressSpace() {
+    firstSharedMapping = nullptr;
+    swappable = false;
+    swapHand = 0;
+
     if (this == kernelSpace) {
         pml4 = (paddr_t) &kernelPml4;
-        mappingArea = (vaddr_t) _kernelMappingArea;
         firstSegment = segments;
+        segmentTree = nullptr;
         prev = nullptr;
         next = nullptr;
     } else {
         pml4 = PhysicalMemory::popPageFrame();
         if (!pml4) FAIL_CONSTRUCTOR;
 
-        firstSegment = new MemorySegment(0, PAGESIZE, PROT_NONE | SEG_NOUNMAP,
-                nullptr, nullptr);
-        if (!firstSegment) FAIL_CONSTRUCTOR;
-        if (!MemorySegment::addSegment(firstSegment, 0x800000000000,
+        firstSegment = nullptr;
+        segmentTree = nullptr;
+        if (!MemorySegment::addSegment(&segmentTree, 0, PAGESIZE,
+                PROT_NONE | SEG_NOUNMAP)) {
+            FAIL_CONSTRUCTOR;
+        }
+        firstSegment = segmentTree;
+        if (!MemorySegment::addSegment(&segmentTree, 0x800000000000,
                 -0x800000000000, PROT_NONE | SEG_NOUNMAP)) {
             FAIL_CONSTRUCTOR;
         }
 
-        mappingArea = MemorySegment::findAndAddNewSegment(
-                kernelSpace->firstSegment, PAGESIZE, PROT_NONE);
-        if (!mappingArea) FAIL_CONSTRUCTOR;
-
         AutoLock lock(&listMutex);
         next = kernelSpace->next;
         if (next) {
@@ -129,13 +163,11 @@ AddressSpace::AddressSpace() {
         kernelSpace->next = this;
 
         // Copy the kernel page directory into the new address space.
-        kernelSpace->mapAt(kernelSpace->mappingArea, pml4, PROT_WRITE);
-        memset((void*) kernelSpace->mappingArea, 0, 0x800);
-        memcpy((void*) (kernelSpace->mappingArea + 0x800),
-                (const void*) (RECURSIVE_PML4() + 0x800), 0x800);
-        *((paddr_t*) (kernelSpace->mappingArea + 0xFF0)) = pml4 |
-                PAGE_PRESENT | PAGE_WRITABLE;
-        kernelSpace->unmap(kernelSpace->mappingArea);
+        uintptr_t* pml4Mapped = DIRECT_MAPPED(pml4);
+        memset(pml4Mapped, 0, 0x800);
+        memcpy(pml4Mapped + 256, (const void*) (RECURSIVE_PML4() + 0x800),
+                0x800);
+        pml4Mapped[510] = pml4 | PAGE_PRESENT | PAGE_WRITABLE;
     }
 
     mutex = KTHREAD_MUTEX_INITIALIZER;
@@ -149,6 +181,9 @@ AddressSpace::~AddressSpace() {
         if (next) {
             next->prev = prev;
         }
+        if (reclaimCursor == this) {
+            reclaimCursor = next;
+        }
         kthread_mutex_unlock(&listMutex);
     }
 
@@ -165,44 +200,41 @@ AddressSpace::~AddressSpace() {
 
     if (!__constructionFailed) {
         // Free the PDPTs, page directories and page tables.
-        uintptr_t* mapped = (uintptr_t*) kernelSpace->mapAt(mappingArea,
-                pml4, PROT_READ);
+        uintptr_t* pml4Mapped = DIRECT_MAPPED(pml4);
         for (size_t i = 0; i < 256; i++) {
-            paddr_t pdpt = mapped[i] & ~PAGE_MISALIGN;
-            if (pdpt) {
-                kernelSpace->mapAt(mappingArea, pdpt, PROT_READ);
-                for (size_t j = 0; j < 512; j++) {
-                    paddr_t pd = mapped[j] & ~PAGE_MISALIGN;
-                    if (pd) {
-                        kernelSpace->mapAt(mappingArea, pd, PROT_READ);
-                        for (size_t k = 0; k < 512; k++) {
-                            paddr_t pt = mapped[k] & ~PAGE_MISALIGN;
-                            if (pt) {
-                                PhysicalMemory::pushPageFrame(pt);
-                            }
-                        }
-                        PhysicalMemory::pushPageFrame(pd);
-                        kernelSpace->mapAt(mappingArea, pdpt, PROT_READ);
+            paddr_t pdpt = pml4Mapped[i] & ~PAGE_FLAGS;
+            if (!pdpt) continue;
+            uintptr_t* pdptMapped = DIRECT_MAPPED(pdpt);
+            for (size_t j = 0; j < 512; j++) {
+                paddr_t pd = pdptMapped[j] & ~PAGE_FLAGS;
+                if (!pd) continue;
+                uintptr_t* pdMapped = DIRECT_MAPPED(pd);
+                for (size_t k = 0; k < 512; k++) {
+                    paddr_t pt = pdMapped[k] & ~PAGE_FLAGS;
+                    if (pt && !(pdMapped[k] & PAGE_LARGE)) {
+                        PhysicalMemory::pushPageFrame(pt);
                     }
                 }
-                PhysicalMemory::pushPageFrame(pdpt);
-                kernelSpace->mapAt(mappingArea, pml4, PROT_READ);
+                PhysicalMemory::pushPageFrame(pd);
             }
+            PhysicalMemory::pushPageFrame(pdpt);
         }
-        kernelSpace->unmap(mappingArea);
-        MemorySegment::removeSegment(kernelSpace->firstSegment, mappingArea,
-                PAGESIZE);
     }
-    if (firstSegment) {
-        if (firstSegment->next) {
-            MemorySegment::deallocateSegment(firstSegment->next);
-        }
-        delete firstSegment;
+    // Only the segments that must not be unmapped are left.
+    currentSegment = firstSegment;
+    while (currentSegment) {
+        MemorySegment* next = currentSegment->next;
+        MemorySegment::deallocateSegment(currentSegment);
+        currentSegment = next;
     }
     PhysicalMemory::pushPageFrame(pml4);
 }
 
 void AddressSpace::initialize() {
+    for (MemorySegment& segment : segments) {
+        MemorySegment::addSegment(&kernelSpace->segmentTree, &segment);
+    }
+
     // Unmap the bootstrap sections
     vaddr_t p = (vaddr_t) &bootstrapBegin;
 
@@ -233,51 +265,170 @@ void AddressSpace::initialize() {
     }
 }
 
+void AddressSpace::mapDirect(paddr_t physicalAddress, size_t size) {
+    // This is called during initialization when no other address spaces exist
+    // yet, so new PDPTs do not need to be added to other address spaces.
+    // Memory outside of the region may belong to devices that must not be
+    // mapped cacheable, so partially covered large pages use page tables.
+    paddr_t end = (physicalAddress + size) & ~(PAGESIZE - 1);
+    if (end > DIRECT_MAP_SIZE) end = DIRECT_MAP_SIZE;
+    physicalAddress = ALIGNUP(physicalAddress, PAGESIZE);
+
+    while (physicalAddress < end) {
+        vaddr_t virtualAddress = DIRECT_MAP + physicalAddress;
+        size_t pml4Index = (virtualAddress >> 39) & 0x1FF;
+        size_t pdptIndex = (virtualAddress >> 30) & 0x1FF;
+        size_t pdIndex = (virtualAddress >> 21) & 0x1FF;
+        size_t ptIndex = (virtualAddress >> 12) & 0x1FF;
+
+        uintptr_t* pml4 = (uintptr_t*) RECURSIVE_PML4();
+        uintptr_t* pdpt = (uintptr_t*) RECURSIVE_PDPT(pml4Index);
+        if (!pml4[pml4Index]) {
+            paddr_t pdptPhys = PhysicalMemory::popPageFrame();
+            if (!pdptPhys) PANIC("Failed to create the direct map");
+            pml4[pml4Index] = pdptPhys | PAGE_PRESENT | PAGE_WRITABLE;
+            asm ("invlpg (%0)" :: "r"(pdpt));
+            memset(pdpt, 0, PAGESIZE);
+        }
+
+        uintptr_t* pageDir = (uintptr_t*) RECURSIVE_PAGEDIR(pml4Index,
+                pdptIndex);
+        if (!pdpt[pdptIndex]) {
+            paddr_t pdPhys = PhysicalMemory::popPageFrame();
+            if (!pdPhys) PANIC("Failed to create the direct map");
+            pdpt[pdptIndex] = pdPhys | PAGE_PRESENT | PAGE_WRITABLE;
+            asm ("invlpg (%0)" :: "r"(pageDir));
+            memset(pageDir, 0, PAGESIZE);
+        }
+
+        if (LARGE_PAGE_ALIGNED(physicalAddress) &&
+                end - physicalAddress >= LARGE_PAGESIZE && !pageDir[pdIndex]) {
+            pageDir[pdIndex] = physicalAddress | PAGE_PRESENT | PAGE_WRITABLE |
+                    PAGE_LARGE | PAGE_NO_EXECUTE;
+            physicalAddress += LARGE_PAGESIZE;
+            continue;
+        }
+
+        uintptr_t* pageTable = (uintptr_t*) RECURSIVE_PAGETABLE(pml4Index,
+                pdptIndex, pdIndex);
+        if (!pageDir[pdIndex]) {
+            paddr_t ptPhys = PhysicalMemory::popPageFrame();
+            if (!ptPhys) PANIC("Failed to create the direct map");
+            pageDir[pdIndex] = ptPhys | PAGE_PRESENT | PAGE_WRITABLE;
+            asm ("invlpg (%0)" :: "r"(pageTable));
+            memset(pageTable, 0, PAGESIZE);
+        }
+
+        pageTable[ptIndex] = physicalAddress | PAGE_PRESENT | PAGE_WRITABLE |
+                PAGE_NO_EXECUTE;
+        physicalAddress += PAGESIZE;
+    }
+}
+
+void AddressSpace::copyPage(paddr_t destination, paddr_t source) {
+    void* dest = (void*) (DIRECT_MAP + destination);
+    const void* src = (const void*) (DIRECT_MAP + source);
+    size_t count = PAGESIZE / sizeof(uint64_t);
+    asm volatile ("rep movsq" : "+D"(dest), "+S"(src), "+c"(count)
+            :: "memory");
+}
+
+void AddressSpace::zeroPage(paddr_t physicalAddress) {
+    char* page = (char*) (DIRECT_MAP + physicalAddress);
+    // Non-temporal stores avoid evicting the cache for memory that is usually
+    // not accessed soon after being zeroed.
+    for (size_t i = 0; i < PAGESIZE; i += 32) {
+        asm volatile ("movnti %1, (%0)\n\t"
+                "movnti %1, 8(%0)\n\t"
+                "movnti %1, 16(%0)\n\t"
+                "movnti %1, 24(%0)"
+                :: "r"(page + i), "r"(0UL) : "memory");
+    }
+    asm volatile ("sfence" ::: "memory");
+}
+
 void AddressSpace::activate() {
     activeAddressSpace = this;
     asm ("mov %0, %%cr3" :: "r"(pml4));
 }
 
-paddr_t AddressSpace::getPhysicalAddress(vaddr_t virtualAddress) {
-    if (this == kernelSpace && virtualAddress < 0xFFFF800000000000) return 0;
+uintptr_t* AddressSpace::getPageDirectoryEntry(vaddr_t virtualAddress,
+        bool allocate) {
     PageIndex index = addressToIndex(virtualAddress);
+    bool active = isActive();
+    uintptr_t tableFlags = PAGE_PRESENT | PAGE_WRITABLE;
+    if (this != kernelSpace) tableFlags |= PAGE_USER;
 
-    if (isActive()) {
-        uintptr_t* pml4 = (uintptr_t*) RECURSIVE_PML4();
-        if (!pml4[index.pml4Index]) return 0;
+    uintptr_t* pml4Mapped = active ? (uintptr_t*) RECURSIVE_PML4() :
+            DIRECT_MAPPED(pml4);
+
+    if (this == kernelSpace && !pml4Mapped[index.pml4Index]) {
+        if (!allocate) return nullptr;
+        paddr_t pdptPhys = PhysicalMemory::popPageFrame();
+        if (!pdptPhys) return nullptr;
         uintptr_t* pdpt = (uintptr_t*) RECURSIVE_PDPT(index.pml4Index);
-        if (!pdpt[index.pdptIndex]) return 0;
-        uintptr_t* pageDir = (uintptr_t*) RECURSIVE_PAGEDIR(index.pml4Index,
-                index.pdptIndex);
-        if (!pageDir[index.pdIndex]) return 0;
-        uintptr_t* pageTable = (uintptr_t*) RECURSIVE_PAGETABLE(index.pml4Index,
-                index.pdptIndex, index.pdIndex);
-        return pageTable[index.ptIndex] & ~PAGE_FLAGS;
-    } else {
-        uintptr_t* pml4Mapping = (uintptr_t*) kernelSpace->mapAt(mappingArea,
-                pml4, PROT_READ);
-        uintptr_t pml4Entry = pml4Mapping[index.pml4Index];
-        kernelSpace->unmap(mappingArea);
-        if (!pml4Entry) return 0;
-
-        uintptr_t* pdpt = (uintptr_t*) kernelSpace->mapAt(mappingArea,
-                pml4Entry & ~PAGE_FLAGS, PROT_READ);
-        uintptr_t pdptEntry = pdpt[index.pdptIndex];
-        kernelSpace->unmap(mappingArea);
-        if (!pdptEntry) return 0;
-
-        uintptr_t* pageDirectory = (uintptr_t*) kernelSpace->mapAt(mappingArea,
-                pdptEntry & ~PAGE_FLAGS, PROT_READ);
-        uintptr_t pdEntry = pageDirectory[index.pdIndex];
-        kernelSpace->unmap(mappingArea);
-        if (!pdEntry) return 0;
-
-        uintptr_t* pageTable = (uintptr_t*) kernelSpace->mapAt(mappingArea,
-                pdEntry & ~PAGE_FLAGS, PROT_READ);
-        paddr_t result = pageTable[index.ptIndex] & ~PAGE_FLAGS;
-        kernelSpace->unmap(mappingArea);
-        return result;
+
+        // We need to map that pdpt in all address spaces. The current PML4
+        // is accessed through the recursive mapping because the direct map
+        // does not exist yet during early initialization.
+        AutoLock lock(&listMutex);
+        pml4Mapped[index.pml4Index] = pdptPhys | tableFlags;
+        asm ("invlpg (%0)" :: "r"(pdpt));
+        memset(pdpt, 0, PAGESIZE);
+
+        paddr_t currentPml4;
+        asm ("mov %%cr3, %0" : "=r"(currentPml4));
+        for (AddressSpace* addressSpace = kernelSpace; addressSpace;
+                addressSpace = addressSpace->next) {
+            if (addressSpace->pml4 == currentPml4) continue;
+            DIRECT_MAPPED(addressSpace->pml4)[index.pml4Index] =
+                    pdptPhys | tableFlags;
+        }
+    }
+
+    uintptr_t* pdpt = getTable(&pml4Mapped[index.pml4Index],
+            RECURSIVE_PDPT(index.pml4Index), active, allocate, tableFlags);
+    if (!pdpt) return nullptr;
+    uintptr_t* pageDir = getTable(&pdpt[index.pdptIndex],
+            RECURSIVE_PAGEDIR(index.pml4Index, index.pdptIndex), active,
+            allocate, tableFlags);
+    if (!pageDir) return nullptr;
+    return &pageDir[index.pdIndex];
+}
+
+uintptr_t* AddressSpace::getPageTableEntry(vaddr_t virtualAddress,
+        bool allocate) {
+    uintptr_t* pageDirEntry = getPageDirectoryEntry(virtualAddress, allocate);
+    if (!pageDirEntry) return nullptr;
+    if (*pageDirEntry & PAGE_LARGE) {
+        // Lookups must not modify the page tables.
+        if (!allocate || !splitLargePage(pageDirEntry, virtualAddress)) {
+            return nullptr;
+        }
+    }
+
+    PageIndex index = addressToIndex(virtualAddress);
+    uintptr_t tableFlags = PAGE_PRESENT | PAGE_WRITABLE;
+    if (this != kernelSpace) tableFlags |= PAGE_USER;
+    uintptr_t* pageTable = getTable(pageDirEntry,
+            RECURSIVE_PAGETABLE(index.pml4Index, index.pdptIndex,
+            index.pdIndex), isActive(), allocate, tableFlags);
+    if (!pageTable) return nullptr;
+    return &pageTable[index.ptIndex];
+}
+
+paddr_t AddressSpace::getPhysicalAddress(vaddr_t virtualAddress) {
+    if (this == kernelSpace && virtualAddress < 0xFFFF800000000000) return 0;
+    uintptr_t* entry = getPageDirectoryEntry(virtualAddress, false);
+    if (!entry || !*entry) return 0;
+    if (*entry & PAGE_LARGE) {
+        return (*entry & ~LARGE_PAGE_FLAGS) +
+                (virtualAddress & (LARGE_PAGESIZE - 1));
     }
+
+    entry = getPageTableEntry(virtualAddress, false);
+    if (!entry || !(*entry & PAGE_PRESENT)) return 0;
+    return *entry & ~PAGE_FLAGS;
 }
 
 vaddr_t AddressSpace::mapAt(vaddr_t virtualAddress, paddr_t physicalAddress,
@@ -290,119 +441,124 @@ vaddr_t AddressSpace::mapAt(vaddr_t virtualAddress, paddr_t physicalAddress,
         // Memory in user space is always accessible by user.
         flags |= PAGE_USER;
     }
+
     if (!physicalAddress) {
-        flags = 0;
+        unmapWithoutInvalidation(virtualAddress);
+    } else {
+        uintptr_t* entry = getPageTableEntry(virtualAddress, true);
+        if (!entry) return 0;
+        *entry = physicalAddress | flags;
     }
 
-    PageIndex index = addressToIndex(virtualAddress);
-    uintptr_t* pml4Mapping = (uintptr_t*) RECURSIVE_PML4();
-    uintptr_t* pdpt = (uintptr_t*) RECURSIVE_PDPT(index.pml4Index);
-    uintptr_t* pageDir = (uintptr_t*) RECURSIVE_PAGEDIR(index.pml4Index,
-            index.pdptIndex);
-    uintptr_t* pageTable = (uintptr_t*) RECURSIVE_PAGETABLE(index.pml4Index,
-            index.pdptIndex, index.pdIndex);
-
-    if (!isActive()) {
-        pml4Mapping = (uintptr_t*) kernelSpace->mapAt(mappingArea, pml4,
-                PROT_READ | PROT_WRITE);
+    if (isActive()) {
+        asm ("invlpg (%0)" :: "r"(virtualAddress));
     }
 
-    if (!pml4Mapping[index.pml4Index]) {
-        paddr_t pdptPhys = PhysicalMemory::popPageFrame();
-        if (!pdptPhys) goto fail;
-        uintptr_t pdptFlags = PAGE_PRESENT | PAGE_WRITABLE;
-        if (this != kernelSpace) pdptFlags |= PAGE_USER;
-
-        if (this == kernelSpace) {
-            // We need to map that pdpt in all address spaces
-            AutoLock lock(&listMutex);
-
-            AddressSpace* addressSpace = kernelSpace;
-            while (addressSpace) {
-                uintptr_t* pml4Mapped = (uintptr_t*)
-                        kernelSpace->mapAt(kernelSpace->mappingArea,
-                        addressSpace->pml4, PROT_WRITE);
-                pml4Mapped[index.pml4Index] = pdptPhys | pdptFlags;
-                kernelSpace->unmap(kernelSpace->mappingArea);
-                addressSpace = addressSpace->next;
-            }
-        } else if (isActive()) {
-            pml4Mapping[index.pml4Index] = pdptPhys | pdptFlags;
-            asm ("invlpg (%0)" :: "r"(RECURSIVE_PDPT(index.pml4Index)));
-        } else {
-            pml4Mapping[index.pml4Index] = pdptPhys | pdptFlags;
-            kernelSpace->unmap(mappingArea);
-            pdpt = (uintptr_t*) kernelSpace->mapAt(mappingArea, pdptPhys,
-                    PROT_READ | PROT_WRITE);
+    return virtualAddress;
+}
+
+// The mutex must be held and is temporarily released when an unused page table
+// needs to be freed.
+bool AddressSpace::mapLargeAt(vaddr_t virtualAddress, paddr_t physicalAddress,
+        int protection) {
+    assert(LARGE_PAGE_ALIGNED(virtualAddress));
+    assert(LARGE_PAGE_ALIGNED(physicalAddress));
+
+    uintptr_t* entry = getPageDirectoryEntry(virtualAddress, true);
+    if (!entry) return false;
+
+    if (*entry) {
+        // A page table may remain from earlier mappings in this area. It can
+        // only be replaced if it does not map anything anymore.
+        if (*entry & PAGE_LARGE) return false;
+        paddr_t pageTable = *entry & ~PAGE_FLAGS;
+        const uintptr_t* table = DIRECT_MAPPED(pageTable);
+        for (size_t i = 0; i < 512; i++) {
+            if (table[i]) return false;
         }
+        *entry = 0;
+        kthread_mutex_unlock(&mutex);
+        PhysicalMemory::pushPageFrame(pageTable);
+        kthread_mutex_lock(&mutex);
+    }
 
-        memset(pdpt, 0, PAGESIZE);
-    } else if (!isActive()) {
-        paddr_t pdptPhys = pml4Mapping[index.pml4Index] & ~PAGE_FLAGS;
-        kernelSpace->unmap(mappingArea);
-        pdpt = (uintptr_t*) kernelSpace->mapAt(mappingArea, pdptPhys,
-                PROT_READ | PROT_WRITE);
+    uintptr_t flags = protectionToFlags(protection & ~PROT_WRITE_COMBINING) |
+            PAGE_LARGE;
+    // The PAT bit is at a different position for large pages.
+    if (protection & PROT_WRITE_COMBINING && patSupported) {
+        flags |= PAGE_LARGE_WRITE_COMBINING;
+    }
+    if (this != kernelSpace) {
+        flags |= PAGE_USER;
     }
 
-    if (!pdpt[index.pdptIndex]) {
-        paddr_t pdPhys = PhysicalMemory::popPageFrame();
-        if (!pdPhys) goto fail;
-        uintptr_t pdFlags = PAGE_PRESENT | PAGE_WRITABLE;
-        if (this != kernelSpace) pdFlags |= PAGE_USER;
-
-        pdpt[index.pdptIndex] = pdPhys | pdFlags;
-        if (isActive()) {
-            asm ("invlpg (%0)" :: "r"(RECURSIVE_PAGEDIR(index.pml4Index,
-                    index.pdptIndex)));
-        } else {
-            kernelSpace->unmap(mappingArea);
-            pageDir = (uintptr_t*) kernelSpace->mapAt(mappingArea, pdPhys,
-                    PROT_READ | PROT_WRITE);
-        }
-        memset(pageDir, 0, PAGESIZE);
-    } else if (!isActive()) {
-        paddr_t pdPhys = pdpt[index.pdptIndex] & ~PAGE_FLAGS;
-        kernelSpace->unmap(mappingArea);
-        pageDir = (uintptr_t*) kernelSpace->mapAt(mappingArea, pdPhys,
-                PROT_READ | PROT_WRITE);
+    *entry = physicalAddress | flags;
+    invalidateTlb(virtualAddress, LARGE_PAGESIZE);
+    return true;
+}
+
+// Returns the page table entry for the given address or 0 if the address is not
+// mapped by a page table.
+uintptr_t AddressSpace::readPageTableEntry(vaddr_t virtualAddress) {
+    uintptr_t* entry = getPageDirectoryEntry(virtualAddress, false);
+    if (!entry || !*entry || *entry & PAGE_LARGE) return 0;
+    entry = getPageTableEntry(virtualAddress, false);
+    return entry ? *entry : 0;
+}
+
+// Replaces a large page by a page table that maps the same memory.
+bool AddressSpace::splitLargePage(uintptr_t* entry, vaddr_t virtualAddress) {
+    paddr_t pageTable = PhysicalMemory::popPageFrame();
+    if (!pageTable) return false;
+
+    paddr_t physicalAddress = *entry & ~LARGE_PAGE_FLAGS;
+    uintptr_t flags = *entry & PAGE_FLAGS & ~PAGE_LARGE;
+    if (*entry & PAGE_LARGE_WRITE_COMBINING) {
+        flags |= PAGE_WRITE_COMBINING;
     }
 
-    if (!pageDir[index.pdIndex]) {
-        paddr_t ptPhys = PhysicalMemory::popPageFrame();
-        if (!ptPhys) goto fail;
-        uintptr_t ptFlags = PAGE_PRESENT | PAGE_WRITABLE;
-        if (this != kernelSpace) ptFlags |= PAGE_USER;
-
-        pageDir[index.pdIndex] = ptPhys | ptFlags;
-        if (isActive()) {
-            asm ("invlpg (%0)" :: "r"(RECURSIVE_PAGETABLE(index.pml4Index,
-                    index.pdptIndex, index.pdIndex)));
-        } else {
-            kernelSpace->unmap(mappingArea);
-            pageTable = (uintptr_t*) kernelSpace->mapAt(mappingArea, ptPhys,
-                    PROT_READ | PROT_WRITE);
-        }
-        memset(pageTable, 0, PAGESIZE);
-    } else if (!isActive()) {
-        paddr_t ptPhys = pageDir[index.pdIndex] & ~PAGE_FLAGS;
-        kernelSpace->unmap(mappingArea);
-        pageTable = (uintptr_t*) kernelSpace->mapAt(mappingArea, ptPhys,
-                PROT_READ | PROT_WRITE);
+    uintptr_t* table = DIRECT_MAPPED(pageTable);
+    for (size_t i = 0; i < 512; i++) {
+        table[i] = (physicalAddress + i * PAGESIZE) | flags;
     }
 
-    pageTable[index.ptIndex] = physicalAddress | flags;
+    uintptr_t tableFlags = PAGE_PRESENT | PAGE_WRITABLE;
+    if (this != kernelSpace) tableFlags |= PAGE_USER;
+    *entry = pageTable | tableFlags;
+    invalidateTlb(virtualAddress & ~(LARGE_PAGESIZE - 1), LARGE_PAGESIZE);
+    return true;
+}
 
-    if (isActive()) {
-        asm ("invlpg (%0)" :: "r"(virtualAddress));
-    } else {
-        kernelSpace->unmap(mappingArea);
+// Unmaps the large page starting at the given address without invalidating the
+// TLB. Returns 0 if there is no such page.
+paddr_t AddressSpace::unmapLargePage(vaddr_t virtualAddress) {
+    if (!LARGE_PAGE_ALIGNED(virtualAddress)) return 0;
+    uintptr_t* entry = getPageDirectoryEntry(virtualAddress, false);
+    if (!entry || !(*entry & PAGE_LARGE)) return 0;
+    paddr_t physicalAddress = *entry & ~LARGE_PAGE_FLAGS;
+    *entry = 0;
+    return physicalAddress;
+}
+
+paddr_t AddressSpace::unmapWithoutInvalidation(vaddr_t virtualAddress) {
+    uintptr_t* entry = getPageDirectoryEntry(virtualAddress, false);
+    if (!entry || !*entry) return 0;
+    // Unmapping part of a large page requires splitting it first.
+    if (*entry & PAGE_LARGE && !splitLargePage(entry, virtualAddress)) {
+        return 0;
     }
 
-    return virtualAddress;
+    entry = getPageTableEntry(virtualAddress, false);
+    if (!entry) return 0;
+    paddr_t physicalAddress = *entry & ~PAGE_FLAGS;
+    *entry = 0;
+    return physicalAddress;
+}
 
-fail:
-    if (!isActive()) {
-        kernelSpace->unmap(mappingArea);
-    }
-    return 0;
+// Replaces an entry in an existing page table without invalidating the TLB.
+void AddressSpace::writePageTableEntry(vaddr_t virtualAddress,
+        uintptr_t entry) {
+    uintptr_t* pageTableEntry = getPageTableEntry(virtualAddress, false);
+    assert(pageTableEntry);
+    *pageTableEntry = entry;
 }
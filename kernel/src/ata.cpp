@@ -33,6 +33,8 @@
 #include <dennix/kernel/pci.h>
 #include <dennix/kernel/physicalmemory.h>
 #include <dennix/kernel/portio.h>
+#include <dennix/kernel/thread.h>
+#include <dennix/kernel/trace.h>
 
 #define REGISTER_DATA 0
 #define REGISTER_ERROR 1
@@ -186,6 +188,7 @@ AtaChannel::AtaChannel(uint16_t iobase, uint16_t ctrlbase,
 bool AtaChannel::finishDmaTransfer() {
     if (!dmaInProgress) return true;
 
+    AutoWaitChannel waitChannel("ata");
     while (awaitingInterrupt) {
         sched_yield();
     }
@@ -289,6 +292,7 @@ void AtaChannel::onIrq(const InterruptContext* /*context*/) {
     if (status & (STATUS_ERROR | STATUS_DEVICE_FAULT)) {
         error = true;
     }
+    TRACE(TRACE_ATA_COMPLETE, iobase, error);
     awaitingInterrupt = false;
 }
 
@@ -316,6 +320,7 @@ bool AtaChannel::readSectors(char* buffer, size_t sectorCount, uint64_t lba,
     awaitingInterrupt = true;
     dmaInProgress = true;
     error = false;
+    TRACE(TRACE_ATA_SUBMIT, iobase, sectorCount);
     outb(busmasterBase + REGISTER_BUSMASTER_COMMAND,
             BUSMASTER_COMMAND_START | BUSMASTER_COMMAND_READ);
     if (!finishDmaTransfer()) return false;
@@ -374,6 +379,7 @@ bool AtaChannel::writeSectors(const char* buffer, size_t sectorCount,
     awaitingInterrupt = true;
     dmaInProgress = true;
     error = false;
+    TRACE(TRACE_ATA_SUBMIT, iobase, sectorCount);
     outb(busmasterBase + REGISTER_BUSMASTER_COMMAND,
             BUSMASTER_COMMAND_START);
     // The transfer will be finished asynchronously.
@@ -21,6 +21,8 @@
 #include <dennix/kernel/addressspace.h>
 #include <dennix/kernel/blockcache.h>
 #include <dennix/kernel/interrupts.h>
+#include <dennix/kernel/thread.h>
+#include <dennix/kernel/trace.h>
 
 static void worker(void* device) {
     BlockCacheDevice* dev = (BlockCacheDevice*) device;
@@ -34,10 +36,23 @@ BlockCacheDevice::BlockCacheDevice(mode_t mode, dev_t dev)
     freeList = nullptr;
     leastRecentlyUsed = nullptr;
     mostRecentlyUsed = nullptr;
+    pinnedBlock = nullptr;
     workerJob.func = worker;
     workerJob.context = this;
 }
 
+off_t BlockCacheDevice::getDeviceOffset(off_t offset,
+        BlockCacheDevice** device) {
+    if (offset < 0 || offset > stats.st_size - PAGESIZE ||
+            offset % stats.st_blksize != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    *device = this;
+    return offset;
+}
+
 bool BlockCacheDevice::isSeekable() {
     return true;
 }
@@ -76,6 +91,33 @@ ssize_t BlockCacheDevice::pread(void* buffer, size_t size, off_t offset,
     }
 
     AutoLock lock(&mutex);
+    return readBlocks(buffer, size, offset, flags);
+}
+
+ssize_t BlockCacheDevice::preadv(const struct iovec* iov, int iovcnt,
+        off_t offset, int flags) {
+    if (offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // All buffers are handled while holding the lock so that the request
+    // behaves like a single read.
+    AutoLock lock(&mutex);
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) continue;
+        ssize_t result = readBlocks(iov[i].iov_base, iov[i].iov_len,
+                offset + total, flags);
+        if (result < 0) return total ? total : -1;
+        total += result;
+        if ((size_t) result < iov[i].iov_len) break;
+    }
+    return total;
+}
+
+ssize_t BlockCacheDevice::readBlocks(void* buffer, size_t size, off_t offset,
+        int flags) {
     if (offset >= stats.st_size) return 0;
     if ((off_t) size > stats.st_size - offset) {
         size = stats.st_size - offset;
@@ -91,6 +133,7 @@ ssize_t BlockCacheDevice::pread(void* buffer, size_t size, off_t offset,
         off_t blockOffset = blockNumber * PAGESIZE;
 
         Block* block = blocks.get(blockNumber);
+        TRACE(block ? TRACE_BLOCK_HIT : TRACE_BLOCK_MISS, blockNumber, 0);
         if (!block) {
             if (!allocatedBlock) {
                 kthread_mutex_unlock(&cacheMutex);
@@ -134,6 +177,7 @@ ssize_t BlockCacheDevice::pread(void* buffer, size_t size, off_t offset,
                     if (!bytesRead) bytesRead = -1;
                     break;
                 }
+                Thread::current()->counters.blockReadBytes += readSize;
 
                 block = allocatedBlock;
                 allocatedBlock = nullptr;
@@ -146,8 +190,14 @@ ssize_t BlockCacheDevice::pread(void* buffer, size_t size, off_t offset,
         size_t readSize = PAGESIZE - (offset & PAGE_MISALIGN);
         if (readSize > size) readSize = size;
 
+        // The buffer is accessed without holding the cache mutex because a
+        // page fault on it might need to reclaim memory from the cache.
+        pinnedBlock = block;
+        kthread_mutex_unlock(&cacheMutex);
         memcpy(buf + bytesRead, (char*) block->address +
                 (offset & PAGE_MISALIGN), readSize);
+        kthread_mutex_lock(&cacheMutex);
+        pinnedBlock = nullptr;
         offset += readSize;
         bytesRead += readSize;
         size -= readSize;
@@ -176,6 +226,31 @@ ssize_t BlockCacheDevice::pwrite(const void* buffer, size_t size, off_t offset,
     }
 
     AutoLock lock(&mutex);
+    return writeBlocks(buffer, size, offset, flags);
+}
+
+ssize_t BlockCacheDevice::pwritev(const struct iovec* iov, int iovcnt,
+        off_t offset, int flags) {
+    if (offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    AutoLock lock(&mutex);
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) continue;
+        ssize_t result = writeBlocks(iov[i].iov_base, iov[i].iov_len,
+                offset + total, flags);
+        if (result < 0) return total ? total : -1;
+        total += result;
+        if ((size_t) result < iov[i].iov_len) break;
+    }
+    return total;
+}
+
+ssize_t BlockCacheDevice::writeBlocks(const void* buffer, size_t size,
+        off_t offset, int flags) {
     if (offset >= stats.st_size) {
         errno = ENOSPC;
         return -1;
@@ -194,6 +269,7 @@ ssize_t BlockCacheDevice::pwrite(const void* buffer, size_t size, off_t offset,
         off_t blockOffset = blockNumber * PAGESIZE;
 
         Block* block = blocks.get(blockNumber);
+        TRACE(block ? TRACE_BLOCK_HIT : TRACE_BLOCK_MISS, blockNumber, 0);
         if (!block) {
             if (!allocatedBlock) {
                 kthread_mutex_unlock(&cacheMutex);
@@ -240,6 +316,7 @@ ssize_t BlockCacheDevice::pwrite(const void* buffer, size_t size, off_t offset,
                         if (!bytesWritten) bytesWritten = -1;
                         break;
                     }
+                    Thread::current()->counters.blockReadBytes += readSize;
                 }
 
                 block = allocatedBlock;
@@ -253,8 +330,12 @@ ssize_t BlockCacheDevice::pwrite(const void* buffer, size_t size, off_t offset,
         size_t writeSize = PAGESIZE - (offset & PAGE_MISALIGN);
         if (writeSize > size) writeSize = size;
 
+        pinnedBlock = block;
+        kthread_mutex_unlock(&cacheMutex);
         memcpy((char*) block->address + (offset & PAGE_MISALIGN),
                 buf + bytesWritten, writeSize);
+        kthread_mutex_lock(&cacheMutex);
+        pinnedBlock = nullptr;
 
         off_t writeOffset = offset & ~(stats.st_blksize - 1);
         size_t writeLength = ALIGNUP(writeSize, stats.st_blksize);
@@ -264,6 +345,7 @@ ssize_t BlockCacheDevice::pwrite(const void* buffer, size_t size, off_t offset,
             if (bytesWritten == 0) return -1;
             return bytesWritten;
         }
+        Thread::current()->counters.blockWriteBytes += writeLength;
 
         offset += writeSize;
         bytesWritten += writeSize;
@@ -300,8 +382,10 @@ void BlockCacheDevice::freeUnusedBlocks() {
 paddr_t BlockCacheDevice::reclaimCache() {
     AutoLock lock(&cacheMutex);
 
+    // The pinned block is the most recently used one, so it is only the least
+    // recently used block if it is the only block in the cache.
     Block* block = leastRecentlyUsed;
-    if (!block) return 0;
+    if (!block || block == pinnedBlock) return 0;
 
     leastRecentlyUsed = block->nextAccessed;
     if (leastRecentlyUsed) {
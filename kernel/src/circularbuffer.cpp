@@ -17,56 +17,160 @@
  * Circular Buffer.
  */
 
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
+#include <dennix/kernel/addressspace.h>
 #include <dennix/kernel/circularbuffer.h>
 
 CircularBuffer::CircularBuffer() {
-
-}
-
-CircularBuffer::CircularBuffer(char* buffer, size_t size) {
-    initialize(buffer, size);
-}
-
-void CircularBuffer::initialize(char* buffer, size_t size) {
-    this->buffer = buffer;
-    bufferSize = size;
+    pages = nullptr;
+    numPages = 0;
     readPosition = 0;
     bytesStored = 0;
 }
 
+CircularBuffer::~CircularBuffer() {
+    for (size_t i = 0; i < numPages; i++) {
+        if (!pages[i]) continue;
+        kernelSpace->unmapMemory((vaddr_t) pages[i], PAGESIZE);
+    }
+    free(pages);
+}
+
 size_t CircularBuffer::bytesAvailable() {
     return bytesStored;
 }
 
-size_t CircularBuffer::spaceAvailable() {
-    return bufferSize - bytesStored;
+size_t CircularBuffer::capacity() {
+    return numPages * PAGESIZE;
 }
 
-size_t CircularBuffer::read(void* buf, size_t size) {
+size_t CircularBuffer::discard(size_t size) {
+    if (size > bytesStored) size = bytesStored;
+    if (size == 0) return 0;
+    readPosition = (readPosition + size) % capacity();
+    bytesStored -= size;
+
+    // Start again at the first page so that buffers that never hold much data
+    // only ever touch a single page.
+    if (bytesStored == 0) {
+        readPosition = 0;
+    }
+    return size;
+}
+
+// Copies data starting offset bytes into the buffer without removing it.
+size_t CircularBuffer::peek(void* buf, size_t size, size_t offset) {
     size_t bytesRead = 0;
-    while (bytesStored > 0 && bytesRead < size) {
-        size_t count = bufferSize - readPosition;
+    while (offset + bytesRead < bytesStored && bytesRead < size) {
+        size_t position = (readPosition + offset + bytesRead) % capacity();
+        size_t pageOffset = position % PAGESIZE;
+        size_t count = PAGESIZE - pageOffset;
         if (count > size - bytesRead) count = size - bytesRead;
-        if (count > bytesStored) count = bytesStored;
+        if (count > bytesStored - offset - bytesRead) {
+            count = bytesStored - offset - bytesRead;
+        }
 
-        memcpy((char*) buf + bytesRead, buffer + readPosition, count);
-        readPosition = (readPosition + count) % bufferSize;
-        bytesStored -= count;
+        memcpy((char*) buf + bytesRead, pages[position / PAGESIZE] +
+                pageOffset, count);
         bytesRead += count;
     }
     return bytesRead;
 }
 
+size_t CircularBuffer::read(void* buf, size_t size) {
+    return discard(peek(buf, size, 0));
+}
+
+// Allocates the pages needed to write the next size bytes so that a following
+// write of that size cannot fail.
+bool CircularBuffer::reserve(size_t size) {
+    if (size > spaceAvailable()) {
+        errno = ENOBUFS;
+        return false;
+    }
+
+    size_t writePosition = (readPosition + bytesStored) % capacity();
+    size_t end = writePosition + size;
+    for (size_t i = writePosition / PAGESIZE; i * PAGESIZE < end; i++) {
+        size_t pageIndex = i % numPages;
+        if (pages[pageIndex]) continue;
+        pages[pageIndex] = (char*) kernelSpace->mapMemory(PAGESIZE,
+                PROT_READ | PROT_WRITE);
+        if (!pages[pageIndex]) return false;
+    }
+    return true;
+}
+
+// Changes the capacity of the buffer. The size is rounded up to whole pages.
+bool CircularBuffer::resize(size_t size) {
+    size_t newNumPages = size <= PAGESIZE ? 1 : ALIGNUP(size, PAGESIZE) /
+            PAGESIZE;
+    if (newNumPages == numPages) return true;
+    if (newNumPages * PAGESIZE < bytesStored) {
+        errno = EBUSY;
+        return false;
+    }
+
+    char** newPages = (char**) calloc(newNumPages, sizeof(char*));
+    if (!newPages) return false;
+
+    // Move the data into fresh pages at the beginning of the ring.
+    for (size_t i = 0; i * PAGESIZE < bytesStored; i++) {
+        newPages[i] = (char*) kernelSpace->mapMemory(PAGESIZE,
+                PROT_READ | PROT_WRITE);
+        if (!newPages[i]) {
+            for (size_t j = 0; j < i; j++) {
+                kernelSpace->unmapMemory((vaddr_t) newPages[j], PAGESIZE);
+            }
+            free(newPages);
+            return false;
+        }
+    }
+
+    size_t stored = bytesStored;
+    for (size_t i = 0; i * PAGESIZE < stored; i++) {
+        read(newPages[i], PAGESIZE);
+    }
+
+    for (size_t i = 0; i < numPages; i++) {
+        if (!pages[i]) continue;
+        kernelSpace->unmapMemory((vaddr_t) pages[i], PAGESIZE);
+    }
+    free(pages);
+
+    pages = newPages;
+    numPages = newNumPages;
+    readPosition = 0;
+    bytesStored = stored;
+    return true;
+}
+
+size_t CircularBuffer::spaceAvailable() {
+    return capacity() - bytesStored;
+}
+
+// Returns less than size only if the buffer is full or a page could not be
+// allocated.
 size_t CircularBuffer::write(const void* buf, size_t size) {
     size_t written = 0;
     while (spaceAvailable() > 0 && written < size) {
-        size_t writeIndex = (readPosition + bytesStored) % bufferSize;
-        size_t count = bufferSize - writeIndex;
+        size_t writePosition = (readPosition + bytesStored) % capacity();
+        size_t pageIndex = writePosition / PAGESIZE;
+        if (!pages[pageIndex]) {
+            pages[pageIndex] = (char*) kernelSpace->mapMemory(PAGESIZE,
+                    PROT_READ | PROT_WRITE);
+            if (!pages[pageIndex]) break;
+        }
+
+        size_t pageOffset = writePosition % PAGESIZE;
+        size_t count = PAGESIZE - pageOffset;
         if (count > size - written) count = size - written;
         if (count > spaceAvailable()) count = spaceAvailable();
 
-        memcpy(buffer + writeIndex, (char*) buf + written, count);
+        memcpy(pages[pageIndex] + pageOffset, (const char*) buf + written,
+                count);
         written += count;
         bytesStored += count;
     }
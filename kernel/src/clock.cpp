@@ -22,6 +22,7 @@
 #include <dennix/kernel/clock.h>
 #include <dennix/kernel/process.h>
 #include <dennix/kernel/signal.h>
+#include <dennix/kernel/vdso.h>
 
 static Clock monotonicClock;
 static Clock realtimeClock;
@@ -38,7 +39,7 @@ struct timespec timespecPlus(struct timespec ts1, struct timespec ts2) {
     return result;
 }
 
-static struct timespec timespecMinus(struct timespec ts1, struct timespec ts2) {
+struct timespec timespecMinus(struct timespec ts1, struct timespec ts2) {
     struct timespec result;
     result.tv_sec = ts1.tv_sec - ts2.tv_sec;
     result.tv_nsec = ts1.tv_nsec - ts2.tv_nsec;
@@ -95,6 +96,7 @@ int Clock::nanosleep(int flags, const struct timespec* requested,
         abstime = timespecPlus(value, *requested);
     }
 
+    AutoWaitChannel waitChannel("nanosleep");
     while (timespecLess(value, abstime) && !Signal::isPending()) {
         sched_yield();
     }
@@ -110,6 +112,7 @@ int Clock::nanosleep(int flags, const struct timespec* requested,
 
 int Clock::setTime(struct timespec* newValue) {
     value = *newValue;
+    Vdso::updateClocks(monotonicClock.value, realtimeClock.value);
     return 0;
 }
 
@@ -125,6 +128,7 @@ void Clock::tick(unsigned long nanoseconds) {
 void Clock::onTick(bool user, unsigned long nanoseconds) {
     monotonicClock.tick(nanoseconds);
     realtimeClock.tick(nanoseconds);
+    Vdso::updateClocks(monotonicClock.value, realtimeClock.value);
     Process::current()->cpuClock.tick(nanoseconds);
     if (user) {
         Process::current()->userCpuClock.tick(nanoseconds);
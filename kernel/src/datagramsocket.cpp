@@ -0,0 +1,345 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/datagramsocket.cpp
+ * Unix domain datagram sockets.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dennix/poll.h>
+#include <dennix/kernel/datagramsocket.h>
+
+DatagramSocket::DatagramSocket(mode_t mode) : Socket(SOCK_DGRAM, mode) {
+    socketMutex = KTHREAD_MUTEX_INITIALIZER;
+    receiveCond = KTHREAD_COND_INITIALIZER;
+    sendCond = KTHREAD_COND_INITIALIZER;
+    boundAddress.sun_family = AF_UNSPEC;
+    peerAddress.sun_family = AF_UNSPEC;
+    firstDatagram = nullptr;
+    lastDatagram = nullptr;
+    bytesQueued = 0;
+    receiveBufferSize = DATAGRAM_SOCKET_DEFAULT_BUFFER;
+    sendBufferSize = DATAGRAM_SOCKET_DEFAULT_BUFFER;
+}
+
+DatagramSocket::~DatagramSocket() {
+    while (firstDatagram) {
+        Datagram* datagram = firstDatagram;
+        firstDatagram = datagram->next;
+        free(datagram);
+    }
+}
+
+int DatagramSocket::bind(const struct sockaddr* address, socklen_t length,
+        int /*flags*/) {
+    AutoLock lock(&socketMutex);
+
+    if (!address) {
+        errno = EDESTADDRREQ;
+        return -1;
+    }
+
+    if (boundAddress.sun_family != AF_UNSPEC) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (bindAddress(address, length) < 0) return -1;
+    boundAddress = *(const struct sockaddr_un*) address;
+    return 0;
+}
+
+// Sets the default destination for datagrams. Connecting to an AF_UNSPEC
+// address removes the default destination again.
+int DatagramSocket::connect(const struct sockaddr* address, socklen_t length,
+        int /*flags*/) {
+    AutoLock lock(&socketMutex);
+
+    if (address->sa_family == AF_UNSPEC) {
+        peerAddress.sun_family = AF_UNSPEC;
+        return 0;
+    }
+
+    Reference<Socket> socket = resolveAddress(address, length);
+    if (!socket) return -1;
+    if (socket->type != SOCK_DGRAM) {
+        errno = EPROTOTYPE;
+        return -1;
+    }
+
+    peerAddress = *(const struct sockaddr_un*) address;
+    return 0;
+}
+
+bool DatagramSocket::enqueue(Datagram* datagram, SocketRights* rights,
+        int fileFlags) {
+    AutoLock lock(&socketMutex);
+
+    // A datagram that is larger than the receive buffer can still be received
+    // when nothing else is queued.
+    while (bytesQueued && bytesQueued + datagram->size > receiveBufferSize) {
+        if (fileFlags & O_NONBLOCK) {
+            errno = EWOULDBLOCK;
+            return false;
+        }
+
+        if (kthread_cond_sigwait(&sendCond, &socketMutex) == EINTR) {
+            errno = EINTR;
+            return false;
+        }
+    }
+
+    if (rights && !checkRights(rights)) return false;
+
+    datagram->next = nullptr;
+    if (lastDatagram) {
+        lastDatagram->next = datagram;
+    } else {
+        firstDatagram = datagram;
+    }
+    lastDatagram = datagram;
+    bytesQueued += datagram->size;
+    if (rights) {
+        queueRights(rights);
+    }
+
+    kthread_cond_broadcast(&receiveCond);
+    notifyEventListeners();
+    return true;
+}
+
+int DatagramSocket::getsockopt(int level, int name, void* restrict value,
+        socklen_t* restrict length) {
+    if (level != SOL_SOCKET) {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    if (*length < (socklen_t) sizeof(int)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    AutoLock lock(&socketMutex);
+    if (name == SO_RCVBUF) {
+        *(int*) value = receiveBufferSize;
+    } else if (name == SO_SNDBUF) {
+        *(int*) value = sendBufferSize;
+    } else {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    *length = sizeof(int);
+    return 0;
+}
+
+short DatagramSocket::poll() {
+    AutoLock lock(&socketMutex);
+    short result = POLLOUT | POLLWRNORM;
+    if (firstDatagram) {
+        result |= POLLIN | POLLRDNORM;
+    }
+    return result;
+}
+
+ssize_t DatagramSocket::read(void* buffer, size_t size, int flags) {
+    struct iovec iov = { buffer, size };
+    return readv(&iov, 1, flags);
+}
+
+ssize_t DatagramSocket::readv(const struct iovec* iov, int iovcnt,
+        int flags) {
+    struct msghdr msg = {};
+    msg.msg_iov = (struct iovec*) iov;
+    msg.msg_iovlen = iovcnt;
+    return recvmsg(&msg, 0, flags);
+}
+
+ssize_t DatagramSocket::recvmsg(struct msghdr* msg, int flags,
+        int fileFlags) {
+    Datagram* datagram;
+    SocketRights* rights = nullptr;
+    size_t bytesRead = 0;
+    msg->msg_flags = 0;
+
+    {
+        AutoLock lock(&socketMutex);
+
+        while (!firstDatagram) {
+            if (fileFlags & O_NONBLOCK) {
+                errno = EWOULDBLOCK;
+                return -1;
+            }
+
+            if (kthread_cond_sigwait(&receiveCond, &socketMutex) == EINTR) {
+                errno = EINTR;
+                return -1;
+            }
+        }
+
+        datagram = firstDatagram;
+        const char* data = (const char*) (datagram + 1);
+        for (int i = 0; i < msg->msg_iovlen && bytesRead < datagram->size;
+                i++) {
+            size_t count = msg->msg_iov[i].iov_len;
+            if (count > datagram->size - bytesRead) {
+                count = datagram->size - bytesRead;
+            }
+            memcpy(msg->msg_iov[i].iov_base, data + bytesRead, count);
+            bytesRead += count;
+        }
+
+        if (bytesRead < datagram->size) {
+            msg->msg_flags |= MSG_TRUNC;
+        }
+
+        if (msg->msg_name) {
+            size_t addressSize = datagram->sender.sun_family == AF_UNSPEC ?
+                    0 : sizeof(struct sockaddr_un);
+            if (msg->msg_namelen < 0) msg->msg_namelen = 0;
+            size_t copySize = (size_t) msg->msg_namelen < addressSize ?
+                    msg->msg_namelen : addressSize;
+            memcpy(msg->msg_name, &datagram->sender, copySize);
+            msg->msg_namelen = copySize;
+        }
+
+        if (!(flags & MSG_PEEK)) {
+            firstDatagram = datagram->next;
+            if (!firstDatagram) {
+                lastDatagram = nullptr;
+            }
+            bytesQueued -= datagram->size;
+            if (datagram->hasRights) {
+                rights = dequeueRights();
+            }
+            kthread_cond_broadcast(&sendCond);
+        }
+    }
+
+    putRights(msg, rights, flags);
+    if (!(flags & MSG_PEEK)) {
+        free(datagram);
+    }
+
+    updateTimestampsLocked(true, false, false);
+    return bytesRead;
+}
+
+ssize_t DatagramSocket::sendmsg(const struct msghdr* msg, int /*flags*/,
+        int fileFlags) {
+    size_t size = 0;
+    for (int i = 0; i < msg->msg_iovlen; i++) {
+        size += msg->msg_iov[i].iov_len;
+    }
+
+    struct sockaddr_un sender;
+    Reference<Socket> socket;
+    {
+        AutoLock lock(&socketMutex);
+        if (size > sendBufferSize) {
+            errno = EMSGSIZE;
+            return -1;
+        }
+
+        sender = boundAddress;
+        if (msg->msg_name) {
+            socket = resolveAddress((const struct sockaddr*) msg->msg_name,
+                    msg->msg_namelen);
+        } else if (peerAddress.sun_family != AF_UNSPEC) {
+            socket = resolveAddress((const struct sockaddr*) &peerAddress,
+                    sizeof(peerAddress));
+        } else {
+            errno = ENOTCONN;
+            return -1;
+        }
+    }
+
+    if (!socket) return -1;
+    if (socket->type != SOCK_DGRAM) {
+        errno = EPROTOTYPE;
+        return -1;
+    }
+
+    Datagram* datagram = (Datagram*) malloc(sizeof(Datagram) + size);
+    if (!datagram) return -1;
+    SocketRights* rights;
+    if (!getRights(msg, &rights)) {
+        free(datagram);
+        return -1;
+    }
+    datagram->sender = sender;
+    datagram->hasRights = rights != nullptr;
+    datagram->size = size;
+
+    char* data = (char*) (datagram + 1);
+    for (int i = 0; i < msg->msg_iovlen; i++) {
+        memcpy(data, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+        data += msg->msg_iov[i].iov_len;
+    }
+
+    Reference<DatagramSocket> receiver = (Reference<DatagramSocket>) socket;
+    if (!receiver->enqueue(datagram, rights, fileFlags)) {
+        delete rights;
+        free(datagram);
+        return -1;
+    }
+
+    updateTimestampsLocked(false, true, true);
+    return size;
+}
+
+int DatagramSocket::setsockopt(int level, int name, const void* value,
+        socklen_t length) {
+    if (level != SOL_SOCKET) {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    if (length != sizeof(int) || *(const int*) value < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t size = *(const int*) value;
+    if (size > DATAGRAM_SOCKET_MAX_BUFFER) size = DATAGRAM_SOCKET_MAX_BUFFER;
+
+    AutoLock lock(&socketMutex);
+    if (name == SO_RCVBUF) {
+        receiveBufferSize = size;
+        kthread_cond_broadcast(&sendCond);
+    } else if (name == SO_SNDBUF) {
+        sendBufferSize = size;
+    } else {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+    return 0;
+}
+
+ssize_t DatagramSocket::write(const void* buffer, size_t size, int flags) {
+    struct iovec iov = { (void*) buffer, size };
+    return writev(&iov, 1, flags);
+}
+
+ssize_t DatagramSocket::writev(const struct iovec* iov, int iovcnt,
+        int flags) {
+    struct msghdr msg = {};
+    msg.msg_iov = (struct iovec*) iov;
+    msg.msg_iovlen = iovcnt;
+    return sendmsg(&msg, 0, flags);
+}
@@ -24,10 +24,12 @@
 #include <dennix/poll.h>
 #include <dennix/kernel/console.h>
 #include <dennix/kernel/devices.h>
+#include <dennix/kernel/mempressure.h>
 #include <dennix/kernel/mouse.h>
 #include <dennix/kernel/panic.h>
 #include <dennix/kernel/process.h>
 #include <dennix/kernel/pseudoterminal.h>
+#include <dennix/kernel/trace.h>
 
 class DevDir : public DirectoryVnode {
 public:
@@ -124,6 +126,8 @@ void DevFS::initialize(const Reference<DirectoryVnode>& rootDir) {
     addDevice("console", console);
     addDevice("display", console->display);
     addDevice("full", xnew DevFull());
+    memoryPressureDevice = xnew MemoryPressureDevice();
+    addDevice("mempressure", memoryPressureDevice);
     mouseDevice = xnew MouseDevice();
     addDevice("mouse", mouseDevice);
     addDevice("null", xnew DevNull());
@@ -131,6 +135,9 @@ void DevFS::initialize(const Reference<DirectoryVnode>& rootDir) {
     addDevice("pts", xnew DevPts());
     Reference<Vnode> random = xnew DevRandom();
     addDevice("random", random);
+    // POSIX shared memory objects are in-memory files in /dev/shm.
+    addDevice("shm", xnew DirectoryVnode(devDir, 01777, dev));
+    addDevice("trace", xnew TraceDevice());
     addDevice("tty", xnew DevTty());
     addDevice("urandom", random);
     addDevice("zero", xnew DevZero());
@@ -127,24 +127,14 @@ int DirectoryVnode::mkdir(const char* name, mode_t mode) {
     return 0;
 }
 
-size_t DirectoryVnode::getDirectoryEntries(void** buffer, int /*flags*/) {
+ssize_t DirectoryVnode::getDirectoryEntries(void* buffer, size_t size,
+        off_t* offset, int /*flags*/) {
     AutoLock lock(&mutex);
 
-    size_t size = ALIGNUP(offsetof(struct posix_dent, d_name) + 2, // .
-            alignof(struct posix_dent)) +
-            ALIGNUP(offsetof(struct posix_dent, d_name) + 3, // ..
-            alignof(struct posix_dent));
-
-    for (size_t i = 0; i < childCount; i++) {
-        size += ALIGNUP(offsetof(struct posix_dent, d_name) +
-                strlen(fileNames[i]) + 1, alignof(struct posix_dent));
-    }
-    *buffer = malloc(size);
-    if (!*buffer) return 0;
-
-    void* p = *buffer;
-
-    for (size_t i = 0; i < childCount + 2; i++) {
+    // The offset is the index of the next entry with . and .. being the
+    // first two entries.
+    size_t used = 0;
+    for (off_t i = *offset; i < (off_t) childCount + 2; i++) {
         struct stat st;
         const char* name;
         if (i == 0) {
@@ -158,17 +148,18 @@ size_t DirectoryVnode::getDirectoryEntries(void** buffer, int /*flags*/) {
             name = fileNames[i - 2];
         }
 
-        posix_dent* dent = (posix_dent*) p;
-        dent->d_ino = st.st_ino;
-        dent->d_reclen = ALIGNUP(offsetof(struct posix_dent, d_name) +
-                strlen(name) + 1, alignof(struct posix_dent));
-        dent->d_type = IFTODT(st.st_mode);
-        strcpy(dent->d_name, name);
-
-        p = (void*) ((uintptr_t) p + dent->d_reclen);
+        if (!addDirectoryEntry(buffer, size, &used, st.st_ino,
+                IFTODT(st.st_mode), name, strlen(name))) {
+            if (used == 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            break;
+        }
+        *offset = i + 1;
     }
 
-    return size;
+    return used;
 }
 
 off_t DirectoryVnode::lseek(off_t offset, int whence) {
@@ -178,7 +169,7 @@ off_t DirectoryVnode::lseek(off_t offset, int whence) {
     if (whence == SEEK_SET || whence == SEEK_CUR) {
         base = 0;
     } else if (whence == SEEK_END) {
-        base = childCount;
+        base = childCount + 2;
     } else {
         errno = EINVAL;
         return -1;
@@ -0,0 +1,271 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/eventqueue.cpp
+ * Event queues.
+ */
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <dennix/kernel/eventqueue.h>
+#include <dennix/kernel/filedescription.h>
+
+#define NUM_BUCKETS (sizeof(registrationBuckets) / sizeof(EventRegistration*))
+
+// This mutex protects the set of registrations of all event queues. It must be
+// acquired before any vnode mutex. Holding it guarantees that the file
+// descriptions of all registrations stay alive.
+static kthread_mutex_t registrationMutex = KTHREAD_MUTEX_INITIALIZER;
+
+EventRegistration::EventRegistration(EventQueue* queue, FileDescription* descr,
+        int fd, const struct epoll_event* event) : queue(queue), descr(descr),
+        fd(fd), event(*event) {
+    enabled = true;
+    queued = false;
+    nextInHashTable = nullptr;
+    prevReady = nullptr;
+    nextReady = nullptr;
+    prevInDescription = nullptr;
+    nextInDescription = nullptr;
+}
+
+void EventRegistration::onEvent() {
+    AutoLock lock(&queue->readyMutex);
+    if (enabled && !queued) {
+        queue->enqueue(this);
+    }
+}
+
+// Event queues are the only vnodes without a file type.
+EventQueue::EventQueue() : Vnode(S_IRUSR | S_IWUSR, 0),
+        registrations(NUM_BUCKETS, registrationBuckets) {
+    firstReady = nullptr;
+    lastReady = nullptr;
+    readyMutex = KTHREAD_MUTEX_INITIALIZER;
+    readyCond = KTHREAD_COND_INITIALIZER;
+}
+
+EventQueue::~EventQueue() {
+    AutoLock lock(&registrationMutex);
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        while (registrationBuckets[i]) {
+            removeRegistration(registrationBuckets[i]);
+        }
+    }
+}
+
+// Reports the events of the registrations in the ready list. Registrations
+// that are queued again while we are doing this are not looked at until the
+// next call.
+int EventQueue::collectEvents(struct epoll_event* events, int maxEvents) {
+    AutoLock lock(&registrationMutex);
+
+    kthread_mutex_lock(&readyMutex);
+    EventRegistration* last = lastReady;
+    kthread_mutex_unlock(&readyMutex);
+    if (!last) return 0;
+
+    int count = 0;
+    while (count < maxEvents) {
+        kthread_mutex_lock(&readyMutex);
+        EventRegistration* registration = firstReady;
+        if (registration) {
+            unlinkReady(registration);
+        }
+        kthread_mutex_unlock(&readyMutex);
+        if (!registration) break;
+
+        // Only registrations whose vnode has signaled a change are polled
+        // here, so the cost does not depend on the number of registrations.
+        short revents = registration->descr->vnode->poll() &
+                (registration->event.events | POLLERR | POLLHUP);
+
+        if (revents) {
+            events[count].events = revents;
+            events[count].data = registration->event.data;
+            count++;
+
+            AutoLock lock(&readyMutex);
+            if (registration->event.events & EPOLLONESHOT) {
+                registration->enabled = false;
+            } else if (!(registration->event.events & EPOLLET) &&
+                    registration->enabled && !registration->queued) {
+                // Level triggered registrations stay in the ready list until
+                // polling shows that they are no longer ready.
+                enqueue(registration);
+            }
+        }
+
+        if (registration == last) break;
+    }
+
+    return count;
+}
+
+int EventQueue::control(int op, int fd, FileDescription* descr,
+        const struct epoll_event* event) {
+    if (descr->vnode->isEventQueue()) {
+        // Nested event queues are not supported.
+        errno = EINVAL;
+        return -1;
+    }
+
+    AutoLock lock(&registrationMutex);
+    EventRegistration* registration = registrations.get(fd);
+    if (registration && registration->descr != descr) {
+        // The file descriptor was closed and reused while the old file
+        // description was still kept alive by another file descriptor.
+        removeRegistration(registration);
+        registration = nullptr;
+    }
+
+    if (op == EPOLL_CTL_ADD) {
+        if (registration) {
+            errno = EEXIST;
+            return -1;
+        }
+
+        registration = new EventRegistration(this, descr, fd, event);
+        if (!registration) return -1;
+        registrations.add(registration);
+
+        registration->nextInDescription = descr->eventRegistrations;
+        if (descr->eventRegistrations) {
+            descr->eventRegistrations->prevInDescription = registration;
+        }
+        descr->eventRegistrations = registration;
+
+        descr->vnode->addEventListener(registration);
+        // The file might already be ready.
+        registration->onEvent();
+        return 0;
+    } else if (op == EPOLL_CTL_DEL) {
+        if (!registration) {
+            errno = ENOENT;
+            return -1;
+        }
+
+        removeRegistration(registration);
+        return 0;
+    } else if (op == EPOLL_CTL_MOD) {
+        if (!registration) {
+            errno = ENOENT;
+            return -1;
+        }
+
+        AutoLock lock(&readyMutex);
+        registration->event = *event;
+        registration->enabled = true;
+        if (!registration->queued) {
+            enqueue(registration);
+        }
+        return 0;
+    }
+
+    errno = EINVAL;
+    return -1;
+}
+
+void EventQueue::enqueue(EventRegistration* registration) {
+    registration->prevReady = lastReady;
+    registration->nextReady = nullptr;
+    if (lastReady) {
+        lastReady->nextReady = registration;
+    } else {
+        firstReady = registration;
+    }
+    lastReady = registration;
+    registration->queued = true;
+    kthread_cond_broadcast(&readyCond);
+}
+
+bool EventQueue::isEventQueue() {
+    return true;
+}
+
+short EventQueue::poll() {
+    AutoLock lock(&readyMutex);
+    return firstReady ? POLLIN | POLLRDNORM : 0;
+}
+
+void EventQueue::removeRegistration(EventRegistration* registration) {
+    FileDescription* descr = registration->descr;
+    descr->vnode->removeEventListener(registration);
+
+    if (registration->prevInDescription) {
+        registration->prevInDescription->nextInDescription =
+                registration->nextInDescription;
+    } else {
+        descr->eventRegistrations = registration->nextInDescription;
+    }
+    if (registration->nextInDescription) {
+        registration->nextInDescription->prevInDescription =
+                registration->prevInDescription;
+    }
+
+    registrations.remove(registration->fd);
+
+    kthread_mutex_lock(&readyMutex);
+    if (registration->queued) {
+        unlinkReady(registration);
+    }
+    kthread_mutex_unlock(&readyMutex);
+
+    delete registration;
+}
+
+// Called when a file description is destroyed.
+void EventQueue::removeRegistrations(FileDescription* descr) {
+    AutoLock lock(&registrationMutex);
+    while (descr->eventRegistrations) {
+        EventRegistration* registration = descr->eventRegistrations;
+        registration->queue->removeRegistration(registration);
+    }
+}
+
+void EventQueue::unlinkReady(EventRegistration* registration) {
+    if (registration->prevReady) {
+        registration->prevReady->nextReady = registration->nextReady;
+    } else {
+        firstReady = registration->nextReady;
+    }
+    if (registration->nextReady) {
+        registration->nextReady->prevReady = registration->prevReady;
+    } else {
+        lastReady = registration->prevReady;
+    }
+    registration->queued = false;
+}
+
+int EventQueue::wait(struct epoll_event* events, int maxEvents,
+        const struct timespec* endTime) {
+    while (true) {
+        kthread_mutex_lock(&readyMutex);
+        while (!firstReady) {
+            int result = kthread_cond_sigclockwait(&readyCond, &readyMutex,
+                    CLOCK_MONOTONIC, endTime);
+            if (result) {
+                kthread_mutex_unlock(&readyMutex);
+                if (result == ETIMEDOUT) return 0;
+                errno = EINTR;
+                return -1;
+            }
+        }
+        kthread_mutex_unlock(&readyMutex);
+
+        int count = collectEvents(events, maxEvents);
+        if (count) return count;
+    }
+}
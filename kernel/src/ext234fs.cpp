@@ -509,6 +509,32 @@ uint64_t Ext234Fs::getBlockGroup(ino_t ino) {
     return (ino - 1) / superBlock.s_inodes_per_group;
 }
 
+// Returns the offset on the block device where the page at the given offset of
+// the inode is stored. Pages that are not stored contiguously cannot be used.
+off_t Ext234Fs::getDeviceOffset(const Inode* inode, off_t offset,
+        BlockCacheDevice** blockDevice) {
+    uint64_t address = getInodeBlockAddress(inode, offset / blockSize);
+    if (address == (uint64_t) -1) return -1;
+    if (address == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    address += offset % blockSize;
+
+    for (off_t i = blockSize - offset % blockSize; i < PAGESIZE;
+            i += blockSize) {
+        uint64_t nextAddress = getInodeBlockAddress(inode,
+                (offset + i) / blockSize);
+        if (nextAddress == (uint64_t) -1) return -1;
+        if (nextAddress != address + i) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    return device->getDeviceOffset(address, blockDevice);
+}
+
 uint64_t Ext234Fs::getInodeBlockAddress(const Inode* inode, uint64_t block) {
     size_t indirectBlockPointers = blockSize / 4;
     size_t doublyIndirectPointers = indirectBlockPointers *
@@ -335,118 +335,98 @@ Reference<Vnode> Ext234Vnode::getChildNodeUnlocked(const char* path,
     return nullptr;
 }
 
-size_t Ext234Vnode::getDirectoryEntries(void** buffer, int flags) {
+ssize_t Ext234Vnode::getDirectoryEntries(void* buffer, size_t size,
+        off_t* offset, int flags) {
     AutoLock lock(&mutex);
 
     if (!S_ISDIR(stats.st_mode)) {
-        *buffer = nullptr;
         errno = ENOTDIR;
-        return 0;
+        return -1;
     }
 
-    // We do not know in advance how large the buffer needs to be, but the size
-    // on disk is a good estimate.
-    *buffer = malloc(stats.st_size);
-    if (!*buffer) return 0;
-    size_t allocatedSize = stats.st_size;
+    // The offset is the byte position of the next entry in the directory.
+    // Entries are read directly from the directory blocks so that we never
+    // need to keep a copy of the whole directory in memory.
+    char* block = new char[filesystem->blockSize];
+    if (!block) return -1;
 
-    size_t bufferOffset = 0;
-    off_t bytesRead = 0;
-    size_t blockNum = 0;
-    while (bytesRead < stats.st_size) {
-        char* block = new char[filesystem->blockSize];
-        if (!block) {
-            free(*buffer);
-            *buffer = nullptr;
-            return 0;
-        }
-        if (!filesystem->readInodeData(&inode, blockNum * filesystem->blockSize,
-                block, filesystem->blockSize)) {
+    size_t used = 0;
+    off_t position = *offset;
+    bool bufferFull = false;
+
+    while (!bufferFull && position < stats.st_size) {
+        uint64_t blockNum = position / filesystem->blockSize;
+        off_t blockStart = blockNum * filesystem->blockSize;
+        size_t target = position - blockStart;
+
+        if (!filesystem->readInodeData(&inode, blockStart, block,
+                filesystem->blockSize)) {
             delete[] block;
-            free(*buffer);
-            *buffer = nullptr;
-            return 0;
+            return -1;
         }
 
-        size_t offset = 0;
-        while (offset < filesystem->blockSize) {
-            DirectoryEntry* entry = (DirectoryEntry*) (block + offset);
+        // The offset might have been set by lseek to a position that is not
+        // the start of an entry. In that case we continue with the next one.
+        size_t blockOffset = 0;
+        while (blockOffset < filesystem->blockSize) {
+            DirectoryEntry* entry = (DirectoryEntry*) (block + blockOffset);
 
-            if (entry->rec_len < 8) {
+            if (entry->rec_len < 8 ||
+                    entry->rec_len > filesystem->blockSize - blockOffset) {
                 delete[] block;
-                free(*buffer);
-                *buffer = nullptr;
                 errno = EIO;
-                return 0;
+                return -1;
             }
 
-            if (entry->inode == 0) {
-                offset += entry->rec_len;
+            if (blockOffset < target || entry->inode == 0) {
+                blockOffset += entry->rec_len;
                 continue;
             }
 
-            reclen_t reclen = ALIGNUP(sizeof(posix_dent) + entry->name_len + 1,
-                    alignof(posix_dent));
-
-            if (bufferOffset + reclen > allocatedSize) {
-                allocatedSize = allocatedSize + ALIGNUP(reclen, 1024);
-                void* newBuffer = realloc(*buffer, allocatedSize);
-                if (!newBuffer) {
-                    delete[] block;
-                    free(*buffer);
-                    *buffer = nullptr;
-                    return 0;
-                }
-                *buffer = newBuffer;
-            }
-
-            posix_dent* dent = (posix_dent*) ((char*) *buffer + bufferOffset);
-            dent->d_ino = entry->inode;
+            ino_t ino = entry->inode;
 
             // If another filesystem has been mounted at a directory we must
             // give the inode number for that filesystem.
-            if (dent->d_ino != stats.st_ino) {
+            if (ino != stats.st_ino) {
                 Reference<Ext234Vnode> vnode =
                         filesystem->getVnodeIfOpen(entry->inode);
                 if (vnode && vnode->mounted) {
                     Reference<Vnode> vnode2 = vnode->resolve();
-                    dent->d_ino = vnode2->stat().st_ino;
+                    ino = vnode2->stat().st_ino;
                 }
             }
 
-            dent->d_reclen = reclen;
-
+            unsigned char type = DT_UNKNOWN;
             if (filesystem->hasIncompatFeature(INCOMPAT_FILETYPE)) {
-                dent->d_type = typeToDT(entry->file_type);
+                type = typeToDT(entry->file_type);
             } else if (flags & DT_FORCE_TYPE) {
                 Reference<Vnode> vnode = filesystem->getVnode(entry->inode);
                 if (vnode) {
-                    dent->d_type = IFTODT(vnode->stat().st_mode);
-                } else {
-                    dent->d_type = DT_UNKNOWN;
+                    type = IFTODT(vnode->stat().st_mode);
                 }
-            } else {
-                dent->d_type = DT_UNKNOWN;
             }
 
-            memcpy(&dent->d_name, entry->name, entry->name_len);
-            dent->d_name[entry->name_len] = '\0';
+            if (!addDirectoryEntry(buffer, size, &used, ino, type, entry->name,
+                    entry->name_len)) {
+                bufferFull = true;
+                break;
+            }
 
-            bufferOffset += dent->d_reclen;
-            offset += entry->rec_len;
+            blockOffset += entry->rec_len;
         }
 
-        delete[] block;
-        bytesRead += filesystem->blockSize;
-        blockNum++;
+        position = blockStart + blockOffset;
     }
 
-    void* result = realloc(*buffer, bufferOffset);
-    if (result) {
-        *buffer = result;
+    delete[] block;
+
+    if (bufferFull && used == 0) {
+        errno = EINVAL;
+        return -1;
     }
 
-    return bufferOffset;
+    *offset = position;
+    return used;
 }
 
 char* Ext234Vnode::getLinkTarget() {
@@ -466,6 +446,23 @@ char* Ext234Vnode::getLinkTarget() {
     }
 }
 
+off_t Ext234Vnode::getDeviceOffset(off_t offset,
+        BlockCacheDevice** blockDevice) {
+    AutoLock lock(&mutex);
+
+    if (!S_ISREG(stats.st_mode) || offset < 0 ||
+            offset > stats.st_size - PAGESIZE) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (filesystem->readonly) {
+        errno = EROFS;
+        return -1;
+    }
+
+    return filesystem->getDeviceOffset(&inode, offset, blockDevice);
+}
+
 bool Ext234Vnode::isSeekable() {
     return S_ISREG(stats.st_mode);
 }
@@ -524,12 +521,8 @@ off_t Ext234Vnode::lseek(off_t offset, int whence) {
     if (whence == SEEK_SET || whence == SEEK_CUR) {
         base = 0;
     } else if (whence == SEEK_END) {
-        if (S_ISDIR(stats.st_mode)) {
-            // We have no easy way to seek to the end without iterating through
-            // the whole directory. However since behavior of posix_getdents is
-            // unspecified after seeking to a value that was not previously
-            // returned we can just seek somewhere past the end instead.
-        }
+        // For directories the offset is a byte position in the directory, so
+        // the size is also the end of the directory.
         base = stats.st_size;
     } else {
         errno = EINVAL;
@@ -25,18 +25,113 @@
 #include <dennix/poll.h>
 #include <dennix/seek.h>
 #include <dennix/stat.h>
+#include <dennix/kernel/addressspace.h>
 #include <dennix/kernel/file.h>
 
+static const size_t ENTRIES_PER_NODE = PAGESIZE / sizeof(vaddr_t);
+
+static vaddr_t allocatePage() {
+    vaddr_t page = kernelSpace->mapMemory(PAGESIZE, PROT_READ | PROT_WRITE);
+    if (!page) return 0;
+    memset((void*) page, 0, PAGESIZE);
+    return page;
+}
+
+// Returns the number of pages covered by a node at the given level.
+static size_t levelSpan(unsigned int level) {
+    size_t span = 1;
+    for (unsigned int i = 0; i < level; i++) {
+        span *= ENTRIES_PER_NODE;
+    }
+    return span;
+}
+
+static void freeNode(vaddr_t* node, unsigned int level) {
+    if (level > 1) {
+        for (size_t i = 0; i < ENTRIES_PER_NODE; i++) {
+            if (node[i]) freeNode((vaddr_t*) node[i], level - 1);
+        }
+    } else {
+        for (size_t i = 0; i < ENTRIES_PER_NODE; i++) {
+            if (node[i]) kernelSpace->unmapMemory(node[i], PAGESIZE);
+        }
+    }
+    kernelSpace->unmapMemory((vaddr_t) node, PAGESIZE);
+}
+
+// Frees all pages with an index of at least firstPage below the given node.
+// Returns whether the node has become empty.
+static bool freeNodePages(vaddr_t* node, unsigned int level, size_t base,
+        size_t firstPage) {
+    size_t childSpan = levelSpan(level - 1);
+    bool empty = true;
+
+    for (size_t i = 0; i < ENTRIES_PER_NODE; i++) {
+        if (!node[i]) continue;
+        size_t childBase = base + i * childSpan;
+
+        if (childBase >= firstPage) {
+            if (level > 1) {
+                freeNode((vaddr_t*) node[i], level - 1);
+            } else {
+                kernelSpace->unmapMemory(node[i], PAGESIZE);
+            }
+            node[i] = 0;
+        } else if (level > 1 && childBase + childSpan > firstPage) {
+            if (freeNodePages((vaddr_t*) node[i], level - 1, childBase,
+                    firstPage)) {
+                kernelSpace->unmapMemory(node[i], PAGESIZE);
+                node[i] = 0;
+            } else {
+                empty = false;
+            }
+        } else {
+            empty = false;
+        }
+    }
+
+    return empty;
+}
+
 FileVnode::FileVnode(const void* data, size_t size, mode_t mode, dev_t dev)
         : Vnode(S_IFREG | mode, dev) {
-    this->data = (char*) malloc(size);
-    if (!this->data) FAIL_CONSTRUCTOR;
-    memcpy(this->data, data, size);
-    stats.st_size = size;
+    pageTree = nullptr;
+    treeLevels = 0;
+    sharedMappings = 0;
+
+    if (size > 0 && writeData((const char*) data, size, 0) != (ssize_t) size) {
+        FAIL_CONSTRUCTOR;
+    }
 }
 
 FileVnode::~FileVnode() {
-    free(data);
+    if (pageTree) {
+        freeNode(pageTree, treeLevels);
+    }
+}
+
+bool FileVnode::addSharedMapping(off_t offset, size_t size) {
+    AutoLock lock(&mutex);
+    if (offset < 0 || offset & PAGE_MISALIGN) {
+        errno = EINVAL;
+        return false;
+    }
+    size_t fileSize = ALIGNUP((size_t) stats.st_size, PAGESIZE);
+    if (offset > stats.st_size || size > fileSize - (size_t) offset) {
+        errno = ENXIO;
+        return false;
+    }
+
+    // Allocate all pages now so that every mapping sees the same memory.
+    for (size_t i = 0; i < size; i += PAGESIZE) {
+        if (!getPage((offset + i) / PAGESIZE, true)) {
+            errno = ENOMEM;
+            return false;
+        }
+    }
+
+    sharedMappings++;
+    return true;
 }
 
 int FileVnode::ftruncate(off_t length) {
@@ -50,15 +145,21 @@ int FileVnode::ftruncate(off_t length) {
     }
 
     AutoLock lock(&mutex);
-    void* newData = realloc(data, (size_t) length);
-    if (!newData) {
-        errno = ENOSPC;
+    if (length < stats.st_size && sharedMappings > 0) {
+        errno = EBUSY;
         return -1;
     }
-    data = (char*) newData;
 
-    if (length > stats.st_size) {
-        memset(data + stats.st_size, '\0', length - stats.st_size);
+    if (length < stats.st_size) {
+        // Bytes after the end of file must always read as zero.
+        size_t offsetInPage = (size_t) length & PAGE_MISALIGN;
+        if (offsetInPage) {
+            char* page = getPage((size_t) length / PAGESIZE, false);
+            if (page) {
+                memset(page + offsetInPage, 0, PAGESIZE - offsetInPage);
+            }
+        }
+        freePages(ALIGNUP((size_t) length, PAGESIZE) / PAGESIZE);
     }
 
     stats.st_size = length;
@@ -66,6 +167,53 @@ int FileVnode::ftruncate(off_t length) {
     return 0;
 }
 
+void FileVnode::freePages(size_t firstPage) {
+    if (!pageTree) return;
+
+    if (freeNodePages(pageTree, treeLevels, 0, firstPage)) {
+        kernelSpace->unmapMemory((vaddr_t) pageTree, PAGESIZE);
+        pageTree = nullptr;
+        treeLevels = 0;
+    }
+}
+
+char* FileVnode::getPage(size_t index, bool allocate) {
+    while (treeLevels == 0 || index >= levelSpan(treeLevels)) {
+        if (!allocate) return nullptr;
+
+        // Grow the tree by adding a new root above the old one.
+        vaddr_t newRoot = allocatePage();
+        if (!newRoot) return nullptr;
+        ((vaddr_t*) newRoot)[0] = (vaddr_t) pageTree;
+        pageTree = (vaddr_t*) newRoot;
+        treeLevels++;
+    }
+
+    vaddr_t* node = pageTree;
+    for (unsigned int level = treeLevels; level > 0; level--) {
+        size_t span = levelSpan(level - 1);
+        size_t i = index / span;
+        index %= span;
+
+        if (!node[i]) {
+            if (!allocate) return nullptr;
+            node[i] = allocatePage();
+            if (!node[i]) return nullptr;
+        }
+
+        node = (vaddr_t*) node[i];
+    }
+
+    return (char*) node;
+}
+
+paddr_t FileVnode::getSharedPage(off_t offset) {
+    AutoLock lock(&mutex);
+    char* page = getPage(offset / PAGESIZE, false);
+    if (!page) return 0;
+    return kernelSpace->getPhysicalAddress((vaddr_t) page);
+}
+
 bool FileVnode::isSeekable() {
     return true;
 }
@@ -105,14 +253,28 @@ ssize_t FileVnode::pread(void* buffer, size_t size, off_t offset,
     if (size == 0) return 0;
 
     AutoLock lock(&mutex);
+    if (offset >= stats.st_size) return 0;
+    off_t remaining = stats.st_size - offset;
+    if ((uintmax_t) remaining < size) {
+        size = remaining;
+    }
+
     char* buf = (char*) buffer;
+    size_t bytesRead = 0;
+
+    while (bytesRead < size) {
+        size_t pos = (size_t) offset + bytesRead;
+        size_t offsetInPage = pos & PAGE_MISALIGN;
+        size_t count = PAGESIZE - offsetInPage;
+        if (count > size - bytesRead) count = size - bytesRead;
 
-    for (size_t i = 0; i < size; i++) {
-        off_t j;
-        if (__builtin_add_overflow(offset, i, &j) || j >= stats.st_size) {
-            return i;
+        const char* page = getPage(pos / PAGESIZE, false);
+        if (page) {
+            memcpy(buf + bytesRead, page + offsetInPage, count);
+        } else {
+            memset(buf + bytesRead, 0, count);
         }
-        buf[i] = data[j];
+        bytesRead += count;
     }
 
     updateTimestamps(true, false, false);
@@ -129,6 +291,20 @@ ssize_t FileVnode::pwrite(const void* buffer, size_t size, off_t offset,
     }
     assert(offset >= 0);
 
+    ssize_t result = writeData((const char*) buffer, size, offset);
+    if (result > 0) {
+        updateTimestamps(false, true, true);
+    }
+    return result;
+}
+
+void FileVnode::removeSharedMapping() {
+    AutoLock lock(&mutex);
+    assert(sharedMappings > 0);
+    sharedMappings--;
+}
+
+ssize_t FileVnode::writeData(const char* buffer, size_t size, off_t offset) {
     off_t newSize;
     if (__builtin_add_overflow(offset, size, &newSize)) {
         errno = ENOSPC;
@@ -140,23 +316,26 @@ ssize_t FileVnode::pwrite(const void* buffer, size_t size, off_t offset,
         return -1;
     }
 
-    if (newSize > stats.st_size) {
-        void* newData = realloc(data, (size_t) newSize);
-        if (!newData) {
-            errno = ENOSPC;
-            return -1;
-        }
-        data = (char*) newData;
+    size_t written = 0;
+    while (written < size) {
+        size_t pos = (size_t) offset + written;
+        size_t offsetInPage = pos & PAGE_MISALIGN;
+        size_t count = PAGESIZE - offsetInPage;
+        if (count > size - written) count = size - written;
 
-        if (offset > stats.st_size) {
-            // When writing after the old EOF, fill the gap with zeros.
-            memset(data + stats.st_size, '\0', offset - stats.st_size);
-        }
+        char* page = getPage(pos / PAGESIZE, true);
+        if (!page) break;
+        memcpy(page + offsetInPage, buffer + written, count);
+        written += count;
+    }
 
-        stats.st_size = newSize;
+    if (written == 0) {
+        errno = ENOSPC;
+        return -1;
     }
 
-    memcpy(data + offset, buffer, size);
-    updateTimestamps(false, true, true);
-    return size;
+    if (offset + (off_t) written > stats.st_size) {
+        stats.st_size = offset + written;
+    }
+    return written;
 }
@@ -18,28 +18,37 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <dennix/dent.h>
 #include <dennix/fcntl.h>
+#include <dennix/poll.h>
 #include <dennix/seek.h>
 #include <dennix/kernel/directory.h>
+#include <dennix/kernel/eventqueue.h>
 #include <dennix/kernel/file.h>
 #include <dennix/kernel/filedescription.h>
+#include <dennix/kernel/interrupts.h>
+#include <dennix/kernel/signal.h>
+#include <dennix/kernel/thread.h>
 
 #define FILE_STATUS_FLAGS (O_APPEND | O_NONBLOCK | O_SYNC)
 
+static const size_t SPLICE_BUFFER_SIZE = 64 * 1024;
+
 FileDescription::FileDescription(const Reference<Vnode>& vnode, int flags)
         : vnode(vnode) {
     offset = 0;
     fileFlags = flags & (O_ACCMODE | FILE_STATUS_FLAGS);
-    dents = nullptr;
-    dentsSize = 0;
+    eventRegistrations = nullptr;
 }
 
 FileDescription::~FileDescription() {
-    free(dents);
+    if (eventRegistrations) {
+        EventQueue::removeRegistrations(this);
+    }
 }
 
 Reference<FileDescription> FileDescription::accept4(struct sockaddr* address,
@@ -67,8 +76,7 @@ int FileDescription::fcntl(int cmd, int param) {
         fileFlags = (param & FILE_STATUS_FLAGS) | (fileFlags & O_ACCMODE);
         return 0;
     default:
-        errno = EINVAL;
-        return -1;
+        return vnode->fcntl(cmd, param);
     }
 }
 
@@ -78,41 +86,14 @@ ssize_t FileDescription::getdents(void* buffer, size_t size, int flags) {
         return -1;
     }
 
-    if (!dents) {
-        dentsSize = vnode->getDirectoryEntries(&dents, flags);
-        if (!dents) return -1;
-    }
-
-    size_t byteOffset = 0;
-    for (off_t i = 0; i < offset; i++) {
-        if (byteOffset + sizeof(struct posix_dent) > dentsSize) break;
-        posix_dent* dent = (posix_dent*) ((uintptr_t) dents + byteOffset);
-        byteOffset += dent->d_reclen;
-    }
-
-    void* copyBegin = (void*) ((uintptr_t) dents + byteOffset);
-    // Determine the number of bytes to copy.
-    size_t copySize = 0;
     if (size > SSIZE_MAX) size = SSIZE_MAX;
-    while (true) {
-        if (byteOffset + copySize + sizeof(struct posix_dent) > dentsSize) {
-            break;
-        }
-        posix_dent* dent = (posix_dent*) ((uintptr_t) copyBegin + copySize);
-        if (copySize + dent->d_reclen > size) break;
-        copySize += dent->d_reclen;
-        offset++;
+    // The file offset is an opaque cursor that the vnode uses to continue
+    // where the previous call stopped.
+    ssize_t result = vnode->getDirectoryEntries(buffer, size, &offset, flags);
+    if (result > 0) {
+        vnode->updateTimestampsLocked(true, false, false);
     }
-
-    if (copySize == 0) {
-        if (byteOffset == dentsSize) return 0;
-        errno = EINVAL;
-        return -1;
-    }
-
-    memcpy(buffer, copyBegin, copySize);
-    vnode->updateTimestampsLocked(true, false, false);
-    return copySize;
+    return result;
 }
 
 off_t FileDescription::lseek(off_t offset, int whence) {
@@ -125,11 +106,6 @@ off_t FileDescription::lseek(off_t offset, int whence) {
 
     off_t result = vnode->lseek(offset, whence);
     if (result < 0) return -1;
-    if (result == 0 && dents) {
-        free(dents);
-        dents = nullptr;
-        dentsSize = 0;
-    }
 
     this->offset = result;
     return result;
@@ -170,6 +146,32 @@ Reference<FileDescription> FileDescription::openat(const char* path, int flags,
     return new FileDescription(vnode, flags);
 }
 
+ssize_t FileDescription::preadv(const struct iovec* iov, int iovcnt,
+        off_t offset) {
+    if (!vnode->isSeekable()) {
+        errno = ESPIPE;
+        return -1;
+    }
+    if (offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return vnode->preadv(iov, iovcnt, offset, fileFlags);
+}
+
+ssize_t FileDescription::pwritev(const struct iovec* iov, int iovcnt,
+        off_t offset) {
+    if (!vnode->isSeekable()) {
+        errno = ESPIPE;
+        return -1;
+    }
+    if (offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return vnode->pwritev(iov, iovcnt, offset, fileFlags);
+}
+
 ssize_t FileDescription::read(void* buffer, size_t size) {
     if (vnode->isSeekable()) {
         ssize_t result = vnode->pread(buffer, size, offset, fileFlags);
@@ -182,6 +184,211 @@ ssize_t FileDescription::read(void* buffer, size_t size) {
     return vnode->read(buffer, size, fileFlags);
 }
 
+ssize_t FileDescription::readv(const struct iovec* iov, int iovcnt) {
+    if (vnode->isSeekable()) {
+        ssize_t result = vnode->preadv(iov, iovcnt, offset, fileFlags);
+
+        if (result != -1) {
+            offset += result;
+        }
+        return result;
+    }
+    return vnode->readv(iov, iovcnt, fileFlags);
+}
+
+ssize_t FileDescription::recvmsg(struct msghdr* msg, int flags) {
+    int flagsForVnode = fileFlags;
+    if (flags & MSG_DONTWAIT) flagsForVnode |= O_NONBLOCK;
+    return vnode->recvmsg(msg, flags, flagsForVnode);
+}
+
+ssize_t FileDescription::sendmsg(const struct msghdr* msg, int flags) {
+    int flagsForVnode = fileFlags;
+    if (flags & MSG_DONTWAIT) flagsForVnode |= O_NONBLOCK;
+    return vnode->sendmsg(msg, flags, flagsForVnode);
+}
+
+// Waits until at least PIPE_BUF bytes can be written to a non-seekable file.
+class SpliceWaiter : public EventListener {
+public:
+    SpliceWaiter() : thread(Thread::current()), woken(false) {}
+    void onEvent() override {
+        Interrupts::disable();
+        woken = true;
+        thread->wake();
+        Interrupts::enable();
+    }
+public:
+    Thread* thread;
+    bool woken;
+};
+
+static bool waitUntilWritable(const Reference<Vnode>& vnode, bool nonBlocking) {
+    short events = vnode->poll();
+    if (events & POLLOUT) return true;
+    if (events & (POLLERR | POLLHUP)) {
+        errno = EPIPE;
+        return false;
+    }
+    if (nonBlocking) {
+        errno = EAGAIN;
+        return false;
+    }
+
+    // The listener is registered before polling again so that no event
+    // between the poll and the sleep can be missed.
+    SpliceWaiter listener;
+    vnode->addEventListener(&listener);
+    AutoWaitChannel waitChannel("splice");
+
+    bool result;
+    while (true) {
+        events = vnode->poll();
+        if (events & POLLOUT) {
+            result = true;
+            break;
+        }
+        if (events & (POLLERR | POLLHUP)) {
+            errno = EPIPE;
+            result = false;
+            break;
+        }
+
+        Interrupts::disable();
+        if (Signal::isPending()) {
+            Interrupts::enable();
+            errno = EINTR;
+            result = false;
+            break;
+        }
+        if (!listener.woken) {
+            Thread::sleep(nullptr);
+        }
+        listener.woken = false;
+        Interrupts::enable();
+    }
+
+    vnode->removeEventListener(&listener);
+    return result;
+}
+
+// Copies data from this file description to another one without copying it
+// to user space. If an offset pointer is given the data is transferred at that
+// offset and the offset is advanced instead of the file offset.
+ssize_t FileDescription::splice(const Reference<FileDescription>& out,
+        off_t* inOffset, off_t* outOffset, size_t size, int flags) {
+    if ((inOffset && !vnode->isSeekable()) ||
+            (outOffset && !out->vnode->isSeekable())) {
+        errno = ESPIPE;
+        return -1;
+    }
+    if ((inOffset && *inOffset < 0) || (outOffset && *outOffset < 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (size > SSIZE_MAX) size = SSIZE_MAX;
+    if (size == 0) return 0;
+
+    size_t bufferSize = size < SPLICE_BUFFER_SIZE ? size : SPLICE_BUFFER_SIZE;
+    char* buffer = (char*) malloc(bufferSize);
+    if (!buffer) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    // Data read from a non-seekable file cannot be put back, so it must not
+    // be read before the output is able to take all of it.
+    bool inputSeekable = inOffset || vnode->isSeekable();
+    bool outputSeekable = outOffset || out->vnode->isSeekable();
+
+    size_t transferred = 0;
+    while (transferred < size) {
+        size_t chunkSize = size - transferred;
+        if (chunkSize > bufferSize) chunkSize = bufferSize;
+
+        // Once some data has been transferred we must not block waiting for
+        // more input.
+        int readFlags = fileFlags | flags;
+        if (transferred) readFlags |= O_NONBLOCK;
+
+        if (!inputSeekable && !outputSeekable) {
+            if (chunkSize > PIPE_BUF) chunkSize = PIPE_BUF;
+            bool nonBlocking = transferred ||
+                    ((out->fileFlags | flags) & O_NONBLOCK);
+            if (!waitUntilWritable(out->vnode, nonBlocking)) {
+                if (transferred == 0) {
+                    free(buffer);
+                    return -1;
+                }
+                break;
+            }
+        }
+
+        ssize_t bytesRead;
+        if (inOffset) {
+            bytesRead = vnode->pread(buffer, chunkSize, *inOffset, readFlags);
+        } else if (vnode->isSeekable()) {
+            bytesRead = vnode->pread(buffer, chunkSize, offset, readFlags);
+        } else {
+            bytesRead = vnode->read(buffer, chunkSize, readFlags);
+        }
+
+        if (bytesRead <= 0) {
+            if (bytesRead < 0 && transferred == 0) {
+                free(buffer);
+                return -1;
+            }
+            break;
+        }
+
+        size_t written = 0;
+        while (written < (size_t) bytesRead) {
+            int writeFlags = out->fileFlags | flags;
+            if (!inputSeekable) writeFlags &= ~O_NONBLOCK;
+            ssize_t result;
+            if (outOffset) {
+                result = out->vnode->pwrite(buffer + written,
+                        bytesRead - written, *outOffset, writeFlags);
+                if (result > 0) *outOffset += result;
+            } else if (out->vnode->isSeekable()) {
+                result = out->vnode->pwrite(buffer + written,
+                        bytesRead - written, out->offset, writeFlags);
+                if (result > 0) {
+                    out->offset = writeFlags & O_APPEND ?
+                            out->vnode->stat().st_size : out->offset + result;
+                }
+            } else {
+                result = out->vnode->write(buffer + written,
+                        bytesRead - written, writeFlags);
+            }
+
+            if (result <= 0) break;
+            written += result;
+        }
+
+        // Only consume the input that could actually be written. Input from
+        // a non-seekable file is only lost if the output failed.
+        if (inOffset) {
+            *inOffset += written;
+        } else if (vnode->isSeekable()) {
+            offset += written;
+        }
+        transferred += written;
+
+        if (written < (size_t) bytesRead) {
+            if (transferred == 0) {
+                free(buffer);
+                return -1;
+            }
+            break;
+        }
+    }
+
+    free(buffer);
+    return transferred;
+}
+
 int FileDescription::tcgetattr(struct termios* result) {
     return vnode->tcgetattr(result);
 }
@@ -201,3 +408,15 @@ ssize_t FileDescription::write(const void* buffer, size_t size) {
     }
     return vnode->write(buffer, size, fileFlags);
 }
+
+ssize_t FileDescription::writev(const struct iovec* iov, int iovcnt) {
+    if (vnode->isSeekable()) {
+        ssize_t result = vnode->pwritev(iov, iovcnt, offset, fileFlags);
+        if (result != -1) {
+            offset = fileFlags & O_APPEND ? vnode->stat().st_size :
+                    offset + result;
+        }
+        return result;
+    }
+    return vnode->writev(iov, iovcnt, fileFlags);
+}
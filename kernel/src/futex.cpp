@@ -0,0 +1,166 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/futex.cpp
+ * Futexes.
+ */
+
+#include <errno.h>
+#include <dennix/kernel/clock.h>
+#include <dennix/kernel/futex.h>
+#include <dennix/kernel/interrupts.h>
+#include <dennix/kernel/signal.h>
+#include <dennix/kernel/thread.h>
+
+#define NUM_BUCKETS 64
+
+struct FutexWaiter {
+    AddressSpace* addressSpace;
+    int* address;
+    Thread* thread;
+    FutexWaiter* prev;
+    FutexWaiter* next;
+    bool blocked;
+};
+
+struct FutexBucket {
+    kthread_mutex_t mutex;
+    FutexWaiter* first;
+};
+
+static FutexBucket buckets[NUM_BUCKETS];
+
+static FutexBucket* getBucket(AddressSpace* addressSpace, int* address) {
+    uintptr_t hash = (uintptr_t) address / sizeof(int) ^
+            (uintptr_t) addressSpace / alignof(AddressSpace);
+    hash ^= hash >> 6;
+    return &buckets[hash % NUM_BUCKETS];
+}
+
+static void removeWaiter(FutexBucket* bucket, FutexWaiter* waiter) {
+    if (waiter->prev) {
+        waiter->prev->next = waiter->next;
+    } else {
+        bucket->first = waiter->next;
+    }
+    if (waiter->next) {
+        waiter->next->prev = waiter->prev;
+    }
+}
+
+int Futex::wait(AddressSpace* addressSpace, int* address, int value,
+        const struct timespec* endTime) {
+    FutexBucket* bucket = getBucket(addressSpace, address);
+    kthread_mutex_lock(&bucket->mutex);
+
+    // Comparing the value while holding the bucket lock guarantees that we
+    // cannot miss a wakeup that happens after the value was changed.
+    if (__atomic_load_n(address, __ATOMIC_ACQUIRE) != value) {
+        kthread_mutex_unlock(&bucket->mutex);
+        errno = EAGAIN;
+        return -1;
+    }
+
+    FutexWaiter waiter;
+    waiter.addressSpace = addressSpace;
+    waiter.address = address;
+    waiter.thread = Thread::current();
+    waiter.prev = nullptr;
+    waiter.next = bucket->first;
+    waiter.blocked = true;
+    if (bucket->first) {
+        bucket->first->prev = &waiter;
+    }
+    bucket->first = &waiter;
+
+    // With interrupts disabled no wakeup can happen before we are asleep.
+    Interrupts::disable();
+    kthread_mutex_unlock(&bucket->mutex);
+
+    // Sleeping uses the monotonic clock.
+    struct timespec wakeTime;
+    if (endTime) {
+        struct timespec now;
+        Clock::get(CLOCK_REALTIME)->getTime(&now);
+        Clock::get(CLOCK_MONOTONIC)->getTime(&wakeTime);
+        if (timespecLess(now, *endTime)) {
+            wakeTime = timespecPlus(wakeTime, timespecMinus(*endTime, now));
+        }
+    }
+
+    int result = 0;
+    AutoWaitChannel waitChannel("futex");
+
+    while (__atomic_load_n(&waiter.blocked, __ATOMIC_ACQUIRE)) {
+        if (endTime) {
+            struct timespec now;
+            Clock::get(CLOCK_MONOTONIC)->getTime(&now);
+            if (!timespecLess(now, wakeTime)) {
+                result = ETIMEDOUT;
+                break;
+            }
+        }
+
+        if (Signal::isPending()) {
+            result = EINTR;
+            break;
+        }
+        Thread::sleep(endTime ? &wakeTime : nullptr);
+    }
+    Interrupts::enable();
+
+    if (result) {
+        kthread_mutex_lock(&bucket->mutex);
+        // We might have been woken up while we were giving up.
+        bool woken = !__atomic_load_n(&waiter.blocked, __ATOMIC_ACQUIRE);
+        if (!woken) {
+            removeWaiter(bucket, &waiter);
+        }
+        kthread_mutex_unlock(&bucket->mutex);
+        if (woken) return 0;
+
+        errno = result;
+        return -1;
+    }
+
+    return 0;
+}
+
+int Futex::wake(AddressSpace* addressSpace, int* address, int count) {
+    FutexBucket* bucket = getBucket(addressSpace, address);
+    int woken = 0;
+
+    kthread_mutex_lock(&bucket->mutex);
+    Interrupts::disable();
+    FutexWaiter* waiter = bucket->first;
+    while (waiter && woken < count) {
+        FutexWaiter* next = waiter->next;
+        if (waiter->addressSpace == addressSpace &&
+                waiter->address == address) {
+            removeWaiter(bucket, waiter);
+            // The waiter may return as soon as it is unblocked, so it must
+            // not be accessed afterwards.
+            Thread* thread = waiter->thread;
+            __atomic_store_n(&waiter->blocked, false, __ATOMIC_RELEASE);
+            thread->wake();
+            woken++;
+        }
+        waiter = next;
+    }
+    Interrupts::enable();
+    kthread_mutex_unlock(&bucket->mutex);
+
+    return woken;
+}
@@ -33,8 +33,10 @@
 #include <dennix/kernel/physicalmemory.h>
 #include <dennix/kernel/pit.h>
 #include <dennix/kernel/process.h>
+#include <dennix/kernel/procfs.h>
 #include <dennix/kernel/ps2.h>
 #include <dennix/kernel/rtc.h>
+#include <dennix/kernel/vdso.h>
 #include <dennix/kernel/worker.h>
 
 #ifndef DENNIX_VERSION
@@ -75,6 +77,7 @@ extern "C" void kmain(uint32_t /*magic*/, paddr_t multibootAddress) {
     PS2::initialize();
 
     Thread::initializeIdleThread();
+    Vdso::initialize();
     Log::printf("Initializing RTC and PIT...\n");
     Rtc::initialize();
     Pit::initialize();
@@ -93,6 +96,7 @@ extern "C" void kmain(uint32_t /*magic*/, paddr_t multibootAddress) {
     Process::current()->rootFd = rootFd;
 
     devFS.initialize(rootDir);
+    procFS.initialize(rootDir);
     rootDir->mkdir("tmp", 0777);
     rootDir->mkdir("run", 0755);
     rootDir->mkdir("mnt", 0755);
@@ -102,8 +106,10 @@ extern "C" void kmain(uint32_t /*magic*/, paddr_t multibootAddress) {
     job.context = &rootFd;
     WorkerThread::addJob(&job);
     WorkerThread::initialize();
+    PhysicalMemory::startReclaimThread();
 
     while (true) {
+        PhysicalMemory::fillZeroedPool();
         asm volatile ("hlt");
     }
 }
@@ -126,6 +132,7 @@ static void startInitProcess(void* param) {
         PANIC("Failed to start init process");
     }
     assert(initProcess->pid == 1);
+    Vdso::setPid(initProcess->addressSpace, initProcess->vdso, 1);
     Process::initProcess = initProcess;
 
     initProcess->controllingTerminal = console;
@@ -21,6 +21,7 @@
 #include <sched.h>
 #include <dennix/kernel/kthread.h>
 #include <dennix/kernel/signal.h>
+#include <dennix/kernel/thread.h>
 
 int kthread_cond_broadcast(kthread_cond_t* cond) {
     kthread_mutex_lock(&cond->mutex);
@@ -54,6 +55,7 @@ int kthread_cond_sigclockwait(kthread_cond_t* cond, kthread_mutex_t* mutex,
     kthread_mutex_unlock(&cond->mutex);
 
     int result = 0;
+    AutoWaitChannel waitChannel("cond_wait");
 
     while (__atomic_load_n(&waiter.blocked, __ATOMIC_ACQUIRE)) {
         if (endTime) {
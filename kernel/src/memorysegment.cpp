@@ -18,13 +18,18 @@
  */
 
 #include <assert.h>
-#include <string.h>
 #include <dennix/kernel/addressspace.h>
 #include <dennix/kernel/kthread.h>
 #include <dennix/kernel/memorysegment.h>
 #include <dennix/kernel/physicalmemory.h>
 
-static char segmentsPage[PAGESIZE] ALIGNED(PAGESIZE) = {0};
+#define SEGMENTS_PER_PAGE (PAGESIZE / sizeof(MemorySegment))
+
+// The first slab page is statically allocated because segments are needed
+// before memory can be mapped.
+static char segmentsPage[PAGESIZE] ALIGNED(PAGESIZE);
+static MemorySegment* freeSegments;
+static size_t freeSegmentCount;
 static kthread_mutex_t mutex = KTHREAD_MUTEX_INITIALIZER;
 
 static inline size_t getFreeSpaceAfter(MemorySegment* segment) {
@@ -32,46 +37,181 @@ static inline size_t getFreeSpaceAfter(MemorySegment* segment) {
     return nextAddress - (segment->address + segment->size);
 }
 
-MemorySegment::MemorySegment(vaddr_t address, size_t size, int flags,
-        MemorySegment* prev, MemorySegment* next) {
+static inline int getHeight(MemorySegment* node) {
+    return node ? node->height : 0;
+}
+
+static void updateNode(MemorySegment* node) {
+    int leftHeight = getHeight(node->left);
+    int rightHeight = getHeight(node->right);
+    node->height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+
+    size_t maxGap = getFreeSpaceAfter(node);
+    if (node->left && node->left->maxGap > maxGap) {
+        maxGap = node->left->maxGap;
+    }
+    if (node->right && node->right->maxGap > maxGap) {
+        maxGap = node->right->maxGap;
+    }
+    node->maxGap = maxGap;
+}
+
+static void updatePath(MemorySegment* node) {
+    while (node) {
+        updateNode(node);
+        node = node->parent;
+    }
+}
+
+static void replaceChild(MemorySegment** tree, MemorySegment* parent,
+        MemorySegment* oldChild, MemorySegment* newChild) {
+    if (!parent) {
+        *tree = newChild;
+    } else if (parent->left == oldChild) {
+        parent->left = newChild;
+    } else {
+        parent->right = newChild;
+    }
+    if (newChild) {
+        newChild->parent = parent;
+    }
+}
+
+static MemorySegment* rotateLeft(MemorySegment** tree, MemorySegment* node) {
+    MemorySegment* right = node->right;
+    replaceChild(tree, node->parent, node, right);
+    node->right = right->left;
+    if (node->right) {
+        node->right->parent = node;
+    }
+    right->left = node;
+    node->parent = right;
+    updateNode(node);
+    updateNode(right);
+    return right;
+}
+
+static MemorySegment* rotateRight(MemorySegment** tree, MemorySegment* node) {
+    MemorySegment* left = node->left;
+    replaceChild(tree, node->parent, node, left);
+    node->left = left->right;
+    if (node->left) {
+        node->left->parent = node;
+    }
+    left->right = node;
+    node->parent = left;
+    updateNode(node);
+    updateNode(left);
+    return left;
+}
+
+static void rebalance(MemorySegment** tree, MemorySegment* node) {
+    while (node) {
+        updateNode(node);
+        int balance = getHeight(node->left) - getHeight(node->right);
+
+        if (balance > 1) {
+            if (getHeight(node->left->left) < getHeight(node->left->right)) {
+                rotateLeft(tree, node->left);
+            }
+            node = rotateRight(tree, node);
+        } else if (balance < -1) {
+            if (getHeight(node->right->right) <
+                    getHeight(node->right->left)) {
+                rotateRight(tree, node->right);
+            }
+            node = rotateLeft(tree, node);
+        }
+
+        node = node->parent;
+    }
+}
+
+// Returns the first segment that ends after the given address.
+static MemorySegment* findSegment(MemorySegment* tree, vaddr_t address) {
+    MemorySegment* result = nullptr;
+    while (tree) {
+        vaddr_t endAddress = tree->address + tree->size;
+        if (endAddress > address || endAddress == 0) {
+            result = tree;
+            tree = tree->left;
+        } else {
+            tree = tree->right;
+        }
+    }
+    return result;
+}
+
+static void addSlabPage(vaddr_t page) {
+    MemorySegment* segments = (MemorySegment*) page;
+    for (size_t i = 0; i < SEGMENTS_PER_PAGE; i++) {
+        segments[i].next = freeSegments;
+        freeSegments = &segments[i];
+    }
+    freeSegmentCount += SEGMENTS_PER_PAGE;
+}
+
+MemorySegment::MemorySegment(vaddr_t address, size_t size, int flags) {
     this->address = address;
     this->size = size;
     this->flags = flags;
-    this->prev = prev;
-    this->next = next;
+    prev = nullptr;
+    next = nullptr;
+    parent = nullptr;
+    left = nullptr;
+    right = nullptr;
+    maxGap = 0;
+    height = 1;
 }
 
-void MemorySegment::addSegment(MemorySegment* firstSegment,
+void MemorySegment::addSegment(MemorySegment** tree,
         MemorySegment* newSegment) {
     vaddr_t endAddress = newSegment->address + newSegment->size;
 
-    MemorySegment* currentSegment = firstSegment;
+    MemorySegment* parent = nullptr;
+    MemorySegment** link = tree;
+    MemorySegment* prev = nullptr;
+    MemorySegment* next = nullptr;
 
-    while (currentSegment->next &&
-            currentSegment->next->address < endAddress) {
-        currentSegment = currentSegment->next;
+    while (*link) {
+        parent = *link;
+        if (parent->address < newSegment->address) {
+            prev = parent;
+            link = &parent->right;
+        } else {
+            next = parent;
+            link = &parent->left;
+        }
     }
 
-    assert(currentSegment->address + currentSegment->size <=
-            newSegment->address);
-    assert(!currentSegment->next ||
-            currentSegment->next->address >= endAddress);
+    assert(!prev || prev->address + prev->size <= newSegment->address);
+    assert(!next || next->address >= endAddress);
 
-    newSegment->prev = currentSegment;
-    newSegment->next = currentSegment->next;
+    newSegment->parent = parent;
+    newSegment->left = nullptr;
+    newSegment->right = nullptr;
+    *link = newSegment;
 
-    currentSegment->next = newSegment;
-    if (newSegment->next) {
-        newSegment->next->prev = newSegment;
+    newSegment->prev = prev;
+    newSegment->next = next;
+    if (prev) {
+        prev->next = newSegment;
+    }
+    if (next) {
+        next->prev = newSegment;
     }
+
+    rebalance(tree, newSegment);
+    // The free space after the previous segment has shrunk.
+    updatePath(prev);
 }
 
-bool MemorySegment::addSegment(MemorySegment* firstSegment, vaddr_t address,
+bool MemorySegment::addSegment(MemorySegment** tree, vaddr_t address,
         size_t size, int protection) {
     AutoLock lock(&mutex);
-    if (!verifySegmentList()) return false;
+    if (!reserveSegments()) return false;
     MemorySegment* newSegment = allocateSegment(address, size, protection);
-    addSegment(firstSegment, newSegment);
+    addSegment(tree, newSegment);
     return true;
 }
 
@@ -79,41 +219,72 @@ MemorySegment* MemorySegment::allocateSegment(vaddr_t address, size_t size,
         int flags) {
     assert(PAGE_ALIGNED(address));
     assert(PAGE_ALIGNED(size));
-    MemorySegment* current = (MemorySegment*) segmentsPage;
-
-    while (current->address != 0 && current->size != 0) {
-        current++;
-        if (((uintptr_t) current & PAGE_MISALIGN) ==
-                (PAGESIZE - PAGESIZE % sizeof(MemorySegment))) {
-            MemorySegment** nextPage = (MemorySegment**) current;
-            assert(*nextPage != nullptr);
-            current = *nextPage;
-        }
-    }
+    assert(freeSegments);
 
-    current->address = address;
-    current->size = size;
-    current->flags = flags;
+    MemorySegment* segment = freeSegments;
+    freeSegments = segment->next;
+    freeSegmentCount--;
 
-    return current;
+    segment->address = address;
+    segment->size = size;
+    segment->flags = flags;
+    segment->height = 1;
+    return segment;
 }
 
 void MemorySegment::deallocateSegment(MemorySegment* segment) {
-    memset(segment, 0, sizeof(MemorySegment));
+    AutoLock lock(&mutex);
+    releaseSegment(segment);
+}
+
+void MemorySegment::releaseSegment(MemorySegment* segment) {
+    segment->next = freeSegments;
+    freeSegments = segment;
+    freeSegmentCount++;
+}
+
+void MemorySegment::removeFromTree(MemorySegment** tree,
+        MemorySegment* segment) {
+    MemorySegment* prev = segment->prev;
+    MemorySegment* next = segment->next;
+    if (prev) {
+        prev->next = next;
+    }
+    if (next) {
+        next->prev = prev;
+    }
+
+    MemorySegment* rebalanceStart;
+    if (!segment->left || !segment->right) {
+        MemorySegment* child = segment->left ? segment->left : segment->right;
+        rebalanceStart = segment->parent;
+        replaceChild(tree, segment->parent, segment, child);
+    } else {
+        // Replace the segment by its successor which has no left child.
+        if (next->parent == segment) {
+            rebalanceStart = next;
+        } else {
+            rebalanceStart = next->parent;
+            replaceChild(tree, next->parent, next, next->right);
+            next->right = segment->right;
+            next->right->parent = next;
+        }
+        replaceChild(tree, segment->parent, segment, next);
+        next->left = segment->left;
+        next->left->parent = next;
+    }
+
+    rebalance(tree, rebalanceStart);
+    // The free space after the previous segment has grown.
+    updatePath(prev);
 }
 
-void MemorySegment::removeSegment(MemorySegment* firstSegment, vaddr_t address,
+void MemorySegment::removeSegment(MemorySegment** tree, vaddr_t address,
         size_t size) {
     AutoLock lock(&mutex);
-    MemorySegment* currentSegment = firstSegment;
+    MemorySegment* currentSegment = findSegment(*tree, address);
     vaddr_t endAddress = address + size;
 
-    while (currentSegment &&
-            currentSegment->address + currentSegment->size <= address &&
-            currentSegment->address + currentSegment->size != 0) {
-        currentSegment = currentSegment->next;
-    }
-
     while (size && currentSegment) {
         if (currentSegment->address > address) {
             if (currentSegment->address > endAddress && endAddress != 0) {
@@ -130,14 +301,8 @@ void MemorySegment::removeSegment(MemorySegment* firstSegment, vaddr_t address,
             size -= currentSegment->size;
 
             MemorySegment* next = currentSegment->next;
-            if (next) {
-                next->prev = currentSegment->prev;
-            }
-            if (currentSegment->prev) {
-                currentSegment->prev->next = next;
-            }
-
-            deallocateSegment(currentSegment);
+            removeFromTree(tree, currentSegment);
+            releaseSegment(currentSegment);
             currentSegment = next;
             continue;
         } else if (currentSegment->address == address &&
@@ -145,6 +310,7 @@ void MemorySegment::removeSegment(MemorySegment* firstSegment, vaddr_t address,
             currentSegment->address += size;
             currentSegment->size -= size;
             size = 0;
+            updatePath(currentSegment->prev);
         } else if (size + (address - currentSegment->address) >=
                 currentSegment->size) {
             size_t diff = currentSegment->address + currentSegment->size -
@@ -152,8 +318,9 @@ void MemorySegment::removeSegment(MemorySegment* firstSegment, vaddr_t address,
             currentSegment->size -= diff;
             size -= diff;
             address += diff;
+            updatePath(currentSegment);
         } else {
-            if (!verifySegmentList()) {
+            if (!reserveSegments()) {
                 // We are so low on memory that we cannot keep track of segments
                 // and therefore have to leak virtual memory.
                 return;
@@ -163,99 +330,94 @@ void MemorySegment::removeSegment(MemorySegment* firstSegment, vaddr_t address,
             size_t firstSize = address - currentSegment->address;
             size_t secondSize = currentSegment->size - firstSize - size;
 
+            currentSegment->size = firstSize;
             MemorySegment* newSegment = allocateSegment(endAddress, secondSize,
                     currentSegment->flags);
-
-            newSegment->prev = currentSegment;
-            newSegment->next = currentSegment->next;
-            if (newSegment->next) {
-                newSegment->next->prev = newSegment;
-            }
-
-            currentSegment->next = newSegment;
-            currentSegment->size = firstSize;
+            addSegment(tree, newSegment);
+            return;
         }
 
         currentSegment = currentSegment->next;
     }
 }
 
-MemorySegment* MemorySegment::findFreeSegment(MemorySegment* firstSegment,
+MemorySegment* MemorySegment::findFreeSegment(MemorySegment* tree,
         size_t size) {
-    MemorySegment* currentSegment = firstSegment;
+    if (!tree || tree->maxGap < size) return nullptr;
 
-    while (currentSegment && getFreeSpaceAfter(currentSegment) < size) {
-        currentSegment = currentSegment->next;
+    // Find the lowest segment that is followed by enough free space.
+    MemorySegment* currentSegment = tree;
+    while (true) {
+        if (currentSegment->left && currentSegment->left->maxGap >= size) {
+            currentSegment = currentSegment->left;
+        } else if (getFreeSpaceAfter(currentSegment) >= size) {
+            return currentSegment;
+        } else {
+            currentSegment = currentSegment->right;
+        }
     }
-
-    return currentSegment;
 }
 
-vaddr_t MemorySegment::findAndAddNewSegment(MemorySegment* firstSegment,
-        size_t size, int protection) {
+vaddr_t MemorySegment::findAndAddNewSegment(MemorySegment** tree, size_t size,
+        int protection, size_t alignment /*= PAGESIZE*/) {
     AutoLock lock(&mutex);
 
-    if (!verifySegmentList()) return 0;
-    MemorySegment* segment = findFreeSegment(firstSegment, size);
+    if (size > SIZE_MAX - alignment) return 0;
+    if (!reserveSegments()) return 0;
+    // Any free space of this size can hold an aligned segment.
+    MemorySegment* segment = findFreeSegment(*tree,
+            size + alignment - PAGESIZE);
     if (!segment) return 0;
 
-    vaddr_t address = segment->address + segment->size;
-    if (segment->flags == protection) {
+    vaddr_t address = ALIGNUP(segment->address + segment->size, alignment);
+    if (address == segment->address + segment->size &&
+            segment->flags == protection) {
         segment->size += size;
+        updatePath(segment);
         return address;
     }
 
     MemorySegment* newSegment = allocateSegment(address, size, protection);
-    addSegment(firstSegment, newSegment);
+    addSegment(tree, newSegment);
     return address;
 }
 
-bool MemorySegment::verifySegmentList() {
-    MemorySegment* current = (MemorySegment*) segmentsPage;
-    MemorySegment** nextPage;
-
-    int freeSegmentSpaceFound = 0;
-    MemorySegment* freeSegment = nullptr;
-
-    while (true) {
-        if (current->address == 0 && current->size == 0) {
-            freeSegment = current;
-            freeSegmentSpaceFound++;
-        }
+// Returns the segment containing the given address or null if there is none.
+MemorySegment* MemorySegment::getSegment(MemorySegment* tree,
+        vaddr_t address) {
+    AutoLock lock(&mutex);
+    MemorySegment* segment = findSegment(tree, address);
+    if (!segment || segment->address > address) return nullptr;
+    return segment;
+}
 
-        current++;
-        if (((uintptr_t) current & PAGE_MISALIGN) ==
-                (PAGESIZE - PAGESIZE % sizeof(MemorySegment))) {
-            nextPage = (MemorySegment**) current;
-            if (!*nextPage) break;
-            current = *nextPage;
-        }
+bool MemorySegment::reserveSegments() {
+    if (freeSegmentCount == 0) {
+        addSlabPage((vaddr_t) segmentsPage);
     }
 
-    assert(freeSegmentSpaceFound > 0);
-
-    if (freeSegmentSpaceFound == 1) {
-        current = findFreeSegment(kernelSpace->firstSegment, PAGESIZE);
-        if (!current) return false;
-        vaddr_t address = current->address + current->size;
-        paddr_t physical = PhysicalMemory::popPageFrame();
-        if (!physical) return false;
-        if (!kernelSpace->mapAt(address, physical, PROT_READ | PROT_WRITE)) {
-            PhysicalMemory::pushPageFrame(physical);
-            return false;
-        }
-        *nextPage = (MemorySegment*) address;
-
-        memset(*nextPage, 0, PAGESIZE);
-
-        if (current->flags == (PROT_READ | PROT_WRITE)) {
-            current->size += PAGESIZE;
-        } else {
-            freeSegment->address = address;
-            freeSegment->size = PAGESIZE;
-            freeSegment->flags = PROT_READ | PROT_WRITE;
-            addSegment(kernelSpace->firstSegment, freeSegment);
-        }
+    // Always keep one segment available so that the segment for a new slab
+    // page can be allocated.
+    if (freeSegmentCount > 1) return true;
+
+    MemorySegment** kernelTree = &kernelSpace->segmentTree;
+    MemorySegment* current = findFreeSegment(*kernelTree, PAGESIZE);
+    if (!current) return false;
+    vaddr_t address = current->address + current->size;
+    paddr_t physical = PhysicalMemory::popPageFrame();
+    if (!physical) return false;
+    if (!kernelSpace->mapAt(address, physical, PROT_READ | PROT_WRITE)) {
+        PhysicalMemory::pushPageFrame(physical);
+        return false;
+    }
+    addSlabPage(address);
+
+    if (current->flags == (PROT_READ | PROT_WRITE)) {
+        current->size += PAGESIZE;
+        updatePath(current);
+    } else {
+        addSegment(kernelTree, allocateSegment(address, PAGESIZE,
+                PROT_READ | PROT_WRITE));
     }
 
     return true;
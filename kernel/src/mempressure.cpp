@@ -0,0 +1,59 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/mempressure.cpp
+ * Memory pressure device.
+ */
+
+#include <errno.h>
+#include <dennix/poll.h>
+#include <dennix/kernel/devices.h>
+#include <dennix/kernel/mempressure.h>
+
+Reference<MemoryPressureDevice> memoryPressureDevice;
+
+// The device is always readable and reads return an int that is nonzero while
+// the system is low on memory. Memory pressure is additionally reported as
+// POLLPRI so that processes can wait for it and release caches.
+MemoryPressureDevice::MemoryPressureDevice()
+        : Vnode(S_IFCHR | 0444, DevFS::dev) {
+    pressure = false;
+}
+
+short MemoryPressureDevice::poll() {
+    AutoLock lock(&mutex);
+    if (pressure) return POLLIN | POLLRDNORM | POLLPRI;
+    return POLLIN | POLLRDNORM;
+}
+
+ssize_t MemoryPressureDevice::read(void* buffer, size_t size, int /*flags*/) {
+    if (size < sizeof(int)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    kthread_mutex_lock(&mutex);
+    int result = pressure;
+    kthread_mutex_unlock(&mutex);
+    *(int*) buffer = result;
+    return sizeof(int);
+}
+
+void MemoryPressureDevice::setPressure(bool pressure) {
+    AutoLock lock(&mutex);
+    if (this->pressure == pressure) return;
+    this->pressure = pressure;
+    notifyEventListeners();
+}
@@ -49,6 +49,7 @@ void MouseDevice::addPacket(mouse_data data) {
     mouseBuffer[writeIndex] = data;
     available++;
     kthread_cond_broadcast(&readCond);
+    notifyEventListeners();
 }
 
 short MouseDevice::poll() {
@@ -92,6 +92,16 @@ Partition::Partition(const Reference<Vnode>& device, off_t offset, size_t size)
     stats.st_blksize = device->stat().st_blksize;
 }
 
+off_t Partition::getDeviceOffset(off_t offset,
+        BlockCacheDevice** blockDevice) {
+    if (offset < 0 || offset > stats.st_size - PAGESIZE) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return device->getDeviceOffset(partitionOffset + offset, blockDevice);
+}
+
 bool Partition::isSeekable() {
     return true;
 }
@@ -18,13 +18,24 @@
  */
 
 #include <assert.h>
+#include <sched.h>
 #include <dennix/meminfo.h>
 #include <dennix/kernel/addressspace.h>
 #include <dennix/kernel/cache.h>
+#include <dennix/kernel/interrupts.h>
 #include <dennix/kernel/kthread.h>
+#include <dennix/kernel/mempressure.h>
 #include <dennix/kernel/panic.h>
 #include <dennix/kernel/physicalmemory.h>
+#include <dennix/kernel/swap.h>
 #include <dennix/kernel/syscall.h>
+#include <dennix/kernel/thread.h>
+
+// Number of zeroed frames that are kept ready for allocations.
+#define ZEROED_POOL_SIZE 256
+// The low watermark is set to 1/LOW_WATERMARK_DIVISOR of memory.
+#define LOW_WATERMARK_DIVISOR 128
+#define MIN_LOW_WATERMARK 64
 
 class MemoryStack {
 public:
@@ -44,17 +55,43 @@ static size_t framesAvailable;
 static size_t framesReserved;
 static MemoryStack memstack(firstStackPage);
 static size_t totalFrames;
+static paddr_t zeroedPool[ZEROED_POOL_SIZE];
+static size_t zeroedFrames;
 
 static kthread_mutex_t mutex = KTHREAD_MUTEX_INITIALIZER;
 
+// The reclaim thread is woken when free frames drop below the low watermark
+// and reclaims memory until the high watermark is reached, so that allocations
+// rarely need to reclaim memory themselves.
+static size_t lowWatermark;
+static size_t highWatermark;
+static kthread_mutex_t reclaimMutex = KTHREAD_MUTEX_INITIALIZER;
+static kthread_cond_t reclaimCond = KTHREAD_COND_INITIALIZER;
+static bool reclaimNeeded;
+
 #ifdef __x86_64__
 static char firstStackPage32[PAGESIZE] ALIGNED(PAGESIZE);
 static MemoryStack memstack32(firstStackPage32);
 
-#define totalFramesOnStack (memstack.framesOnStack + memstack32.framesOnStack)
+// Free large frames are kept in a list that is linked through the direct map.
+// Large frames are only taken from memory above LARGE_FRAMES_BEGIN so that
+// enough small frames remain for early allocations and 32 bit DMA.
+#define FRAMES_PER_LARGE_FRAME (LARGE_PAGESIZE / PAGESIZE)
+#define LARGE_FRAMES_BEGIN 0x1000000
+static paddr_t largeFrames;
+static size_t largeFrameCount;
+// A large frame that is being split into small frames.
+static paddr_t splitFrame;
+static size_t splitFramesLeft;
+
+#define stackFrames (memstack.framesOnStack + memstack32.framesOnStack)
+#define largeFramesOnStack \
+        (largeFrameCount * FRAMES_PER_LARGE_FRAME + splitFramesLeft)
 #else
-#define totalFramesOnStack (memstack.framesOnStack)
+#define stackFrames (memstack.framesOnStack)
+#define largeFramesOnStack 0
 #endif
+#define totalFramesOnStack (stackFrames + zeroedFrames + largeFramesOnStack)
 
 extern "C" {
 extern symbol_t bootstrapBegin;
@@ -99,6 +136,34 @@ static inline bool isUsedByMultiboot(paddr_t physicalAddress,
     return physicalAddress >= multibootPhys && physicalAddress < multibootEnd;
 }
 
+static bool isUsable(paddr_t physicalAddress, const multiboot_info* multiboot,
+        paddr_t multibootPhys, paddr_t multibootEnd) {
+    return !isUsedByModule(physicalAddress, multiboot) &&
+            !isUsedByKernel(physicalAddress) &&
+            !isUsedByMultiboot(physicalAddress, multibootPhys, multibootEnd);
+}
+
+#ifdef __x86_64__
+static bool isUsableLargeFrame(paddr_t physicalAddress, paddr_t end,
+        const multiboot_info* multiboot, paddr_t multibootPhys,
+        paddr_t multibootEnd) {
+    if (!LARGE_PAGE_ALIGNED(physicalAddress) ||
+            physicalAddress < LARGE_FRAMES_BEGIN ||
+            physicalAddress + LARGE_PAGESIZE > end ||
+            physicalAddress + LARGE_PAGESIZE > DIRECT_MAP_SIZE) {
+        return false;
+    }
+
+    for (size_t i = 0; i < LARGE_PAGESIZE; i += PAGESIZE) {
+        if (!isUsable(physicalAddress + i, multiboot, multibootPhys,
+                multibootEnd)) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
 void PhysicalMemory::initialize(const multiboot_info* multiboot) {
     uintptr_t p = (uintptr_t) multiboot + 8;
     const multiboot_tag* tag;
@@ -134,9 +199,16 @@ void PhysicalMemory::initialize(const multiboot_info* multiboot) {
             paddr_t addr = (paddr_t) mmapEntry->addr;
             for (uint64_t i = 0; i < mmapEntry->len; i += PAGESIZE) {
                 totalFrames++;
-                if (isUsedByModule(addr + i, multiboot) ||
-                        isUsedByKernel(addr + i) ||
-                        isUsedByMultiboot(addr + i, multibootPhys,
+#ifdef __x86_64__
+                // Large frames are added once the direct map exists.
+                if (isUsableLargeFrame(addr + i, addr + mmapEntry->len,
+                        multiboot, multibootPhys, multibootEnd)) {
+                    totalFrames += FRAMES_PER_LARGE_FRAME - 1;
+                    i += LARGE_PAGESIZE - PAGESIZE;
+                    continue;
+                }
+#endif
+                if (!isUsable(addr + i, multiboot, multibootPhys,
                         multibootEnd)) {
                     continue;
                 }
@@ -147,6 +219,41 @@ void PhysicalMemory::initialize(const multiboot_info* multiboot) {
 
         mmap += mmapTag->entry_size;
     }
+
+#ifdef __x86_64__
+    mmap = (vaddr_t) mmapTag->entries;
+    while (mmap < mmapEnd) {
+        multiboot_mmap_entry* mmapEntry = (multiboot_mmap_entry*) mmap;
+        if (mmapEntry->type == MULTIBOOT_MEMORY_AVAILABLE &&
+                mmapEntry->addr < DIRECT_MAP_SIZE) {
+            AddressSpace::mapDirect(mmapEntry->addr, mmapEntry->len);
+        }
+        mmap += mmapTag->entry_size;
+    }
+
+    mmap = (vaddr_t) mmapTag->entries;
+    while (mmap < mmapEnd) {
+        multiboot_mmap_entry* mmapEntry = (multiboot_mmap_entry*) mmap;
+        if (mmapEntry->type == MULTIBOOT_MEMORY_AVAILABLE &&
+                mmapEntry->addr + mmapEntry->len <= UINTPTR_MAX) {
+            paddr_t addr = ALIGNUP((paddr_t) mmapEntry->addr, LARGE_PAGESIZE);
+            paddr_t end = (paddr_t) mmapEntry->addr + mmapEntry->len;
+            for (; addr < end; addr += LARGE_PAGESIZE) {
+                if (isUsableLargeFrame(addr, end, multiboot, multibootPhys,
+                        multibootEnd)) {
+                    pushLargeFrame(addr);
+                }
+            }
+        }
+        mmap += mmapTag->entry_size;
+    }
+#endif
+
+    lowWatermark = totalFrames / LOW_WATERMARK_DIVISOR;
+    if (lowWatermark < MIN_LOW_WATERMARK) {
+        lowWatermark = MIN_LOW_WATERMARK;
+    }
+    highWatermark = 2 * lowWatermark;
 }
 
 MemoryStack::MemoryStack(void* firstStackPage) {
@@ -192,6 +299,18 @@ void MemoryStack::pushPageFrame(paddr_t physicalAddress,
     }
 }
 
+#ifdef __x86_64__
+void PhysicalMemory::pushLargeFrame(paddr_t physicalAddress) {
+    assert(LARGE_PAGE_ALIGNED(physicalAddress));
+    AutoLock lock(&mutex);
+
+    *(paddr_t*) (DIRECT_MAP + physicalAddress) = largeFrames;
+    largeFrames = physicalAddress;
+    largeFrameCount++;
+    framesAvailable += FRAMES_PER_LARGE_FRAME;
+}
+#endif
+
 void PhysicalMemory::pushPageFrame(paddr_t physicalAddress) {
     assert(physicalAddress);
     assert(PAGE_ALIGNED(physicalAddress));
@@ -220,18 +339,143 @@ paddr_t MemoryStack::popPageFrame(bool cache /*= false*/) {
     return *stack--;
 }
 
+// Pops a frame from the stacks and only uses zeroed frames when the stacks are
+// empty. Large frames are split only when no other frames are left. The mutex
+// must be held and a frame must be available.
+static paddr_t popFreeFrame(bool cache) {
+    if (memstack.framesOnStack > 0) {
+        return memstack.popPageFrame(cache);
+    }
+#ifdef __x86_64__
+    if (memstack32.framesOnStack > 0) {
+        return memstack32.popPageFrame(cache);
+    }
+#endif
+
+#ifdef __x86_64__
+    if (zeroedFrames == 0) {
+        if (splitFramesLeft == 0) {
+            assert(largeFrameCount > 0);
+            splitFrame = largeFrames;
+            largeFrames = *(paddr_t*) (DIRECT_MAP + splitFrame);
+            largeFrameCount--;
+            splitFramesLeft = FRAMES_PER_LARGE_FRAME;
+        }
+
+        if (!cache) {
+            framesAvailable--;
+        }
+        splitFramesLeft--;
+        return splitFrame + splitFramesLeft * PAGESIZE;
+    }
+#endif
+
+    assert(zeroedFrames > 0);
+    if (!cache) {
+        framesAvailable--;
+    }
+    return zeroedPool[--zeroedFrames];
+}
+
+// Puts a frame that was reclaimed from a cache on the stacks. The mutex must be
+// held.
+static void pushReclaimedFrame(paddr_t address) {
+#ifdef __x86_64__
+    if (address <= 0xFFFFF000) {
+        memstack32.pushPageFrame(address, true);
+        return;
+    }
+#endif
+    memstack.pushPageFrame(address, true);
+}
+
+// Wakes the reclaim thread if free frames are running low. The mutex must be
+// held.
+static void checkWatermarks() {
+    if (totalFramesOnStack >= framesReserved + lowWatermark &&
+            framesAvailable >= framesReserved + lowWatermark) {
+        return;
+    }
+    if (__atomic_load_n(&reclaimNeeded, __ATOMIC_RELAXED)) return;
+
+    kthread_mutex_lock(&reclaimMutex);
+    reclaimNeeded = true;
+    kthread_cond_signal(&reclaimCond);
+    kthread_mutex_unlock(&reclaimMutex);
+}
+
+// The idle thread is only scheduled when no other thread can run, so it must
+// not be preempted while holding the mutex.
+static bool lockFromIdle() {
+    Interrupts::disable();
+    if (kthread_mutex_trylock(&mutex) == 0) return true;
+    Interrupts::enable();
+    return false;
+}
+
+static void unlockFromIdle() {
+    kthread_mutex_unlock(&mutex);
+    Interrupts::enable();
+}
+
+void PhysicalMemory::fillZeroedPool() {
+    while (true) {
+        if (!lockFromIdle()) return;
+        // Leave enough frames on the stacks for reservations.
+        if (zeroedFrames == ZEROED_POOL_SIZE ||
+                stackFrames < framesReserved + ZEROED_POOL_SIZE) {
+            unlockFromIdle();
+            return;
+        }
+
+        // The frame remains counted as available while it is being zeroed.
+        paddr_t frame = popFreeFrame(true);
+        unlockFromIdle();
+
+        AddressSpace::zeroPage(frame);
+
+        while (!lockFromIdle()) {
+            sched_yield();
+        }
+        zeroedPool[zeroedFrames++] = frame;
+        unlockFromIdle();
+    }
+}
+
+#ifdef __x86_64__
+// Takes a large frame out of frames that have already been reserved. Returns 0
+// and keeps the reservation if no large frame is available.
+paddr_t PhysicalMemory::popLargeReserved(bool zeroed /*= false*/) {
+    kthread_mutex_lock(&mutex);
+    assert(framesReserved >= FRAMES_PER_LARGE_FRAME);
+    if (largeFrameCount == 0) {
+        kthread_mutex_unlock(&mutex);
+        return 0;
+    }
+
+    paddr_t result = largeFrames;
+    largeFrames = *(paddr_t*) (DIRECT_MAP + result);
+    largeFrameCount--;
+    framesReserved -= FRAMES_PER_LARGE_FRAME;
+    framesAvailable -= FRAMES_PER_LARGE_FRAME;
+    kthread_mutex_unlock(&mutex);
+
+    if (zeroed) {
+        for (size_t i = 0; i < LARGE_PAGESIZE; i += PAGESIZE) {
+            AddressSpace::zeroPage(result + i);
+        }
+    }
+    return result;
+}
+#endif
+
 paddr_t PhysicalMemory::popPageFrame() {
     AutoLock lock(&mutex);
     if (framesAvailable - framesReserved == 0) return 0;
+    checkWatermarks();
 
     if (totalFramesOnStack - framesReserved > 0) {
-        if (memstack.framesOnStack > 0) {
-            return memstack.popPageFrame();
-        }
-
-    #ifdef __x86_64__
-        return memstack32.popPageFrame();
-    #endif
+        return popFreeFrame(false);
     }
 
     for (CacheController* cache = firstCache; cache; cache = cache->nextCache) {
@@ -254,23 +498,35 @@ paddr_t PhysicalMemory::popPageFrame32() {
 }
 #endif
 
-paddr_t PhysicalMemory::popReserved() {
-    AutoLock lock(&mutex);
+paddr_t PhysicalMemory::popReserved(bool zeroed /*= false*/) {
+    kthread_mutex_lock(&mutex);
     assert(framesReserved > 0);
-
     framesReserved--;
-#ifdef __x86_64__
-    if (memstack.framesOnStack > 0) {
-        return memstack.popPageFrame();
+
+    if (zeroed && zeroedFrames > 0) {
+        framesAvailable--;
+        paddr_t result = zeroedPool[--zeroedFrames];
+        kthread_mutex_unlock(&mutex);
+        return result;
     }
-    return memstack32.popPageFrame();
-#else
-    return memstack.popPageFrame();
-#endif
+
+    paddr_t result = popFreeFrame(false);
+    kthread_mutex_unlock(&mutex);
+
+    if (zeroed) {
+        AddressSpace::zeroPage(result);
+    }
+    return result;
+}
+
+size_t PhysicalMemory::getAvailableFrames() {
+    AutoLock lock(&mutex);
+    return framesAvailable - framesReserved;
 }
 
 bool PhysicalMemory::reserveFrames(size_t frames) {
     AutoLock lock(&mutex);
+    checkWatermarks();
 
     if (framesAvailable - framesReserved < frames) return false;
 
@@ -284,16 +540,8 @@ bool PhysicalMemory::reserveFrames(size_t frames) {
             if (address) break;
         }
 
-        if (address) {
-#ifdef __x86_64__
-            if (address <= 0xFFFFF000) {
-                memstack32.pushPageFrame(address, true);
-            } else
-#endif
-            memstack.pushPageFrame(address, true);
-        } else {
-            return false;
-        }
+        if (!address) return false;
+        pushReclaimedFrame(address);
     }
 
     framesReserved += frames;
@@ -307,6 +555,61 @@ void PhysicalMemory::unreserveFrames(size_t frames) {
     framesReserved -= frames;
 }
 
+// Moves frames from caches to the stacks until the high watermark is reached.
+static void refillStacks() {
+    while (true) {
+        AutoLock lock(&mutex);
+        if (totalFramesOnStack >= framesReserved + highWatermark) return;
+
+        paddr_t address = 0;
+        for (CacheController* cache = firstCache; cache;
+                cache = cache->nextCache) {
+            address = cache->reclaimCache();
+            if (address) break;
+        }
+        if (!address) return;
+        pushReclaimedFrame(address);
+    }
+}
+
+static NORETURN void reclaimThread() {
+    bool pressure = false;
+
+    while (true) {
+        kthread_mutex_lock(&reclaimMutex);
+        if (!reclaimNeeded && pressure) {
+            // Check regularly whether the memory pressure is gone.
+            struct timespec endTime;
+            Clock::get(CLOCK_MONOTONIC)->getTime(&endTime);
+            endTime.tv_sec++;
+            kthread_cond_sigclockwait(&reclaimCond, &reclaimMutex,
+                    CLOCK_MONOTONIC, &endTime);
+        } else if (!reclaimNeeded) {
+            kthread_cond_sigwait(&reclaimCond, &reclaimMutex);
+        }
+        reclaimNeeded = false;
+        kthread_mutex_unlock(&reclaimMutex);
+
+        refillStacks();
+        // Swap out memory if reclaiming caches was not sufficient.
+        AddressSpace::reclaimFrames(highWatermark);
+
+        size_t available = PhysicalMemory::getAvailableFrames();
+        if (available < lowWatermark) {
+            pressure = true;
+        } else if (available >= highWatermark) {
+            pressure = false;
+        }
+        if (memoryPressureDevice) {
+            memoryPressureDevice->setPressure(pressure);
+        }
+    }
+}
+
+void PhysicalMemory::startReclaimThread() {
+    Thread::createKernelThread(reclaimThread);
+}
+
 CacheController::CacheController() {
     nextCache = firstCache;
     firstCache = this;
@@ -317,14 +620,10 @@ paddr_t CacheController::allocateCache() {
     if (framesAvailable - framesReserved == 0) {
         return 0;
     }
+    checkWatermarks();
 
     if (totalFramesOnStack - framesReserved > 0) {
-        if (memstack.framesOnStack > 0) {
-            return memstack.popPageFrame(true);
-        }
-#ifdef __x86_64__
-        return memstack32.popPageFrame(true);
-#endif
+        return popFreeFrame(true);
     }
 
     for (CacheController* cache = firstCache; cache; cache = cache->nextCache) {
@@ -342,9 +641,19 @@ void CacheController::returnCache(paddr_t address) {
 }
 
 void Syscall::meminfo(struct meminfo* info) {
-    AutoLock lock(&mutex);
-    info->mem_total = totalFrames * PAGESIZE;
-    info->mem_free = totalFramesOnStack * PAGESIZE;
-    info->mem_available = framesAvailable * PAGESIZE;
-    info->__reserved = 0;
+    // The info is filled in without holding the mutex because writing to user
+    // memory might need to swap in a page.
+    struct meminfo result;
+    kthread_mutex_lock(&mutex);
+    result.mem_total = totalFrames * PAGESIZE;
+    result.mem_free = totalFramesOnStack * PAGESIZE;
+    result.mem_available = framesAvailable * PAGESIZE;
+    kthread_mutex_unlock(&mutex);
+
+    size_t swapTotal;
+    size_t swapFree;
+    Swap::getUsage(&swapTotal, &swapFree);
+    result.swap_total = swapTotal * PAGESIZE;
+    result.swap_free = swapFree * PAGESIZE;
+    *info = result;
 }
@@ -22,6 +22,7 @@
 #include <fcntl.h>
 #include <sched.h>
 #include <sys/stat.h>
+#include <dennix/fcntl.h>
 #include <dennix/poll.h>
 #include <dennix/kernel/pipe.h>
 #include <dennix/kernel/signal.h>
@@ -31,6 +32,7 @@ class PipeVnode::Endpoint : public Vnode {
 public:
     Endpoint(const Reference<PipeVnode>& pipe)
             : Vnode(S_IFIFO | S_IRUSR | S_IWUSR, 0), pipe(pipe) {}
+    int fcntl(int cmd, int param) override;
     int stat(struct stat* result) override;
 protected:
     Reference<PipeVnode> pipe;
@@ -41,6 +43,7 @@ public:
     ReadEnd(const Reference<PipeVnode>& pipe) : Endpoint(pipe) {}
     short poll() override;
     ssize_t read(void* buffer, size_t size, int flags) override;
+    ssize_t readv(const struct iovec* iov, int iovcnt, int flags) override;
     virtual ~ReadEnd();
 };
 
@@ -49,12 +52,16 @@ public:
     WriteEnd(const Reference<PipeVnode>& pipe) : Endpoint(pipe) {}
     short poll() override;
     ssize_t write(const void* buffer, size_t size, int flags) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt, int flags) override;
     virtual ~WriteEnd();
 };
 
 PipeVnode::PipeVnode(Reference<Vnode>& readPipe, Reference<Vnode>& writePipe)
-        : Vnode(S_IFIFO | S_IRUSR | S_IWUSR, 0),
-        circularBuffer(pipeBuffer, sizeof(pipeBuffer)) {
+        : Vnode(S_IFIFO | S_IRUSR | S_IWUSR, 0) {
+    readEnd = nullptr;
+    writeEnd = nullptr;
+    if (!circularBuffer.resize(PIPE_DEFAULT_SIZE)) FAIL_CONSTRUCTOR;
+
     readEnd = new ReadEnd(this);
     if (!readEnd) FAIL_CONSTRUCTOR;
     writeEnd = new WriteEnd(this);
@@ -75,6 +82,10 @@ PipeVnode::~PipeVnode() {
     assert(!writeEnd);
 }
 
+int PipeVnode::Endpoint::fcntl(int cmd, int param) {
+    return pipe->fcntl(cmd, param);
+}
+
 int PipeVnode::Endpoint::stat(struct stat* result) {
     return pipe->stat(result);
 }
@@ -87,10 +98,18 @@ ssize_t PipeVnode::ReadEnd::read(void* buffer, size_t size, int flags) {
     return pipe->read(buffer, size, flags);
 }
 
+ssize_t PipeVnode::ReadEnd::readv(const struct iovec* iov, int iovcnt,
+        int flags) {
+    return pipe->readv(iov, iovcnt, flags);
+}
+
 PipeVnode::ReadEnd::~ReadEnd() {
     AutoLock lock(&pipe->mutex);
     pipe->readEnd = nullptr;
     kthread_cond_broadcast(&pipe->writeCond);
+    if (pipe->writeEnd) {
+        pipe->writeEnd->notifyEventListeners();
+    }
 }
 
 short PipeVnode::WriteEnd::poll() {
@@ -101,17 +120,50 @@ ssize_t PipeVnode::WriteEnd::write(const void* buffer, size_t size, int flags) {
     return pipe->write(buffer, size, flags);
 }
 
+ssize_t PipeVnode::WriteEnd::writev(const struct iovec* iov, int iovcnt,
+        int flags) {
+    return pipe->writev(iov, iovcnt, flags);
+}
+
 PipeVnode::WriteEnd::~WriteEnd() {
     AutoLock lock(&pipe->mutex);
     pipe->writeEnd = nullptr;
     kthread_cond_broadcast(&pipe->readCond);
+    if (pipe->readEnd) {
+        pipe->readEnd->notifyEventListeners();
+    }
+}
+
+int PipeVnode::fcntl(int cmd, int param) {
+    AutoLock lock(&mutex);
+
+    if (cmd == F_GETPIPE_SZ) {
+        return circularBuffer.capacity();
+    } else if (cmd == F_SETPIPE_SZ) {
+        if (param < 0) {
+            errno = EINVAL;
+            return -1;
+        } else if (param > PIPE_MAX_SIZE) {
+            errno = EPERM;
+            return -1;
+        }
+
+        if (!circularBuffer.resize(param)) return -1;
+        kthread_cond_broadcast(&writeCond);
+        if (writeEnd) {
+            writeEnd->notifyEventListeners();
+        }
+        return circularBuffer.capacity();
+    }
+
+    return Vnode::fcntl(cmd, param);
 }
 
 short PipeVnode::poll() {
     AutoLock lock(&mutex);
     short result = 0;
     if (circularBuffer.bytesAvailable()) result |= POLLIN | POLLRDNORM;
-    if (readEnd && circularBuffer.spaceAvailable()) {
+    if (readEnd && circularBuffer.spaceAvailable() >= writeWatermark()) {
         result |= POLLOUT | POLLWRNORM;
     }
     if (!readEnd || !writeEnd) result |= POLLHUP;
@@ -119,6 +171,15 @@ short PipeVnode::poll() {
 }
 
 ssize_t PipeVnode::read(void* buffer, size_t size, int flags) {
+    struct iovec iov = { buffer, size };
+    return readv(&iov, 1, flags);
+}
+
+ssize_t PipeVnode::readv(const struct iovec* iov, int iovcnt, int flags) {
+    size_t size = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        size += iov[i].iov_len;
+    }
     if (size == 0) return 0;
     AutoLock lock(&mutex);
 
@@ -136,16 +197,50 @@ ssize_t PipeVnode::read(void* buffer, size_t size, int flags) {
         }
     }
 
-    size_t bytesRead = circularBuffer.read(buffer, size);
-    kthread_cond_broadcast(&writeCond);
+    size_t spaceBefore = circularBuffer.spaceAvailable();
+    size_t bytesRead = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        size_t count = circularBuffer.read(iov[i].iov_base, iov[i].iov_len);
+        bytesRead += count;
+        if (count < iov[i].iov_len) break;
+    }
+
+    // Writers only wait when the pipe is (almost) full, so they only need to
+    // be woken once enough space has become available.
+    size_t watermark = writeWatermark();
+    if (spaceBefore < watermark &&
+            circularBuffer.spaceAvailable() >= watermark) {
+        kthread_cond_broadcast(&writeCond);
+        if (writeEnd) {
+            writeEnd->notifyEventListeners();
+        }
+    }
     updateTimestamps(true, false, false);
     return bytesRead;
 }
 
 ssize_t PipeVnode::write(const void* buffer, size_t size, int flags) {
+    struct iovec iov = { (void*) buffer, size };
+    return writev(&iov, 1, flags);
+}
+
+// The pipe is writable once this much space is available so that a write of
+// PIPE_BUF bytes does not block. Writers are woken when this is reached.
+size_t PipeVnode::writeWatermark() {
+    size_t capacity = circularBuffer.capacity();
+    return capacity >= PIPE_BUF ? PIPE_BUF : capacity;
+}
+
+ssize_t PipeVnode::writev(const struct iovec* iov, int iovcnt, int flags) {
+    size_t size = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        size += iov[i].iov_len;
+    }
     if (size == 0) return 0;
     AutoLock lock(&mutex);
 
+    // Writes of at most PIPE_BUF bytes are atomic even if they consist of
+    // multiple buffers.
     if (size <= PIPE_BUF) {
         while (circularBuffer.spaceAvailable() < size && readEnd) {
             if (flags & O_NONBLOCK) {
@@ -160,41 +255,63 @@ ssize_t PipeVnode::write(const void* buffer, size_t size, int flags) {
         }
     }
 
-    const char* buf = (const char*) buffer;
     size_t written = 0;
 
-    while (written < size) {
-        while (circularBuffer.spaceAvailable() == 0 && readEnd) {
-            if (flags & O_NONBLOCK) {
-                if (written) {
-                    updateTimestamps(false, true, true);
-                    return written;
+    for (int i = 0; i < iovcnt; i++) {
+        const char* buf = (const char*) iov[i].iov_base;
+        size_t bufferWritten = 0;
+
+        while (bufferWritten < iov[i].iov_len) {
+            while (circularBuffer.spaceAvailable() == 0 && readEnd) {
+                if (flags & O_NONBLOCK) {
+                    if (written) {
+                        updateTimestamps(false, true, true);
+                        return written;
+                    }
+                    errno = EAGAIN;
+                    return -1;
                 }
-                errno = EAGAIN;
+
+                if (kthread_cond_sigwait(&writeCond, &mutex) == EINTR) {
+                    if (written) {
+                        updateTimestamps(false, true, true);
+                        return written;
+                    }
+                    errno = EINTR;
+                    return -1;
+                }
+            }
+
+            if (!readEnd) {
+                siginfo_t siginfo = {};
+                siginfo.si_signo = SIGPIPE;
+                siginfo.si_code = SI_KERNEL;
+                Thread::current()->raiseSignal(siginfo);
+                errno = EPIPE;
                 return -1;
             }
 
-            if (kthread_cond_sigwait(&writeCond, &mutex) == EINTR) {
+            // Readers only wait when the pipe is empty.
+            bool wasEmpty = circularBuffer.bytesAvailable() == 0;
+            size_t count = circularBuffer.write(buf + bufferWritten,
+                    iov[i].iov_len - bufferWritten);
+            if (count == 0) {
+                // A page could not be allocated.
                 if (written) {
                     updateTimestamps(false, true, true);
                     return written;
                 }
-                errno = EINTR;
+                errno = ENOMEM;
                 return -1;
             }
-        }
 
-        if (!readEnd) {
-            siginfo_t siginfo = {};
-            siginfo.si_signo = SIGPIPE;
-            siginfo.si_code = SI_KERNEL;
-            Thread::current()->raiseSignal(siginfo);
-            errno = EPIPE;
-            return -1;
+            bufferWritten += count;
+            written += count;
+            if (wasEmpty) {
+                kthread_cond_broadcast(&readCond);
+                readEnd->notifyEventListeners();
+            }
         }
-
-        written += circularBuffer.write(buf + written, size - written);
-        kthread_cond_broadcast(&readCond);
     }
 
     updateTimestamps(false, true, true);
@@ -20,6 +20,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <sched.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <dennix/fcntl.h>
@@ -28,6 +29,7 @@
 #include <dennix/kernel/process.h>
 #include <dennix/kernel/registers.h>
 #include <dennix/kernel/signal.h>
+#include <dennix/kernel/vdso.h>
 
 #define USER_STACK_SIZE (128 * 1024) // 128 KiB
 
@@ -52,10 +54,13 @@ extern symbol_t endSigreturn;
 
 Process::Process() : mainThread(this) {
     addressSpace = nullptr;
+    addressSpaceMutex = KTHREAD_MUTEX_INITIALIZER;
     alarmTime.tv_nsec = -1;
     childrenMutex = KTHREAD_MUTEX_INITIALIZER;
     controllingTerminal = nullptr;
     cwdFd = nullptr;
+    exitedThreadCounters = {};
+    exiting = false;
     firstChild = nullptr;
     groupMutex = KTHREAD_MUTEX_INITIALIZER;
     nextChild = nullptr;
@@ -67,11 +72,16 @@ Process::Process() : mainThread(this) {
     pid = -1;
     sid = -1;
     rootFd = nullptr;
+    vforkWaiter = nullptr;
+    memset(name, '\0', sizeof(name));
     memset(sigactions, '\0', sizeof(sigactions));
     sigreturn = 0;
     terminated = false;
     terminationStatus = {};
+    threadCount = 1;
+    threadsMutex = KTHREAD_MUTEX_INITIALIZER;
     umask = S_IWGRP | S_IWOTH;
+    vdso = 0;
 }
 
 Process::~Process() {
@@ -79,6 +89,9 @@ Process::~Process() {
 }
 
 bool Process::addProcess(Process* process) {
+    process->mainThread.tid = process->threads.add(&process->mainThread);
+    if (process->mainThread.tid < 0) return false;
+
     AutoLock lock(&processesMutex);
     Process* group = process->pgid == -1 ? process : nullptr;
     process->pid = processes.add({process, group});
@@ -168,13 +181,13 @@ uintptr_t Process::loadELF(const Reference<Vnode>& vnode,
         if (programHeader.p_flags & PF_W) protection |= PROT_WRITE;
         if (programHeader.p_flags & PF_R) protection |= PROT_READ;
 
-        if (!newAddressSpace->mapMemory(loadAddressAligned, size, protection)) {
+        if (!newAddressSpace->mapMemory(loadAddressAligned, size,
+                protection | PROT_ZERO)) {
             return 0;
         }
         vaddr_t dest = kernelSpace->mapFromOtherAddressSpace(newAddressSpace,
                 loadAddressAligned, size, PROT_WRITE);
         if (!dest) return 0;
-        memset((void*) (dest + offset), 0, programHeader.p_memsz);
         readSize = vnode->pread((void*) (dest + offset), programHeader.p_filesz,
                 programHeader.p_offset, 0);
         if (readSize < 0) {
@@ -233,10 +246,49 @@ int Process::close(int fd) {
         return -1;
     }
 
-    fdTable[fd] = { nullptr, 0 };
+    fdTable.remove(fd);
     return 0;
 }
 
+pid_t Process::createThread(regfork_t* registers) {
+    Thread* thread = new Thread(this);
+    if (!thread) return -1;
+
+    vaddr_t newKernelStack = kernelSpace->mapMemory(PAGESIZE,
+            PROT_READ | PROT_WRITE);
+    if (!newKernelStack) {
+        delete thread;
+        return -1;
+    }
+    InterruptContext* newInterruptContext = (InterruptContext*)
+            (newKernelStack + PAGESIZE - sizeof(InterruptContext));
+    Registers::restore(newInterruptContext, registers);
+
+    Thread* current = Thread::current();
+    thread->updateContext(newKernelStack, newInterruptContext,
+            &current->fpuEnv);
+    thread->signalMask = current->signalMask;
+    thread->tlsBase = current->tlsBase;
+
+    AutoLock lock(&threadsMutex);
+    if (exiting) {
+        delete thread;
+        errno = EAGAIN;
+        return -1;
+    }
+
+    thread->tid = threads.add(thread);
+    if (thread->tid < 0) {
+        delete thread;
+        errno = EAGAIN;
+        return -1;
+    }
+    threadCount++;
+
+    Thread::addThread(thread);
+    return thread->tid;
+}
+
 int Process::dup3(int fd1, int fd2, int flags) {
     if (fd1 == fd2) {
         errno = EINVAL;
@@ -291,6 +343,12 @@ int Process::execute(Reference<Vnode>& vnode, char* const argv[],
     memcpy((void*) sigreturnMapped, &beginSigreturn, sigreturnSize);
     kernelSpace->unmapPhysical(sigreturnMapped, PAGESIZE);
 
+    vaddr_t newVdso = Vdso::map(newAddressSpace, pid);
+    if (!newVdso) {
+        delete newAddressSpace;
+        return -1;
+    }
+
     vaddr_t userStack = newAddressSpace->mapMemory(USER_STACK_SIZE,
             PROT_READ | PROT_WRITE);
     if (!userStack) {
@@ -324,6 +382,7 @@ int Process::execute(Reference<Vnode>& vnode, char* const argv[],
     newInterruptContext->eax = argc;
     newInterruptContext->ebx = (uint32_t) newArgv;
     newInterruptContext->ecx = (uint32_t) newEnvp;
+    newInterruptContext->edx = (uint32_t) newVdso;
     newInterruptContext->eip = (uint32_t) entry;
     newInterruptContext->cs = 0x1B;
     newInterruptContext->eflags = 0x200; // Interrupt enable
@@ -333,34 +392,70 @@ int Process::execute(Reference<Vnode>& vnode, char* const argv[],
     newInterruptContext->rdi = argc;
     newInterruptContext->rsi = (vaddr_t) newArgv;
     newInterruptContext->rdx = (vaddr_t) newEnvp;
+    newInterruptContext->rcx = newVdso;
     newInterruptContext->rip = entry;
     newInterruptContext->cs = 0x1B;
     newInterruptContext->rflags = 0x200; // Interrupt enable
     newInterruptContext->rsp = userStack + USER_STACK_SIZE;
     newInterruptContext->ss = 0x23;
 #endif
+
+    if (this == current()) {
+        // Other threads cannot continue running after the address space was
+        // replaced.
+        if (!stopOtherThreads()) {
+            kernelSpace->unmapMemory(newKernelStack, PAGESIZE);
+            delete newAddressSpace;
+            exitThread();
+        }
+        exiting = false;
+    }
+
     // Close all file descriptors marked with FD_CLOEXEC.
     for (int i = fdTable.next(-1); i >= 0; i = fdTable.next(i)) {
         if (fdTable[i].flags & FD_CLOEXEC) {
-            fdTable[i] = { nullptr, 0 };
+            fdTable.remove(i);
         }
     }
 
+    // The arguments still live in the old address space.
+    const char* programName = argv[0] ? argv[0] : "";
+    const char* slash = strrchr(programName, '/');
+    strlcpy(name, slash ? slash + 1 : programName, sizeof(name));
+
+    kthread_mutex_lock(&addressSpaceMutex);
     AddressSpace* oldAddressSpace = addressSpace;
     addressSpace = newAddressSpace;
+    kthread_mutex_unlock(&addressSpaceMutex);
+    // The kernel no longer writes to the new address space directly.
+    newAddressSpace->swappable = true;
+    vdso = newVdso;
     if (this == current()) {
         addressSpace->activate();
     }
-    delete oldAddressSpace;
+    if (vforkWaiter) {
+        Interrupts::disable();
+        releaseVforkParent();
+        Interrupts::enable();
+    } else {
+        delete oldAddressSpace;
+    }
 
     memset(sigactions, '\0', sizeof(sigactions));
 
-    mainThread.updateContext(newKernelStack, newInterruptContext, &initFpu);
+    Thread* thread = this == current() ? Thread::current() : &mainThread;
+    thread->tlsBase = 0;
+    thread->updateContext(newKernelStack, newInterruptContext, &initFpu);
 
     return 0;
 }
 
 void Process::exit(int status) {
+    if (!stopOtherThreads()) {
+        // Another thread is already terminating the process.
+        exitThread();
+    }
+
     terminationStatus.si_signo = SIGCHLD;
     terminationStatus.si_code = CLD_EXITED;
     terminationStatus.si_pid = pid;
@@ -369,6 +464,29 @@ void Process::exit(int status) {
     terminate();
 }
 
+void Process::exitThread() {
+    Thread* thread = Thread::current();
+
+    kthread_mutex_lock(&threadsMutex);
+    if (threadCount == 1 && !exiting) {
+        kthread_mutex_unlock(&threadsMutex);
+        // The process terminates when its last thread exits.
+        exit(0);
+        __builtin_unreachable();
+    }
+
+    exitedThreadCounters.add(thread->counters);
+    threads.remove(thread->tid);
+    // Interrupts need to be disabled before the thread count is updated
+    // because the process might otherwise be freed while we are still running.
+    Interrupts::disable();
+    threadCount--;
+    kthread_mutex_unlock(&threadsMutex);
+
+    // The main thread is part of the process and is deleted together with it.
+    thread->terminate(thread != &mainThread);
+}
+
 int Process::fcntl(int fd, int cmd, int param) {
     if (fd < 0 || fd >= fdTable.allocatedSize || !fdTable[fd]) {
         errno = EBADF;
@@ -421,35 +539,132 @@ Process* Process::getGroup(pid_t pgid) {
     return processes[pgid].processGroup;
 }
 
+bool Process::getInfo(pid_t pid, ProcessInfo* info) {
+    // Holding the mutex prevents the process from being freed.
+    AutoLock lock(&processesMutex);
+    if (pid < 0 || pid >= processes.allocatedSize ||
+            !processes[pid].process) {
+        errno = ESRCH;
+        return false;
+    }
+    Process* process = processes[pid].process;
+
+    memcpy(info->name, process->name, sizeof(info->name));
+    info->pid = pid;
+    info->ppid = process->parent ? process->parent->pid : 0;
+    info->pgid = process->pgid;
+    info->sid = process->sid;
+    process->userCpuClock.getTime(&info->userTime);
+    process->systemCpuClock.getTime(&info->systemTime);
+
+    bool running = false;
+    info->waitChannel = nullptr;
+    kthread_mutex_lock(&process->threadsMutex);
+    info->threads = process->threadCount;
+    info->counters = process->exitedThreadCounters;
+    for (pid_t i = process->threads.next(-1); i >= 0;
+            i = process->threads.next(i)) {
+        Thread* thread = process->threads[i];
+        info->counters.add(thread->counters);
+        const char* waitChannel = thread->waitChannel;
+        if (!waitChannel) {
+            running = true;
+        } else if (!info->waitChannel) {
+            info->waitChannel = waitChannel;
+        }
+    }
+    kthread_mutex_unlock(&process->threadsMutex);
+
+    if (process->terminated) {
+        info->state = 'Z';
+        info->threads = 0;
+        info->waitChannel = nullptr;
+    } else {
+        info->state = running ? 'R' : 'S';
+        if (running) info->waitChannel = nullptr;
+    }
+
+    info->residentSize = 0;
+    kthread_mutex_lock(&process->addressSpaceMutex);
+    if (process->addressSpace && process->addressSpace != kernelSpace) {
+        size_t count;
+        MemorySegment* segments =
+                process->addressSpace->copySegments(&count);
+        if (segments) {
+            for (size_t i = 0; i < count; i++) {
+                info->residentSize += segments[i].size;
+            }
+            free(segments);
+        }
+    }
+    kthread_mutex_unlock(&process->addressSpaceMutex);
+
+    return true;
+}
+
+MemorySegment* Process::getSegments(pid_t pid, size_t* count) {
+    AutoLock lock(&processesMutex);
+    if (pid < 0 || pid >= processes.allocatedSize ||
+            !processes[pid].process) {
+        errno = ESRCH;
+        return nullptr;
+    }
+    Process* process = processes[pid].process;
+
+    AutoLock addressSpaceLock(&process->addressSpaceMutex);
+    if (!process->addressSpace || process->addressSpace == kernelSpace) {
+        *count = 0;
+        return (MemorySegment*) malloc(sizeof(MemorySegment));
+    }
+    return process->addressSpace->copySegments(count);
+}
+
 bool Process::isParentOf(Process* process) {
     return this == process->parent;
 }
 
-Process* Process::regfork(int /*flags*/, regfork_t* registers) {
+pid_t Process::nextPid(pid_t pid) {
+    AutoLock lock(&processesMutex);
+    for (pid_t i = processes.next(pid); i >= 0; i = processes.next(i)) {
+        if (processes[i].process) return i;
+    }
+    return -1;
+}
+
+pid_t Process::regfork(int flags, regfork_t* registers) {
     Process* process = new Process();
-    if (!process) return nullptr;
+    if (!process) return -1;
     process->parent = this;
+    VforkWaiter waiter = { Thread::current(), false };
 
     vaddr_t newKernelStack = kernelSpace->mapMemory(PAGESIZE,
             PROT_READ | PROT_WRITE);
     if (!newKernelStack) {
         process->terminate();
         delete process;
-        return nullptr;
+        return -1;
     }
     InterruptContext* newInterruptContext = (InterruptContext*)
             (newKernelStack + PAGESIZE - sizeof(InterruptContext));
     Registers::restore(newInterruptContext, registers);
 
+    Thread* thread = Thread::current();
     process->mainThread.updateContext(newKernelStack, newInterruptContext,
-            &mainThread.fpuEnv);
-
-    // Fork the address space
-    process->addressSpace = addressSpace->fork();
+            &thread->fpuEnv);
+    process->mainThread.signalMask = thread->signalMask;
+    process->mainThread.tlsBase = thread->tlsBase;
+
+    if (flags & RFVFORK) {
+        // The child borrows our address space until it calls execve or exits.
+        process->addressSpace = addressSpace;
+        process->vforkWaiter = &waiter;
+    } else {
+        process->addressSpace = addressSpace->fork();
+    }
     if (!process->addressSpace) {
         process->terminate();
         delete process;
-        return nullptr;
+        return -1;
     }
 
     // Copy the file descriptor table except for fds with FD_CLOFORK set.
@@ -458,7 +673,7 @@ Process* Process::regfork(int /*flags*/, regfork_t* registers) {
         if (process->fdTable.insert(i, fdTable[i]) < 0) {
             process->terminate();
             delete process;
-            return nullptr;
+            return -1;
         }
     }
 
@@ -466,14 +681,25 @@ Process* Process::regfork(int /*flags*/, regfork_t* registers) {
     process->cwdFd = cwdFd;
     process->pgid = pgid;
     process->sid = sid;
+    memcpy(process->name, name, sizeof(name));
     process->rootFd = rootFd;
     process->sigreturn = sigreturn;
     process->umask = umask;
+    process->vdso = vdso;
 
     if (!addProcess(process)) {
         process->terminate();
         delete process;
-        return nullptr;
+        return -1;
+    }
+
+    // A vfork child shares our vDSO, so getpid needs to use the syscall until
+    // the child has called execve or exited.
+    pid_t vdsoPid = flags & RFVFORK ? 0 : process->pid;
+    if (!Vdso::setPid(process->addressSpace, vdso, vdsoPid)) {
+        process->terminate();
+        delete process;
+        return -1;
     }
 
     kthread_mutex_lock(&childrenMutex);
@@ -484,7 +710,7 @@ Process* Process::regfork(int /*flags*/, regfork_t* registers) {
     firstChild = process;
     kthread_mutex_unlock(&childrenMutex);
 
-    AutoLock lock(&processesMutex);
+    kthread_mutex_lock(&processesMutex);
     Process* groupLeader = processes[pgid].processGroup;
     kthread_mutex_lock(&groupLeader->groupMutex);
     process->prevInGroup = this;
@@ -494,9 +720,36 @@ Process* Process::regfork(int /*flags*/, regfork_t* registers) {
     }
     nextInGroup = process;
     kthread_mutex_unlock(&groupLeader->groupMutex);
+    kthread_mutex_unlock(&processesMutex);
 
+    // The child might already be reaped once it is running, so it must not be
+    // accessed afterwards.
+    pid_t childPid = process->pid;
     Thread::addThread(&process->mainThread);
-    return process;
+
+    if (flags & RFVFORK) {
+        // We cannot return to userspace while the child might still be running
+        // on our address space.
+        AutoWaitChannel waitChannel("vfork");
+        Interrupts::disable();
+        while (!waiter.done) {
+            Thread::sleep(nullptr);
+        }
+        Interrupts::enable();
+
+        // If this fails getpid keeps using the syscall.
+        Vdso::setPid(addressSpace, vdso, pid);
+    }
+
+    return childPid;
+}
+
+// Lets the parent of a vfork child continue once the child no longer uses its
+// address space. This must be called with interrupts disabled.
+void Process::releaseVforkParent() {
+    vforkWaiter->done = true;
+    vforkWaiter->thread->wake();
+    vforkWaiter = nullptr;
 }
 
 void Process::removeFromGroup() {
@@ -519,6 +772,9 @@ void Process::removeFromGroup() {
         } else {
             // The group ceases to exist.
             processes[pgid].processGroup = nullptr;
+            if (!processes[pgid]) {
+                processes.remove(pgid);
+            }
         }
     } else {
         prevInGroup->nextInGroup = nextInGroup;
@@ -531,6 +787,35 @@ void Process::removeFromGroup() {
     kthread_mutex_unlock(&groupLeader->groupMutex);
 }
 
+// Makes all other threads of the process exit. Returns false if another thread
+// is already doing that, in which case the calling thread needs to exit too.
+bool Process::stopOtherThreads() {
+    kthread_mutex_lock(&threadsMutex);
+    if (exiting) {
+        kthread_mutex_unlock(&threadsMutex);
+        return false;
+    }
+    exiting = true;
+
+    siginfo_t siginfo = {};
+    siginfo.si_signo = SIGKILL;
+    siginfo.si_code = SI_KERNEL;
+
+    Thread* current = Thread::current();
+    for (pid_t i = threads.next(-1); i >= 0; i = threads.next(i)) {
+        if (threads[i] != current) {
+            threads[i]->raiseSignal(siginfo);
+        }
+    }
+    kthread_mutex_unlock(&threadsMutex);
+
+    // The threads exit when they handle the signal.
+    while (__atomic_load_n(&threadCount, __ATOMIC_ACQUIRE) > 1) {
+        sched_yield();
+    }
+    return true;
+}
+
 int Process::setpgid(pid_t pgid) {
     if (pgid == 0) {
         pgid = pid;
@@ -627,6 +912,19 @@ void Process::terminate() {
         parent->raiseSignal(terminationStatus);
     }
 
+    kthread_mutex_lock(&addressSpaceMutex);
+    AddressSpace* oldAddressSpace = addressSpace;
+    addressSpace = kernelSpace;
+    kthread_mutex_unlock(&addressSpaceMutex);
+
+    if (this == current()) {
+        Thread* thread = Thread::current();
+        kthread_mutex_lock(&threadsMutex);
+        exitedThreadCounters.add(thread->counters);
+        threads.remove(thread->tid);
+        kthread_mutex_unlock(&threadsMutex);
+    }
+
     Interrupts::disable();
 
     if (this == current()) {
@@ -634,13 +932,29 @@ void Process::terminate() {
     }
 
     // Clean up
+    if (vforkWaiter) {
+        releaseVforkParent();
+    } else if (oldAddressSpace != kernelSpace) {
+        delete oldAddressSpace;
+    }
+
+    if (this == current()) {
+        Thread* thread = Thread::current();
+        threadCount--;
+        terminated = true;
+        thread->terminate(thread != &mainThread);
+    }
+
     Thread::removeThread(&mainThread);
-    delete addressSpace;
     terminated = true;
     Interrupts::enable();
 }
 
 void Process::terminateBySignal(siginfo_t siginfo) {
+    if (!stopOtherThreads()) {
+        exitThread();
+    }
+
     terminationStatus.si_signo = SIGCHLD;
     terminationStatus.si_code = CLD_KILLED;
     terminationStatus.si_pid = pid;
@@ -657,6 +971,7 @@ Process* Process::waitpid(pid_t pid, int flags) {
     }
 
     Process* process;
+    AutoWaitChannel waitChannel("waitpid");
 
     if (pid == -1) {
         while (true) {
@@ -721,6 +1036,9 @@ Process* Process::waitpid(pid_t pid, int flags) {
 
     AutoLock lock(&processesMutex);
     processes[process->pid].process = nullptr;
+    if (!processes[process->pid]) {
+        processes.remove(process->pid);
+    }
 
     return process;
 }
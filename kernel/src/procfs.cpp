@@ -0,0 +1,388 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/procfs.cpp
+ * Process information filesystem.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <dennix/fcntl.h>
+#include <dennix/kernel/panic.h>
+#include <dennix/kernel/process.h>
+#include <dennix/kernel/procfs.h>
+
+// Inode numbers are derived from the pid so that they are stable even though
+// the vnodes are created on demand.
+#define PROC_INO(pid, index) (((ino_t) (pid) + 1) << 2 | (index))
+
+enum {
+    PROC_DIR,
+    PROC_STAT,
+    PROC_MAPS,
+};
+
+class ProcRootDir : public Vnode {
+public:
+    ProcRootDir(const Reference<Vnode>& mountPoint);
+    Reference<Vnode> getChildNode(const char* name) override;
+    Reference<Vnode> getChildNode(const char* name, size_t length) override;
+    ssize_t getDirectoryEntries(void* buffer, size_t size, off_t* offset,
+            int flags) override;
+    Reference<Vnode> open(const char* name, int flags, mode_t mode) override;
+private:
+    Reference<Vnode> mountPoint;
+};
+
+class ProcPidDir : public Vnode {
+public:
+    ProcPidDir(pid_t pid);
+    Reference<Vnode> getChildNode(const char* name) override;
+    Reference<Vnode> getChildNode(const char* name, size_t length) override;
+    ssize_t getDirectoryEntries(void* buffer, size_t size, off_t* offset,
+            int flags) override;
+    Reference<Vnode> open(const char* name, int flags, mode_t mode) override;
+private:
+    pid_t pid;
+};
+
+class ProcFile : public Vnode {
+public:
+    ProcFile(pid_t pid, int type);
+    bool isSeekable() override;
+    ssize_t pread(void* buffer, size_t size, off_t offset, int flags) override;
+private:
+    char* generate(size_t* length);
+    char* generateMaps(size_t* length);
+    char* generateStat(size_t* length);
+private:
+    pid_t pid;
+    int type;
+};
+
+static const char* const pidDirEntries[] = { "stat", "maps" };
+
+ProcFS procFS;
+const dev_t ProcFS::dev = (dev_t) &procFS;
+
+static Reference<Vnode> openChild(const Reference<Vnode>& dir,
+        const char* name, int flags) {
+    size_t length = strcspn(name, "/");
+    Reference<Vnode> vnode = dir->getChildNode(name, length);
+    if (!vnode) {
+        return nullptr;
+    } else if (flags & O_EXCL) {
+        errno = EEXIST;
+        return nullptr;
+    }
+
+    return vnode;
+}
+
+Reference<Vnode> ProcFS::getRootDir() {
+    return rootDir;
+}
+
+void ProcFS::initialize(const Reference<DirectoryVnode>& rootDir) {
+    rootDir->mkdir("proc", 0555);
+    Reference<Vnode> dir = rootDir->getChildNode("proc");
+    if (!dir) PANIC("Could not create /proc.");
+    this->rootDir = xnew ProcRootDir(dir);
+    if (dir->mount(this) < 0) {
+        PANIC("Could not mount /proc filesystem.");
+    }
+}
+
+bool ProcFS::onUnmount() {
+    errno = EBUSY;
+    return false;
+}
+
+ProcRootDir::ProcRootDir(const Reference<Vnode>& mountPoint)
+        : Vnode(S_IFDIR | 0555, ProcFS::dev), mountPoint(mountPoint) {
+    stats.st_ino = 1;
+}
+
+Reference<Vnode> ProcRootDir::getChildNode(const char* name) {
+    if (strcmp(name, ".") == 0) {
+        return this;
+    } else if (strcmp(name, "..") == 0) {
+        return mountPoint->getChildNode(name);
+    }
+
+    pid_t pid;
+    if (strcmp(name, "self") == 0) {
+        pid = Process::current()->pid;
+    } else {
+        char* end;
+        unsigned long value = strtoul(name, &end, 10);
+        if (!*name || *end || value > INT_MAX ||
+                !Process::get((pid_t) value)) {
+            errno = ENOENT;
+            return nullptr;
+        }
+        pid = (pid_t) value;
+    }
+
+    return new ProcPidDir(pid);
+}
+
+Reference<Vnode> ProcRootDir::getChildNode(const char* name, size_t length) {
+    char* nameCopy = strndup(name, length);
+    if (!nameCopy) return nullptr;
+    Reference<Vnode> result = getChildNode(nameCopy);
+    free(nameCopy);
+    return result;
+}
+
+ssize_t ProcRootDir::getDirectoryEntries(void* buffer, size_t size,
+        off_t* offset, int /*flags*/) {
+    // Indexes 0, 1 and 2 are ., .. and self. All further indexes are the pid
+    // plus 3.
+    size_t used = 0;
+    off_t i = *offset;
+    while (true) {
+        ino_t ino;
+        unsigned char type = DT_DIR;
+        char name[12];
+
+        if (i == 0) {
+            ino = stats.st_ino;
+            strcpy(name, ".");
+        } else if (i == 1) {
+            ino = mountPoint->getChildNode("..")->stat().st_ino;
+            strcpy(name, "..");
+        } else if (i == 2) {
+            ino = PROC_INO(Process::current()->pid, PROC_DIR);
+            strcpy(name, "self");
+        } else {
+            pid_t pid = Process::nextPid(i - 4);
+            if (pid < 0) break;
+            i = pid + 3;
+            ino = PROC_INO(pid, PROC_DIR);
+            snprintf(name, sizeof(name), "%d", pid);
+        }
+
+        if (!addDirectoryEntry(buffer, size, &used, ino, type, name,
+                strlen(name))) {
+            if (used == 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            break;
+        }
+        i++;
+    }
+
+    *offset = i;
+    return used;
+}
+
+Reference<Vnode> ProcRootDir::open(const char* name, int flags,
+        mode_t /*mode*/) {
+    return openChild(this, name, flags);
+}
+
+ProcPidDir::ProcPidDir(pid_t pid) : Vnode(S_IFDIR | 0555, ProcFS::dev) {
+    this->pid = pid;
+    stats.st_ino = PROC_INO(pid, PROC_DIR);
+}
+
+Reference<Vnode> ProcPidDir::getChildNode(const char* name) {
+    if (strcmp(name, ".") == 0) {
+        return this;
+    } else if (strcmp(name, "..") == 0) {
+        return procFS.getRootDir();
+    }
+
+    for (size_t i = 0; i < sizeof(pidDirEntries) / sizeof(char*); i++) {
+        if (strcmp(name, pidDirEntries[i]) == 0) {
+            return new ProcFile(pid, PROC_STAT + i);
+        }
+    }
+
+    errno = ENOENT;
+    return nullptr;
+}
+
+Reference<Vnode> ProcPidDir::getChildNode(const char* name, size_t length) {
+    char* nameCopy = strndup(name, length);
+    if (!nameCopy) return nullptr;
+    Reference<Vnode> result = getChildNode(nameCopy);
+    free(nameCopy);
+    return result;
+}
+
+ssize_t ProcPidDir::getDirectoryEntries(void* buffer, size_t size,
+        off_t* offset, int /*flags*/) {
+    size_t entries = sizeof(pidDirEntries) / sizeof(char*);
+    size_t used = 0;
+    off_t i = *offset;
+    for (; i < (off_t) entries + 2; i++) {
+        ino_t ino;
+        unsigned char type;
+        const char* name;
+
+        if (i == 0) {
+            ino = stats.st_ino;
+            type = DT_DIR;
+            name = ".";
+        } else if (i == 1) {
+            ino = procFS.getRootDir()->stat().st_ino;
+            type = DT_DIR;
+            name = "..";
+        } else {
+            ino = PROC_INO(pid, PROC_STAT + i - 2);
+            type = DT_REG;
+            name = pidDirEntries[i - 2];
+        }
+
+        if (!addDirectoryEntry(buffer, size, &used, ino, type, name,
+                strlen(name))) {
+            if (used == 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            break;
+        }
+    }
+
+    *offset = i;
+    return used;
+}
+
+Reference<Vnode> ProcPidDir::open(const char* name, int flags,
+        mode_t /*mode*/) {
+    return openChild(this, name, flags);
+}
+
+ProcFile::ProcFile(pid_t pid, int type) : Vnode(S_IFREG | 0444, ProcFS::dev) {
+    this->pid = pid;
+    this->type = type;
+    stats.st_ino = PROC_INO(pid, type);
+}
+
+char* ProcFile::generate(size_t* length) {
+    switch (type) {
+        case PROC_STAT: return generateStat(length);
+        case PROC_MAPS: return generateMaps(length);
+        default:
+            errno = EINVAL;
+            return nullptr;
+    }
+}
+
+char* ProcFile::generateMaps(size_t* length) {
+    size_t count;
+    MemorySegment* segments = Process::getSegments(pid, &count);
+    if (!segments) return nullptr;
+
+    const int width = sizeof(vaddr_t) * 2;
+    size_t lineLength = 2 * width + 8;
+    char* buffer = (char*) reallocarray(nullptr, count + 1, lineLength);
+    if (!buffer) {
+        free(segments);
+        return nullptr;
+    }
+
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (size_t i = 0; i < count; i++) {
+        int flags = segments[i].flags;
+        used += snprintf(buffer + used, lineLength + 1,
+                "%0*jx-%0*jx %c%c%c %c\n", width,
+                (uintmax_t) segments[i].address, width,
+                (uintmax_t) (segments[i].address + segments[i].size),
+                flags & PROT_READ ? 'r' : '-',
+                flags & PROT_WRITE ? 'w' : '-',
+                flags & PROT_EXEC ? 'x' : '-',
+                flags & SEG_SHARED ? 's' : 'p');
+    }
+    free(segments);
+
+    *length = used;
+    return buffer;
+}
+
+char* ProcFile::generateStat(size_t* length) {
+    ProcessInfo info;
+    if (!Process::getInfo(pid, &info)) return nullptr;
+
+    uint64_t userTime = (uint64_t) info.userTime.tv_sec * 1000000000 +
+            info.userTime.tv_nsec;
+    uint64_t systemTime = (uint64_t) info.systemTime.tv_sec * 1000000000 +
+            info.systemTime.tv_nsec;
+
+    char* buffer;
+    int result = asprintf(&buffer,
+            "name %s\n"
+            "pid %d\n"
+            "ppid %d\n"
+            "pgid %d\n"
+            "sid %d\n"
+            "state %c\n"
+            "wchan %s\n"
+            "threads %zu\n"
+            "utime_ns %" PRIu64 "\n"
+            "stime_ns %" PRIu64 "\n"
+            "rss_bytes %zu\n"
+            "voluntary_switches %" PRIu64 "\n"
+            "involuntary_switches %" PRIu64 "\n"
+            "page_faults %" PRIu64 "\n"
+            "syscalls %" PRIu64 "\n"
+            "block_read_bytes %" PRIu64 "\n"
+            "block_write_bytes %" PRIu64 "\n",
+            info.name[0] ? info.name : "-", info.pid, info.ppid, info.pgid,
+            info.sid, info.state, info.waitChannel ? info.waitChannel : "-",
+            info.threads, userTime, systemTime, info.residentSize,
+            info.counters.voluntarySwitches,
+            info.counters.involuntarySwitches, info.counters.pageFaults,
+            info.counters.syscalls, info.counters.blockReadBytes,
+            info.counters.blockWriteBytes);
+    if (result < 0) return nullptr;
+
+    *length = result;
+    return buffer;
+}
+
+bool ProcFile::isSeekable() {
+    return true;
+}
+
+ssize_t ProcFile::pread(void* buffer, size_t size, off_t offset,
+        int /*flags*/) {
+    // The contents are regenerated on every read so that they are current.
+    size_t length;
+    char* contents = generate(&length);
+    if (!contents) return -1;
+
+    if ((uintmax_t) offset >= length) {
+        free(contents);
+        return 0;
+    }
+
+    if (size > length - offset) {
+        size = length - offset;
+    }
+    memcpy(buffer, contents + offset, size);
+    free(contents);
+    return size;
+}
@@ -86,7 +86,7 @@ void PS2Keyboard::handleKey(int keycode) {
     available++;
 
     if (available == 1) {
-        WorkerThread::addJob(&job);
+        WorkerThread::addJob(&job, WORKER_PRIORITY_HIGH);
     }
 }
 
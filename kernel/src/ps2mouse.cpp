@@ -110,7 +110,7 @@ void PS2Mouse::irqHandler() {
             packetBuffer[packetsAvailable] = data;
             packetsAvailable++;
             if (packetsAvailable == 1) {
-                WorkerThread::addJob(&job);
+                WorkerThread::addJob(&job, WORKER_PRIORITY_HIGH);
             }
         }
     }
@@ -41,6 +41,7 @@ protected:
     void output(const char* buffer, size_t size) override;
 public:
     unsigned int number;
+    Vnode* controller;
 private:
     char controllerBuffer[BUFFER_SIZE];
     size_t bufferIndex;
@@ -118,49 +119,47 @@ Reference<Vnode> DevPts::getChildNode(const char* name, size_t length) {
     return result;
 }
 
-size_t DevPts::getDirectoryEntries(void** buffer, int /*flags*/) {
+ssize_t DevPts::getDirectoryEntries(void* buffer, size_t size,
+        off_t* offset, int /*flags*/) {
     AutoLock lock(&ptsMutex);
 
-    size_t maxEntrySize = ALIGNUP(sizeof(posix_dent) + 11, alignof(posix_dent));
-    size_t maxSize = pseudoTerminals.allocatedSize * maxEntrySize +
-            ALIGNUP(sizeof(posix_dent) + 2, alignof(posix_dent)) +
-            ALIGNUP(sizeof(posix_dent) + 3, alignof(posix_dent));
-
-    void* buf = malloc(maxSize);
-    if (!buf) return 0;
-    size_t sizeUsed = 0;
-
-    posix_dent* dent = (posix_dent*) buf;
-    dent->d_ino = stats.st_ino;
-    dent->d_reclen = ALIGNUP(sizeof(posix_dent) + 2, alignof(posix_dent));
-    dent->d_type = DT_DIR;
-    strcpy(dent->d_name, ".");
-    sizeUsed += dent->d_reclen;
-
-    dent = (posix_dent*) ((char*) dent + dent->d_reclen);
-    dent->d_ino = devFS.getRootDir()->stat().st_ino;
-    dent->d_reclen = ALIGNUP(sizeof(posix_dent) + 3, alignof(posix_dent));
-    dent->d_type = DT_DIR;
-    strcpy(dent->d_name, "..");
-    sizeUsed += dent->d_reclen;
-
-    dent = (posix_dent*) ((char*) dent + dent->d_reclen);
-    for (unsigned int i = 0; i < pseudoTerminals.allocatedSize; i++) {
-        Reference<PseudoTerminal> pts = pseudoTerminals[i];
-        if (!pts) continue;
-
-        dent->d_ino = pts->stat().st_ino;
-        int length = sprintf(dent->d_name, "%u", pts->number);
-        dent->d_reclen = ALIGNUP(sizeof(posix_dent) + length + 1,
-                alignof(posix_dent));
-        dent->d_type = DT_CHR;
-        sizeUsed += dent->d_reclen;
-        dent = (posix_dent*) ((char*) dent + dent->d_reclen);
+    // The offset is the index of the next entry. Indexes 0 and 1 are . and ..
+    // and all further indexes correspond to pseudo terminal numbers.
+    size_t used = 0;
+    off_t i = *offset;
+    for (; i < (off_t) pseudoTerminals.allocatedSize + 2; i++) {
+        ino_t ino;
+        unsigned char type;
+        char name[12];
+
+        if (i == 0) {
+            ino = stats.st_ino;
+            type = DT_DIR;
+            strcpy(name, ".");
+        } else if (i == 1) {
+            ino = devFS.getRootDir()->stat().st_ino;
+            type = DT_DIR;
+            strcpy(name, "..");
+        } else {
+            Reference<PseudoTerminal> pts = pseudoTerminals[(unsigned int) i - 2];
+            if (!pts) continue;
+            ino = pts->stat().st_ino;
+            type = DT_CHR;
+            sprintf(name, "%u", pts->number);
+        }
+
+        if (!addDirectoryEntry(buffer, size, &used, ino, type, name,
+                strlen(name))) {
+            if (used == 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            break;
+        }
     }
 
-    *buffer = realloc(buf, sizeUsed);
-    if (!*buffer) *buffer = buf;
-    return sizeUsed;
+    *offset = i;
+    return used;
 }
 
 Reference<Vnode> DevPts::open(const char* name, int flags, mode_t /*mode*/) {
@@ -180,6 +179,7 @@ PseudoTerminal::PseudoTerminal() : Terminal(DevFS::dev) {
     AutoLock lock(&ptsMutex);
     number = pseudoTerminals.add(this);
 
+    controller = nullptr;
     bufferIndex = 0;
     bytesAvailable = 0;
     controllerReadCond = KTHREAD_COND_INITIALIZER;
@@ -225,6 +225,9 @@ void PseudoTerminal::output(const char* buffer, size_t size) {
             bytesAvailable++;
         }
         kthread_cond_broadcast(&controllerReadCond);
+        if (controller) {
+            controller->notifyEventListeners();
+        }
     }
 }
 
@@ -275,6 +278,7 @@ ssize_t PseudoTerminal::readController(void* buffer, size_t size, int flags) {
     }
 
     kthread_cond_broadcast(&outputCond);
+    notifyEventListeners();
     updateTimestamps(true, false, false);
     return bytesRead;
 }
@@ -294,10 +298,14 @@ ssize_t PseudoTerminal::writeController(const void* buffer, size_t size,
 
 PtController::PtController(const Reference<PseudoTerminal>& pts)
         : Vnode(S_IFCHR | 0666, DevFS::dev), pts(pts) {
-
+    AutoLock lock(&pts->mutex);
+    pts->controller = this;
 }
 
 PtController::~PtController() {
+    kthread_mutex_lock(&pts->mutex);
+    pts->controller = nullptr;
+    kthread_mutex_unlock(&pts->mutex);
     pts->hangup();
 }
 
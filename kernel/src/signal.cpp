@@ -191,7 +191,24 @@ InterruptContext* Thread::handleSignal(InterruptContext* context) {
 }
 
 void Process::raiseSignal(siginfo_t siginfo) {
-    mainThread.raiseSignal(siginfo);
+    AutoLock lock(&threadsMutex);
+
+    // Deliver the signal to the first thread that does not block it.
+    Thread* target = nullptr;
+    for (pid_t i = threads.next(-1); i >= 0; i = threads.next(i)) {
+        Thread* thread = threads[i];
+        if (!sigismember(&thread->signalMask, siginfo.si_signo)) {
+            target = thread;
+            break;
+        }
+        if (!target) {
+            target = thread;
+        }
+    }
+
+    if (target) {
+        target->raiseSignal(siginfo);
+    }
 }
 
 void Process::raiseSignalForGroup(siginfo_t siginfo) {
@@ -256,6 +273,11 @@ void Thread::raiseSignalUnlocked(siginfo_t siginfo) {
         current->next = pending;
     }
 
+    // Sleeping threads need to run to handle the signal. They will check
+    // whether they need to continue sleeping.
+    if (!sigismember(&signalMask, siginfo.si_signo)) {
+        sleeping = false;
+    }
     kthread_cond_broadcast(&signalCond);
 }
 
@@ -0,0 +1,450 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/socket.cpp
+ * Sockets.
+ */
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <dennix/fcntl.h>
+#include <dennix/un.h>
+#include <dennix/kernel/interrupts.h>
+#include <dennix/kernel/process.h>
+#include <dennix/kernel/socket.h>
+#include <dennix/kernel/worker.h>
+
+// File descriptions that are passed over sockets hold references to each other
+// when sockets are passed, so cycles of sockets can stay alive after they have
+// been closed. These are found by a garbage collector.
+static kthread_mutex_t inflightMutex = KTHREAD_MUTEX_INITIALIZER;
+static Socket* firstInflight;
+static size_t inflightSockets;
+static size_t collectionThreshold = SOCKET_GC_THRESHOLD;
+static bool collectionScheduled;
+static WorkerJob collectionJob;
+
+static void collect(void*) {
+    Socket::collectGarbage();
+}
+
+// Schedules garbage collection in a worker thread because it destroys file
+// descriptions, which must not happen with the inflight mutex held. The mutex
+// must be held.
+static void scheduleCollection() {
+    if (collectionScheduled) return;
+    collectionScheduled = true;
+    collectionJob.func = collect;
+    collectionJob.context = nullptr;
+    Interrupts::disable();
+    WorkerThread::addJob(&collectionJob, WORKER_PRIORITY_LOW);
+    Interrupts::enable();
+}
+
+static Socket* getSocket(const Reference<FileDescription>& descr) {
+    if (!descr->vnode->isSocket()) return nullptr;
+    return (Socket*) (Vnode*) descr->vnode;
+}
+
+static bool checkAddress(const struct sockaddr* address, socklen_t length) {
+    if (address->sa_family != AF_UNIX) {
+        errno = EAFNOSUPPORT;
+        return false;
+    }
+
+    if (length != sizeof(struct sockaddr_un)) {
+        errno = EINVAL;
+        return false;
+    }
+
+    const struct sockaddr_un* addr = (const struct sockaddr_un*) address;
+    // Check that the string is null terminated.
+    for (size_t i = 0; i < length - sizeof(sa_family_t); i++) {
+        if (!addr->sun_path[i]) break;
+        if (i == length - sizeof(sa_family_t) - 1) {
+            errno = EAFNOSUPPORT;
+            return false;
+        }
+    }
+    return true;
+}
+
+Socket::Socket(int type, mode_t mode) : Vnode(S_IFSOCK | mode, 0),
+        type(type) {
+    firstRights = nullptr;
+    lastRights = nullptr;
+    queuedRights = 0;
+    inflight = 0;
+    inflightDescription = nullptr;
+    prevInflight = nullptr;
+    nextInflight = nullptr;
+    nextGarbage = nullptr;
+    gcReferences = 0;
+    gcCandidate = false;
+    gcReachable = false;
+}
+
+Socket::~Socket() {
+    kthread_mutex_lock(&inflightMutex);
+    SocketRights* rights = firstRights;
+    for (SocketRights* r = rights; r; r = r->next) {
+        removeInflight(r);
+    }
+    firstRights = nullptr;
+    lastRights = nullptr;
+
+    // Closing a socket might have left a cycle of sockets unreachable.
+    if (inflightSockets > 0) {
+        scheduleCollection();
+    }
+    kthread_mutex_unlock(&inflightMutex);
+
+    while (rights) {
+        SocketRights* next = rights->next;
+        delete rights;
+        rights = next;
+    }
+}
+
+// Accounts for the sockets in the rights being queued in a socket. The inflight
+// mutex must be held.
+void Socket::addInflight(const SocketRights* rights) {
+    for (size_t i = 0; i < rights->count; i++) {
+        Socket* socket = getSocket(rights->files[i]);
+        if (!socket) continue;
+
+        FileDescription* descr = (FileDescription*) rights->files[i];
+        if (socket->inflight++ == 0) {
+            socket->inflightDescription = descr;
+            socket->prevInflight = nullptr;
+            socket->nextInflight = firstInflight;
+            if (firstInflight) {
+                firstInflight->prevInflight = socket;
+            }
+            firstInflight = socket;
+            inflightSockets++;
+        } else if (socket->inflightDescription != descr) {
+            // Sockets with multiple file descriptions are never collected.
+            socket->inflightDescription = nullptr;
+        }
+    }
+}
+
+// Accounts for rights being removed from the queue of a socket. The inflight
+// mutex must be held.
+void Socket::removeInflight(const SocketRights* rights) {
+    for (size_t i = 0; i < rights->count; i++) {
+        Socket* socket = getSocket(rights->files[i]);
+        if (!socket || --socket->inflight > 0) continue;
+
+        if (socket->prevInflight) {
+            socket->prevInflight->nextInflight = socket->nextInflight;
+        } else {
+            firstInflight = socket->nextInflight;
+        }
+        if (socket->nextInflight) {
+            socket->nextInflight->prevInflight = socket->prevInflight;
+        }
+        socket->inflightDescription = nullptr;
+        inflightSockets--;
+    }
+}
+
+int Socket::bindAddress(const struct sockaddr* address, socklen_t length) {
+    if (!checkAddress(address, length)) return -1;
+
+    const struct sockaddr_un* addr = (const struct sockaddr_un*) address;
+    Reference<Vnode> directory;
+    if (addr->sun_path[0] == '\0') {
+        errno = ENOENT;
+        return -1;
+    } else if (addr->sun_path[0] == '/') {
+        directory = Process::current()->rootFd->vnode;
+    } else {
+        directory = Process::current()->cwdFd->vnode;
+    }
+
+    const char* lastComponent;
+    directory = resolvePathExceptLastComponent(directory, addr->sun_path,
+            &lastComponent);
+    if (!directory) return -1;
+
+    if (directory->link(lastComponent, this) < 0) {
+        if (errno == EEXIST) errno = EADDRINUSE;
+        return -1;
+    }
+    return 0;
+}
+
+// Collects the file descriptions of all SCM_RIGHTS control messages. rights
+// is set to null if the message does not pass any file descriptors.
+bool Socket::getRights(const struct msghdr* msg, SocketRights** rights) {
+    *rights = nullptr;
+    if (!msg->msg_control || msg->msg_controllen == 0) return true;
+
+    size_t count = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg;
+            cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_len < (socklen_t) CMSG_LEN(0) ||
+                (char*) cmsg + cmsg->cmsg_len > (char*) msg->msg_control +
+                msg->msg_controllen) {
+            errno = EINVAL;
+            return false;
+        }
+
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            errno = EINVAL;
+            return false;
+        }
+        count += (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    }
+
+    if (count == 0) return true;
+    if (count > SOCKET_MAX_RIGHTS) {
+        errno = EINVAL;
+        return false;
+    }
+
+    SocketRights* result = new SocketRights();
+    if (!result) return false;
+    result->next = nullptr;
+    result->offset = 0;
+    result->count = count;
+    result->files = new Reference<FileDescription>[count];
+    if (!result->files) {
+        delete result;
+        return false;
+    }
+
+    size_t index = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg;
+            cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        const int* fds = (const int*) CMSG_DATA(cmsg);
+        size_t fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < fdCount; i++) {
+            result->files[index] = Process::current()->getFd(fds[i]);
+            if (!result->files[index]) {
+                delete result;
+                return false;
+            }
+            index++;
+        }
+    }
+
+    *rights = result;
+    return true;
+}
+
+// Checks whether the rights can be queued in this socket without exceeding the
+// limit of queued file descriptions.
+bool Socket::checkRights(const SocketRights* rights) {
+    AutoLock lock(&inflightMutex);
+    if (rights->count > SOCKET_MAX_QUEUED_RIGHTS - queuedRights) {
+        errno = ETOOMANYREFS;
+        return false;
+    }
+    return true;
+}
+
+// Finds sockets that can only be reached through the queues of other such
+// sockets and drops the file descriptions queued in them.
+void Socket::collectGarbage() {
+    kthread_mutex_lock(&inflightMutex);
+    collectionScheduled = false;
+
+    // Candidates are sockets whose only file description is referenced by
+    // socket queues only.
+    for (Socket* socket = firstInflight; socket;
+            socket = socket->nextInflight) {
+        FileDescription* descr = socket->inflightDescription;
+        socket->gcCandidate = descr && socket->getRefCount() == 1 &&
+                descr->getRefCount() == socket->inflight;
+        socket->gcReferences = socket->inflight;
+        socket->gcReachable = false;
+    }
+
+    // Candidates that are still referenced after subtracting the references
+    // from the queues of candidates are reachable from outside.
+    for (Socket* socket = firstInflight; socket;
+            socket = socket->nextInflight) {
+        if (!socket->gcCandidate) continue;
+        for (SocketRights* rights = socket->firstRights; rights;
+                rights = rights->next) {
+            for (size_t i = 0; i < rights->count; i++) {
+                Socket* passed = getSocket(rights->files[i]);
+                if (passed && passed->gcCandidate) {
+                    passed->gcReferences--;
+                }
+            }
+        }
+    }
+
+    Socket* reachable = nullptr;
+    for (Socket* socket = firstInflight; socket;
+            socket = socket->nextInflight) {
+        if (socket->gcCandidate && socket->gcReferences > 0) {
+            socket->gcReachable = true;
+            socket->nextGarbage = reachable;
+            reachable = socket;
+        }
+    }
+
+    // Sockets queued in reachable sockets are reachable as well.
+    while (reachable) {
+        Socket* socket = reachable;
+        reachable = socket->nextGarbage;
+        for (SocketRights* rights = socket->firstRights; rights;
+                rights = rights->next) {
+            for (size_t i = 0; i < rights->count; i++) {
+                Socket* passed = getSocket(rights->files[i]);
+                if (passed && passed->gcCandidate && !passed->gcReachable) {
+                    passed->gcReachable = true;
+                    passed->nextGarbage = reachable;
+                    reachable = passed;
+                }
+            }
+        }
+    }
+
+    // The queues of the remaining candidates are emptied. This releases the
+    // file descriptions of the garbage sockets.
+    SocketRights* released = nullptr;
+    for (Socket* socket = firstInflight; socket;
+            socket = socket->nextInflight) {
+        if (!socket->gcCandidate || socket->gcReachable) continue;
+        if (socket->lastRights) {
+            socket->lastRights->next = released;
+            released = socket->firstRights;
+        }
+        socket->firstRights = nullptr;
+        socket->lastRights = nullptr;
+        socket->queuedRights = 0;
+    }
+
+    for (SocketRights* rights = released; rights; rights = rights->next) {
+        removeInflight(rights);
+    }
+
+    collectionThreshold = 2 * inflightSockets;
+    if (collectionThreshold < SOCKET_GC_THRESHOLD) {
+        collectionThreshold = SOCKET_GC_THRESHOLD;
+    }
+    kthread_mutex_unlock(&inflightMutex);
+
+    while (released) {
+        SocketRights* next = released->next;
+        delete released;
+        released = next;
+    }
+}
+
+// Removes the first rights from the queue and returns them.
+SocketRights* Socket::dequeueRights() {
+    AutoLock lock(&inflightMutex);
+    SocketRights* rights = firstRights;
+    if (!rights) return nullptr;
+
+    firstRights = rights->next;
+    if (!firstRights) {
+        lastRights = nullptr;
+    }
+    rights->next = nullptr;
+    queuedRights -= rights->count;
+    removeInflight(rights);
+    return rights;
+}
+
+bool Socket::isSocket() {
+    return true;
+}
+
+// Installs the passed file descriptions into the current process and stores
+// the new file descriptors in the control buffer of the message. File
+// descriptions that do not fit are closed and MSG_CTRUNC is set.
+void Socket::putRights(struct msghdr* msg, SocketRights* rights, int flags) {
+    socklen_t controlLength = msg->msg_controllen;
+    msg->msg_controllen = 0;
+    if (!rights) return;
+
+    size_t count = 0;
+    if (msg->msg_control && controlLength >= (socklen_t) CMSG_LEN(0)) {
+        count = (controlLength - CMSG_LEN(0)) / sizeof(int);
+        if (count > rights->count) count = rights->count;
+    }
+
+    int fdFlags = 0;
+    if (flags & MSG_CMSG_CLOEXEC) fdFlags |= FD_CLOEXEC;
+    if (flags & MSG_CMSG_CLOFORK) fdFlags |= FD_CLOFORK;
+
+    struct cmsghdr* cmsg = (struct cmsghdr*) msg->msg_control;
+    size_t installed = 0;
+    while (installed < count) {
+        int fd = Process::current()->addFileDescriptor(
+                rights->files[installed], fdFlags);
+        if (fd < 0) break;
+        ((int*) CMSG_DATA(cmsg))[installed++] = fd;
+    }
+
+    if (installed < rights->count) {
+        msg->msg_flags |= MSG_CTRUNC;
+    }
+
+    if (installed > 0) {
+        cmsg->cmsg_len = CMSG_LEN(installed * sizeof(int));
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        msg->msg_controllen = cmsg->cmsg_len;
+    }
+
+    delete rights;
+}
+
+void Socket::queueRights(SocketRights* rights) {
+    AutoLock lock(&inflightMutex);
+    rights->next = nullptr;
+    if (lastRights) {
+        lastRights->next = rights;
+    } else {
+        firstRights = rights;
+    }
+    lastRights = rights;
+    queuedRights += rights->count;
+    addInflight(rights);
+
+    if (inflightSockets > collectionThreshold) {
+        scheduleCollection();
+    }
+}
+
+Reference<Socket> Socket::resolveAddress(const struct sockaddr* address,
+        socklen_t length) {
+    if (!checkAddress(address, length)) return nullptr;
+
+    const struct sockaddr_un* addr = (const struct sockaddr_un*) address;
+    Reference<Vnode> directory;
+    if (addr->sun_path[0] == '/') {
+        directory = Process::current()->rootFd->vnode;
+    } else {
+        directory = Process::current()->cwdFd->vnode;
+    }
+
+    Reference<Vnode> vnode = resolvePath(directory, addr->sun_path);
+    if (!vnode) return nullptr;
+    if (!S_ISSOCK(vnode->stat().st_mode)) {
+        errno = ECONNREFUSED;
+        return nullptr;
+    }
+    return (Reference<Socket>) vnode;
+}
@@ -14,7 +14,7 @@
  */
 
 /* kernel/src/streamsocket.cpp
- * Unix domain stream sockets.
+ * Unix domain stream and sequenced packet sockets.
  */
 
 #include <errno.h>
@@ -26,9 +26,23 @@
 #include <dennix/kernel/process.h>
 #include <dennix/kernel/streamsocket.h>
 
-#define BUFFER_SIZE (4 * 1024 * 1024) // 4 MiB
+// Packets of sequenced packet sockets are stored in the circular buffer with
+// a header containing their length.
+typedef size_t PacketHeader;
 
-StreamSocket::StreamSocket(mode_t mode) : Socket(SOCK_STREAM, mode) {
+static size_t copyToIovec(CircularBuffer& buffer, const struct msghdr* msg,
+        size_t offset, size_t size) {
+    size_t copied = 0;
+    for (int i = 0; i < msg->msg_iovlen && copied < size; i++) {
+        size_t count = msg->msg_iov[i].iov_len;
+        if (count > size - copied) count = size - copied;
+        copied += buffer.peek(msg->msg_iov[i].iov_base, count,
+                offset + copied);
+    }
+    return copied;
+}
+
+StreamSocket::StreamSocket(int type, mode_t mode) : Socket(type, mode) {
     socketMutex = KTHREAD_MUTEX_INITIALIZER;
     acceptCond = KTHREAD_COND_INITIALIZER;
     connectCond = KTHREAD_COND_INITIALIZER;
@@ -36,22 +50,25 @@ StreamSocket::StreamSocket(mode_t mode) : Socket(SOCK_STREAM, mode) {
     isConnected = false;
     isConnecting = false;
     isListening = false;
+    receiveBufferSize = STREAM_SOCKET_DEFAULT_BUFFER;
+    sendBufferSize = STREAM_SOCKET_DEFAULT_BUFFER;
 
     receiveCond = KTHREAD_COND_INITIALIZER;
     sendCond = KTHREAD_COND_INITIALIZER;
     peer = nullptr;
-    receiveBuffer = nullptr;
+    readOffset = 0;
+    writeOffset = 0;
 }
 
-StreamSocket::StreamSocket(mode_t mode, const Reference<StreamSocket>& peer,
+// The receive buffer needs to be allocated using resizeReceiveBuffer before
+// the socket can be used.
+StreamSocket::StreamSocket(int type, mode_t mode,
+        const Reference<StreamSocket>& peer,
         const Reference<ConnectionMutex>& connectionMutex)
-        : StreamSocket(mode) {
+        : StreamSocket(type, mode) {
     isConnected = true;
     this->peer = (StreamSocket*) peer;
     this->connectionMutex = connectionMutex;
-    receiveBuffer = new char[BUFFER_SIZE];
-    if (!receiveBuffer) FAIL_CONSTRUCTOR;
-    circularBuffer.initialize(receiveBuffer, BUFFER_SIZE);
 }
 
 StreamSocket::~StreamSocket() {
@@ -61,13 +78,14 @@ StreamSocket::~StreamSocket() {
             peer->peer = nullptr;
             kthread_cond_broadcast(&peer->receiveCond);
             kthread_cond_broadcast(&peer->sendCond);
+            peer->notifyEventListeners();
         }
         kthread_mutex_unlock(&connectionMutex->mutex);
-        delete receiveBuffer;
     }
 
     while (firstConnection) {
         kthread_cond_broadcast(&firstConnection->connectCond);
+        firstConnection->notifyEventListeners();
         Reference<StreamSocket> connection = firstConnection;
         firstConnection = firstConnection->nextConnection;
         connection->nextConnection = nullptr;
@@ -104,28 +122,39 @@ Reference<Vnode> StreamSocket::accept(struct sockaddr* address,
 
     Reference<ConnectionMutex> connectionMutex;
     Reference<StreamSocket> newSocket;
-    char* buffer;
 
-    if (!(connectionMutex = new ConnectionMutex()) ||
-            !(newSocket = new StreamSocket(stat().st_mode, incoming,
-            connectionMutex)) ||
-            !(buffer = new char[BUFFER_SIZE])) {
-        kthread_mutex_lock(&incoming->socketMutex);
+    if ((connectionMutex = new ConnectionMutex()) &&
+            (newSocket = new StreamSocket(type, stat().st_mode, incoming,
+            connectionMutex))) {
+        // Accepted sockets inherit the buffer sizes of the listening socket.
+        newSocket->receiveBufferSize = receiveBufferSize;
+        newSocket->sendBufferSize = sendBufferSize;
+    }
+
+    kthread_mutex_lock(&incoming->socketMutex);
+    bool success = newSocket && newSocket->resizeReceiveBuffer();
+    if (success) {
+        incoming->peer = (StreamSocket*) newSocket;
+        success = incoming->resizeReceiveBuffer();
+    }
+
+    if (!success) {
+        incoming->peer = nullptr;
         incoming->isConnecting = false;
         kthread_cond_broadcast(&incoming->connectCond);
+        incoming->notifyEventListeners();
         kthread_mutex_unlock(&incoming->socketMutex);
         return nullptr;
     }
 
-    kthread_mutex_lock(&incoming->socketMutex);
-    incoming->peer = (StreamSocket*) newSocket;
     incoming->connectionMutex = connectionMutex;
-    incoming->isConnected = true;
+    // Once a socket is connected it can be read and written without taking
+    // the socket mutex.
+    __atomic_store_n(&incoming->isConnected, true, __ATOMIC_RELEASE);
     incoming->isConnecting = false;
-    incoming->receiveBuffer = buffer;
-    incoming->circularBuffer.initialize(buffer, BUFFER_SIZE);
     struct sockaddr_un peerAddr = incoming->boundAddress;
     kthread_cond_broadcast(&incoming->connectCond);
+    incoming->notifyEventListeners();
     kthread_mutex_unlock(&incoming->socketMutex);
 
     if (address) {
@@ -153,6 +182,7 @@ bool StreamSocket::addConnection(const Reference<StreamSocket>& socket) {
     lastConnection = socket;
 
     kthread_cond_signal(&acceptCond);
+    notifyEventListeners();
     return true;
 }
 
@@ -175,47 +205,8 @@ int StreamSocket::bind(const struct sockaddr* address, socklen_t length,
         return -1;
     }
 
-    if (address->sa_family != AF_UNIX) {
-        errno = EAFNOSUPPORT;
-        return -1;
-    }
-
-    if (length != sizeof(struct sockaddr_un)) {
-        errno = EINVAL;
-        return -1;
-    }
-
-    const struct sockaddr_un* addr = (const struct sockaddr_un*) address;
-    // Check that the string is null terminated.
-    for (size_t i = 0; i < length - sizeof(sa_family_t); i++) {
-        if (!addr->sun_path[i]) break;
-        if (i == length - sizeof(sa_family_t) - 1) {
-            errno = EAFNOSUPPORT;
-            return -1;
-        }
-    }
-
-    Reference<Vnode> directory;
-    if (addr->sun_path[0] == '\0') {
-        errno = ENOENT;
-        return -1;
-    } else if (addr->sun_path[0] == '/') {
-        directory = Process::current()->rootFd->vnode;
-    } else {
-        directory = Process::current()->cwdFd->vnode;
-    }
-
-    const char* lastComponent;
-    directory = resolvePathExceptLastComponent(directory, addr->sun_path,
-            &lastComponent);
-    if (!directory) return -1;
-
-    if (directory->link(lastComponent, this) < 0) {
-        if (errno == EEXIST) errno = EADDRINUSE;
-        return -1;
-    }
-
-    boundAddress = *addr;
+    if (bindAddress(address, length) < 0) return -1;
+    boundAddress = *(const struct sockaddr_un*) address;
     return 0;
 }
 
@@ -238,42 +229,10 @@ int StreamSocket::connect(const struct sockaddr* address, socklen_t length,
         return -1;
     }
 
-    if (address->sa_family != AF_UNIX) {
-        errno = EAFNOSUPPORT;
-        return -1;
-    }
-
-    if (length != sizeof(struct sockaddr_un)) {
-        errno = EINVAL;
-        return -1;
-    }
-
-    const struct sockaddr_un* addr = (const struct sockaddr_un*) address;
-    // Check that the string is null terminated.
-    for (size_t i = 0; i < length - sizeof(sa_family_t); i++) {
-        if (!addr->sun_path[i]) break;
-        if (i == length - sizeof(sa_family_t) - 1) {
-            errno = EAFNOSUPPORT;
-            return -1;
-        }
-    }
-
     {
-        Reference<Vnode> directory;
-        if (addr->sun_path[0] == '/') {
-            directory = Process::current()->rootFd->vnode;
-        } else {
-            directory = Process::current()->cwdFd->vnode;
-        }
-
-        Reference<Vnode> vnode = resolvePath(directory, addr->sun_path);
-        if (!vnode) return -1;
-        if (!S_ISSOCK(vnode->stat().st_mode)) {
-            errno = ECONNREFUSED;
-            return -1;
-        }
-        Reference<Socket> socket = (Reference<Socket>) vnode;
-        if (socket->type != SOCK_STREAM) {
+        Reference<Socket> socket = resolveAddress(address, length);
+        if (!socket) return -1;
+        if (socket->type != type) {
             errno = EPROTOTYPE;
             return -1;
         }
@@ -310,6 +269,47 @@ int StreamSocket::connect(const struct sockaddr* address, socklen_t length,
     return 0;
 }
 
+bool StreamSocket::createPair(int type, mode_t mode,
+        Reference<StreamSocket>& first, Reference<StreamSocket>& second) {
+    Reference<ConnectionMutex> connectionMutex = new ConnectionMutex();
+    if (!connectionMutex) return false;
+    first = new StreamSocket(type, mode);
+    if (!first) return false;
+    second = new StreamSocket(type, mode, first, connectionMutex);
+    if (!second) return false;
+
+    first->peer = (StreamSocket*) second;
+    first->connectionMutex = connectionMutex;
+    first->isConnected = true;
+    return first->resizeReceiveBuffer() && second->resizeReceiveBuffer();
+}
+
+int StreamSocket::getsockopt(int level, int name, void* restrict value,
+        socklen_t* restrict length) {
+    if (level != SOL_SOCKET) {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    if (*length < (socklen_t) sizeof(int)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    AutoLock lock(&socketMutex);
+    if (name == SO_RCVBUF) {
+        *(int*) value = receiveBufferSize;
+    } else if (name == SO_SNDBUF) {
+        *(int*) value = sendBufferSize;
+    } else {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    *length = sizeof(int);
+    return 0;
+}
+
 int StreamSocket::listen(int /*backlog*/) {
     AutoLock lock(&socketMutex);
 
@@ -341,7 +341,9 @@ short StreamSocket::poll() {
         }
 
         if (peer) {
-            if (peer->circularBuffer.spaceAvailable()) {
+            size_t minimumSpace = type == SOCK_SEQPACKET ?
+                    sizeof(PacketHeader) + 1 : 1;
+            if (peer->circularBuffer.spaceAvailable() >= minimumSpace) {
                 result |= POLLOUT | POLLWRNORM;
             }
         } else {
@@ -353,113 +355,366 @@ short StreamSocket::poll() {
 }
 
 ssize_t StreamSocket::read(void* buffer, size_t size, int flags) {
+    struct iovec iov = { buffer, size };
+    return readv(&iov, 1, flags);
+}
+
+ssize_t StreamSocket::readv(const struct iovec* iov, int iovcnt, int flags) {
+    struct msghdr msg = {};
+    msg.msg_iov = (struct iovec*) iov;
+    msg.msg_iovlen = iovcnt;
+    return recvmsg(&msg, 0, flags);
+}
+
+ssize_t StreamSocket::recvmsg(struct msghdr* msg, int flags, int fileFlags) {
+    if (!__atomic_load_n(&isConnected, __ATOMIC_ACQUIRE) &&
+            !waitForConnection(fileFlags)) {
+        return -1;
+    }
+
+    msg->msg_namelen = 0;
+    msg->msg_flags = 0;
+    SocketRights* rights = nullptr;
+    size_t bytesRead;
+
     {
-        AutoLock lock(&socketMutex);
+        AutoLock lock(&connectionMutex->mutex);
+
+        while (circularBuffer.bytesAvailable() == 0) {
+            if (!peer) {
+                if (type == SOCK_SEQPACKET) {
+                    msg->msg_controllen = 0;
+                    return 0;
+                }
+                errno = ECONNRESET;
+                return -1;
+            }
 
-        while (isConnecting) {
-            if (flags & O_NONBLOCK) {
+            if (fileFlags & O_NONBLOCK) {
                 errno = EWOULDBLOCK;
                 return -1;
             }
 
-            if (kthread_cond_sigwait(&connectCond, &socketMutex) == EINTR) {
+            if (kthread_cond_sigwait(&receiveCond, &connectionMutex->mutex) ==
+                    EINTR) {
                 errno = EINTR;
                 return -1;
             }
         }
 
-        if (!isConnected) {
-            errno = ENOTCONN;
-            return -1;
+        SocketRights* nextRights = firstRights;
+        if (nextRights && nextRights->offset == readOffset) {
+            rights = nextRights;
+            nextRights = nextRights->next;
+        }
+
+        size_t consumed;
+        if (type == SOCK_SEQPACKET) {
+            PacketHeader length;
+            circularBuffer.peek(&length, sizeof(length), 0);
+            bytesRead = copyToIovec(circularBuffer, msg, sizeof(length),
+                    length);
+            if (bytesRead < length) {
+                msg->msg_flags |= MSG_TRUNC;
+            }
+            consumed = sizeof(length) + length;
+        } else {
+            // Data that rights were sent with is never merged with data that
+            // was written before it.
+            size_t available = circularBuffer.bytesAvailable();
+            if (nextRights && nextRights->offset - readOffset < available) {
+                available = nextRights->offset - readOffset;
+            }
+            bytesRead = copyToIovec(circularBuffer, msg, 0, available);
+            consumed = bytesRead;
+        }
+
+        if (flags & MSG_PEEK) {
+            rights = nullptr;
+        } else {
+            if (rights) {
+                dequeueRights();
+            }
+
+            size_t spaceBefore = circularBuffer.spaceAvailable();
+            circularBuffer.discard(consumed);
+            readOffset += consumed;
+
+            // The peer only waits when our receive buffer is full. To avoid
+            // waking it up for every read we wait until half of the buffer is
+            // free. Writers of packets might need more space than that.
+            size_t watermark = circularBuffer.capacity() / 2;
+            if (peer && (type == SOCK_SEQPACKET || (spaceBefore < watermark &&
+                    circularBuffer.spaceAvailable() >= watermark))) {
+                kthread_cond_broadcast(&peer->sendCond);
+                peer->notifyEventListeners();
+            }
+        }
+    }
+
+    // Installing file descriptors must not happen while holding the
+    // connection mutex because closing a file description might destroy a
+    // socket of this connection.
+    putRights(msg, rights, flags);
+    updateTimestamps(true, false, false);
+    return bytesRead;
+}
+
+// Resizes the receive buffer so that it satisfies both our SO_RCVBUF and the
+// SO_SNDBUF of the peer.
+bool StreamSocket::resizeReceiveBuffer() {
+    size_t size = receiveBufferSize;
+    if (peer && peer->sendBufferSize > size) {
+        size = peer->sendBufferSize;
+    }
+    return circularBuffer.resize(size);
+}
+
+ssize_t StreamSocket::sendmsg(const struct msghdr* msg, int flags,
+        int fileFlags) {
+    if (msg->msg_name && msg->msg_namelen) {
+        errno = EISCONN;
+        return -1;
+    }
+
+    size_t size = 0;
+    for (int i = 0; i < msg->msg_iovlen; i++) {
+        size += msg->msg_iov[i].iov_len;
+    }
+
+    SocketRights* rights;
+    if (!getRights(msg, &rights)) return -1;
+
+    ssize_t result = -1;
+    if (__atomic_load_n(&isConnected, __ATOMIC_ACQUIRE) ||
+            waitForConnection(fileFlags)) {
+        AutoLock lock(&connectionMutex->mutex);
+        if (type == SOCK_SEQPACKET) {
+            result = sendPacket(msg, size, rights, flags, fileFlags);
+        } else {
+            result = sendStream(msg, rights, flags, fileFlags);
         }
     }
 
-    AutoLock lock(&connectionMutex->mutex);
+    // Rights that were not sent are dropped without holding the connection
+    // mutex because this might destroy a socket of this connection.
+    delete rights;
+
+    if (result < 0 && errno == EPIPE && !(flags & MSG_NOSIGNAL)) {
+        siginfo_t siginfo = {};
+        siginfo.si_signo = SIGPIPE;
+        siginfo.si_code = SI_KERNEL;
+        Thread::current()->raiseSignal(siginfo);
+    }
+    if (result > 0) {
+        updateTimestampsLocked(false, true, true);
+    }
+    return result;
+}
 
-    while (circularBuffer.bytesAvailable() == 0) {
-        if (!peer) {
-            errno = ECONNRESET;
+// Sends a packet as a whole. The connection mutex must be held.
+ssize_t StreamSocket::sendPacket(const struct msghdr* msg, size_t size,
+        SocketRights*& rights, int /*flags*/, int fileFlags) {
+    size_t packetSize = sizeof(PacketHeader) + size;
+
+    while (peer && peer->circularBuffer.spaceAvailable() < packetSize) {
+        if (packetSize > peer->circularBuffer.capacity()) {
+            errno = EMSGSIZE;
             return -1;
         }
 
-        if (flags & O_NONBLOCK) {
+        if (fileFlags & O_NONBLOCK) {
             errno = EWOULDBLOCK;
             return -1;
         }
 
-        if (kthread_cond_sigwait(&receiveCond, &connectionMutex->mutex) ==
+        if (kthread_cond_sigwait(&sendCond, &connectionMutex->mutex) ==
                 EINTR) {
             errno = EINTR;
             return -1;
         }
     }
 
-    size_t bytesRead = circularBuffer.read(buffer, size);
+    if (!peer) {
+        errno = EPIPE;
+        return -1;
+    }
 
-    if (peer) {
-        kthread_cond_broadcast(&peer->sendCond);
+    if (rights && !peer->checkRights(rights)) return -1;
+
+    if (!peer->circularBuffer.reserve(packetSize)) {
+        errno = ENOMEM;
+        return -1;
     }
-    updateTimestamps(true, false, false);
-    return bytesRead;
+
+    if (rights) {
+        rights->offset = peer->writeOffset;
+        peer->queueRights(rights);
+        rights = nullptr;
+    }
+
+    bool wasEmpty = peer->circularBuffer.bytesAvailable() == 0;
+    PacketHeader header = size;
+    peer->circularBuffer.write(&header, sizeof(header));
+    for (int i = 0; i < msg->msg_iovlen; i++) {
+        peer->circularBuffer.write(msg->msg_iov[i].iov_base,
+                msg->msg_iov[i].iov_len);
+    }
+    peer->writeOffset += packetSize;
+
+    if (wasEmpty) {
+        kthread_cond_broadcast(&peer->receiveCond);
+        peer->notifyEventListeners();
+    }
+    return size;
 }
 
-ssize_t StreamSocket::write(const void* buffer, size_t size, int flags) {
-    {
-        AutoLock lock(&socketMutex);
+// Writes as much of the data as possible. The connection mutex must be held.
+ssize_t StreamSocket::sendStream(const struct msghdr* msg,
+        SocketRights*& rights, int /*flags*/, int fileFlags) {
+    size_t written = 0;
 
-        while (isConnecting) {
-            if (flags & O_NONBLOCK) {
-                errno = EWOULDBLOCK;
+    for (int i = 0; i < msg->msg_iovlen; i++) {
+        const char* buf = (const char*) msg->msg_iov[i].iov_base;
+        size_t length = msg->msg_iov[i].iov_len;
+        size_t bufferWritten = 0;
+
+        while (bufferWritten < length) {
+            while (peer && peer->circularBuffer.spaceAvailable() == 0) {
+                if (fileFlags & O_NONBLOCK) {
+                    if (written) return written;
+                    errno = EWOULDBLOCK;
+                    return -1;
+                }
+
+                if (kthread_cond_sigwait(&sendCond, &connectionMutex->mutex) ==
+                        EINTR) {
+                    if (written) return written;
+                    errno = EINTR;
+                    return -1;
+                }
+            }
+
+            if (!peer) {
+                errno = EPIPE;
                 return -1;
             }
 
-            if (kthread_cond_sigwait(&connectCond, &socketMutex) == EINTR) {
-                errno = EINTR;
+            // Rights are only sent with the first write.
+            if (rights && !peer->checkRights(rights)) return -1;
+
+            // The peer only waits when its receive buffer is empty.
+            bool wasEmpty = peer->circularBuffer.bytesAvailable() == 0;
+            size_t count = peer->circularBuffer.write(buf + bufferWritten,
+                    length - bufferWritten);
+            if (count == 0) {
+                // A page could not be allocated.
+                if (written) return written;
+                errno = ENOMEM;
                 return -1;
             }
+
+            // Rights are attached to the first byte written with them.
+            if (rights) {
+                rights->offset = peer->writeOffset;
+                peer->queueRights(rights);
+                rights = nullptr;
+            }
+
+            peer->writeOffset += count;
+            bufferWritten += count;
+            written += count;
+            if (wasEmpty) {
+                kthread_cond_broadcast(&peer->receiveCond);
+                peer->notifyEventListeners();
+            }
         }
+    }
 
-        if (!isConnected) {
-            errno = ENOTCONN;
-            return -1;
+    return written;
+}
+
+int StreamSocket::setsockopt(int level, int name, const void* value,
+        socklen_t length) {
+    if (level != SOL_SOCKET) {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    if (length != sizeof(int) || *(const int*) value < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t size = *(const int*) value;
+    if (size < PAGESIZE) size = PAGESIZE;
+    if (size > STREAM_SOCKET_MAX_BUFFER) size = STREAM_SOCKET_MAX_BUFFER;
+
+    AutoLock lock(&socketMutex);
+    if (name != SO_RCVBUF && name != SO_SNDBUF) {
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    if (!isConnected) {
+        if (name == SO_RCVBUF) {
+            receiveBufferSize = size;
+        } else {
+            sendBufferSize = size;
         }
+        return 0;
     }
 
-    AutoLock lock(&connectionMutex->mutex);
-    const char* buf = (const char*) buffer;
-    size_t written = 0;
+    // Resizing fails if the buffer currently holds more data than fits into
+    // the new size. In that case the buffer just keeps its old size.
+    AutoLock connectionLock(&connectionMutex->mutex);
+    if (name == SO_RCVBUF) {
+        receiveBufferSize = size;
+        resizeReceiveBuffer();
+    } else {
+        sendBufferSize = size;
+        if (peer) {
+            peer->resizeReceiveBuffer();
+        }
+    }
 
-    while (written < size) {
-        while (peer && peer->circularBuffer.spaceAvailable() == 0) {
-            if (flags & O_NONBLOCK) {
-                errno = EWOULDBLOCK;
-                return -1;
-            }
+    if (peer) {
+        kthread_cond_broadcast(&peer->sendCond);
+    }
+    kthread_cond_broadcast(&sendCond);
+    return 0;
+}
 
-            if (kthread_cond_sigwait(&sendCond, &connectionMutex->mutex) ==
-                    EINTR) {
-                if (written) {
-                    updateTimestamps(false, true, true);
-                    return written;
-                }
-                errno = EINTR;
-                return -1;
-            }
+bool StreamSocket::waitForConnection(int flags) {
+    AutoLock lock(&socketMutex);
+
+    while (isConnecting) {
+        if (flags & O_NONBLOCK) {
+            errno = EWOULDBLOCK;
+            return false;
         }
 
-        if (!peer) {
-            siginfo_t siginfo = {};
-            siginfo.si_signo = SIGPIPE;
-            siginfo.si_code = SI_KERNEL;
-            Thread::current()->raiseSignal(siginfo);
-            errno = EPIPE;
-            return -1;
+        if (kthread_cond_sigwait(&connectCond, &socketMutex) == EINTR) {
+            errno = EINTR;
+            return false;
         }
+    }
 
-        written += peer->circularBuffer.write(buf + written, size - written);
-        kthread_cond_broadcast(&peer->receiveCond);
+    if (!isConnected) {
+        errno = ENOTCONN;
+        return false;
     }
+    return true;
+}
 
-    updateTimestampsLocked(false, true, true);
-    return size;
+ssize_t StreamSocket::write(const void* buffer, size_t size, int flags) {
+    struct iovec iov = { (void*) buffer, size };
+    return writev(&iov, 1, flags);
+}
+
+ssize_t StreamSocket::writev(const struct iovec* iov, int iovcnt, int flags) {
+    struct msghdr msg = {};
+    msg.msg_iov = (struct iovec*) iov;
+    msg.msg_iovlen = iovcnt;
+    return sendmsg(&msg, 0, flags);
 }
@@ -0,0 +1,219 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/swap.cpp
+ * Swapping of anonymous memory.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <dennix/kernel/addressspace.h>
+#include <dennix/kernel/blockcache.h>
+#include <dennix/kernel/swap.h>
+
+#define BITS_PER_WORD (sizeof(size_t) * 8)
+
+// Swap slots are mapped to the block device once when swapping is enabled, so
+// that pages can be read and written without going through filesystems and
+// the block cache whose locks might be held while user memory is accessed.
+struct SwapExtent {
+    size_t firstSlot;
+    size_t slots;
+    off_t deviceOffset;
+};
+
+static kthread_mutex_t mutex = KTHREAD_MUTEX_INITIALIZER;
+static Reference<Vnode> swapVnode;
+static BlockCacheDevice* device;
+static SwapExtent* extents;
+static size_t extentCount;
+static size_t* bitmap;
+static size_t totalSlots;
+static size_t freeSlots;
+static size_t nextSlot;
+static bool enabled;
+
+static off_t getDeviceOffset(size_t slot) {
+    size_t low = 0;
+    size_t high = extentCount;
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (extents[middle].firstSlot <= slot) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    const SwapExtent& extent = extents[low];
+    return extent.deviceOffset + (slot - extent.firstSlot) * PAGESIZE;
+}
+
+static void* mapFrame(paddr_t physicalAddress) {
+#ifdef __x86_64__
+    return (void*) (DIRECT_MAP + physicalAddress);
+#else
+    return (void*) kernelSpace->mapPhysical(physicalAddress, PAGESIZE,
+            PROT_READ | PROT_WRITE);
+#endif
+}
+
+static void unmapFrame(void* page) {
+#ifdef __x86_64__
+    (void) page;
+#else
+    kernelSpace->unmapPhysical((vaddr_t) page, PAGESIZE);
+#endif
+}
+
+bool Swap::activate(const Reference<Vnode>& vnode) {
+    if (enabled) {
+        errno = EBUSY;
+        return false;
+    }
+
+    size_t slots = vnode->stat().st_size / PAGESIZE;
+    if (slots > SWAP_MAX_SLOTS) {
+        slots = SWAP_MAX_SLOTS;
+    }
+    // The first page is never used so that slot 0 can mean failure.
+    if (slots < 2) {
+        errno = EINVAL;
+        return false;
+    }
+
+    BlockCacheDevice* swapDevice = nullptr;
+    SwapExtent* newExtents = nullptr;
+    size_t newExtentCount = 0;
+
+    for (size_t slot = 1; slot < slots; slot++) {
+        BlockCacheDevice* pageDevice;
+        off_t offset = vnode->getDeviceOffset(slot * PAGESIZE, &pageDevice);
+        if (offset < 0 || (swapDevice && pageDevice != swapDevice)) {
+            free(newExtents);
+            errno = EINVAL;
+            return false;
+        }
+        swapDevice = pageDevice;
+
+        if (newExtentCount > 0) {
+            SwapExtent& last = newExtents[newExtentCount - 1];
+            if (last.deviceOffset + (off_t) (last.slots * PAGESIZE) ==
+                    offset) {
+                last.slots++;
+                continue;
+            }
+        }
+
+        SwapExtent* grown = (SwapExtent*) reallocarray(newExtents,
+                newExtentCount + 1, sizeof(SwapExtent));
+        if (!grown) {
+            free(newExtents);
+            return false;
+        }
+        newExtents = grown;
+        newExtents[newExtentCount].firstSlot = slot;
+        newExtents[newExtentCount].slots = 1;
+        newExtents[newExtentCount].deviceOffset = offset;
+        newExtentCount++;
+    }
+
+    size_t words = ALIGNUP(slots, BITS_PER_WORD) / BITS_PER_WORD;
+    size_t* newBitmap = (size_t*) calloc(words, sizeof(size_t));
+    if (!newBitmap) {
+        free(newExtents);
+        return false;
+    }
+    newBitmap[0] = 1;
+    // Slots beyond the end of the swap area are marked as used.
+    for (size_t slot = slots; slot < words * BITS_PER_WORD; slot++) {
+        newBitmap[slot / BITS_PER_WORD] |= (size_t) 1 << slot % BITS_PER_WORD;
+    }
+
+    AutoLock lock(&mutex);
+    if (enabled) {
+        free(newBitmap);
+        free(newExtents);
+        errno = EBUSY;
+        return false;
+    }
+
+    swapVnode = vnode;
+    device = swapDevice;
+    extents = newExtents;
+    extentCount = newExtentCount;
+    bitmap = newBitmap;
+    totalSlots = slots;
+    freeSlots = slots - 1;
+    nextSlot = 1;
+    enabled = true;
+    return true;
+}
+
+size_t Swap::allocateSlot() {
+    AutoLock lock(&mutex);
+    if (freeSlots == 0) return 0;
+
+    size_t words = ALIGNUP(totalSlots, BITS_PER_WORD) / BITS_PER_WORD;
+    size_t word = nextSlot / BITS_PER_WORD;
+    while (bitmap[word] == (size_t) -1) {
+        word = (word + 1) % words;
+    }
+
+    size_t bit = __builtin_ctzl(~bitmap[word]);
+    bitmap[word] |= (size_t) 1 << bit;
+    freeSlots--;
+
+    size_t slot = word * BITS_PER_WORD + bit;
+    nextSlot = slot + 1 < totalSlots ? slot + 1 : 1;
+    return slot;
+}
+
+void Swap::freeSlot(size_t slot) {
+    AutoLock lock(&mutex);
+    assert(slot > 0 && slot < totalSlots);
+    assert(bitmap[slot / BITS_PER_WORD] & (size_t) 1 << slot % BITS_PER_WORD);
+    bitmap[slot / BITS_PER_WORD] &= ~((size_t) 1 << slot % BITS_PER_WORD);
+    freeSlots++;
+}
+
+void Swap::getUsage(size_t* total, size_t* free) {
+    AutoLock lock(&mutex);
+    *total = enabled ? totalSlots - 1 : 0;
+    *free = freeSlots;
+}
+
+bool Swap::isEnabled() {
+    return enabled;
+}
+
+bool Swap::readPage(size_t slot, paddr_t physicalAddress) {
+    void* page = mapFrame(physicalAddress);
+    if (!page) return false;
+    bool result = device->readUncached(page, PAGESIZE, getDeviceOffset(slot),
+            0);
+    unmapFrame(page);
+    return result;
+}
+
+bool Swap::writePage(size_t slot, paddr_t physicalAddress) {
+    void* page = mapFrame(physicalAddress);
+    if (!page) return false;
+    bool result = device->writeUncached(page, PAGESIZE, getDeviceOffset(slot),
+            0);
+    unmapFrame(page);
+    return result;
+}
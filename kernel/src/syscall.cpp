@@ -18,24 +18,35 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include <sched.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <dennix/fchownat.h>
 #include <dennix/fcntl.h>
+#include <dennix/futex.h>
+#include <dennix/splice.h>
 #include <dennix/wait.h>
 #include <dennix/kernel/addressspace.h>
 #include <dennix/kernel/clock.h>
+#include <dennix/kernel/datagramsocket.h>
+#include <dennix/kernel/eventqueue.h>
 #include <dennix/kernel/ext234.h>
+#include <dennix/kernel/file.h>
+#include <dennix/kernel/futex.h>
 #include <dennix/kernel/log.h>
 #include <dennix/kernel/pipe.h>
 #include <dennix/kernel/process.h>
 #include <dennix/kernel/signal.h>
 #include <dennix/kernel/streamsocket.h>
+#include <dennix/kernel/swap.h>
 #include <dennix/kernel/syscall.h>
+#include <dennix/kernel/trace.h>
+#include <dennix/kernel/vdso.h>
 
 static const void* syscallList[NUM_SYSCALLS] = {
     /*[SYSCALL_EXIT] =*/ (void*) Syscall::exit,
@@ -101,6 +112,25 @@ static const void* syscallList[NUM_SYSCALLS] = {
     /*[SYSCALL_FSSYNC] =*/ (void*) Syscall::fssync,
     /*[SYSCALL_FCHOWN] =*/ (void*) Syscall::fchown,
     /*[SYSCALL_SETSID] =*/ (void*) Syscall::setsid,
+    /*[SYSCALL_READV] =*/ (void*) Syscall::readv,
+    /*[SYSCALL_WRITEV] =*/ (void*) Syscall::writev,
+    /*[SYSCALL_PREADV] =*/ (void*) Syscall::preadv,
+    /*[SYSCALL_PWRITEV] =*/ (void*) Syscall::pwritev,
+    /*[SYSCALL_SENDFILE] =*/ (void*) Syscall::sendfile,
+    /*[SYSCALL_COPY_FILE_RANGE] =*/ (void*) Syscall::copy_file_range,
+    /*[SYSCALL_SPLICE] =*/ (void*) Syscall::splice,
+    /*[SYSCALL_EPOLL_CREATE1] =*/ (void*) Syscall::epoll_create1,
+    /*[SYSCALL_EPOLL_CTL] =*/ (void*) Syscall::epoll_ctl,
+    /*[SYSCALL_EPOLL_PWAIT2] =*/ (void*) Syscall::epoll_pwait2,
+    /*[SYSCALL_GETSOCKOPT] =*/ (void*) Syscall::getsockopt,
+    /*[SYSCALL_SETSOCKOPT] =*/ (void*) Syscall::setsockopt,
+    /*[SYSCALL_SOCKETPAIR] =*/ (void*) Syscall::socketpair,
+    /*[SYSCALL_RECVMSG] =*/ (void*) Syscall::recvmsg,
+    /*[SYSCALL_SENDMSG] =*/ (void*) Syscall::sendmsg,
+    /*[SYSCALL_FUTEX] =*/ (void*) Syscall::futex,
+    /*[SYSCALL_EXIT_THREAD] =*/ (void*) Syscall::exit_thread,
+    /*[SYSCALL_SET_THREAD_POINTER] =*/ (void*) Syscall::set_thread_pointer,
+    /*[SYSCALL_SWAPON] =*/ (void*) Syscall::swapon,
 };
 
 static Reference<FileDescription> getRootFd(int fd, const char* path) {
@@ -120,7 +150,26 @@ static Reference<Vnode> resolvePathExceptLastComponent(int fd, const char* path,
     return resolvePathExceptLastComponent(descr->vnode, path, lastComponent);
 }
 
+static bool isValidIovec(const struct iovec* iov, int iovcnt) {
+    if (iovcnt <= 0 || iovcnt > IOV_MAX) {
+        errno = EINVAL;
+        return false;
+    }
+
+    size_t totalSize = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (__builtin_add_overflow(totalSize, iov[i].iov_len, &totalSize) ||
+                totalSize > SSIZE_MAX) {
+            errno = EINVAL;
+            return false;
+        }
+    }
+    return true;
+}
+
 extern "C" const void* getSyscallHandler(unsigned interruptNumber) {
+    Thread::current()->counters.syscalls++;
+    TRACE(TRACE_SYSCALL_ENTER, interruptNumber, 0);
     if (interruptNumber >= NUM_SYSCALLS) {
         return (void*) Syscall::badSyscall;
     } else {
@@ -192,6 +241,32 @@ int Syscall::connect(int fd, const struct sockaddr* address, socklen_t length) {
     return descr->connect(address, length);
 }
 
+ssize_t Syscall::copy_file_range(struct spliceParams* params) {
+    if (params->flags) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    Reference<FileDescription> in = Process::current()->getFd(params->inFd);
+    if (!in) return -1;
+    Reference<FileDescription> out = Process::current()->getFd(params->outFd);
+    if (!out) return -1;
+
+    mode_t inMode = in->vnode->stat().st_mode;
+    mode_t outMode = out->vnode->stat().st_mode;
+    if (S_ISDIR(inMode) || S_ISDIR(outMode)) {
+        errno = EISDIR;
+        return -1;
+    }
+    if (!S_ISREG(inMode) || !S_ISREG(outMode)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return in->splice(out, params->inOffset, params->outOffset,
+            params->length, 0);
+}
+
 int Syscall::devctl(int fd, int command, void* restrict data, size_t size,
         int* restrict info) {
     int dummy;
@@ -213,6 +288,78 @@ int Syscall::dup3(int fd1, int fd2, int flags) {
     return Process::current()->dup3(fd1, fd2, flags);
 }
 
+int Syscall::epoll_create1(int flags) {
+    if (flags & ~(EPOLL_CLOEXEC | EPOLL_CLOFORK)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    Reference<Vnode> queue = new EventQueue();
+    if (!queue) return -1;
+    Reference<FileDescription> descr = new FileDescription(queue, O_RDWR);
+    if (!descr) return -1;
+
+    int fdFlags = 0;
+    if (flags & EPOLL_CLOEXEC) fdFlags |= FD_CLOEXEC;
+    if (flags & EPOLL_CLOFORK) fdFlags |= FD_CLOFORK;
+    return Process::current()->addFileDescriptor(descr, fdFlags);
+}
+
+int Syscall::epoll_ctl(int epfd, int op, int fd, struct epoll_event* event) {
+    Reference<FileDescription> queueDescr = Process::current()->getFd(epfd);
+    if (!queueDescr) return -1;
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+
+    if (!queueDescr->vnode->isEventQueue() ||
+            (op != EPOLL_CTL_DEL && !event)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    Reference<EventQueue> queue = (Reference<EventQueue>) queueDescr->vnode;
+    return queue->control(op, fd, (FileDescription*) descr, event);
+}
+
+int Syscall::epoll_pwait2(int epfd, struct epoll_event* events, int maxEvents,
+        const struct timespec* timeout, const sigset_t* sigmask) {
+    Reference<FileDescription> descr = Process::current()->getFd(epfd);
+    if (!descr) return -1;
+
+    if (!descr->vnode->isEventQueue() || maxEvents <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct timespec endTime;
+    if (timeout) {
+        if (timeout->tv_nsec < 0 || timeout->tv_nsec >= 1000000000L) {
+            errno = EINVAL;
+            return -1;
+        }
+        struct timespec now;
+        Clock::get(CLOCK_MONOTONIC)->getTime(&now);
+        endTime = timespecPlus(now, *timeout);
+    }
+
+    sigset_t oldMask;
+    if (sigmask) {
+        sigprocmask(SIG_SETMASK, sigmask, &oldMask);
+    }
+
+    Reference<EventQueue> queue = (Reference<EventQueue>) descr->vnode;
+    int result = queue->wait(events, maxEvents, timeout ? &endTime : nullptr);
+
+    if (sigmask) {
+        if (result < 0 && errno == EINTR) {
+            Thread::current()->returnSignalMask = oldMask;
+        } else {
+            sigprocmask(SIG_SETMASK, &oldMask, nullptr);
+        }
+    }
+    return result;
+}
+
 int Syscall::execve(const char* path, char* const argv[], char* const envp[]) {
     Reference<FileDescription> descr = getRootFd(AT_FDCWD, path);
     Reference<Vnode> vnode = resolvePath(descr->vnode, path);
@@ -232,6 +379,24 @@ NORETURN void Syscall::exit(int status) {
     __builtin_unreachable();
 }
 
+NORETURN void Syscall::exit_thread(void* unmapAddress, size_t unmapSize,
+        int* clearAddress) {
+    Process* process = Process::current();
+
+    if (clearAddress) {
+        __atomic_store_n(clearAddress, 0, __ATOMIC_RELEASE);
+        Futex::wake(process->addressSpace, clearAddress, INT_MAX);
+    }
+
+    // This allows a detached thread to free its own stack.
+    if (unmapSize && PAGE_ALIGNED((vaddr_t) unmapAddress)) {
+        process->addressSpace->unmapMemory((vaddr_t) unmapAddress,
+                ALIGNUP(unmapSize, PAGESIZE));
+    }
+
+    process->exitThread();
+}
+
 int Syscall::fchdir(int fd) {
     Reference<FileDescription> descr = Process::current()->getFd(fd);
     if (!descr) return -1;
@@ -342,6 +507,35 @@ int Syscall::ftruncate(int fd, off_t length) {
     return descr->vnode->ftruncate(length);
 }
 
+int Syscall::futex(int* address, int op, int value,
+        const struct timespec* timeout) {
+    if ((uintptr_t) address % alignof(int) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    AddressSpace* addressSpace = Process::current()->addressSpace;
+
+    if (op == FUTEX_WAIT) {
+        // The timeout is an absolute time measured by CLOCK_REALTIME.
+        if (timeout && (timeout->tv_nsec < 0 ||
+                timeout->tv_nsec >= 1000000000L)) {
+            errno = EINVAL;
+            return -1;
+        }
+        return Futex::wait(addressSpace, address, value, timeout);
+    } else if (op == FUTEX_WAKE) {
+        if (value < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        return Futex::wake(addressSpace, address, value);
+    }
+
+    errno = EINVAL;
+    return -1;
+}
+
 int Syscall::futimens(int fd, const struct timespec ts[2]) {
     static struct timespec nullTs[2] = {{ 0, UTIME_NOW }, { 0, UTIME_NOW }};
     if (!ts) {
@@ -403,6 +597,13 @@ int Syscall::getrusagens(int who, struct rusagens* usage) {
     return 0;
 }
 
+int Syscall::getsockopt(int fd, int level, int name, void* restrict value,
+        socklen_t* restrict length) {
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->vnode->getsockopt(level, name, value, length);
+}
+
 int Syscall::isatty(int fd) {
     Reference<FileDescription> descr = Process::current()->getFd(fd);
     if (!descr) return 0;
@@ -455,19 +656,68 @@ int Syscall::mkdirat(int fd, const char* path, mode_t mode) {
 }
 
 static void* mmapImplementation(void* /*addr*/, size_t size,
-        int protection, int flags, int /*fd*/, off_t /*offset*/) {
-    if (size == 0 || !(flags & MAP_PRIVATE)) {
+        int protection, int flags, int fd, off_t offset) {
+    if (size == 0 || size > SIZE_MAX - PAGESIZE ||
+            !(flags & MAP_PRIVATE) == !(flags & MAP_SHARED)) {
         errno = EINVAL;
         return MAP_FAILED;
     }
 
+    AddressSpace* addressSpace = Process::current()->addressSpace;
+    size = ALIGNUP(size, PAGESIZE);
+    protection &= _PROT_FLAGS;
+
+    if (flags & MAP_HUGETLB) {
+#ifdef __x86_64__
+        // Large pages are only supported for private anonymous memory.
+        if (!(flags & MAP_ANONYMOUS) || flags & MAP_SHARED ||
+                size > SIZE_MAX - LARGE_PAGESIZE) {
+            errno = EINVAL;
+            return MAP_FAILED;
+        }
+        size = ALIGNUP(size, LARGE_PAGESIZE);
+        vaddr_t result = addressSpace->mapMemory(size,
+                protection | PROT_ZERO | PROT_LARGE_PAGES);
+        if (!result) errno = ENOMEM;
+        return (void*) result;
+#else
+        errno = ENOTSUP;
+        return MAP_FAILED;
+#endif
+    }
+
+    if (flags & MAP_SHARED) {
+        Reference<Vnode> vnode;
+        if (flags & MAP_ANONYMOUS) {
+            // Anonymous shared memory is backed by an unnamed file so that it
+            // stays shared with child processes after fork.
+            vnode = new FileVnode(nullptr, 0, 0600, 0);
+            if (!vnode || vnode->ftruncate(size) < 0) return MAP_FAILED;
+            offset = 0;
+        } else {
+            Reference<FileDescription> descr = Process::current()->getFd(fd);
+            if (!descr) return MAP_FAILED;
+
+            int fileFlags = descr->fcntl(F_GETFL, 0);
+            if (!(fileFlags & O_RDONLY) ||
+                    (protection & PROT_WRITE && !(fileFlags & O_WRONLY))) {
+                errno = EACCES;
+                return MAP_FAILED;
+            }
+            vnode = descr->vnode;
+        }
+
+        return (void*) addressSpace->mapShared(vnode, offset, size,
+                protection);
+    }
+
     if (flags & MAP_ANONYMOUS) {
-        AddressSpace* addressSpace = Process::current()->addressSpace;
-        return (void*) addressSpace->mapMemory(ALIGNUP(size, PAGESIZE),
-                protection & _PROT_FLAGS);
+        vaddr_t result = addressSpace->mapMemory(size, protection | PROT_ZERO);
+        if (!result) errno = ENOMEM;
+        return (void*) result;
     }
 
-    // TODO: Implement other flags than MAP_ANONYMOUS
+    // TODO: Implement private file mappings.
     errno = ENOTSUP;
     return MAP_FAILED;
 }
@@ -520,9 +770,20 @@ int Syscall::munmap(void* addr, size_t size) {
         return -1;
     }
 
-    AddressSpace* addressSpace = Process::current()->addressSpace;
+    Process* process = Process::current();
+    vaddr_t address = (vaddr_t) addr;
+    size = ALIGNUP(size, 0x1000);
+    // The vDSO page is shared with all other processes.
+    if (address < process->vdso + VDSO_SIZE && address + size > process->vdso) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    AddressSpace* addressSpace = process->addressSpace;
     //TODO: The userspace process could unmap kernel pages!
-    addressSpace->unmapMemory((vaddr_t) addr, ALIGNUP(size, 0x1000));
+    if (!addressSpace->unmapMemory(address, size)) {
+        return -1;
+    }
     return 0;
 }
 
@@ -591,6 +852,7 @@ int Syscall::ppoll(struct pollfd fds[], nfds_t nfds,
     }
 
     int events = 0;
+    AutoWaitChannel waitChannel("poll");
     while (true) {
         for (nfds_t i = 0; i < nfds; i++) {
             int fd = fds[i].fd;
@@ -638,6 +900,22 @@ int Syscall::ppoll(struct pollfd fds[], nfds_t nfds,
     }
 }
 
+ssize_t Syscall::preadv(int fd, const struct iovec* iov, int iovcnt,
+        off_t offset) {
+    if (!isValidIovec(iov, iovcnt)) return -1;
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->preadv(iov, iovcnt, offset);
+}
+
+ssize_t Syscall::pwritev(int fd, const struct iovec* iov, int iovcnt,
+        off_t offset) {
+    if (!isValidIovec(iov, iovcnt)) return -1;
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->pwritev(iov, iovcnt, offset);
+}
+
 ssize_t Syscall::read(int fd, void* buffer, size_t size) {
     Reference<FileDescription> descr = Process::current()->getFd(fd);
     if (!descr) return -1;
@@ -656,15 +934,32 @@ ssize_t Syscall::readlinkat(int fd, const char* restrict path,
 }
 
 pid_t Syscall::regfork(int flags, regfork_t* registers) {
+    if (flags == RFTHREAD) {
+        return Process::current()->createThread(registers);
+    }
+
     if (!((flags & RFPROC) && (flags & RFFDG))) {
         errno = EINVAL;
         return -1;
     }
 
-    Process* newProcess = Process::current()->regfork(flags, registers);
-    if (!newProcess) return -1;
+    return Process::current()->regfork(flags, registers);
+}
 
-    return newProcess->pid;
+ssize_t Syscall::readv(int fd, const struct iovec* iov, int iovcnt) {
+    if (!isValidIovec(iov, iovcnt)) return -1;
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->readv(iov, iovcnt);
+}
+
+ssize_t Syscall::recvmsg(int fd, struct msghdr* msg, int flags) {
+    if (msg->msg_iovlen != 0 && !isValidIovec(msg->msg_iov, msg->msg_iovlen)) {
+        return -1;
+    }
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->recvmsg(msg, flags);
 }
 
 int Syscall::renameat(int oldFd, const char* oldPath, int newFd,
@@ -690,6 +985,38 @@ int Syscall::renameat(int oldFd, const char* oldPath, int newFd,
     return newDirectory->rename(oldDirectory, oldName, newName);
 }
 
+ssize_t Syscall::sendfile(int outFd, int inFd, off_t* offset, size_t count) {
+    Reference<FileDescription> in = Process::current()->getFd(inFd);
+    if (!in) return -1;
+    Reference<FileDescription> out = Process::current()->getFd(outFd);
+    if (!out) return -1;
+
+    if (!in->vnode->isSeekable()) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return in->splice(out, offset, nullptr, count, 0);
+}
+
+ssize_t Syscall::sendmsg(int fd, const struct msghdr* msg, int flags) {
+    if (msg->msg_iovlen != 0 && !isValidIovec(msg->msg_iov, msg->msg_iovlen)) {
+        return -1;
+    }
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->sendmsg(msg, flags);
+}
+
+int Syscall::set_thread_pointer(void* pointer) {
+    Thread* thread = Thread::current();
+    Interrupts::disable();
+    thread->tlsBase = (vaddr_t) pointer;
+    setThreadPointer(thread->tlsBase);
+    Interrupts::enable();
+    return 0;
+}
+
 int Syscall::setpgid(pid_t pid, pid_t pgid) {
     if (pgid < 0) {
         errno = EINVAL;
@@ -722,6 +1049,13 @@ pid_t Syscall::setsid() {
     return Process::current()->setsid();
 }
 
+int Syscall::setsockopt(int fd, int level, int name, const void* value,
+        socklen_t length) {
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->vnode->setsockopt(level, name, value, length);
+}
+
 int Syscall::sigtimedwait(const sigset_t* set, siginfo_t* info,
         const struct timespec* timeout) {
     return Thread::current()->sigtimedwait(set, info, timeout);
@@ -731,13 +1065,23 @@ int Syscall::socket(int domain, int type, int protocol) {
     Reference<Vnode> socket;
 
     if (domain == AF_UNIX) {
-        if ((type & ~_SOCK_FLAGS) == SOCK_STREAM) {
+        int socketType = type & ~_SOCK_FLAGS;
+        mode_t mode = 0666 & ~Process::current()->umask;
+        if (socketType == SOCK_STREAM || socketType == SOCK_SEQPACKET) {
             if (protocol != 0) {
                 errno = EPROTONOSUPPORT;
                 return -1;
             }
 
-            socket = new StreamSocket(0666 & ~Process::current()->umask);
+            socket = new StreamSocket(socketType, mode);
+            if (!socket) return -1;
+        } else if (socketType == SOCK_DGRAM) {
+            if (protocol != 0) {
+                errno = EPROTONOSUPPORT;
+                return -1;
+            }
+
+            socket = new DatagramSocket(mode);
             if (!socket) return -1;
         } else {
             errno = ESOCKTNOSUPPORT;
@@ -759,6 +1103,95 @@ int Syscall::socket(int domain, int type, int protocol) {
     return Process::current()->addFileDescriptor(descr, fdFlags);
 }
 
+int Syscall::socketpair(int domain, int type, int protocol, int fd[2]) {
+    if (domain != AF_UNIX) {
+        errno = EAFNOSUPPORT;
+        return -1;
+    }
+    int socketType = type & ~_SOCK_FLAGS;
+    if (socketType == SOCK_DGRAM) {
+        // Datagram sockets are only connected by address.
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    if (socketType != SOCK_STREAM && socketType != SOCK_SEQPACKET) {
+        errno = ESOCKTNOSUPPORT;
+        return -1;
+    }
+    if (protocol != 0) {
+        errno = EPROTONOSUPPORT;
+        return -1;
+    }
+
+    Reference<StreamSocket> socket0;
+    Reference<StreamSocket> socket1;
+    if (!StreamSocket::createPair(socketType,
+            0666 & ~Process::current()->umask, socket0, socket1)) {
+        return -1;
+    }
+
+    int fileFlags = O_RDWR;
+    if (type & SOCK_NONBLOCK) fileFlags |= O_NONBLOCK;
+    Reference<FileDescription> descr0 = new FileDescription(socket0,
+            fileFlags);
+    if (!descr0) return -1;
+    Reference<FileDescription> descr1 = new FileDescription(socket1,
+            fileFlags);
+    if (!descr1) return -1;
+
+    int fdFlags = 0;
+    if (type & SOCK_CLOEXEC) fdFlags |= FD_CLOEXEC;
+    if (type & SOCK_CLOFORK) fdFlags |= FD_CLOFORK;
+
+    int fd0 = Process::current()->addFileDescriptor(descr0, fdFlags);
+    if (fd0 < 0) return -1;
+    int fd1 = Process::current()->addFileDescriptor(descr1, fdFlags);
+    if (fd1 < 0) {
+        int oldErrno = errno;
+        Process::current()->close(fd0);
+        errno = oldErrno;
+        return -1;
+    }
+
+    fd[0] = fd0;
+    fd[1] = fd1;
+    return 0;
+}
+
+ssize_t Syscall::splice(struct spliceParams* params) {
+    if (params->flags & ~(SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    Reference<FileDescription> in = Process::current()->getFd(params->inFd);
+    if (!in) return -1;
+    Reference<FileDescription> out = Process::current()->getFd(params->outFd);
+    if (!out) return -1;
+
+    bool inIsPipe = S_ISFIFO(in->vnode->stat().st_mode);
+    bool outIsPipe = S_ISFIFO(out->vnode->stat().st_mode);
+    if (!inIsPipe && !outIsPipe) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((inIsPipe && params->inOffset) || (outIsPipe && params->outOffset)) {
+        errno = ESPIPE;
+        return -1;
+    }
+
+    int flags = params->flags & SPLICE_F_NONBLOCK ? O_NONBLOCK : 0;
+    return in->splice(out, params->inOffset, params->outOffset,
+            params->length, flags);
+}
+
+int Syscall::swapon(const char* path) {
+    Reference<Vnode> vnode = resolvePath(getRootFd(AT_FDCWD, path)->vnode,
+            path);
+    if (!vnode) return -1;
+    return Swap::activate(vnode) ? 0 : -1;
+}
+
 int Syscall::symlinkat(const char* targetPath, int fd, const char* linkPath) {
     const char* name;
     Reference<Vnode> vnode = resolvePathExceptLastComponent(fd, linkPath,
@@ -866,6 +1299,13 @@ ssize_t Syscall::write(int fd, const void* buffer, size_t size) {
     return descr->write(buffer, size);
 }
 
+ssize_t Syscall::writev(int fd, const struct iovec* iov, int iovcnt) {
+    if (!isValidIovec(iov, iovcnt)) return -1;
+    Reference<FileDescription> descr = Process::current()->getFd(fd);
+    if (!descr) return -1;
+    return descr->writev(iov, iovcnt);
+}
+
 void Syscall::badSyscall() {
     siginfo_t siginfo = {};
     siginfo.si_signo = SIGSYS;
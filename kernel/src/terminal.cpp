@@ -72,6 +72,7 @@ void Terminal::handleCharacter(char c) {
         } else {
             numEof++;
             kthread_cond_broadcast(&readCond);
+            notifyEventListeners();
         }
     } else if (termio.c_lflag & ICANON && c == termio.c_cc[VERASE]) {
         if (backspace() && (termio.c_lflag & ECHOE)) {
@@ -127,6 +128,7 @@ void Terminal::hangup() {
 
     hungup = true;
     kthread_cond_broadcast(&readCond);
+    notifyEventListeners();
 }
 
 int Terminal::devctl(int command, void* restrict data, size_t size,
@@ -430,6 +432,7 @@ bool Terminal::canWriteBuffer() {
 void Terminal::endLine() {
     lineIndex = writeIndex;
     kthread_cond_broadcast(&readCond);
+    notifyEventListeners();
 }
 
 bool Terminal::hasIncompleteLine() {
@@ -20,8 +20,10 @@
 #include <assert.h>
 #include <sched.h>
 #include <string.h>
+#include <dennix/kernel/panic.h>
 #include <dennix/kernel/process.h>
 #include <dennix/kernel/registers.h>
+#include <dennix/kernel/trace.h>
 #include <dennix/kernel/worker.h>
 
 Thread* Thread::_current;
@@ -32,6 +34,7 @@ __fpu_t initFpu;
 
 Thread::Thread(Process* process) {
     contextChanged = false;
+    counters = {};
     interruptContext = nullptr;
     kernelStack = 0;
     next = nullptr;
@@ -42,15 +45,25 @@ Thread::Thread(Process* process) {
     signalMask = 0;
     signalMutex = KTHREAD_MUTEX_INITIALIZER;
     signalCond = KTHREAD_COND_INITIALIZER;
+    sleeping = false;
+    tid = -1;
+    tlsBase = 0;
+    waitChannel = nullptr;
 }
 
 Thread::~Thread() {
+    while (pendingSignals) {
+        PendingSignal* pending = pendingSignals;
+        pendingSignals = pending->next;
+        delete pending;
+    }
     kernelSpace->unmapMemory(kernelStack, PAGESIZE);
 }
 
 void Thread::initializeIdleThread() {
     Process* idleProcess = xnew Process();
     idleProcess->addressSpace = kernelSpace;
+    strlcpy(idleProcess->name, "idle", sizeof(idleProcess->name));
     Process::addProcess(idleProcess);
     assert(idleProcess->pid == 0);
     idleThread = &idleProcess->mainThread;
@@ -67,6 +80,37 @@ void Thread::addThread(Thread* thread) {
     Interrupts::enable();
 }
 
+// Creates a thread in the idle process that runs the given function. The
+// function must never return.
+Thread* Thread::createKernelThread(void (*function)(void)) {
+    Thread* thread = xnew Thread(idleThread->process);
+    vaddr_t stack = kernelSpace->mapMemory(PAGESIZE, PROT_READ | PROT_WRITE);
+    if (!stack) PANIC("Failed to allocate stack for kernel thread");
+    InterruptContext* context = (InterruptContext*)
+            (stack + PAGESIZE - sizeof(InterruptContext));
+    *context = {};
+
+#ifdef __i386__
+    context->eip = (vaddr_t) function;
+    context->cs = 0x8;
+    context->eflags = 0x200;
+    context->esp = stack + PAGESIZE - sizeof(void*);
+    context->ss = 0x10;
+#elif defined(__x86_64__)
+    context->rip = (vaddr_t) function;
+    context->cs = 0x8;
+    context->rflags = 0x200;
+    context->rsp = stack + PAGESIZE - sizeof(void*);
+    context->ss = 0x10;
+#else
+#  error "InterruptContext in kernel thread is uninitialized."
+#endif
+
+    thread->updateContext(stack, context, &initFpu);
+    addThread(thread);
+    return thread;
+}
+
 void Thread::removeThread(Thread* thread) {
     if (thread->prev) {
         thread->prev->next = thread->next;
@@ -79,7 +123,8 @@ void Thread::removeThread(Thread* thread) {
     }
 }
 
-InterruptContext* Thread::schedule(InterruptContext* context) {
+InterruptContext* Thread::schedule(InterruptContext* context,
+        bool voluntary) {
     if (likely(!_current->contextChanged)) {
         _current->interruptContext = context;
         Registers::saveFpu(&_current->fpuEnv);
@@ -87,17 +132,34 @@ InterruptContext* Thread::schedule(InterruptContext* context) {
         _current->contextChanged = false;
     }
 
-    if (_current->next) {
-        _current = _current->next;
-    } else {
-        if (firstThread) {
-            _current = firstThread;
+    struct timespec now;
+    Clock::get(CLOCK_MONOTONIC)->getTime(&now);
+
+    // Sleeping threads are skipped. The idle thread runs if no other thread is
+    // runnable.
+    Thread* first = _current->next ? _current->next : firstThread;
+    Thread* next = first;
+    while (next && !next->isRunnable(now)) {
+        next = next->next ? next->next : firstThread;
+        if (next == first) {
+            next = nullptr;
+        }
+    }
+    if (!next) {
+        next = idleThread;
+    }
+    if (next != _current) {
+        if (voluntary) {
+            _current->counters.voluntarySwitches++;
         } else {
-            _current = idleThread;
+            _current->counters.involuntarySwitches++;
         }
     }
+    TRACE(TRACE_SCHEDULE, next->process->pid, next->tid);
+    _current = next;
 
     setKernelStack(_current->kernelStack + PAGESIZE);
+    setThreadPointer(_current->tlsBase);
     Registers::restoreFpu(&_current->fpuEnv);
 
     _current->process->addressSpace->activate();
@@ -106,6 +168,49 @@ InterruptContext* Thread::schedule(InterruptContext* context) {
     return _current->interruptContext;
 }
 
+bool Thread::isRunnable(const struct timespec& now) {
+    if (!sleeping) return true;
+    if (wakeTime.tv_nsec != -1 && !timespecLess(now, wakeTime)) {
+        sleeping = false;
+        return true;
+    }
+    return false;
+}
+
+// Blocks the current thread until it is woken or the given CLOCK_MONOTONIC
+// time is reached. This must be called with interrupts disabled and the caller
+// needs to recheck whether it should continue sleeping afterwards.
+void Thread::sleep(const struct timespec* wakeTime) {
+    _current->sleeping = true;
+    if (wakeTime) {
+        _current->wakeTime = *wakeTime;
+    } else {
+        _current->wakeTime.tv_nsec = -1;
+    }
+    sched_yield();
+}
+
+static void deleteThread(void* thread) {
+    delete (Thread*) thread;
+}
+
+void Thread::terminate(bool destroy) {
+    // This function must be called by the thread itself with interrupts
+    // disabled. The thread is deleted by the worker thread once it no longer
+    // runs on its kernel stack.
+    assert(this == _current);
+    removeThread(this);
+
+    if (destroy) {
+        deleteJob.func = deleteThread;
+        deleteJob.context = this;
+        WorkerThread::addJob(&deleteJob, WORKER_PRIORITY_LOW);
+    }
+
+    sched_yield();
+    __builtin_unreachable();
+}
+
 static void deallocateStack(void* address) {
     kernelSpace->unmapMemory((vaddr_t) address, PAGESIZE);
 }
@@ -127,7 +232,7 @@ void Thread::updateContext(vaddr_t newKernelStack, InterruptContext* newContext,
         if (oldKernelStack) {
             job.func = deallocateStack;
             job.context = (void*) oldKernelStack;
-            WorkerThread::addJob(&job);
+            WorkerThread::addJob(&job, WORKER_PRIORITY_LOW);
         }
 
         sched_yield();
@@ -138,3 +243,8 @@ void Thread::updateContext(vaddr_t newKernelStack, InterruptContext* newContext,
 
     Interrupts::enable();
 }
+
+// Wakes a sleeping thread. This must be called with interrupts disabled.
+void Thread::wake() {
+    sleeping = false;
+}
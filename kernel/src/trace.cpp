@@ -0,0 +1,203 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/trace.cpp
+ * Kernel tracing.
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <dennix/kernel/addressspace.h>
+#include <dennix/kernel/clock.h>
+#include <dennix/kernel/devices.h>
+#include <dennix/kernel/process.h>
+#include <dennix/kernel/trace.h>
+
+#define BUFFER_ENTRIES 8192 // must be a power of two
+
+struct TraceSlot {
+    // Index of the event in this slot plus one or zero while it is written.
+    unsigned long sequence;
+    struct trace_event event;
+};
+
+volatile unsigned int traceEvents;
+
+// The kernel runs on a single cpu so there is only one ring buffer. Writers
+// reserve slots with an atomic increment so that tracepoints never block and
+// can be used in interrupt handlers.
+static TraceSlot* ringBuffer;
+static unsigned long head;
+static unsigned long tail;
+static uint64_t lost;
+static uint64_t frequency;
+static kthread_mutex_t traceMutex = KTHREAD_MUTEX_INITIALIZER;
+
+static inline uint64_t readTimestamp() {
+    uint32_t low;
+    uint32_t high;
+    asm volatile ("rdtsc" : "=a"(low), "=d"(high));
+    return (uint64_t) high << 32 | low;
+}
+
+static uint64_t measureFrequency() {
+    // Count cpu cycles during a few timer ticks.
+    Clock* clock = Clock::get(CLOCK_MONOTONIC);
+    struct timespec start;
+    struct timespec now;
+    clock->getTime(&start);
+    do {
+        sched_yield();
+        clock->getTime(&now);
+    } while (!timespecLess(start, now));
+
+    start = now;
+    uint64_t startTimestamp = readTimestamp();
+    struct timespec end = timespecPlus(start, { 0, 20000000 });
+    do {
+        sched_yield();
+        clock->getTime(&now);
+    } while (timespecLess(now, end));
+    uint64_t cycles = readTimestamp() - startTimestamp;
+
+    uint64_t nanoseconds = (uint64_t) (now.tv_sec - start.tv_sec) *
+            1000000000 + now.tv_nsec - start.tv_nsec;
+    return cycles * 1000 / (nanoseconds / 1000000);
+}
+
+void Trace::record(unsigned int type, unsigned long arg0,
+        unsigned long arg1) {
+    unsigned long index = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+    TraceSlot* slot = &ringBuffer[index % BUFFER_ENTRIES];
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    Thread* thread = Thread::current();
+    slot->event.te_timestamp = readTimestamp();
+    slot->event.te_type = type;
+    slot->event.te_pid = thread->process->pid;
+    slot->event.te_tid = thread->tid;
+    slot->event.te_arg0 = arg0;
+    slot->event.te_arg1 = arg1;
+
+    __atomic_store_n(&slot->sequence, index + 1, __ATOMIC_RELEASE);
+}
+
+extern "C" void traceSyscallExit(unsigned long result) {
+    Trace::record(TRACE_SYSCALL_EXIT, result, 0);
+}
+
+TraceDevice::TraceDevice() : Vnode(S_IFCHR | 0644, DevFS::dev) {
+
+}
+
+int TraceDevice::devctl(int command, void* restrict data, size_t size,
+        int* restrict info) {
+    switch (command) {
+    case TRACE_SET_EVENTS: {
+        if (size != 0 && size != sizeof(int)) {
+            *info = -1;
+            return EINVAL;
+        }
+
+        unsigned int events = *(const int*) data;
+        if (events & ~((1U << TRACE_NUM_EVENTS) - 1)) {
+            *info = -1;
+            return EINVAL;
+        }
+
+        AutoLock lock(&traceMutex);
+        if (events && !ringBuffer) {
+            size_t bufferSize = ALIGNUP(BUFFER_ENTRIES * sizeof(TraceSlot),
+                    PAGESIZE);
+            ringBuffer = (TraceSlot*) kernelSpace->mapMemory(bufferSize,
+                    PROT_READ | PROT_WRITE);
+            if (!ringBuffer) {
+                *info = -1;
+                return ENOMEM;
+            }
+            memset(ringBuffer, 0, bufferSize);
+            frequency = measureFrequency();
+        }
+
+        *info = traceEvents;
+        __atomic_store_n(&traceEvents, events, __ATOMIC_RELEASE);
+        return 0;
+    } break;
+    case TRACE_GET_INFO: {
+        if (size != 0 && size != sizeof(struct trace_info)) {
+            *info = -1;
+            return EINVAL;
+        }
+
+        AutoLock lock(&traceMutex);
+        struct trace_info* traceInfo = (struct trace_info*) data;
+        traceInfo->ti_frequency = frequency;
+        traceInfo->ti_lost = lost;
+        *info = 0;
+        return 0;
+    } break;
+    default:
+        *info = -1;
+        return EINVAL;
+    }
+}
+
+ssize_t TraceDevice::read(void* buffer, size_t size, int /*flags*/) {
+    if (size < sizeof(struct trace_event)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    AutoLock lock(&traceMutex);
+    if (!ringBuffer) return 0;
+
+    unsigned long end = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    if (end - tail > BUFFER_ENTRIES) {
+        lost += end - tail - BUFFER_ENTRIES;
+        tail = end - BUFFER_ENTRIES;
+    }
+
+    // Events are returned without blocking. A return value of 0 means that
+    // there are currently no events.
+    size_t count = 0;
+    size_t maxCount = size / sizeof(struct trace_event);
+    while (tail != end && count < maxCount) {
+        TraceSlot* slot = &ringBuffer[tail % BUFFER_ENTRIES];
+        unsigned long sequence = __atomic_load_n(&slot->sequence,
+                __ATOMIC_ACQUIRE);
+        if (sequence == 0 || (long) (sequence - (tail + 1)) < 0) {
+            // The event is still being written.
+            break;
+        }
+
+        struct trace_event event = slot->event;
+        if (sequence != tail + 1 || __atomic_load_n(&slot->sequence,
+                __ATOMIC_ACQUIRE) != sequence) {
+            // The event was overwritten by a newer one.
+            lost++;
+            tail++;
+            continue;
+        }
+
+        memcpy((struct trace_event*) buffer + count, &event, sizeof(event));
+        count++;
+        tail++;
+    }
+
+    return count * sizeof(struct trace_event);
+}
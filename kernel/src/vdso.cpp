@@ -0,0 +1,165 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* kernel/src/vdso.cpp
+ * Virtual dynamic shared object.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <dennix/kernel/panic.h>
+#include <dennix/kernel/physicalmemory.h>
+#include <dennix/kernel/vdso.h>
+
+#ifdef __i386__
+#  define CPUID_EDX_SEP (1 << 11)
+#  define MSR_SYSENTER_CS 0x174
+#  define MSR_SYSENTER_ESP 0x175
+#  define MSR_SYSENTER_EIP 0x176
+#elif defined(__x86_64__)
+#  define EFER_SYSCALL_ENABLE (1 << 0)
+#  define EFLAGS_MASK 0x700 // Trap, interrupt and direction flag
+#  define MSR_EFER 0xC0000080
+#  define MSR_STAR 0xC0000081
+#  define MSR_LSTAR 0xC0000082
+#  define MSR_FMASK 0xC0000084
+#endif
+
+extern "C" {
+#ifdef __i386__
+extern symbol_t beginVdsoInt;
+extern symbol_t endVdsoInt;
+extern symbol_t beginVdsoSysenter;
+extern symbol_t endVdsoSysenter;
+extern symbol_t sysenterEntry;
+#elif defined(__x86_64__)
+extern symbol_t syscallEntry;
+#endif
+}
+
+static paddr_t sharedPage;
+static struct vdso_clocks* clocks;
+
+#ifdef __x86_64__
+static inline uint64_t readMsr(uint32_t msr) {
+    uint32_t low;
+    uint32_t high;
+    asm volatile ("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+    return (uint64_t) high << 32 | low;
+}
+#endif
+
+static inline void writeMsr(uint32_t msr, uint64_t value) {
+    asm volatile ("wrmsr" :: "a"((uint32_t) value),
+            "d"((uint32_t) (value >> 32)), "c"(msr));
+}
+
+#ifdef __i386__
+// This stack is only used until sysenterEntry has switched to the kernel stack
+// of the thread.
+static char sysenterStack[64] ALIGNED(16);
+
+static bool sysenterSupported() {
+    uint32_t eax = 1;
+    uint32_t edx;
+    asm("cpuid" : "+a"(eax), "=d"(edx) :: "ebx", "ecx");
+    if (!(edx & CPUID_EDX_SEP)) return false;
+
+    // Early Pentium Pro processors report sysenter without supporting it.
+    unsigned int family = (eax >> 8) & 0xF;
+    unsigned int model = (eax >> 4) & 0xF;
+    unsigned int stepping = eax & 0xF;
+    return family != 6 || model >= 3 || stepping >= 3;
+}
+#endif
+
+void Vdso::initialize() {
+    sharedPage = PhysicalMemory::popPageFrame();
+    if (!sharedPage) PANIC("Failed to allocate the vDSO");
+    vaddr_t mapped = kernelSpace->mapPhysical(sharedPage, PAGESIZE,
+            PROT_READ | PROT_WRITE);
+    if (!mapped) PANIC("Failed to map the vDSO");
+    memset((void*) mapped, 0, PAGESIZE);
+
+#ifdef __i386__
+    const char* begin = (const char*) &beginVdsoInt;
+    const char* end = (const char*) &endVdsoInt;
+    if (sysenterSupported()) {
+        writeMsr(MSR_SYSENTER_CS, 0x8);
+        writeMsr(MSR_SYSENTER_ESP,
+                (uintptr_t) sysenterStack + sizeof(sysenterStack));
+        writeMsr(MSR_SYSENTER_EIP, (uintptr_t) &sysenterEntry);
+        begin = (const char*) &beginVdsoSysenter;
+        end = (const char*) &endVdsoSysenter;
+    }
+    assert(end - begin <= PAGESIZE - VDSO_SYSCALL);
+    memcpy((void*) (mapped + VDSO_SYSCALL), begin, end - begin);
+#elif defined(__x86_64__)
+    writeMsr(MSR_EFER, readMsr(MSR_EFER) | EFER_SYSCALL_ENABLE);
+    // syscall loads the kernel segments from 0x08 and 0x10. sysret loads the
+    // user data segment from 0x38 and the user code segment from 0x40.
+    writeMsr(MSR_STAR, (uint64_t) 0x30 << 48 | (uint64_t) 0x08 << 32);
+    writeMsr(MSR_LSTAR, (uintptr_t) &syscallEntry);
+    writeMsr(MSR_FMASK, EFLAGS_MASK);
+#endif
+
+    clocks = (struct vdso_clocks*) mapped;
+}
+
+vaddr_t Vdso::map(AddressSpace* addressSpace, pid_t pid) {
+    // Allocate both pages at once so that they are adjacent and then replace
+    // the first one with the shared page. The process page is never swapped
+    // out because setPid writes to it through its physical address. On failure
+    // the caller deletes the address space.
+    vaddr_t vdso = addressSpace->mapMemory(VDSO_SIZE, PROT_READ | SEG_VDSO);
+    if (!vdso) return 0;
+    if (!addressSpace->unmapMemory(vdso, PAGESIZE)) return 0;
+    if (!addressSpace->mapPhysical(vdso, sharedPage, PAGESIZE,
+            PROT_READ | PROT_EXEC | SEG_NOUNMAP | SEG_VDSO)) {
+        return 0;
+    }
+
+    vaddr_t mapped = kernelSpace->mapFromOtherAddressSpace(addressSpace,
+            vdso + VDSO_PROCESS, PAGESIZE, PROT_WRITE);
+    if (!mapped) return 0;
+    memset((void*) mapped, 0, PAGESIZE);
+    ((struct vdso_process*) mapped)->vp_pid = pid > 0 ? pid : 0;
+    kernelSpace->unmapPhysical(mapped, PAGESIZE);
+    return vdso;
+}
+
+bool Vdso::setPid(AddressSpace* addressSpace, vaddr_t vdso, pid_t pid) {
+    vaddr_t mapped = kernelSpace->mapFromOtherAddressSpace(addressSpace,
+            vdso + VDSO_PROCESS, PAGESIZE, PROT_WRITE);
+    if (!mapped) return false;
+    struct vdso_process* process = (struct vdso_process*) mapped;
+    __atomic_store_n(&process->vp_pid, pid, __ATOMIC_RELAXED);
+    kernelSpace->unmapPhysical(mapped, PAGESIZE);
+    return true;
+}
+
+void Vdso::updateClocks(const struct timespec& monotonic,
+        const struct timespec& realtime) {
+    if (!clocks) return;
+
+    // Userspace retries reading the clocks if the sequence number is odd or
+    // has changed while reading.
+    unsigned long sequence = clocks->vc_sequence;
+    __atomic_store_n(&clocks->vc_sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    clocks->vc_monotonic = monotonic;
+    clocks->vc_realtime = realtime;
+    __atomic_store_n(&clocks->vc_sequence, sequence + 2, __ATOMIC_RELEASE);
+}
@@ -23,6 +23,8 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <dennix/conf.h>
+#include <dennix/dent.h>
+#include <dennix/fcntl.h>
 #include <dennix/kernel/clock.h>
 #include <dennix/kernel/process.h>
 #include <dennix/kernel/vnode.h>
@@ -40,10 +42,31 @@ Vnode::Vnode(mode_t mode, dev_t dev) {
     stats.st_blksize = 0x1000;
 
     mutex = KTHREAD_MUTEX_INITIALIZER;
+    firstListener = nullptr;
+    listenerMutex = KTHREAD_MUTEX_INITIALIZER;
 }
 
 Vnode::~Vnode() {
     assert(stats.st_nlink == 0);
+    assert(!firstListener);
+}
+
+// Appends an entry to a buffer passed to posix_getdents. Returns false if the
+// entry does not fit into the buffer.
+bool addDirectoryEntry(void* buffer, size_t size, size_t* used, ino_t ino,
+        unsigned char type, const char* name, size_t nameLength) {
+    size_t reclen = ALIGNUP(offsetof(struct posix_dent, d_name) + nameLength +
+            1, alignof(struct posix_dent));
+    if (reclen > size - *used) return false;
+
+    posix_dent* dent = (posix_dent*) ((char*) buffer + *used);
+    dent->d_ino = ino;
+    dent->d_reclen = reclen;
+    dent->d_type = type;
+    memcpy(dent->d_name, name, nameLength);
+    dent->d_name[nameLength] = '\0';
+    *used += reclen;
+    return true;
 }
 
 static Reference<Vnode> resolvePathExceptLastComponent(
@@ -201,6 +224,21 @@ Reference<Vnode> Vnode::accept(struct sockaddr* /*address*/,
     return nullptr;
 }
 
+void Vnode::addEventListener(EventListener* listener) {
+    AutoLock lock(&listenerMutex);
+    listener->prevListener = nullptr;
+    listener->nextListener = firstListener;
+    if (firstListener) {
+        firstListener->prevListener = listener;
+    }
+    firstListener = listener;
+}
+
+bool Vnode::addSharedMapping(off_t /*offset*/, size_t /*size*/) {
+    errno = ENODEV;
+    return false;
+}
+
 int Vnode::bind(const struct sockaddr* /*address*/, socklen_t /*length*/,
         int /*flags*/) {
     errno = ENOTSOCK;
@@ -241,6 +279,11 @@ int Vnode::devctl(int /*command*/, void* restrict /*data*/, size_t /*size*/,
     return ENOTTY;
 }
 
+int Vnode::fcntl(int /*cmd*/, int /*param*/) {
+    errno = EINVAL;
+    return -1;
+}
+
 int Vnode::ftruncate(off_t /*length*/) {
     errno = EBADF;
     return -1;
@@ -256,10 +299,16 @@ Reference<Vnode> Vnode::getChildNode(const char* /*path*/, size_t /*length*/) {
     return nullptr;
 }
 
-size_t Vnode::getDirectoryEntries(void** buffer, int /*flags*/) {
-    *buffer = nullptr;
+ssize_t Vnode::getDirectoryEntries(void* /*buffer*/, size_t /*size*/,
+        off_t* /*offset*/, int /*flags*/) {
     errno = ENOTDIR;
-    return 0;
+    return -1;
+}
+
+off_t Vnode::getDeviceOffset(off_t /*offset*/,
+        BlockCacheDevice** /*device*/) {
+    errno = EINVAL;
+    return -1;
 }
 
 char* Vnode::getLinkTarget() {
@@ -267,15 +316,33 @@ char* Vnode::getLinkTarget() {
     return nullptr;
 }
 
+paddr_t Vnode::getSharedPage(off_t /*offset*/) {
+    return 0;
+}
+
+int Vnode::getsockopt(int /*level*/, int /*name*/, void* restrict /*value*/,
+        socklen_t* restrict /*length*/) {
+    errno = ENOTSOCK;
+    return -1;
+}
+
 int Vnode::isatty() {
     errno = ENOTTY;
     return 0;
 }
 
+bool Vnode::isEventQueue() {
+    return false;
+}
+
 bool Vnode::isSeekable() {
     return false;
 }
 
+bool Vnode::isSocket() {
+    return false;
+}
+
 int Vnode::link(const char* /*name*/, const Reference<Vnode>& /*vnode*/) {
     errno = ENOTDIR;
     return -1;
@@ -301,6 +368,15 @@ int Vnode::mount(FileSystem* /*filesystem*/) {
     return -1;
 }
 
+// Vnodes call this whenever their poll() result might have changed.
+void Vnode::notifyEventListeners() {
+    AutoLock lock(&listenerMutex);
+    for (EventListener* listener = firstListener; listener;
+            listener = listener->nextListener) {
+        listener->onEvent();
+    }
+}
+
 void Vnode::onLink() {
     AutoLock lock(&mutex);
     updateTimestamps(false, true, false);
@@ -339,12 +415,40 @@ ssize_t Vnode::pread(void* /*buffer*/, size_t /*size*/, off_t /*offset*/,
     return -1;
 }
 
+ssize_t Vnode::preadv(const struct iovec* iov, int iovcnt, off_t offset,
+        int flags) {
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) continue;
+        ssize_t result = pread(iov[i].iov_base, iov[i].iov_len,
+                offset + total, flags);
+        if (result < 0) return total ? total : -1;
+        total += result;
+        if ((size_t) result < iov[i].iov_len) break;
+    }
+    return total;
+}
+
 ssize_t Vnode::pwrite(const void* /*buffer*/, size_t /*size*/,
         off_t /*offset*/, int /*flags*/) {
     errno = ESPIPE;
     return -1;
 }
 
+ssize_t Vnode::pwritev(const struct iovec* iov, int iovcnt, off_t offset,
+        int flags) {
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) continue;
+        ssize_t result = pwrite(iov[i].iov_base, iov[i].iov_len,
+                offset + total, flags);
+        if (result < 0) return total ? total : -1;
+        total += result;
+        if ((size_t) result < iov[i].iov_len) break;
+    }
+    return total;
+}
+
 ssize_t Vnode::read(void* /*buffer*/, size_t /*size*/, int /*flags*/) {
     errno = EBADF;
     return -1;
@@ -355,6 +459,42 @@ ssize_t Vnode::readlink(char* /*buffer*/, size_t /*size*/) {
     return -1;
 }
 
+ssize_t Vnode::readv(const struct iovec* iov, int iovcnt, int flags) {
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) continue;
+        // Once some data has been read we must not block waiting for more.
+        ssize_t result = read(iov[i].iov_base, iov[i].iov_len,
+                total ? flags | O_NONBLOCK : flags);
+        if (result < 0) return total ? total : -1;
+        total += result;
+        if ((size_t) result < iov[i].iov_len) break;
+    }
+    return total;
+}
+
+void Vnode::removeEventListener(EventListener* listener) {
+    AutoLock lock(&listenerMutex);
+    if (listener->prevListener) {
+        listener->prevListener->nextListener = listener->nextListener;
+    } else {
+        firstListener = listener->nextListener;
+    }
+    if (listener->nextListener) {
+        listener->nextListener->prevListener = listener->prevListener;
+    }
+}
+
+ssize_t Vnode::recvmsg(struct msghdr* /*msg*/, int /*flags*/,
+        int /*fileFlags*/) {
+    errno = ENOTSOCK;
+    return -1;
+}
+
+void Vnode::removeSharedMapping() {
+
+}
+
 int Vnode::rename(const Reference<Vnode>& /*oldDirectory*/,
         const char* /*oldName*/, const char* /*newName*/) {
     errno = EBADF;
@@ -365,6 +505,18 @@ Reference<Vnode> Vnode::resolve() {
     return this;
 }
 
+ssize_t Vnode::sendmsg(const struct msghdr* /*msg*/, int /*flags*/,
+        int /*fileFlags*/) {
+    errno = ENOTSOCK;
+    return -1;
+}
+
+int Vnode::setsockopt(int /*level*/, int /*name*/, const void* /*value*/,
+        socklen_t /*length*/) {
+    errno = ENOTSOCK;
+    return -1;
+}
+
 int Vnode::stat(struct stat* result) {
     AutoLock lock(&mutex);
     *result = stats;
@@ -436,3 +588,15 @@ ssize_t Vnode::write(const void* /*buffer*/, size_t /*size*/, int /*flags*/) {
     errno = EBADF;
     return -1;
 }
+
+ssize_t Vnode::writev(const struct iovec* iov, int iovcnt, int flags) {
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) continue;
+        ssize_t result = write(iov[i].iov_base, iov[i].iov_len, flags);
+        if (result < 0) return total ? total : -1;
+        total += result;
+        if ((size_t) result < iov[i].iov_len) break;
+    }
+    return total;
+}
@@ -14,74 +14,124 @@
  */
 
 /* kernel/src/worker.cpp
- * Kernel worker thread.
+ * Kernel worker threads.
  */
 
-#include <sched.h>
-#include <dennix/kernel/addressspace.h>
-#include <dennix/kernel/panic.h>
 #include <dennix/kernel/thread.h>
 #include <dennix/kernel/worker.h>
 
-static WorkerJob* firstJob;
-static WorkerJob* lastJob;
+// The kernel only uses one CPU, but having multiple workers makes sure that a
+// job that blocks does not delay all other deferred work.
+#ifndef WORKER_THREADS
+#  define WORKER_THREADS 2
+#endif
+
+// Each worker has its own queue. A job is always added to the same queue so
+// that it never runs concurrently with itself. Because jobs are added from
+// interrupt handlers, queues are protected by disabling interrupts.
+struct WorkerQueue {
+    WorkerJob* firstJob[WORKER_PRIORITIES];
+    WorkerJob* lastJob[WORKER_PRIORITIES];
+    // Delayed jobs are sorted by the time at which they become ready.
+    WorkerJob* firstDelayed;
+    Thread* thread;
+};
+
+static WorkerQueue queues[WORKER_THREADS];
+static size_t startedWorkers;
+
+static WorkerQueue* getQueue(const WorkerJob* job) {
+    return &queues[(uintptr_t) job / sizeof(WorkerJob) % WORKER_THREADS];
+}
+
+static void enqueue(WorkerQueue* queue, WorkerJob* job) {
+    job->next = nullptr;
+    if (!queue->firstJob[job->priority]) {
+        queue->firstJob[job->priority] = job;
+    } else {
+        queue->lastJob[job->priority]->next = job;
+    }
+    queue->lastJob[job->priority] = job;
+}
+
+static WorkerJob* dequeue(WorkerQueue* queue) {
+    for (int i = 0; i < WORKER_PRIORITIES; i++) {
+        WorkerJob* job = queue->firstJob[i];
+        if (job) {
+            queue->firstJob[i] = job->next;
+            return job;
+        }
+    }
+    return nullptr;
+}
 
 static NORETURN void worker(void) {
+    Interrupts::disable();
+    WorkerQueue* queue = &queues[startedWorkers++];
+    queue->thread = Thread::current();
+
     while (true) {
-        Interrupts::disable();
-        WorkerJob* job = firstJob;
-        firstJob = nullptr;
-        Interrupts::enable();
+        struct timespec now;
+        Clock::get(CLOCK_MONOTONIC)->getTime(&now);
+        while (queue->firstDelayed &&
+                !timespecLess(now, queue->firstDelayed->time)) {
+            WorkerJob* job = queue->firstDelayed;
+            queue->firstDelayed = job->next;
+            enqueue(queue, job);
+        }
 
+        WorkerJob* job = dequeue(queue);
         if (!job) {
-            sched_yield();
+            AutoWaitChannel waitChannel("worker");
+            Thread::sleep(queue->firstDelayed ? &queue->firstDelayed->time :
+                    nullptr);
+            continue;
         }
 
-        while (job) {
-            WorkerJob* next = job->next;
-            job->func(job->context);
-            job = next;
-        }
+        // The job might be freed or added again while it is running.
+        void (*func)(void*) = job->func;
+        void* context = job->context;
+        Interrupts::enable();
+        func(context);
+        Interrupts::disable();
     }
 }
 
-void WorkerThread::addJob(WorkerJob* job) {
+void WorkerThread::addDelayedJob(WorkerJob* job, const struct timespec* delay,
+        int priority /*= WORKER_PRIORITY_NORMAL*/) {
     // This function needs to be called with interrupts disabled.
+    struct timespec now;
+    Clock::get(CLOCK_MONOTONIC)->getTime(&now);
+    job->priority = priority;
+    job->time = timespecPlus(now, *delay);
 
-    job->next = nullptr;
-    if (!firstJob) {
-        firstJob = job;
-        lastJob = job;
-    } else {
-        lastJob->next = job;
-        lastJob = job;
+    WorkerQueue* queue = getQueue(job);
+    WorkerJob** link = &queue->firstDelayed;
+    while (*link && !timespecLess(job->time, (*link)->time)) {
+        link = &(*link)->next;
+    }
+    job->next = *link;
+    *link = job;
+
+    // The worker needs to update the time at which it wakes up.
+    if (queue->thread) {
+        queue->thread->wake();
     }
 }
 
-void WorkerThread::initialize() {
-    Thread* thread = xnew Thread(Thread::idleThread->process);
-    vaddr_t stack = kernelSpace->mapMemory(PAGESIZE, PROT_READ | PROT_WRITE);
-    if (!stack) PANIC("Failed to allocate stack for worker thread");
-    InterruptContext* context = (InterruptContext*)
-            (stack + PAGESIZE - sizeof(InterruptContext));
-    *context = {};
-
-#ifdef __i386__
-    context->eip = (vaddr_t) worker;
-    context->cs = 0x8;
-    context->eflags = 0x200;
-    context->esp = stack + PAGESIZE - sizeof(void*);
-    context->ss = 0x10;
-#elif defined(__x86_64__)
-    context->rip = (vaddr_t) worker;
-    context->cs = 0x8;
-    context->rflags = 0x200;
-    context->rsp = stack + PAGESIZE - sizeof(void*);
-    context->ss = 0x10;
-#else
-#  error "InterruptContext in WorkerThread is uninitialized."
-#endif
+void WorkerThread::addJob(WorkerJob* job,
+        int priority /*= WORKER_PRIORITY_NORMAL*/) {
+    // This function needs to be called with interrupts disabled.
+    job->priority = priority;
+    WorkerQueue* queue = getQueue(job);
+    enqueue(queue, job);
+    if (queue->thread) {
+        queue->thread->wake();
+    }
+}
 
-    thread->updateContext(stack, context, &initFpu);
-    Thread::addThread(thread);
+void WorkerThread::initialize() {
+    for (size_t i = 0; i < WORKER_THREADS; i++) {
+        Thread::createKernelThread(worker);
+    }
 }
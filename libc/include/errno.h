@@ -27,8 +27,14 @@
 extern "C" {
 #endif
 
+#if defined(__is_dennix_kernel) || defined(__is_dennix_libk)
 extern int errno;
-#define errno errno
+#  define errno errno
+#else
+/* Every thread has its own errno. */
+int* __errno_location(void) __attribute__((__const__));
+#  define errno (*__errno_location())
+#endif
 
 #if __USE_DENNIX
 extern char* program_invocation_name;
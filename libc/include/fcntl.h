@@ -24,11 +24,18 @@
 #define __need_mode_t
 #define __need_off_t
 #define __need_pid_t
+#if __USE_DENNIX
+#  define __need_size_t
+#  define __need_ssize_t
+#endif
 #include <bits/types.h>
 #include <bits/stat.h>
 #include <dennix/fcntl.h>
 #include <dennix/oflags.h>
 #include <dennix/seek.h>
+#if __USE_DENNIX
+#  include <dennix/splice.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +45,10 @@ int fcntl(int, int, ...);
 int open(const char*, int, ...);
 int openat(int, const char*, int, ...);
 
+#if __USE_DENNIX
+ssize_t splice(int, off_t*, int, off_t*, size_t, unsigned int);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
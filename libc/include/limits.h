@@ -40,6 +40,9 @@
 
 #  define ATEXIT_MAX 32
 #  define HOST_NAME_MAX 255
+#  define PTHREAD_DESTRUCTOR_ITERATIONS 4
+#  define PTHREAD_KEYS_MAX 128
+#  define PTHREAD_STACK_MIN PAGESIZE
 
 #  define LONG_BIT (__SIZEOF_LONG__ * CHAR_BIT)
 #  define SSIZE_MAX LONG_MAX
@@ -0,0 +1,140 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/include/pthread.h
+ * Threads.
+ */
+
+#ifndef _PTHREAD_H
+#define _PTHREAD_H
+
+#include <sys/cdefs.h>
+#define __need_size_t
+#include <bits/types.h>
+#include <dennix/timespec.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct __pthread* pthread_t;
+typedef unsigned int pthread_key_t;
+typedef int pthread_once_t;
+
+typedef struct {
+    size_t __stackSize;
+    int __detachState;
+} pthread_attr_t;
+
+typedef struct {
+    int __state;
+    int __type;
+    pthread_t __owner;
+    unsigned long __count;
+} pthread_mutex_t;
+
+typedef struct {
+    int __type;
+} pthread_mutexattr_t;
+
+typedef struct {
+    int __sequence;
+    unsigned int __waiters;
+} pthread_cond_t;
+
+typedef struct {
+    int __unused;
+} pthread_condattr_t;
+
+typedef struct {
+    int __state;
+    unsigned int __waiters;
+} pthread_rwlock_t;
+
+typedef struct {
+    int __unused;
+} pthread_rwlockattr_t;
+
+#define PTHREAD_CREATE_JOINABLE 0
+#define PTHREAD_CREATE_DETACHED 1
+
+#define PTHREAD_MUTEX_NORMAL 0
+#define PTHREAD_MUTEX_ERRORCHECK 1
+#define PTHREAD_MUTEX_RECURSIVE 2
+#define PTHREAD_MUTEX_DEFAULT PTHREAD_MUTEX_NORMAL
+
+#define PTHREAD_COND_INITIALIZER { 0, 0 }
+#define PTHREAD_MUTEX_INITIALIZER { 0, PTHREAD_MUTEX_DEFAULT, 0, 0 }
+#define PTHREAD_ONCE_INIT 0
+#define PTHREAD_RWLOCK_INITIALIZER { 0, 0 }
+
+int pthread_attr_destroy(pthread_attr_t*);
+int pthread_attr_getdetachstate(const pthread_attr_t*, int*);
+int pthread_attr_getstacksize(const pthread_attr_t* __restrict,
+        size_t* __restrict);
+int pthread_attr_init(pthread_attr_t*);
+int pthread_attr_setdetachstate(pthread_attr_t*, int);
+int pthread_attr_setstacksize(pthread_attr_t*, size_t);
+int pthread_cond_broadcast(pthread_cond_t*);
+int pthread_cond_destroy(pthread_cond_t*);
+int pthread_cond_init(pthread_cond_t* __restrict,
+        const pthread_condattr_t* __restrict);
+int pthread_cond_signal(pthread_cond_t*);
+int pthread_cond_timedwait(pthread_cond_t* __restrict,
+        pthread_mutex_t* __restrict, const struct timespec* __restrict);
+int pthread_cond_wait(pthread_cond_t* __restrict, pthread_mutex_t* __restrict);
+int pthread_condattr_destroy(pthread_condattr_t*);
+int pthread_condattr_init(pthread_condattr_t*);
+int pthread_create(pthread_t* __restrict, const pthread_attr_t* __restrict,
+        void* (*)(void*), void* __restrict);
+int pthread_detach(pthread_t);
+int pthread_equal(pthread_t, pthread_t);
+__noreturn void pthread_exit(void*);
+void* pthread_getspecific(pthread_key_t);
+int pthread_join(pthread_t, void**);
+int pthread_key_create(pthread_key_t*, void (*)(void*));
+int pthread_key_delete(pthread_key_t);
+int pthread_mutex_destroy(pthread_mutex_t*);
+int pthread_mutex_init(pthread_mutex_t* __restrict,
+        const pthread_mutexattr_t* __restrict);
+int pthread_mutex_lock(pthread_mutex_t*);
+int pthread_mutex_timedlock(pthread_mutex_t* __restrict,
+        const struct timespec* __restrict);
+int pthread_mutex_trylock(pthread_mutex_t*);
+int pthread_mutex_unlock(pthread_mutex_t*);
+int pthread_mutexattr_destroy(pthread_mutexattr_t*);
+int pthread_mutexattr_gettype(const pthread_mutexattr_t* __restrict,
+        int* __restrict);
+int pthread_mutexattr_init(pthread_mutexattr_t*);
+int pthread_mutexattr_settype(pthread_mutexattr_t*, int);
+int pthread_once(pthread_once_t*, void (*)(void));
+int pthread_rwlock_destroy(pthread_rwlock_t*);
+int pthread_rwlock_init(pthread_rwlock_t* __restrict,
+        const pthread_rwlockattr_t* __restrict);
+int pthread_rwlock_rdlock(pthread_rwlock_t*);
+int pthread_rwlock_tryrdlock(pthread_rwlock_t*);
+int pthread_rwlock_trywrlock(pthread_rwlock_t*);
+int pthread_rwlock_unlock(pthread_rwlock_t*);
+int pthread_rwlock_wrlock(pthread_rwlock_t*);
+int pthread_rwlockattr_destroy(pthread_rwlockattr_t*);
+int pthread_rwlockattr_init(pthread_rwlockattr_t*);
+pthread_t pthread_self(void);
+int pthread_setspecific(pthread_key_t, const void*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/include/spawn.h
+ * Process spawning.
+ */
+
+#ifndef _SPAWN_H
+#define _SPAWN_H
+
+#include <sys/cdefs.h>
+#define __need_mode_t
+#define __need_pid_t
+#define __need_size_t
+#include <bits/types.h>
+#include <dennix/sigset.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POSIX_SPAWN_RESETIDS (1 << 0)
+#define POSIX_SPAWN_SETPGROUP (1 << 1)
+#define POSIX_SPAWN_SETSIGDEF (1 << 2)
+#define POSIX_SPAWN_SETSIGMASK (1 << 3)
+
+typedef struct {
+    short __flags;
+    pid_t __pgroup;
+    sigset_t __sigdefault;
+    sigset_t __sigmask;
+} posix_spawnattr_t;
+
+typedef struct {
+    struct __spawn_action* __actions;
+    size_t __count;
+} posix_spawn_file_actions_t;
+
+int posix_spawn(pid_t* __restrict, const char* __restrict,
+        const posix_spawn_file_actions_t*, const posix_spawnattr_t* __restrict,
+        char* const[], char* const[]);
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t*, int);
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t*, int, int);
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t* __restrict,
+        int, const char* __restrict, int, mode_t);
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t*);
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t*);
+int posix_spawnattr_destroy(posix_spawnattr_t*);
+int posix_spawnattr_getflags(const posix_spawnattr_t* __restrict,
+        short* __restrict);
+int posix_spawnattr_getpgroup(const posix_spawnattr_t* __restrict,
+        pid_t* __restrict);
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t* __restrict,
+        sigset_t* __restrict);
+int posix_spawnattr_getsigmask(const posix_spawnattr_t* __restrict,
+        sigset_t* __restrict);
+int posix_spawnattr_init(posix_spawnattr_t*);
+int posix_spawnattr_setflags(posix_spawnattr_t*, short);
+int posix_spawnattr_setpgroup(posix_spawnattr_t*, pid_t);
+int posix_spawnattr_setsigdefault(posix_spawnattr_t* __restrict,
+        const sigset_t* __restrict);
+int posix_spawnattr_setsigmask(posix_spawnattr_t* __restrict,
+        const sigset_t* __restrict);
+int posix_spawnp(pid_t* __restrict, const char* __restrict,
+        const posix_spawn_file_actions_t*, const posix_spawnattr_t* __restrict,
+        char* const[], char* const[]);
+
+#if __USE_DENNIX
+int posix_spawn_file_actions_addtcsetpgrp_np(posix_spawn_file_actions_t*,
+        int);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
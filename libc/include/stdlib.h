@@ -116,6 +116,7 @@ char* canonicalize_file_name(const char*);
 int mkostemp(char*, int);
 int mkostemps(char*, int, int);
 int mkstemps(char*, int);
+void malloc_stats(void);
 void qsort_r(void*, size_t, size_t, int (*)(const void*, const void*, void*),
         void*);
 void* reallocarray(void*, size_t, size_t);
@@ -29,6 +29,7 @@ extern "C" {
 
 int fssync(int, int);
 int mount(const char*, const char*, const char*, int);
+int swapon(const char*);
 int unmount(const char*);
 
 #ifdef __cplusplus
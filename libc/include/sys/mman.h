@@ -32,6 +32,8 @@ extern "C" {
 
 void* mmap(void*, size_t, int, int, int, off_t);
 int munmap(void*, size_t);
+int shm_open(const char*, int, mode_t);
+int shm_unlink(const char*);
 
 #ifdef __cplusplus
 }
@@ -35,8 +35,19 @@ extern "C" {
 int accept(int, struct sockaddr* __restrict, socklen_t* __restrict);
 int bind(int, const struct sockaddr*, socklen_t);
 int connect(int, const struct sockaddr*, socklen_t);
+int getsockopt(int, int, int, void* __restrict, socklen_t* __restrict);
 int listen(int, int);
+ssize_t recv(int, void*, size_t, int);
+ssize_t recvfrom(int, void* __restrict, size_t, int,
+        struct sockaddr* __restrict, socklen_t* __restrict);
+ssize_t recvmsg(int, struct msghdr*, int);
+ssize_t send(int, const void*, size_t, int);
+ssize_t sendmsg(int, const struct msghdr*, int);
+ssize_t sendto(int, const void*, size_t, int, const struct sockaddr*,
+        socklen_t);
+int setsockopt(int, int, int, const void*, socklen_t);
 int socket(int, int, int);
+int socketpair(int, int, int, int[2]);
 
 #if __USE_DENNIX
 int accept4(int, struct sockaddr* __restrict, socklen_t* __restrict, int);
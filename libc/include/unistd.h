@@ -191,6 +191,7 @@ ssize_t write(int, const void*, size_t);
 
 #if __USE_DENNIX
 typedef unsigned long useconds_t;
+ssize_t copy_file_range(int, off_t*, int, off_t*, size_t, unsigned int);
 int dup3(int, int, int);
 int fchdirat(int, const char*);
 int getentropy(void*, size_t);
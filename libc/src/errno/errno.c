@@ -19,4 +19,12 @@
 
 #include <errno.h>
 
+#ifdef __is_dennix_libk
 int errno = 0;
+#else
+#  include "../pthread/thread.h"
+
+int* __errno_location(void) {
+    return &__threadSelf()->errnoValue;
+}
+#endif
@@ -32,6 +32,7 @@ int fcntl(int fd, int cmd, ...) {
         case F_DUPFD_CLOEXEC:
         case F_SETFD:
         case F_SETFL:
+        case F_SETPIPE_SZ:
             param = va_arg(ap, int);
     }
     va_end(ap);
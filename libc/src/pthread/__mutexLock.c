@@ -0,0 +1,53 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/__mutexLock.c
+ * Locks a mutex.
+ */
+
+#include "thread.h"
+
+int __mutexLock(pthread_mutex_t* restrict mutex,
+        const struct timespec* restrict timeout) {
+    pthread_t self = __threadSelf();
+
+    if (mutex->__type != PTHREAD_MUTEX_NORMAL && mutex->__owner == self) {
+        if (mutex->__type == PTHREAD_MUTEX_ERRORCHECK) return EDEADLK;
+        if (mutex->__count == ULONG_MAX) return EAGAIN;
+        mutex->__count++;
+        return 0;
+    }
+
+    // The state is 0 when the mutex is unlocked, 1 when it is locked and 2
+    // when it is locked and other threads might be waiting for it. An
+    // uncontended mutex is locked and unlocked without entering the kernel.
+    int state = 0;
+    if (!__atomic_compare_exchange_n(&mutex->__state, &state, 1, false,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if (state != 2) {
+            state = __atomic_exchange_n(&mutex->__state, 2, __ATOMIC_ACQUIRE);
+        }
+
+        while (state != 0) {
+            int result = __futexWait(&mutex->__state, 2, timeout);
+            if (result == ETIMEDOUT || result == EINVAL) return result;
+            state = __atomic_exchange_n(&mutex->__state, 2, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    mutex->__owner = self;
+    mutex->__count = 1;
+    return 0;
+}
@@ -0,0 +1,28 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_cond_broadcast.c
+ * Wakes all threads waiting on a condition variable.
+ */
+
+#include "thread.h"
+
+int pthread_cond_broadcast(pthread_cond_t* cond) {
+    __atomic_add_fetch(&cond->__sequence, 1, __ATOMIC_RELEASE);
+    if (__atomic_load_n(&cond->__waiters, __ATOMIC_ACQUIRE)) {
+        __futexWake(&cond->__sequence, INT_MAX);
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_cond_timedwait.c
+ * Waits on a condition variable with a timeout.
+ */
+
+#include "thread.h"
+
+int pthread_cond_timedwait(pthread_cond_t* restrict cond,
+        pthread_mutex_t* restrict mutex,
+        const struct timespec* restrict abstime) {
+    __atomic_add_fetch(&cond->__waiters, 1, __ATOMIC_ACQUIRE);
+    int sequence = __atomic_load_n(&cond->__sequence, __ATOMIC_ACQUIRE);
+    pthread_mutex_unlock(mutex);
+
+    // Any signal after we read the sequence number changes it, so the wakeup
+    // cannot get lost.
+    int result = __futexWait(&cond->__sequence, sequence, abstime);
+    __atomic_sub_fetch(&cond->__waiters, 1, __ATOMIC_RELEASE);
+
+    __mutexLock(mutex, NULL);
+    return result == ETIMEDOUT || result == EINVAL ? result : 0;
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_create.c
+ * Creates a thread.
+ */
+
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "thread.h"
+
+static __noreturn void startThread(struct __pthread* self) {
+    __setThreadPointer(self);
+    pthread_exit(self->startRoutine(self->argument));
+}
+
+int pthread_create(pthread_t* restrict thread,
+        const pthread_attr_t* restrict attr, void* (*startRoutine)(void*),
+        void* restrict argument) {
+    size_t stackSize = attr ? attr->__stackSize : DEFAULT_STACK_SIZE;
+    size_t mappingSize;
+    if (__builtin_add_overflow(stackSize, sizeof(struct __pthread) +
+            PAGESIZE - 1, &mappingSize)) {
+        return EAGAIN;
+    }
+    mappingSize &= ~(PAGESIZE - 1);
+
+    int oldErrno = errno;
+    void* mapping = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        errno = oldErrno;
+        return EAGAIN;
+    }
+
+    // The thread structure is placed above the stack.
+    struct __pthread* newThread = (struct __pthread*) ((char*) mapping +
+            mappingSize - sizeof(struct __pthread));
+    newThread->self = newThread;
+    newThread->alive = 1;
+    newThread->state = attr && attr->__detachState == PTHREAD_CREATE_DETACHED ?
+            THREAD_DETACHED : THREAD_JOINABLE;
+    newThread->startRoutine = startRoutine;
+    newThread->argument = argument;
+    newThread->mapping = mapping;
+    newThread->mappingSize = mappingSize;
+    newThread->mallocCache = NULL;
+
+    // Set up the stack as if startThread had been called.
+    uintptr_t stack = (uintptr_t) newThread & ~0xF;
+    regfork_t registers = {0};
+#ifdef __i386__
+    stack -= 16;
+    *(uintptr_t*) stack = (uintptr_t) newThread;
+    stack -= sizeof(uintptr_t);
+    *(uintptr_t*) stack = 0;
+    registers.__eip = (uintptr_t) startThread;
+    registers.__esp = stack;
+#elif defined(__x86_64__)
+    stack -= sizeof(uintptr_t);
+    *(uintptr_t*) stack = 0;
+    registers.__rdi = (uintptr_t) newThread;
+    registers.__rip = (uintptr_t) startThread;
+    registers.__rsp = stack;
+#else
+#  error "pthread_create is unimplemented for this architecture."
+#endif
+
+    __atomic_add_fetch(&__threadCount, 1, __ATOMIC_RELAXED);
+    if (regfork(RFTHREAD, &registers) < 0) {
+        __atomic_sub_fetch(&__threadCount, 1, __ATOMIC_RELAXED);
+        munmap(mapping, mappingSize);
+        errno = oldErrno;
+        return EAGAIN;
+    }
+
+    *thread = newThread;
+    return 0;
+}
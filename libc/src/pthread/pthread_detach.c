@@ -0,0 +1,31 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_detach.c
+ * Detaches a thread.
+ */
+
+#include "thread.h"
+
+int pthread_detach(pthread_t thread) {
+    int state = THREAD_JOINABLE;
+    if (!__atomic_compare_exchange_n(&thread->state, &state, THREAD_DETACHED,
+            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        // If the thread has already exited we need to free its resources.
+        if (state == THREAD_EXITED) return pthread_join(thread, NULL);
+        return EINVAL;
+    }
+    return 0;
+}
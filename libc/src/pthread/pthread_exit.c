@@ -0,0 +1,67 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_exit.c
+ * Terminates the calling thread.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include "thread.h"
+
+static void destroySpecificValues(struct __pthread* self) {
+    for (int i = 0; i < PTHREAD_DESTRUCTOR_ITERATIONS; i++) {
+        bool calledDestructor = false;
+
+        for (pthread_key_t key = 0; key < PTHREAD_KEYS_MAX; key++) {
+            void* value = self->keyValues[key];
+            if (!value || self->keyGenerations[key] != __keyGenerations[key]) {
+                continue;
+            }
+
+            self->keyValues[key] = NULL;
+            void (*destructor)(void*) = __keyDestructors[key];
+            if (destructor) {
+                destructor(value);
+                calledDestructor = true;
+            }
+        }
+
+        if (!calledDestructor) break;
+    }
+}
+
+__noreturn void pthread_exit(void* result) {
+    struct __pthread* self = __threadSelf();
+    destroySpecificValues(self);
+    __destroyMallocCache();
+
+    if (__atomic_sub_fetch(&__threadCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        // The process exits normally when its last thread exits.
+        exit(0);
+    }
+
+    self->result = result;
+    int state = THREAD_JOINABLE;
+    if (__atomic_compare_exchange_n(&self->state, &state, THREAD_EXITED,
+            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        // The joining thread frees the stack.
+        __exitThread(NULL, 0, &self->alive);
+    }
+
+    // A detached thread frees its own stack. The kernel does that after we
+    // stopped using it.
+    __exitThread(self->mapping, self->mappingSize, NULL);
+}
@@ -0,0 +1,44 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_join.c
+ * Waits for a thread to terminate.
+ */
+
+#include <sys/mman.h>
+#include "thread.h"
+
+int pthread_join(pthread_t thread, void** result) {
+    if (thread == __threadSelf()) return EDEADLK;
+    if (__atomic_load_n(&thread->state, __ATOMIC_ACQUIRE) == THREAD_DETACHED) {
+        return EINVAL;
+    }
+
+    int alive;
+    while ((alive = __atomic_load_n(&thread->alive, __ATOMIC_ACQUIRE))) {
+        __futexWait(&thread->alive, alive, NULL);
+    }
+
+    if (result) {
+        *result = thread->result;
+    }
+
+    if (thread->mapping) {
+        int oldErrno = errno;
+        munmap(thread->mapping, thread->mappingSize);
+        errno = oldErrno;
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_key_create.c
+ * Creates a thread-specific data key.
+ */
+
+#include "thread.h"
+
+// A key is in use when its generation is odd. Values that were set for an
+// older generation of the key are not visible.
+void (*__keyDestructors[PTHREAD_KEYS_MAX])(void*);
+unsigned int __keyGenerations[PTHREAD_KEYS_MAX];
+pthread_mutex_t __keyMutex = PTHREAD_MUTEX_INITIALIZER;
+
+int pthread_key_create(pthread_key_t* key, void (*destructor)(void*)) {
+    pthread_mutex_lock(&__keyMutex);
+    for (pthread_key_t i = 0; i < PTHREAD_KEYS_MAX; i++) {
+        if (__keyGenerations[i] % 2 == 0) {
+            __keyDestructors[i] = destructor;
+            __keyGenerations[i]++;
+            pthread_mutex_unlock(&__keyMutex);
+            *key = i;
+            return 0;
+        }
+    }
+    pthread_mutex_unlock(&__keyMutex);
+    return EAGAIN;
+}
@@ -0,0 +1,40 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_mutex_trylock.c
+ * Tries to lock a mutex.
+ */
+
+#include "thread.h"
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex) {
+    pthread_t self = __threadSelf();
+
+    if (mutex->__type == PTHREAD_MUTEX_RECURSIVE && mutex->__owner == self) {
+        if (mutex->__count == ULONG_MAX) return EAGAIN;
+        mutex->__count++;
+        return 0;
+    }
+
+    int state = 0;
+    if (!__atomic_compare_exchange_n(&mutex->__state, &state, 1, false,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return EBUSY;
+    }
+
+    mutex->__owner = self;
+    mutex->__count = 1;
+    return 0;
+}
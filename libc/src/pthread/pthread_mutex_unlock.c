@@ -0,0 +1,34 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_mutex_unlock.c
+ * Unlocks a mutex.
+ */
+
+#include "thread.h"
+
+int pthread_mutex_unlock(pthread_mutex_t* mutex) {
+    if (mutex->__type != PTHREAD_MUTEX_NORMAL) {
+        if (mutex->__owner != __threadSelf()) return EPERM;
+        if (--mutex->__count > 0) return 0;
+    }
+
+    mutex->__owner = NULL;
+    // Only enter the kernel if another thread might be waiting.
+    if (__atomic_exchange_n(&mutex->__state, 0, __ATOMIC_RELEASE) == 2) {
+        __futexWake(&mutex->__state, 1);
+    }
+    return 0;
+}
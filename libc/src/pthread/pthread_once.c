@@ -0,0 +1,43 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_once.c
+ * Dynamic package initialization.
+ */
+
+#include "thread.h"
+
+#define ONCE_RUNNING 1
+#define ONCE_DONE 2
+
+int pthread_once(pthread_once_t* once, void (*function)(void)) {
+    while (true) {
+        int state = __atomic_load_n(once, __ATOMIC_ACQUIRE);
+        if (state == ONCE_DONE) return 0;
+
+        if (state == PTHREAD_ONCE_INIT && __atomic_compare_exchange_n(once,
+                &state, ONCE_RUNNING, false, __ATOMIC_ACQUIRE,
+                __ATOMIC_RELAXED)) {
+            function();
+            __atomic_store_n(once, ONCE_DONE, __ATOMIC_RELEASE);
+            __futexWake(once, INT_MAX);
+            return 0;
+        }
+
+        if (state == ONCE_RUNNING) {
+            __futexWait(once, ONCE_RUNNING, NULL);
+        }
+    }
+}
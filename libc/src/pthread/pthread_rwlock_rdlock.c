@@ -0,0 +1,40 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_rwlock_rdlock.c
+ * Locks a read-write lock for reading.
+ */
+
+#include "thread.h"
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) {
+    // The state is the number of readers or -1 if a writer holds the lock.
+    while (true) {
+        int state = __atomic_load_n(&rwlock->__state, __ATOMIC_RELAXED);
+        if (state == INT_MAX) return EAGAIN;
+
+        if (state >= 0) {
+            if (__atomic_compare_exchange_n(&rwlock->__state, &state,
+                    state + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                return 0;
+            }
+            continue;
+        }
+
+        __atomic_add_fetch(&rwlock->__waiters, 1, __ATOMIC_ACQUIRE);
+        __futexWait(&rwlock->__state, state, NULL);
+        __atomic_sub_fetch(&rwlock->__waiters, 1, __ATOMIC_RELAXED);
+    }
+}
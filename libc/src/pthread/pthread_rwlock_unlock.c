@@ -0,0 +1,35 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/pthread_rwlock_unlock.c
+ * Unlocks a read-write lock.
+ */
+
+#include "thread.h"
+
+int pthread_rwlock_unlock(pthread_rwlock_t* rwlock) {
+    int state = __atomic_load_n(&rwlock->__state, __ATOMIC_RELAXED);
+    if (state == -1) {
+        state = 0;
+        __atomic_store_n(&rwlock->__state, 0, __ATOMIC_RELEASE);
+    } else {
+        state = __atomic_sub_fetch(&rwlock->__state, 1, __ATOMIC_RELEASE);
+    }
+
+    if (state == 0 && __atomic_load_n(&rwlock->__waiters, __ATOMIC_ACQUIRE)) {
+        __futexWake(&rwlock->__state, INT_MAX);
+    }
+    return 0;
+}
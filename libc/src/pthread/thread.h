@@ -0,0 +1,96 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/pthread/thread.h
+ * Internal definitions for threads.
+ */
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <dennix/futex.h>
+
+#define DEFAULT_STACK_SIZE (128 * 1024)
+
+#define THREAD_JOINABLE 0
+#define THREAD_DETACHED 1
+#define THREAD_EXITED 2
+
+struct __pthread {
+    // The thread pointer register points to this structure. __syscall relies
+    // on the layout of the first two members.
+    struct __pthread* self;
+    int errnoValue;
+    // The kernel clears this when the thread has exited.
+    int alive;
+    int state;
+    void* (*startRoutine)(void*);
+    void* argument;
+    void* result;
+    void* mapping;
+    size_t mappingSize;
+    void* keyValues[PTHREAD_KEYS_MAX];
+    unsigned int keyGenerations[PTHREAD_KEYS_MAX];
+    struct MallocCache* mallocCache;
+};
+
+extern void (*__keyDestructors[PTHREAD_KEYS_MAX])(void*);
+extern unsigned int __keyGenerations[PTHREAD_KEYS_MAX];
+extern pthread_mutex_t __keyMutex;
+extern struct __pthread __mainThread;
+extern unsigned int __threadCount;
+
+void __destroyMallocCache(void);
+__noreturn void __exitThread(void*, size_t, int*);
+int __futex(int*, int, int, const struct timespec*);
+void __initThreads(void);
+int __mutexLock(pthread_mutex_t* __restrict, const struct timespec* __restrict);
+int __setThreadPointer(void*);
+
+static inline struct __pthread* __threadSelf(void) {
+    struct __pthread* self;
+#ifdef __i386__
+    asm("mov %%gs:0, %0" : "=r"(self));
+#elif defined(__x86_64__)
+    asm("mov %%fs:0, %0" : "=r"(self));
+#else
+#  error "__threadSelf is unimplemented for this architecture."
+#endif
+    return self;
+}
+
+// Waits until the futex no longer has the given value. Unlike __futex this
+// returns an error number and leaves errno unchanged.
+static inline int __futexWait(int* futex, int value,
+        const struct timespec* timeout) {
+    int oldErrno = errno;
+    int result = 0;
+    if (__futex(futex, FUTEX_WAIT, value, timeout) < 0) {
+        result = errno;
+    }
+    errno = oldErrno;
+    return result;
+}
+
+static inline void __futexWake(int* futex, int count) {
+    __futex(futex, FUTEX_WAKE, count, NULL);
+}
+
+#endif
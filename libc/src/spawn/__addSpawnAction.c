@@ -0,0 +1,35 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/spawn/__addSpawnAction.c
+ * Appends an action to a list of spawn file actions.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include "spawn.h"
+
+int __addSpawnAction(posix_spawn_file_actions_t* fileActions,
+        const struct __spawn_action* action) {
+    int oldErrno = errno;
+    struct __spawn_action* actions = reallocarray(fileActions->__actions,
+            fileActions->__count + 1, sizeof(struct __spawn_action));
+    errno = oldErrno;
+    if (!actions) return ENOMEM;
+
+    actions[fileActions->__count++] = *action;
+    fileActions->__actions = actions;
+    return 0;
+}
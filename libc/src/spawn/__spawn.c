@@ -0,0 +1,250 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/spawn/__spawn.c
+ * Spawns a process without copying the address space.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "spawn.h"
+
+#define CHILD_STACK_SIZE 8192
+
+struct SpawnContext {
+    const char* file;
+    const char* path;
+    const posix_spawn_file_actions_t* fileActions;
+    const posix_spawnattr_t* attr;
+    char* const* argv;
+    char* const* envp;
+    sigset_t oldMask;
+    bool search;
+    volatile int error;
+};
+
+// The child runs on our address space until it calls execve, so it must not
+// modify any state that is shared with the parent. In particular it must not
+// use malloc because other threads might be holding the heap lock.
+
+// Signals are blocked while the child runs. Handlers installed by the parent
+// would run on the parent's memory, so they are reset before any signal can be
+// delivered.
+static void resetSignalHandlers(const posix_spawnattr_t* attr) {
+    struct sigaction action;
+    action.sa_handler = SIG_DFL;
+    action.sa_flags = 0;
+    sigemptyset(&action.sa_mask);
+
+    for (int i = 1; i < NSIG; i++) {
+        struct sigaction old;
+        if (sigaction(i, NULL, &old) < 0) continue;
+        bool setDefault = old.sa_handler != SIG_DFL &&
+                old.sa_handler != SIG_IGN;
+        if (attr && attr->__flags & POSIX_SPAWN_SETSIGDEF &&
+                sigismember(&attr->__sigdefault, i) == 1) {
+            setDefault = true;
+        }
+        if (setDefault) {
+            sigaction(i, &action, NULL);
+        }
+    }
+}
+
+static int applyAttributes(const posix_spawnattr_t* attr) {
+    if (attr->__flags & POSIX_SPAWN_SETPGROUP) {
+        if (setpgid(0, attr->__pgroup) < 0) return -1;
+    }
+
+    return 0;
+}
+
+static int applyFileActions(const posix_spawn_file_actions_t* fileActions) {
+    for (size_t i = 0; i < fileActions->__count; i++) {
+        const struct __spawn_action* action = &fileActions->__actions[i];
+
+        switch (action->type) {
+        case SPAWN_CLOSE:
+            if (close(action->fd) < 0 && errno != EBADF) return -1;
+            break;
+        case SPAWN_DUP2:
+            if (action->fd == action->newFd) {
+                int flags = fcntl(action->fd, F_GETFD);
+                if (flags < 0) return -1;
+                if (fcntl(action->fd, F_SETFD, flags & ~FD_CLOEXEC) < 0) {
+                    return -1;
+                }
+            } else if (dup2(action->fd, action->newFd) < 0) {
+                return -1;
+            }
+            break;
+        case SPAWN_OPEN: {
+            int fd = open(action->path, action->flags, action->mode);
+            if (fd < 0) return -1;
+            if (fd != action->fd) {
+                if (dup2(fd, action->fd) < 0) return -1;
+                close(fd);
+            }
+        } break;
+        case SPAWN_TCSETPGRP:
+            if (tcsetpgrp(action->fd, getpgrp()) < 0) return -1;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static void executeFile(const char* pathname, struct SpawnContext* context) {
+    execve(pathname, context->argv, context->envp);
+    if (errno != ENOEXEC || !context->search) return;
+
+    // Like execvp, run files that are not executables as shell scripts.
+    int argc;
+    for (argc = 0; context->argv[argc]; argc++);
+    if (argc == 0) argc = 1;
+    char* newArgv[argc + 3];
+
+    newArgv[0] = context->argv[0] ? context->argv[0] : (char*) context->file;
+    newArgv[1] = "--";
+    newArgv[2] = (char*) pathname;
+    for (int i = 1; i < argc; i++) {
+        newArgv[i + 2] = context->argv[i];
+    }
+    newArgv[argc + 2] = NULL;
+
+    execve("/bin/sh", newArgv, context->envp);
+}
+
+static __noreturn void startChild(struct SpawnContext* context) {
+    resetSignalHandlers(context->attr);
+    if (context->attr && applyAttributes(context->attr) < 0) goto fail;
+    if (context->fileActions && applyFileActions(context->fileActions) < 0) {
+        goto fail;
+    }
+
+    const sigset_t* mask = &context->oldMask;
+    if (context->attr && context->attr->__flags & POSIX_SPAWN_SETSIGMASK) {
+        mask = &context->attr->__sigmask;
+    }
+    if (sigprocmask(SIG_SETMASK, mask, NULL) < 0) goto fail;
+
+    if (!context->search || strchr(context->file, '/')) {
+        executeFile(context->file, context);
+    } else if (!*context->file) {
+        errno = ENOENT;
+    } else {
+        const char* path = context->path;
+        size_t fileLength = strlen(context->file);
+        bool denied = false;
+
+        while (path) {
+            size_t length = strcspn(path, ":");
+            char buffer[length + fileLength + 2];
+            const char* pathname = context->file;
+            if (length != 0) {
+                memcpy(buffer, path, length);
+                buffer[length] = '/';
+                memcpy(buffer + length + 1, context->file, fileLength + 1);
+                pathname = buffer;
+            }
+
+            executeFile(pathname, context);
+            if (errno == EACCES) {
+                denied = true;
+            } else if (errno != ENOENT && errno != ENOTDIR) {
+                break;
+            }
+
+            path = path[length] ? path + length + 1 : NULL;
+        }
+
+        if (!path) {
+            errno = denied ? EACCES : ENOENT;
+        }
+    }
+
+fail:
+    context->error = errno;
+    _Exit(127);
+}
+
+int __spawn(pid_t* pid, const char* file,
+        const posix_spawn_file_actions_t* fileActions,
+        const posix_spawnattr_t* attr, char* const argv[], char* const envp[],
+        bool search) {
+    struct SpawnContext context;
+    context.file = file;
+    context.path = search ? getenv("PATH") : NULL;
+    context.fileActions = fileActions;
+    context.attr = attr;
+    context.argv = argv;
+    context.envp = envp;
+    context.search = search;
+    context.error = 0;
+
+    // The kernel does not let us continue before the child has called execve
+    // or exited, so the child can use a stack allocated in our stack frame.
+    _Alignas(16) char stack[CHILD_STACK_SIZE];
+    uintptr_t stackPointer = (uintptr_t) stack + sizeof(stack);
+    regfork_t registers = {0};
+#ifdef __i386__
+    stackPointer -= 16;
+    *(uintptr_t*) stackPointer = (uintptr_t) &context;
+    stackPointer -= sizeof(uintptr_t);
+    *(uintptr_t*) stackPointer = 0;
+    registers.__eip = (uintptr_t) startChild;
+    registers.__esp = stackPointer;
+#elif defined(__x86_64__)
+    stackPointer -= sizeof(uintptr_t);
+    *(uintptr_t*) stackPointer = 0;
+    registers.__rdi = (uintptr_t) &context;
+    registers.__rip = (uintptr_t) startChild;
+    registers.__rsp = stackPointer;
+#else
+#  error "__spawn is unimplemented for this architecture."
+#endif
+
+    int oldErrno = errno;
+    sigset_t set;
+    sigfillset(&set);
+    sigprocmask(SIG_BLOCK, &set, &context.oldMask);
+    pid_t child = regfork(_RFFORK | RFVFORK, &registers);
+    int error = errno;
+    sigprocmask(SIG_SETMASK, &context.oldMask, NULL);
+    if (child < 0) {
+        errno = oldErrno;
+        return error;
+    }
+
+    if (context.error) {
+        // The child has already exited, so we can collect it immediately.
+        while (waitpid(child, NULL, 0) < 0 && errno == EINTR);
+        errno = oldErrno;
+        return context.error;
+    }
+
+    if (pid) {
+        *pid = child;
+    }
+    errno = oldErrno;
+    return 0;
+}
@@ -0,0 +1,30 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/spawn/posix_spawn_file_actions_adddup2.c
+ * Adds a dup2 action to spawn file actions.
+ */
+
+#include <errno.h>
+#include "spawn.h"
+
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t* fileActions,
+        int fd, int newFd) {
+    if (fd < 0 || newFd < 0) return EBADF;
+    struct __spawn_action action = {
+        .type = SPAWN_DUP2, .fd = fd, .newFd = newFd
+    };
+    return __addSpawnAction(fileActions, &action);
+}
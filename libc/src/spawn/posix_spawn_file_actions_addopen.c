@@ -0,0 +1,44 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/spawn/posix_spawn_file_actions_addopen.c
+ * Adds an open action to spawn file actions.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spawn.h"
+
+int posix_spawn_file_actions_addopen(
+        posix_spawn_file_actions_t* restrict fileActions, int fd,
+        const char* restrict path, int flags, mode_t mode) {
+    if (fd < 0) return EBADF;
+
+    int oldErrno = errno;
+    char* pathCopy = strdup(path);
+    errno = oldErrno;
+    if (!pathCopy) return ENOMEM;
+
+    struct __spawn_action action = {
+        .type = SPAWN_OPEN, .fd = fd, .flags = flags, .mode = mode,
+        .path = pathCopy
+    };
+    int result = __addSpawnAction(fileActions, &action);
+    if (result != 0) {
+        free(pathCopy);
+    }
+    return result;
+}
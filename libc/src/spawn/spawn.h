@@ -0,0 +1,47 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/spawn/spawn.h
+ * Internal declarations for posix_spawn.
+ */
+
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include <spawn.h>
+#include <stdbool.h>
+
+#define SPAWN_CLOSE 0
+#define SPAWN_DUP2 1
+#define SPAWN_OPEN 2
+#define SPAWN_TCSETPGRP 3
+
+struct __spawn_action {
+    int type;
+    int fd;
+    int newFd;
+    int flags;
+    mode_t mode;
+    char* path;
+};
+
+int __addSpawnAction(posix_spawn_file_actions_t* fileActions,
+        const struct __spawn_action* action);
+int __spawn(pid_t* pid, const char* file,
+        const posix_spawn_file_actions_t* fileActions,
+        const posix_spawnattr_t* attr, char* const argv[], char* const envp[],
+        bool search);
+
+#endif
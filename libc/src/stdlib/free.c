@@ -22,36 +22,24 @@
 
 void free(void* addr) {
     if (addr == NULL) return;
-    __lockHeap();
-
-    Chunk* chunk = (Chunk*) addr - 1;
 
-    assert(chunk->magic == MAGIC_USED_CHUNK);
+    Span* span = __getSpan(addr);
+    assert(span);
 
-    chunk->magic = MAGIC_FREE_CHUNK;
-
-    // Unify the chunk with its neighbors if they are free too
-    if (chunk->prev && chunk->prev->magic == MAGIC_FREE_CHUNK) {
-        chunk = __unifyChunks(chunk->prev, chunk);
+    if (span->sizeClass == LARGE_CLASS) {
+        assert(span->start == addr);
+        __freeLarge(span);
+        return;
     }
 
-    if (chunk->next->magic == MAGIC_FREE_CHUNK) {
-        chunk = __unifyChunks(chunk, chunk->next);
-    }
-
-    if (chunk->prev == NULL && chunk->next->magic == MAGIC_END_CHUNK) {
-        // The whole big chunk is free, so we can unmap it
-        Chunk* bigChunk = chunk - 1;
-        assert(bigChunk->magic == MAGIC_BIG_CHUNK);
-
-        if (bigChunk->prev) {
-            bigChunk->prev->next = bigChunk->next;
-        }
-        if (bigChunk->next) {
-            bigChunk->next->prev = bigChunk->prev;
-        }
-        unmapMemory(bigChunk, bigChunk->size);
+#ifdef __is_dennix_libc
+    if (span->sizeClass < CACHE_CLASSES &&
+            __freeCached(span->sizeClass, addr)) {
+        return;
     }
+#endif
 
+    __lockHeap();
+    __freeSmall(span, addr);
     __unlockHeap();
 }
@@ -0,0 +1,98 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/stdlib/malloc-cache.c
+ * Per-thread caches for memory allocation.
+ */
+
+#include <string.h>
+#include "malloc.h"
+#include "../pthread/thread.h"
+
+#define CACHE_BATCH (CACHE_SIZE / 2)
+#define CACHE_MAPPING_SIZE alignUp(sizeof(struct MallocCache), PAGESIZE)
+
+// The cache is only created once the process has multiple threads because a
+// single thread does not contend for the heap lock.
+static struct MallocCache* getCache(void) {
+    struct __pthread* self = __threadSelf();
+    if (self->mallocCache) return self->mallocCache;
+    if (__atomic_load_n(&__threadCount, __ATOMIC_RELAXED) <= 1) return NULL;
+
+    struct MallocCache* cache = mapMemory(CACHE_MAPPING_SIZE);
+    if (!cache) return NULL;
+    memset(cache->count, 0, sizeof(cache->count));
+
+    __lockHeap();
+    __mallocStats.mappedBytes += CACHE_MAPPING_SIZE;
+    __unlockHeap();
+    self->mallocCache = cache;
+    return cache;
+}
+
+static void flushCache(struct MallocCache* cache, unsigned int sizeClass,
+        unsigned int count) {
+    __lockHeap();
+    while (count--) {
+        void* object = cache->objects[sizeClass][--cache->count[sizeClass]];
+        __freeSmall(__getSpan(object), object);
+    }
+    __unlockHeap();
+}
+
+void* __allocateCached(unsigned int sizeClass) {
+    struct MallocCache* cache = getCache();
+    if (!cache) return NULL;
+
+    if (cache->count[sizeClass] == 0) {
+        __lockHeap();
+        while (cache->count[sizeClass] < CACHE_BATCH) {
+            void* object = __allocateSmall(sizeClass);
+            if (!object) break;
+            cache->objects[sizeClass][cache->count[sizeClass]++] = object;
+        }
+        __unlockHeap();
+        if (cache->count[sizeClass] == 0) return NULL;
+    }
+
+    return cache->objects[sizeClass][--cache->count[sizeClass]];
+}
+
+bool __freeCached(unsigned int sizeClass, void* addr) {
+    struct MallocCache* cache = getCache();
+    if (!cache) return false;
+
+    if (cache->count[sizeClass] == CACHE_SIZE) {
+        flushCache(cache, sizeClass, CACHE_BATCH);
+    }
+    cache->objects[sizeClass][cache->count[sizeClass]++] = addr;
+    return true;
+}
+
+void __destroyMallocCache(void) {
+    struct __pthread* self = __threadSelf();
+    struct MallocCache* cache = self->mallocCache;
+    if (!cache) return;
+
+    for (unsigned int i = 0; i < CACHE_CLASSES; i++) {
+        flushCache(cache, i, cache->count[i]);
+    }
+    self->mallocCache = NULL;
+
+    __lockHeap();
+    __mallocStats.mappedBytes -= CACHE_MAPPING_SIZE;
+    __unlockHeap();
+    unmapMemory(cache, CACHE_MAPPING_SIZE);
+}
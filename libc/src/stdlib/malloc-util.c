@@ -18,84 +18,301 @@
  */
 
 #include <assert.h>
-#include <stdint.h>
+#include <errno.h>
+#include <string.h>
 #include "malloc.h"
 
-static Chunk emptyBigChunk[2] = {
-    {MAGIC_BIG_CHUNK, sizeof(emptyBigChunk), NULL, NULL},
-    {MAGIC_END_CHUNK, 0, NULL, NULL}
-};
+#if UINTPTR_MAX > 0xFFFFFFFF
+#  define PAGEMAP_LEVELS 4
+#  define PAGEMAP_BITS 9
+#else
+#  define PAGEMAP_LEVELS 2
+#  define PAGEMAP_BITS 10
+#endif
+#define PAGEMAP_ENTRIES (1 << PAGEMAP_BITS)
+#define MAX_SPAN_PAGES 16
 
-Chunk* __firstBigChunk = emptyBigChunk;
+struct MallocStats __mallocStats;
 
-Chunk* __allocateBigChunk(Chunk* lastBigChunk, size_t size) {
-    assert(lastBigChunk->magic == MAGIC_BIG_CHUNK);
+// The page map is a radix tree that maps each page of the heap to its span so
+// that free can find the span of an object in constant time.
+static void* pagemap[PAGEMAP_ENTRIES];
+static Span* partialSpans[NUM_SIZE_CLASSES];
+static Span* freeSpanStructs;
 
-    size += 3 * sizeof(Chunk);
-    size = alignUp(size, PAGESIZE);
+static void** getPagemapEntry(uintptr_t address, bool create) {
+    uintptr_t page = address / PAGESIZE;
+    void** node = pagemap;
+    for (int level = PAGEMAP_LEVELS - 1; level > 0; level--) {
+        size_t index = (page >> (level * PAGEMAP_BITS)) &
+                (PAGEMAP_ENTRIES - 1);
+        if (!node[index]) {
+            if (!create) return NULL;
+            void* newNode = mapMemory(PAGESIZE);
+            if (!newNode) return NULL;
+            memset(newNode, 0, PAGESIZE);
+            __mallocStats.mappedBytes += PAGESIZE;
+            node[index] = newNode;
+        }
+        node = node[index];
+    }
+    return &node[page & (PAGEMAP_ENTRIES - 1)];
+}
 
-    if (size < 4 * PAGESIZE) {
-        size = 4 * PAGESIZE;
+static bool setPagemapEntries(Span* span, size_t pages) {
+    for (size_t i = 0; i < pages; i++) {
+        void** entry = getPagemapEntry((uintptr_t) span->start + i * PAGESIZE,
+                true);
+        if (!entry) {
+            while (i--) {
+                *getPagemapEntry((uintptr_t) span->start + i * PAGESIZE,
+                        false) = NULL;
+            }
+            return false;
+        }
+        *entry = span;
     }
+    return true;
+}
 
-    Chunk* bigChunk = mapMemory(size);
+static void clearPagemapEntries(Span* span, size_t pages) {
+    for (size_t i = 0; i < pages; i++) {
+        *getPagemapEntry((uintptr_t) span->start + i * PAGESIZE, false) = NULL;
+    }
+}
+
+static Span* allocateSpanStruct(void) {
+    if (!freeSpanStructs) {
+        Span* spans = mapMemory(PAGESIZE);
+        if (!spans) return NULL;
+        __mallocStats.mappedBytes += PAGESIZE;
+        for (size_t i = 0; i < PAGESIZE / sizeof(Span); i++) {
+            spans[i].next = freeSpanStructs;
+            freeSpanStructs = &spans[i];
+        }
+    }
+
+    Span* span = freeSpanStructs;
+    freeSpanStructs = span->next;
+    return span;
+}
+
+static void freeSpanStruct(Span* span) {
+    span->next = freeSpanStructs;
+    freeSpanStructs = span;
+}
 
-    if (!bigChunk) return NULL;
+static void linkSpan(Span* span) {
+    span->prev = NULL;
+    span->next = partialSpans[span->sizeClass];
+    if (span->next) {
+        span->next->prev = span;
+    }
+    partialSpans[span->sizeClass] = span;
+}
 
-    Chunk* chunk = bigChunk + 1;
-    Chunk* endChunk = (Chunk*) ((uintptr_t) bigChunk + size - sizeof(Chunk));
+static void unlinkSpan(Span* span) {
+    if (span->prev) {
+        span->prev->next = span->next;
+    } else {
+        partialSpans[span->sizeClass] = span->next;
+    }
+    if (span->next) {
+        span->next->prev = span->prev;
+    }
+}
 
-    bigChunk->magic = MAGIC_BIG_CHUNK;
-    bigChunk->size = size;
-    bigChunk->prev = lastBigChunk;
-    bigChunk->next = NULL;
+// Returns the smallest number of pages that wastes at most an eighth of the
+// span for the given object size.
+static size_t getSpanPages(size_t size) {
+    size_t pages;
+    for (pages = 1; pages < MAX_SPAN_PAGES; pages++) {
+        size_t objects = pages * PAGESIZE / size;
+        if (objects > MAX_SPAN_OBJECTS) objects = MAX_SPAN_OBJECTS;
+        if (objects == 0) continue;
+        if ((pages * PAGESIZE - objects * size) * 8 <= pages * PAGESIZE) break;
+    }
+    return pages;
+}
 
-    lastBigChunk->next = bigChunk;
+static Span* createSpan(unsigned int sizeClass) {
+    size_t size = __classToSize(sizeClass);
+    size_t pages = getSpanPages(size);
 
-    chunk->magic = MAGIC_FREE_CHUNK;
-    chunk->size = size - 3 * sizeof(Chunk);
-    chunk->prev = NULL;
-    chunk->next = endChunk;
+    Span* span = allocateSpanStruct();
+    if (!span) return NULL;
+    span->start = mapMemory(pages * PAGESIZE);
+    if (!span->start) {
+        freeSpanStruct(span);
+        return NULL;
+    }
+    if (!setPagemapEntries(span, pages)) {
+        unmapMemory(span->start, pages * PAGESIZE);
+        freeSpanStruct(span);
+        return NULL;
+    }
 
-    endChunk->magic = MAGIC_END_CHUNK;
-    endChunk->size = 0;
-    endChunk->prev = chunk;
-    endChunk->next = NULL;
+    span->pages = pages;
+    span->sizeClass = sizeClass;
+    size_t objects = pages * PAGESIZE / size;
+    if (objects > MAX_SPAN_OBJECTS) objects = MAX_SPAN_OBJECTS;
+    span->objects = objects;
+    span->freeObjects = objects;
+    memset(span->bitmap, 0, sizeof(span->bitmap));
+    for (size_t i = 0; i < objects; i++) {
+        span->bitmap[i / (CHAR_BIT * sizeof(long))] |=
+                1UL << i % (CHAR_BIT * sizeof(long));
+    }
 
-    return bigChunk;
+    linkSpan(span);
+    __mallocStats.spans[sizeClass]++;
+    __mallocStats.mappedBytes += pages * PAGESIZE;
+    return span;
 }
 
-void __splitChunk(Chunk* chunk, size_t size) {
-    assert(chunk->magic == MAGIC_FREE_CHUNK);
+static void releaseSpan(Span* span) {
+    unlinkSpan(span);
+    clearPagemapEntries(span, span->pages);
+    unmapMemory(span->start, span->pages * PAGESIZE);
+    __mallocStats.spans[span->sizeClass]--;
+    __mallocStats.mappedBytes -= span->pages * PAGESIZE;
+    freeSpanStruct(span);
+}
 
-    Chunk* newChunk = (Chunk*) ((uintptr_t) chunk + sizeof(Chunk) + size);
-    newChunk->magic = MAGIC_FREE_CHUNK;
-    newChunk->size = chunk->size - sizeof(Chunk) - size;
-    newChunk->prev = chunk;
-    newChunk->next = chunk->next;
+// The heap must be locked when calling this function.
+void* __allocateSmall(unsigned int sizeClass) {
+    Span* span = partialSpans[sizeClass];
+    if (!span) {
+        span = createSpan(sizeClass);
+        if (!span) {
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
 
-    chunk->size = size;
-    chunk->next->prev = newChunk;
-    chunk->next = newChunk;
+    size_t index = 0;
+    for (size_t i = 0; i < BITMAP_WORDS; i++) {
+        if (span->bitmap[i]) {
+            size_t bit = __builtin_ctzl(span->bitmap[i]);
+            span->bitmap[i] &= ~(1UL << bit);
+            index = i * CHAR_BIT * sizeof(long) + bit;
+            break;
+        }
+    }
+
+    if (--span->freeObjects == 0) {
+        unlinkSpan(span);
+    }
+    __mallocStats.objectsInUse[sizeClass]++;
+    return span->start + index * __classToSize(sizeClass);
 }
 
-Chunk* __unifyChunks(Chunk* first, Chunk* second) {
-    assert(first->magic == MAGIC_FREE_CHUNK);
-    assert(second->magic == MAGIC_FREE_CHUNK);
+// The heap must be locked when calling this function.
+void __freeSmall(Span* span, void* addr) {
+    size_t size = __classToSize(span->sizeClass);
+    size_t index = ((char*) addr - span->start) / size;
+    assert(span->start + index * size == addr);
+    unsigned long* word = &span->bitmap[index / (CHAR_BIT * sizeof(long))];
+    unsigned long bit = 1UL << index % (CHAR_BIT * sizeof(long));
+    assert(!(*word & bit));
+    *word |= bit;
 
-    first->next = second->next;
-    first->size += sizeof(Chunk) + second->size;
-    second->next->prev = first;
+    __mallocStats.objectsInUse[span->sizeClass]--;
+    if (span->freeObjects++ == 0) {
+        linkSpan(span);
+    }
 
-    return first;
+    // Keep the last partial span of a size class around even when it is empty
+    // so that memory does not need to be mapped again immediately.
+    if (span->freeObjects == span->objects && (span->prev || span->next)) {
+        releaseSpan(span);
+    }
+}
+
+void* __allocateLarge(size_t size) {
+    if (size > SIZE_MAX - PAGESIZE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size = alignUp(size, PAGESIZE);
+
+    void* result = mapMemory(size);
+    if (!result) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    __lockHeap();
+    Span* span = allocateSpanStruct();
+    if (span) {
+        span->start = result;
+        span->pages = size / PAGESIZE;
+        span->sizeClass = LARGE_CLASS;
+        // Only the first page is needed because the pointer is never
+        // inside of another page.
+        if (!setPagemapEntries(span, 1)) {
+            freeSpanStruct(span);
+            span = NULL;
+        }
+    }
+    if (!span) {
+        __unlockHeap();
+        unmapMemory(result, size);
+        errno = ENOMEM;
+        return NULL;
+    }
+    __mallocStats.largeAllocations++;
+    __mallocStats.largeBytes += size;
+    __mallocStats.mappedBytes += size;
+    __unlockHeap();
+    return result;
+}
+
+void __freeLarge(Span* span) {
+    __lockHeap();
+    void* start = span->start;
+    size_t size = span->pages * PAGESIZE;
+    clearPagemapEntries(span, 1);
+    freeSpanStruct(span);
+    __mallocStats.largeAllocations--;
+    __mallocStats.largeBytes -= size;
+    __mallocStats.mappedBytes -= size;
+    __unlockHeap();
+    unmapMemory(start, size);
+}
+
+// Shrinks a large allocation in place. Growing is not possible because the
+// pages after the allocation might already be in use.
+bool __resizeLarge(Span* span, size_t size) {
+    size = alignUp(size, PAGESIZE);
+    size_t oldSize = span->pages * PAGESIZE;
+    if (size > oldSize) return false;
+    if (size == oldSize) return true;
+
+    __lockHeap();
+    span->pages = size / PAGESIZE;
+    __mallocStats.largeBytes -= oldSize - size;
+    __mallocStats.mappedBytes -= oldSize - size;
+    __unlockHeap();
+    unmapMemory(span->start + size, oldSize - size);
+    return true;
+}
+
+Span* __getSpan(const void* addr) {
+    void** entry = getPagemapEntry((uintptr_t) addr, false);
+    return entry ? *entry : NULL;
 }
 
 #ifdef __is_dennix_libc
-void __lockHeap(void) {
+#  include <pthread.h>
 
+static pthread_mutex_t heapMutex = PTHREAD_MUTEX_INITIALIZER;
+
+void __lockHeap(void) {
+    pthread_mutex_lock(&heapMutex);
 }
 
 void __unlockHeap(void) {
-
+    pthread_mutex_unlock(&heapMutex);
 }
 #endif
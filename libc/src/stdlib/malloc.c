@@ -17,58 +17,21 @@
  * Memory allocation.
  */
 
-#include <errno.h>
-#include <stdalign.h>
-#include <stddef.h>
 #include "malloc.h"
 
 void* malloc(size_t size) {
-    if (size == 0) size = 1;
+    if (size > MAX_SMALL_SIZE) return __allocateLarge(size);
 
-    size = alignUp(size, 16);
+    unsigned int sizeClass = __sizeToClass(size);
+#ifdef __is_dennix_libc
+    if (sizeClass < CACHE_CLASSES) {
+        void* result = __allocateCached(sizeClass);
+        if (result) return result;
+    }
+#endif
 
     __lockHeap();
-
-    Chunk* currentBigChunk = __firstBigChunk;
-    Chunk* currentChunk = currentBigChunk + 1;
-
-    while (1) {
-        switch (currentChunk->magic) {
-        case MAGIC_FREE_CHUNK:
-            if (currentChunk->size >= size) {
-                // We found a chunk!
-                if (currentChunk->size > size + sizeof(Chunk)) {
-                    // Split the chunk
-                    __splitChunk(currentChunk, size);
-                }
-                currentChunk->magic = MAGIC_USED_CHUNK;
-                __unlockHeap();
-                return (void*) (currentChunk + 1);
-            } else {
-                currentChunk = currentChunk->next;
-            }
-            break;
-        case MAGIC_USED_CHUNK:
-            currentChunk = currentChunk->next;
-            break;
-        case MAGIC_END_CHUNK:
-            if (currentBigChunk->next) {
-                currentBigChunk = currentBigChunk->next;
-                currentChunk = currentBigChunk + 1;
-            } else {
-                currentBigChunk = __allocateBigChunk(currentBigChunk, size);
-                currentChunk = currentBigChunk + 1;
-                if (!currentBigChunk) {
-                    __unlockHeap();
-                    errno = ENOMEM;
-                    return NULL;
-                }
-            }
-            break;
-        default:
-            // This shouldn't happen!
-            __unlockHeap();
-            abort();
-        }
-    }
+    void* result = __allocateSmall(sizeClass);
+    __unlockHeap();
+    return result;
 }
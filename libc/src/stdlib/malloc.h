@@ -21,12 +21,17 @@
 #define MALLOC_H
 
 #include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #if __is_dennix_libc
 #  include <sys/mman.h>
-#  define mapMemory(size) mmap(NULL, size, PROT_READ | PROT_WRITE, \
-        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+static inline void* mapMemory(size_t size) {
+    void* result = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return result == MAP_FAILED ? NULL : result;
+}
 #  define unmapMemory(addr, size) munmap(addr, size)
 #else /* if __is_dennix_libk */
 extern void* __mapMemory(size_t);
@@ -36,27 +41,79 @@ extern void __unmapMemory(void*, size_t);
 #  define unmapMemory(addr, size) __unmapMemory(addr, size)
 #endif
 
-typedef struct Chunk {
-    size_t magic;
-    size_t size;
-    struct Chunk* prev;
-    struct Chunk* next;
-} Chunk;
+// Small allocations are rounded up to one of these size classes: Multiples of
+// 16 up to 128 and then four classes for each power of two up to 16 KiB.
+#define NUM_SIZE_CLASSES 36
+#define MAX_SMALL_SIZE 16384
+#define LARGE_CLASS 0xFFFF
 
-#define MAGIC_BIG_CHUNK 0xC001C0DE
-#define MAGIC_FREE_CHUNK 0xBEEFBEEF
-#define MAGIC_USED_CHUNK 0xDEADBEEF
-#define MAGIC_END_CHUNK 0xDEADDEAD
+#define MAX_SPAN_OBJECTS 256
+#define BITMAP_WORDS (MAX_SPAN_OBJECTS / (CHAR_BIT * sizeof(unsigned long)))
+
+// A span is a range of pages that either contains objects of a single size
+// class or a single large allocation.
+typedef struct Span {
+    struct Span* prev;
+    struct Span* next;
+    char* start;
+    size_t pages;
+    unsigned short sizeClass;
+    unsigned short objects;
+    unsigned short freeObjects;
+    // Set bits are free objects.
+    unsigned long bitmap[BITMAP_WORDS];
+} Span;
+
+struct MallocStats {
+    size_t spans[NUM_SIZE_CLASSES];
+    size_t objectsInUse[NUM_SIZE_CLASSES];
+    size_t largeAllocations;
+    size_t largeBytes;
+    size_t mappedBytes;
+};
 
 #define alignUp(val, alignment) ((((val) - 1) & ~((alignment) - 1)) + (alignment))
 
-extern Chunk* __firstBigChunk;
+extern struct MallocStats __mallocStats;
+
+static inline unsigned int __sizeToClass(size_t size) {
+    if (size <= 128) return size ? (size - 1) / 16 : 0;
+    unsigned int shift = sizeof(long) * CHAR_BIT - 1 -
+            __builtin_clzl(size - 1);
+    size_t base = (size_t) 1 << shift;
+    return 8 + (shift - 7) * 4 + (size - 1 - base) / (base / 4);
+}
+
+static inline size_t __classToSize(unsigned int sizeClass) {
+    if (sizeClass < 8) return 16 * (sizeClass + 1);
+    size_t base = (size_t) 128 << (sizeClass - 8) / 4;
+    return base + ((sizeClass - 8) % 4 + 1) * (base / 4);
+}
 
-Chunk* __allocateBigChunk(Chunk* lastBigChunk, size_t size);
-void __splitChunk(Chunk* chunk, size_t size);
-Chunk* __unifyChunks(Chunk* first, Chunk* second);
+void* __allocateLarge(size_t size);
+void* __allocateSmall(unsigned int sizeClass);
+void __freeLarge(Span* span);
+void __freeSmall(Span* span, void* addr);
+Span* __getSpan(const void* addr);
+bool __resizeLarge(Span* span, size_t size);
 
 void __lockHeap(void);
 void __unlockHeap(void);
 
+#ifdef __is_dennix_libc
+// Threads keep a few free objects of the smaller size classes so that most
+// allocations do not need to take the heap lock.
+#  define CACHE_CLASSES 20
+#  define CACHE_SIZE 32
+
+struct MallocCache {
+    unsigned int count[CACHE_CLASSES];
+    void* objects[CACHE_CLASSES][CACHE_SIZE];
+};
+
+void* __allocateCached(unsigned int sizeClass);
+bool __freeCached(unsigned int sizeClass, void* addr);
+void __destroyMallocCache(void);
+#endif
+
 #endif
@@ -0,0 +1,42 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/stdlib/malloc_stats.c
+ * Prints memory allocation statistics.
+ */
+
+#include <stdio.h>
+#include "malloc.h"
+
+void malloc_stats(void) {
+    __lockHeap();
+    struct MallocStats stats = __mallocStats;
+    __unlockHeap();
+
+    size_t inUse = 0;
+    fprintf(stderr, "%10s %8s %10s\n", "size", "spans", "objects");
+    for (unsigned int i = 0; i < NUM_SIZE_CLASSES; i++) {
+        if (!stats.spans[i]) continue;
+        fprintf(stderr, "%10zu %8zu %10zu\n", __classToSize(i),
+                stats.spans[i], stats.objectsInUse[i]);
+        inUse += stats.objectsInUse[i] * __classToSize(i);
+    }
+
+    // Objects in thread caches are counted as in use.
+    fprintf(stderr, "small bytes in use:  %zu\n", inUse);
+    fprintf(stderr, "large allocations:   %zu (%zu bytes)\n",
+            stats.largeAllocations, stats.largeBytes);
+    fprintf(stderr, "total bytes mapped:  %zu\n", stats.mappedBytes);
+}
@@ -19,10 +19,13 @@
 
 #include <errno.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/wait.h>
 
+extern char** environ;
+
 int system(const char* command) {
     if (!command) {
         return access("/bin/sh", X_OK) == 0;
@@ -43,18 +46,36 @@ int system(const char* command) {
     sigset_t oldMask;
     sigprocmask(SIG_BLOCK, &maskSigchld, &oldMask);
 
+    // The child gets the original signal mask and dispositions back.
+    // Dispositions other than SIG_IGN cannot be inherited across execve, so
+    // resetting these signals to their default action is sufficient.
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    if (sigint.sa_handler != SIG_IGN) {
+        sigaddset(&defaultSignals, SIGINT);
+    }
+    if (sigquit.sa_handler != SIG_IGN) {
+        sigaddset(&defaultSignals, SIGQUIT);
+    }
+    posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+    posix_spawnattr_setsigmask(&attr, &oldMask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF |
+            POSIX_SPAWN_SETSIGMASK);
+
     int status;
+    pid_t pid;
+    char* argv[] = { "sh", "-c", (char*) command, NULL };
+    int error = posix_spawn(&pid, "/bin/sh", NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
 
-    pid_t pid = fork();
-    if (pid < 0) {
+    if (error == EAGAIN || error == ENOMEM) {
+        errno = error;
         status = -1;
-    } else if (pid == 0) {
-        sigaction(SIGINT, &sigint, NULL);
-        sigaction(SIGQUIT, &sigquit, NULL);
-        sigprocmask(SIG_SETMASK, &oldMask, NULL);
-
-        execl("/bin/sh", "sh", "-c", command, NULL);
-        _Exit(127);
+    } else if (error) {
+        // Behave as if the shell had been executed and exited with status 127.
+        status = _WSTATUS(_WEXITED, 127);
     } else {
         while (waitpid(pid, &status, 0) < 0) {
             if (errno != EINTR) {
@@ -18,9 +18,36 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+// Only aligned blocks are loaded, so no load crosses into a page that does not
+// contain any of the searched bytes.
+static SSE2_TARGET void* memchrSse2(const unsigned char* p, unsigned char c,
+        size_t size) {
+    v16qi needle = (v16qi) {0} + (char) c;
+    size_t offset = (uintptr_t) p & 15;
+    unsigned int mask = CMPEQ_MASK(LOAD_ALIGNED(p - offset), needle) >> offset;
+    if (mask) {
+        size_t i = __builtin_ctz(mask);
+        return i < size ? (void*) &p[i] : NULL;
+    }
+
+    for (size_t i = 16 - offset; i < size; i += 16) {
+        mask = CMPEQ_MASK(LOAD_ALIGNED(p + i), needle);
+        if (mask) {
+            i += __builtin_ctz(mask);
+            return i < size ? (void*) &p[i] : NULL;
+        }
+    }
+    return NULL;
+}
 
 void* memchr(const void* s, int c, size_t size) {
     const unsigned char* p = s;
+    if (HAVE_SSE2 && size >= 16) {
+        return memchrSse2(p, c, size);
+    }
+
     for (size_t i = 0; i < size; i++) {
         if (p[i] == (unsigned char) c) {
             return (void*) &p[i];
@@ -18,12 +18,30 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+// Returns the offset of the first differing byte or the number of bytes that
+// were compared.
+static SSE2_TARGET size_t compareSse2(const unsigned char* a,
+        const unsigned char* b, size_t size) {
+    size_t i;
+    for (i = 0; i + 16 <= size; i += 16) {
+        unsigned int mask = CMPEQ_MASK(LOAD(a + i), LOAD(b + i)) ^ 0xFFFF;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i;
+}
 
 int memcmp(const void* p1, const void* p2, size_t size) {
     const unsigned char* a = p1;
     const unsigned char* b = p2;
 
-    for (size_t i = 0; i < size; i++) {
+    size_t i = 0;
+    if (HAVE_SSE2) {
+        i = compareSse2(a, b, size);
+    }
+
+    for (; i < size; i++) {
         if (a[i] < b[i]) {
             return -1;
         } else if (a[i] > b[i]) {
@@ -18,13 +18,23 @@
  */
 
 #include <string.h>
+#include "simd.h"
 
 void* memcpy(void* restrict dest, const void* restrict src, size_t size) {
     unsigned char* d = dest;
     const unsigned char* s = src;
 
-    for (size_t i = 0; i < size; i++) {
-        d[i] = s[i];
+    if (HAVE_ERMS && size >= ERMS_THRESHOLD) {
+        asm volatile ("rep movsb" : "+D"(d), "+S"(s), "+c"(size)
+                :: "memory");
+    } else if (HAVE_SSE2 && size >= 16) {
+        __copySse2(d, s, size);
+    } else if (size >= 16) {
+        __copyWords(d, s, size);
+    } else {
+        for (size_t i = 0; i < size; i++) {
+            d[i] = s[i];
+        }
     }
 
     return dest;
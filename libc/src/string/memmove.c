@@ -18,15 +18,38 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+static SSE2_TARGET void copyBackwardSse2(unsigned char* dest,
+        const unsigned char* src, size_t size) {
+    v16qi head = LOAD(src);
+    while (size > 16) {
+        size -= 16;
+        STORE(dest + size, LOAD(src + size));
+    }
+    STORE(dest, head);
+}
 
 void* memmove(void* dest, const void* src, size_t size) {
     unsigned char* d = dest;
     const unsigned char* s = src;
 
-    if (src > dest) {
-        for (size_t i = 0; i < size; i++) {
-            d[i] = s[i];
+    if (src > dest || s + size <= d) {
+        // Copying forward is safe here, so memcpy's strategy can be used.
+        if (HAVE_ERMS && size >= ERMS_THRESHOLD) {
+            asm volatile ("rep movsb" : "+D"(d), "+S"(s), "+c"(size)
+                    :: "memory");
+        } else if (HAVE_SSE2 && size >= 16) {
+            __copySse2(d, s, size);
+        } else if (size >= 16) {
+            __copyWords(d, s, size);
+        } else {
+            for (size_t i = 0; i < size; i++) {
+                d[i] = s[i];
+            }
         }
+    } else if (HAVE_SSE2 && size >= 16) {
+        copyBackwardSse2(d, s, size);
     } else {
         for (size_t i = size; i > 0; i--) {
             d[i - 1] = s[i - 1];
@@ -18,12 +18,39 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+static SSE2_TARGET void setSse2(unsigned char* p, unsigned char value,
+        size_t size) {
+    v16qi v = (v16qi) {0} + (char) value;
+    unsigned char* last = p + size - 16;
+    while (p < last) {
+        STORE(p, v);
+        p += 16;
+    }
+    STORE(last, v);
+}
 
 void* memset(void* dest, int value, size_t size) {
     unsigned char* p = dest;
 
-    for (size_t i = 0; i < size; i++) {
-        p[i] = (unsigned char) value;
+    if (HAVE_ERMS && size >= ERMS_THRESHOLD) {
+        asm volatile ("rep stosb" : "+D"(p), "+c"(size) : "a"(value)
+                : "memory");
+    } else if (HAVE_SSE2 && size >= 16) {
+        setSse2(p, value, size);
+    } else if (size >= 16) {
+        unsigned long word = (unsigned char) value * (~0UL / 0xFF);
+        size_t words = size / sizeof(long);
+        size_t bytes = size % sizeof(long);
+        asm volatile (REP_STOS_WORD : "+D"(p), "+c"(words) : "a"(word)
+                : "memory");
+        asm volatile ("rep stosb" : "+D"(p), "+c"(bytes) : "a"(word)
+                : "memory");
+    } else {
+        for (size_t i = 0; i < size; i++) {
+            p[i] = (unsigned char) value;
+        }
     }
 
     return dest;
@@ -0,0 +1,97 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/string/simd.h
+ * Helpers for vectorized string functions.
+ */
+
+#ifndef STRING_SIMD_H
+#define STRING_SIMD_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __is_dennix_libc
+#  include "../crt/cpu.h"
+#  ifdef __SSE2__
+#    define HAVE_SSE2 1
+#  else
+#    define HAVE_SSE2 (__cpuFeatures & CPU_SSE2)
+#  endif
+#  define HAVE_ERMS (__cpuFeatures & CPU_ERMS)
+#else
+// The kernel does not save FPU registers on entry, so libk must not use SSE.
+#  define HAVE_SSE2 0
+#  define HAVE_ERMS 0
+#endif
+
+// From this size on rep movsb and rep stosb are faster than the SSE2 loops on
+// CPUs with enhanced rep movsb/stosb.
+#define ERMS_THRESHOLD 2048
+
+#ifdef __x86_64__
+#  define REP_MOVS_WORD "rep movsq"
+#  define REP_STOS_WORD "rep stosq"
+#else
+#  define REP_MOVS_WORD "rep movsl"
+#  define REP_STOS_WORD "rep stosl"
+#endif
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+
+typedef char v16qi __attribute__((vector_size(16)));
+typedef char v16qi_a __attribute__((vector_size(16), __may_alias__));
+typedef char v16qi_u __attribute__((vector_size(16), __may_alias__,
+        aligned(1)));
+
+#define LOAD(p) (*(const v16qi_u*) (p))
+#define LOAD_ALIGNED(p) (*(const v16qi_a*) (p))
+#define STORE(p, v) (*(v16qi_u*) (p) = (v))
+
+// Returns a mask with a bit set for every byte that is equal in a and b.
+#define CMPEQ_MASK(a, b) \
+    ((unsigned int) __builtin_ia32_pmovmskb128((v16qi) ((a) == (b))))
+
+#define PAGE_OFFSET(p) ((uintptr_t) (p) & (PAGESIZE - 1))
+
+// Copies forward using only integer registers. This is also correct for
+// overlapping buffers when dest is below src.
+static inline void __copyWords(unsigned char* dest, const unsigned char* src,
+        size_t size) {
+    size_t words = size / sizeof(long);
+    size_t bytes = size % sizeof(long);
+    asm volatile (REP_MOVS_WORD : "+D"(dest), "+S"(src), "+c"(words)
+            :: "memory");
+    asm volatile ("rep movsb" : "+D"(dest), "+S"(src), "+c"(bytes)
+            :: "memory");
+}
+
+// Copies at least 16 bytes forward. Like __copyWords this may be used for
+// overlapping buffers when dest is below src.
+static inline SSE2_TARGET void __copySse2(unsigned char* dest,
+        const unsigned char* src, size_t size) {
+    v16qi tail = LOAD(src + size - 16);
+    unsigned char* tailDest = dest + size - 16;
+    while (size > 16) {
+        STORE(dest, LOAD(src));
+        dest += 16;
+        src += 16;
+        size -= 16;
+    }
+    STORE(tailDest, tail);
+}
+
+#endif
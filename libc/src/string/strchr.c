@@ -18,8 +18,33 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+static SSE2_TARGET char* strchrSse2(const char* s, char c) {
+    v16qi zero = {0};
+    v16qi needle = zero + c;
+    size_t offset = (uintptr_t) s & 15;
+    const char* block = s - offset;
+    v16qi data = LOAD_ALIGNED(block);
+    unsigned int mask = (CMPEQ_MASK(data, needle) | CMPEQ_MASK(data, zero)) >>
+            offset;
+
+    while (!mask) {
+        block += 16;
+        data = LOAD_ALIGNED(block);
+        mask = CMPEQ_MASK(data, needle) | CMPEQ_MASK(data, zero);
+        s = block;
+    }
+
+    s += __builtin_ctz(mask);
+    return *s == c ? (char*) s : NULL;
+}
 
 char* strchr(const char* s, int c) {
+    if (HAVE_SSE2) {
+        return strchrSse2(s, (char) c);
+    }
+
     do {
         if (*s == (char) c) {
             return (char*) s;
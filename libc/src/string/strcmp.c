@@ -18,11 +18,44 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+static SSE2_TARGET int strcmpSse2(const unsigned char* s1,
+        const unsigned char* s2) {
+    v16qi zero = {0};
+
+    while (true) {
+        if (PAGE_OFFSET(s1) > PAGESIZE - 16 ||
+                PAGE_OFFSET(s2) > PAGESIZE - 16) {
+            // A 16 byte load could cross into a page that is not mapped.
+            if (*s1 != *s2 || !*s1) {
+                return (*s1 > *s2) - (*s1 < *s2);
+            }
+            s1++;
+            s2++;
+            continue;
+        }
+
+        v16qi a = LOAD(s1);
+        unsigned int mask = (CMPEQ_MASK(a, LOAD(s2)) ^ 0xFFFF) |
+                CMPEQ_MASK(a, zero);
+        if (mask) {
+            size_t i = __builtin_ctz(mask);
+            return (s1[i] > s2[i]) - (s1[i] < s2[i]);
+        }
+        s1 += 16;
+        s2 += 16;
+    }
+}
 
 int strcmp(const char* str1, const char* str2) {
     const unsigned char* s1 = (const unsigned char*) str1;
     const unsigned char* s2 = (const unsigned char*) str2;
 
+    if (HAVE_SSE2) {
+        return strcmpSse2(s1, s2);
+    }
+
     while (*s1 || *s2) {
         if (*s1 < *s2) {
             return -1;
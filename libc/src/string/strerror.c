@@ -98,6 +98,7 @@ char* strerror(int errnum) {
     case ESRCH: return "No such process";
     case ESTALE: return "Stale file handle";
     case ETIMEDOUT: return "Connection timed out";
+    case ETOOMANYREFS: return "Too many references";
     case ETXTBSY: return "Text file busy";
     case EWOULDBLOCK: return "Operation would block";
     case EXDEV: return "Cross-device link";
@@ -18,8 +18,25 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+static SSE2_TARGET size_t strlenSse2(const char* s) {
+    v16qi zero = {0};
+    size_t offset = (uintptr_t) s & 15;
+    unsigned int mask = CMPEQ_MASK(LOAD_ALIGNED(s - offset), zero) >> offset;
+    if (mask) return __builtin_ctz(mask);
+
+    for (size_t length = 16 - offset; ; length += 16) {
+        mask = CMPEQ_MASK(LOAD_ALIGNED(s + length), zero);
+        if (mask) return length + __builtin_ctz(mask);
+    }
+}
 
 size_t strlen(const char* s) {
+    if (HAVE_SSE2) {
+        return strlenSse2(s);
+    }
+
     size_t result = 0;
     while (*s++) {
         result++;
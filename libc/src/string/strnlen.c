@@ -18,8 +18,32 @@
  */
 
 #include <string.h>
+#include "simd.h"
+
+static SSE2_TARGET size_t strnlenSse2(const char* s, size_t maxlen) {
+    v16qi zero = {0};
+    size_t offset = (uintptr_t) s & 15;
+    unsigned int mask = CMPEQ_MASK(LOAD_ALIGNED(s - offset), zero) >> offset;
+    if (mask) {
+        size_t length = __builtin_ctz(mask);
+        return length < maxlen ? length : maxlen;
+    }
+
+    for (size_t length = 16 - offset; length < maxlen; length += 16) {
+        mask = CMPEQ_MASK(LOAD_ALIGNED(s + length), zero);
+        if (mask) {
+            length += __builtin_ctz(mask);
+            return length < maxlen ? length : maxlen;
+        }
+    }
+    return maxlen;
+}
 
 size_t strnlen(const char* s, size_t maxlen) {
+    if (HAVE_SSE2 && maxlen >= 16) {
+        return strnlenSse2(s, maxlen);
+    }
+
     size_t length = 0;
     while (length < maxlen && s[length] != '\0') {
         length++;
@@ -0,0 +1,43 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/sys/mman/shm_open.c
+ * Open a shared memory object.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+int shm_open(const char* name, int flags, mode_t mode) {
+    // Shared memory objects are files in /dev/shm. Only names of the form
+    // "/name" are portable, so reject anything else.
+    if (name[0] != '/' || !name[1] || strchr(name + 1, '/')) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    char* path = malloc(sizeof("/dev/shm") + strlen(name));
+    if (!path) return -1;
+    stpcpy(stpcpy(path, "/dev/shm"), name);
+
+    int fd = open(path, flags | O_CLOEXEC | O_NOFOLLOW, mode);
+    int oldErrno = errno;
+    free(path);
+    errno = oldErrno;
+    return fd;
+}
@@ -0,0 +1,39 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/sys/socket/recvfrom.c
+ * Receive a message and its source address from a socket.
+ */
+
+#include <sys/socket.h>
+
+ssize_t recvfrom(int fd, void* restrict buffer, size_t size, int flags,
+        struct sockaddr* restrict address, socklen_t* restrict length) {
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = size;
+
+    struct msghdr msg = {0};
+    msg.msg_name = address;
+    msg.msg_namelen = length ? *length : 0;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    ssize_t result = recvmsg(fd, &msg, flags);
+    if (result >= 0 && length) {
+        *length = msg.msg_namelen;
+    }
+    return result;
+}
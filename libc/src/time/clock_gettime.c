@@ -19,6 +19,26 @@
 
 #include <time.h>
 #include <sys/syscall.h>
+#include "../crt/vdso.h"
 
-DEFINE_SYSCALL_GLOBAL(SYSCALL_CLOCK_GETTIME, int, clock_gettime,
+DEFINE_SYSCALL(SYSCALL_CLOCK_GETTIME, int, sys_clock_gettime,
         (clockid_t, struct timespec*));
+
+int clock_gettime(clockid_t clock, struct timespec* ts) {
+    if (!__vdso || (clock != CLOCK_MONOTONIC && clock != CLOCK_REALTIME)) {
+        return sys_clock_gettime(clock, ts);
+    }
+
+    // The kernel updates the clocks in the vDSO on every timer tick.
+    const struct vdso_clocks* clocks = (const struct vdso_clocks*) __vdso;
+    unsigned long sequence;
+    unsigned long end;
+    do {
+        sequence = __atomic_load_n(&clocks->vc_sequence, __ATOMIC_ACQUIRE);
+        *ts = clock == CLOCK_MONOTONIC ? clocks->vc_monotonic :
+                clocks->vc_realtime;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&clocks->vc_sequence, __ATOMIC_RELAXED);
+    } while ((sequence & 1) || end != sequence);
+    return 0;
+}
@@ -0,0 +1,37 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/src/unistd/copy_file_range.c
+ * Copy data between files.
+ */
+
+#include <unistd.h>
+#include <dennix/splice.h>
+#include <sys/syscall.h>
+
+DEFINE_SYSCALL(SYSCALL_COPY_FILE_RANGE, ssize_t, sys_copy_file_range,
+        (struct spliceParams*));
+
+ssize_t copy_file_range(int inFd, off_t* inOffset, int outFd,
+        off_t* outOffset, size_t length, unsigned int flags) {
+    struct spliceParams params;
+    params.inFd = inFd;
+    params.inOffset = inOffset;
+    params.outFd = outFd;
+    params.outOffset = outOffset;
+    params.length = length;
+    params.flags = flags;
+    return sys_copy_file_range(&params);
+}
@@ -18,7 +18,13 @@
  */
 
 #include <unistd.h>
+#include "../pthread/thread.h"
 
 pid_t fork(void) {
-    return rfork(_RFFORK);
+    pid_t pid = rfork(_RFFORK);
+    if (pid == 0) {
+        // Only the calling thread exists in the child process.
+        __threadCount = 1;
+    }
+    return pid;
 }
@@ -19,5 +19,16 @@
 
 #include <unistd.h>
 #include <sys/syscall.h>
+#include "../crt/vdso.h"
 
-DEFINE_SYSCALL_GLOBAL(SYSCALL_GETPID, pid_t, getpid, (void));
+DEFINE_SYSCALL(SYSCALL_GETPID, pid_t, sys_getpid, (void));
+
+pid_t getpid(void) {
+    if (__vdso) {
+        const struct vdso_process* process =
+                (const struct vdso_process*) (__vdso + VDSO_PROCESS);
+        pid_t pid = __atomic_load_n(&process->vp_pid, __ATOMIC_RELAXED);
+        if (pid > 0) return pid;
+    }
+    return sys_getpid();
+}
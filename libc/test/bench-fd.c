@@ -0,0 +1,147 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/bench-fd.c
+ * Benchmark for file descriptor allocation and process lookup.
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define NUM_FDS 50000
+#define NUM_PROCESSES 5000
+#define ITERATIONS 10000
+
+static uint64_t nanosecondsSince(const struct timespec* start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000000000ULL + end.tv_nsec -
+            start->tv_nsec;
+}
+
+static void benchmarkFds(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+            limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int fd = open("/dev/null", O_RDONLY);
+    if (fd < 0) {
+        perror("/dev/null");
+        exit(1);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int count = 0;
+    while (count < NUM_FDS && dup(fd) >= 0) {
+        count++;
+    }
+    uint64_t nanoseconds = nanosecondsSince(&start);
+    printf("dup of %d fds: %" PRIu64 " ns per fd\n", count,
+            nanoseconds / (count ? count : 1));
+
+    // Reusing the lowest free fd must not scan all open fds.
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < ITERATIONS; i++) {
+        close(fd);
+        if (dup(fd + 1) != fd) {
+            fputs("dup did not return the lowest free fd\n", stderr);
+            exit(1);
+        }
+    }
+    nanoseconds = nanosecondsSince(&start);
+    printf("close and dup with %d open fds: %" PRIu64 " ns\n", count,
+            nanoseconds / ITERATIONS);
+
+    // Allocating a new fd after the highest one.
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int iterations = 0;
+    while (iterations < ITERATIONS) {
+        int newFd = dup(fd);
+        if (newFd < 0) break;
+        close(newFd);
+        iterations++;
+    }
+    nanoseconds = nanosecondsSince(&start);
+    if (iterations) {
+        printf("dup and close of the highest fd: %" PRIu64 " ns\n",
+                nanoseconds / iterations);
+    }
+
+    for (int i = 0; i <= count; i++) {
+        close(fd + i);
+    }
+}
+
+static void benchmarkProcesses(void) {
+    static pid_t pids[NUM_PROCESSES];
+    int fds[2];
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        exit(1);
+    }
+
+    // The children wait until the pipe is closed.
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int count = 0;
+    while (count < NUM_PROCESSES) {
+        pid_t pid = fork();
+        if (pid < 0) break;
+        if (pid == 0) {
+            char c;
+            close(fds[1]);
+            read(fds[0], &c, 1);
+            _exit(0);
+        }
+        pids[count++] = pid;
+    }
+    uint64_t nanoseconds = nanosecondsSince(&start);
+    printf("fork of %d processes: %" PRIu64 " us per process\n", count,
+            nanoseconds / (count ? count : 1) / 1000);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < ITERATIONS; i++) {
+        kill(pids[i % count], 0);
+    }
+    nanoseconds = nanosecondsSince(&start);
+    printf("kill(pid, 0) with %d processes: %" PRIu64 " ns\n", count,
+            nanoseconds / ITERATIONS);
+
+    close(fds[0]);
+    close(fds[1]);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < count; i++) {
+        waitpid(pids[i], NULL, 0);
+    }
+    nanoseconds = nanosecondsSince(&start);
+    printf("waitpid of %d processes: %" PRIu64 " us per process\n", count,
+            nanoseconds / (count ? count : 1) / 1000);
+}
+
+int main(void) {
+    benchmarkFds();
+    benchmarkProcesses();
+}
@@ -0,0 +1,156 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/bench-malloc.c
+ * Benchmark for memory allocation.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ITERATIONS 1000000
+#define NUM_SLOTS 4096
+#define NUM_THREADS 4
+
+static void* slots[NUM_THREADS][NUM_SLOTS];
+
+static uint32_t nextRandom(uint32_t* state) {
+    *state = *state * 1103515245 + 12345;
+    return *state >> 8;
+}
+
+// Allocates and immediately frees blocks of the same size.
+static size_t sameSize(size_t size, void** slots) {
+    (void) slots;
+    for (int i = 0; i < ITERATIONS; i++) {
+        void* block = malloc(size);
+        if (!block) abort();
+        *(volatile char*) block = 0;
+        free(block);
+    }
+    return ITERATIONS;
+}
+
+// Replaces random blocks of a working set with blocks of mixed sizes. Most
+// allocations are small, some are large.
+static size_t mixedSizes(size_t maxSize, void** slots) {
+    uint32_t state = (uintptr_t) slots;
+    for (int i = 0; i < ITERATIONS; i++) {
+        uint32_t random = nextRandom(&state);
+        size_t index = random % NUM_SLOTS;
+        size_t size = random % 16 == 0 ? nextRandom(&state) % maxSize + 1 :
+                nextRandom(&state) % 256 + 1;
+        free(slots[index]);
+        slots[index] = malloc(size);
+        if (!slots[index]) abort();
+        memset(slots[index], 0, size < 64 ? size : 64);
+    }
+
+    for (size_t i = 0; i < NUM_SLOTS; i++) {
+        free(slots[i]);
+        slots[i] = NULL;
+    }
+    return ITERATIONS;
+}
+
+// Reallocates a growing buffer as done when reading input of unknown size.
+static size_t growing(size_t maxSize, void** slots) {
+    (void) slots;
+    size_t operations = 0;
+    for (int i = 0; i < ITERATIONS / 1000; i++) {
+        char* buffer = NULL;
+        for (size_t size = 16; size <= maxSize; size *= 2) {
+            buffer = realloc(buffer, size);
+            if (!buffer) abort();
+            buffer[size - 1] = 0;
+            operations++;
+        }
+        free(buffer);
+    }
+    return operations;
+}
+
+struct Benchmark {
+    size_t (*func)(size_t, void**);
+    size_t size;
+    size_t operations;
+};
+
+static void* runBenchmark(void* arg) {
+    struct Benchmark* benchmark = arg;
+    static int nextThread;
+    int thread = __atomic_fetch_add(&nextThread, 1, __ATOMIC_RELAXED);
+    size_t operations = benchmark->func(benchmark->size,
+            slots[thread % NUM_THREADS]);
+    __atomic_fetch_add(&benchmark->operations, operations, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static uint64_t measure(size_t (*func)(size_t, void**), size_t size,
+        int threads) {
+    struct Benchmark benchmark = { func, size, 0 };
+    pthread_t thread[NUM_THREADS];
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&thread[i], NULL, runBenchmark, &benchmark) != 0) {
+            fputs("pthread_create failed\n", stderr);
+            exit(1);
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    uint64_t nanoseconds = (end.tv_sec - start.tv_sec) * 1000000000ULL +
+            end.tv_nsec - start.tv_nsec;
+    return nanoseconds / benchmark.operations;
+}
+
+int main(void) {
+    static const struct {
+        const char* name;
+        size_t (*func)(size_t, void**);
+        size_t size;
+    } benchmarks[] = {
+        { "same size 16", sameSize, 16 },
+        { "same size 256", sameSize, 256 },
+        { "same size 4096", sameSize, 4096 },
+        { "same size 256K", sameSize, 256 * 1024 },
+        { "mixed up to 4K", mixedSizes, 4096 },
+        { "mixed up to 256K", mixedSizes, 256 * 1024 },
+        { "realloc up to 1M", growing, 1024 * 1024 },
+    };
+
+    printf("%-18s%10s%10s  (ns per operation)\n", "", "1 thread",
+            "4 threads");
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        printf("%-18s", benchmarks[i].name);
+        fflush(stdout);
+        printf("%10" PRIu64, measure(benchmarks[i].func, benchmarks[i].size,
+                1));
+        fflush(stdout);
+        printf("%10" PRIu64 "\n", measure(benchmarks[i].func,
+                benchmarks[i].size, NUM_THREADS));
+    }
+
+    malloc_stats();
+}
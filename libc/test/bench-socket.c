@@ -0,0 +1,154 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/bench-socket.c
+ * Benchmark for Unix stream sockets.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define MAX_CHUNK_SIZE (1024 * 1024)
+#define BYTES_PER_RUN (64 * 1024 * 1024)
+#define ROUND_TRIPS 100000
+
+static const int bufferSizes[] = { 0, 64 * 1024, 16 * 1024 * 1024 };
+#define NUM_BUFFER_SIZES (sizeof(bufferSizes) / sizeof(bufferSizes[0]))
+
+static char* buffer;
+
+static uint64_t nanosecondsSince(const struct timespec* start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t nanoseconds = (end.tv_sec - start->tv_sec) * 1000000000ULL +
+            end.tv_nsec - start->tv_nsec;
+    return nanoseconds ? nanoseconds : 1;
+}
+
+static pid_t startReader(int fds[2], size_t chunkSize, int echo) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    } else if (pid == 0) {
+        close(fds[0]);
+        ssize_t size;
+        while ((size = read(fds[1], buffer, chunkSize)) > 0) {
+            if (echo && write(fds[1], buffer, size) != size) _exit(1);
+        }
+        _exit(size < 0);
+    }
+
+    close(fds[1]);
+    return pid;
+}
+
+static void createSocketPair(int fds[2], int bufferSize) {
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        perror("socketpair");
+        exit(1);
+    }
+
+    if (bufferSize) {
+        for (int i = 0; i < 2; i++) {
+            if (setsockopt(fds[i], SOL_SOCKET, SO_SNDBUF, &bufferSize,
+                    sizeof(bufferSize)) < 0 || setsockopt(fds[i], SOL_SOCKET,
+                    SO_RCVBUF, &bufferSize, sizeof(bufferSize)) < 0) {
+                perror("setsockopt");
+                exit(1);
+            }
+        }
+    }
+}
+
+static uint64_t pingPong(void) {
+    int fds[2];
+    createSocketPair(fds, 0);
+    pid_t pid = startReader(fds, 1, 1);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        if (write(fds[0], buffer, 1) != 1 || read(fds[0], buffer, 1) != 1) {
+            perror("ping-pong");
+            exit(1);
+        }
+    }
+    uint64_t nanoseconds = nanosecondsSince(&start);
+
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    return nanoseconds / ROUND_TRIPS;
+}
+
+static uint64_t bandwidth(size_t chunkSize, int bufferSize) {
+    int fds[2];
+    createSocketPair(fds, bufferSize);
+    pid_t pid = startReader(fds, chunkSize, 0);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t sent = 0; sent < BYTES_PER_RUN; sent += chunkSize) {
+        size_t written = 0;
+        while (written < chunkSize) {
+            ssize_t result = write(fds[0], buffer + written,
+                    chunkSize - written);
+            if (result < 0) {
+                perror("write");
+                exit(1);
+            }
+            written += result;
+        }
+    }
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    uint64_t nanoseconds = nanosecondsSince(&start);
+
+    return (uint64_t) BYTES_PER_RUN * 1000000000 / nanoseconds /
+            (1024 * 1024);
+}
+
+int main(void) {
+    buffer = calloc(MAX_CHUNK_SIZE, 1);
+    if (!buffer) {
+        fputs("out of memory\n", stderr);
+        return 1;
+    }
+
+    printf("ping-pong: %" PRIu64 " ns per round trip\n\n", pingPong());
+
+    printf("%8s", "chunk");
+    for (size_t i = 0; i < NUM_BUFFER_SIZES; i++) {
+        if (bufferSizes[i]) {
+            printf("%9dK", bufferSizes[i] / 1024);
+        } else {
+            printf("%10s", "default");
+        }
+    }
+    puts("  (MiB/s)");
+
+    for (size_t chunkSize = 64; chunkSize <= MAX_CHUNK_SIZE; chunkSize *= 4) {
+        printf("%8zu", chunkSize);
+        for (size_t i = 0; i < NUM_BUFFER_SIZES; i++) {
+            printf("%10" PRIu64, bandwidth(chunkSize, bufferSizes[i]));
+        }
+        putchar('\n');
+    }
+}
@@ -0,0 +1,96 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/bench-spawn.c
+ * Benchmark for process creation.
+ */
+
+#include <inttypes.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define ITERATIONS 200
+#define MAX_PARENT_SIZE (64 * 1024 * 1024)
+
+extern char** environ;
+static char* const spawnArgv[] = { "true", NULL };
+static const char* program = "/bin/true";
+
+static pid_t spawnWithFork(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execve(program, spawnArgv, environ);
+        _exit(127);
+    }
+    return pid;
+}
+
+static pid_t spawnWithPosixSpawn(void) {
+    pid_t pid;
+    if (posix_spawn(&pid, program, NULL, NULL, spawnArgv, environ) != 0) {
+        return -1;
+    }
+    return pid;
+}
+
+// Returns the average time in microseconds to create a process and wait for
+// it to exit.
+static uint64_t benchmark(pid_t (*spawn)(void)) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < ITERATIONS; i++) {
+        pid_t pid = spawn();
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid ||
+                !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "failed to run %s\n", program);
+            exit(1);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    uint64_t nanoseconds = (end.tv_sec - start.tv_sec) * 1000000000ULL +
+            end.tv_nsec - start.tv_nsec;
+    return nanoseconds / ITERATIONS / 1000;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2) {
+        program = argv[1];
+    }
+
+    // The parent size is increased by touching more memory.
+    char* memory = malloc(MAX_PARENT_SIZE);
+    if (!memory) {
+        fputs("out of memory\n", stderr);
+        return 1;
+    }
+
+    printf("%12s%9s%12s  (us per process)\n", "parent size", "fork",
+            "posix_spawn");
+    size_t touched = 0;
+    for (size_t size = 0; size <= MAX_PARENT_SIZE;
+            size = size ? size * 4 : 1024 * 1024) {
+        memset(memory + touched, 1, size - touched);
+        touched = size;
+        printf("%11zuK%9" PRIu64 "%12" PRIu64 "\n", size / 1024,
+                benchmark(spawnWithFork), benchmark(spawnWithPosixSpawn));
+    }
+}
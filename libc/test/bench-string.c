@@ -0,0 +1,100 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/bench-string.c
+ * Benchmark for string and memory functions.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SIZE (1024 * 1024)
+#define BYTES_PER_RUN (64 * 1024 * 1024)
+
+enum {
+    MEMCPY, MEMMOVE, MEMSET, MEMCMP, MEMCHR, STRLEN, STRNLEN, STRCHR, STRCMP,
+    NUM_FUNCTIONS
+};
+
+static const char* names[] = {
+    "memcpy", "memmove", "memset", "memcmp", "memchr", "strlen", "strnlen",
+    "strchr", "strcmp"
+};
+
+static char* buffer1;
+static char* buffer2;
+static volatile size_t sink;
+
+static void run(int function, size_t size) {
+    switch (function) {
+    case MEMCPY: memcpy(buffer1, buffer2, size); break;
+    case MEMMOVE: memmove(buffer1 + 1, buffer1, size); break;
+    case MEMSET: memset(buffer1, 'a', size); break;
+    case MEMCMP: sink = memcmp(buffer1, buffer2, size); break;
+    case MEMCHR: sink = (size_t) memchr(buffer1, 'b', size); break;
+    case STRLEN: sink = strlen(buffer1); break;
+    case STRNLEN: sink = strnlen(buffer1, size); break;
+    case STRCHR: sink = (size_t) strchr(buffer1, 'b'); break;
+    case STRCMP: sink = strcmp(buffer1, buffer2); break;
+    }
+}
+
+static uint64_t benchmark(int function, size_t size) {
+    // The string functions need a terminated string of the given size.
+    memset(buffer1, 'a', size + 1);
+    memset(buffer2, 'a', size + 1);
+    buffer1[size] = '\0';
+    buffer2[size] = '\0';
+
+    size_t iterations = BYTES_PER_RUN / size;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < iterations; i++) {
+        run(function, size);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    uint64_t nanoseconds = (end.tv_sec - start.tv_sec) * 1000000000ULL +
+            end.tv_nsec - start.tv_nsec;
+    if (!nanoseconds) nanoseconds = 1;
+    uint64_t bytes = iterations * size;
+    return bytes * 1000000000 / nanoseconds / (1024 * 1024);
+}
+
+int main(void) {
+    buffer1 = malloc(MAX_SIZE + 2);
+    buffer2 = malloc(MAX_SIZE + 2);
+    if (!buffer1 || !buffer2) {
+        fputs("out of memory\n", stderr);
+        return 1;
+    }
+
+    printf("%8s", "size");
+    for (int i = 0; i < NUM_FUNCTIONS; i++) {
+        printf("%9s", names[i]);
+    }
+    puts("  (MiB/s)");
+
+    for (size_t size = 1; size <= MAX_SIZE; size *= 2) {
+        printf("%8zu", size);
+        for (int i = 0; i < NUM_FUNCTIONS; i++) {
+            printf("%9" PRIu64, benchmark(i, size));
+        }
+        putchar('\n');
+    }
+}
@@ -0,0 +1,95 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/bench-syscall.c
+ * Benchmark for system call entry and the vDSO.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <dennix/syscall.h>
+
+#define ITERATIONS 1000000
+
+static volatile long sink;
+
+// Performs a system call using the int instruction that was used before the
+// fast system call entry existed.
+static long intSyscall(long number, long arg0, long arg1) {
+#ifdef __x86_64__
+    __asm__ __volatile__ ("int $0x30" : "+a"(number), "+D"(arg0), "+S"(arg1)
+            : : "rcx", "rdx", "r8", "r9", "r10", "r11", "memory");
+#else
+    __asm__ __volatile__ ("int $0x30" : "+a"(number), "+b"(arg0), "+c"(arg1)
+            : : "edx", "esi", "edi", "memory");
+#endif
+    return number;
+}
+
+static void getpgidInt(void) {
+    sink = intSyscall(SYSCALL_GETPGID, 0, 0);
+}
+
+static void getpgidFast(void) {
+    sink = getpgid(0);
+}
+
+static void getpidInt(void) {
+    sink = intSyscall(SYSCALL_GETPID, 0, 0);
+}
+
+static void getpidVdso(void) {
+    sink = getpid();
+}
+
+static void clockGettimeInt(void) {
+    struct timespec ts;
+    sink = intSyscall(SYSCALL_CLOCK_GETTIME, CLOCK_MONOTONIC, (long) &ts);
+}
+
+static void clockGettimeVdso(void) {
+    struct timespec ts;
+    sink = clock_gettime(CLOCK_MONOTONIC, &ts);
+}
+
+static const struct {
+    const char* name;
+    void (*func)(void);
+} benchmarks[] = {
+    { "getpgid (int $0x30)", getpgidInt },
+    { "getpgid (fast entry)", getpgidFast },
+    { "getpid (int $0x30)", getpidInt },
+    { "getpid (vDSO)", getpidVdso },
+    { "clock_gettime (int $0x30)", clockGettimeInt },
+    { "clock_gettime (vDSO)", clockGettimeVdso },
+};
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int j = 0; j < ITERATIONS; j++) {
+            benchmarks[i].func();
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        uint64_t nanoseconds = (end.tv_sec - start.tv_sec) * 1000000000ULL +
+                end.tv_nsec - start.tv_nsec;
+        printf("%-26s %5" PRIu64 " ns\n", benchmarks[i].name,
+                nanoseconds / ITERATIONS);
+    }
+}
@@ -0,0 +1,143 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/test-procfs.c
+ * Tests for the process accounting in /proc.
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define SIZE (1024 * 1024)
+
+static uintmax_t getStat(const char* name) {
+    FILE* file = fopen("/proc/self/stat", "r");
+    assert(file);
+
+    uintmax_t result = UINTMAX_MAX;
+    char* line = NULL;
+    size_t size = 0;
+    while (getline(&line, &size, file) > 0) {
+        char* value = strchr(line, ' ');
+        if (!value) continue;
+        *value++ = '\0';
+        if (strcmp(line, name) == 0) {
+            result = strtoumax(value, NULL, 10);
+        }
+    }
+
+    free(line);
+    fclose(file);
+    assert(result != UINTMAX_MAX);
+    return result;
+}
+
+static bool isMapped(void* address, size_t size, const char* protection) {
+    FILE* file = fopen("/proc/self/maps", "r");
+    assert(file);
+
+    bool found = false;
+    uintmax_t begin, end;
+    char flags[5];
+    while (fscanf(file, "%jx-%jx %4s %*c", &begin, &end, flags) == 3) {
+        if (begin <= (uintptr_t) address &&
+                end >= (uintptr_t) address + size &&
+                strncmp(flags, protection, 3) == 0) {
+            found = true;
+        }
+    }
+
+    fclose(file);
+    return found;
+}
+
+static void testIds(void) {
+    pid_t parent = getpid();
+    assert(getStat("pid") == (uintmax_t) parent);
+    assert(getStat("threads") == 1);
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        _exit(getStat("ppid") != (uintmax_t) parent);
+    }
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void testSyscalls(void) {
+    uintmax_t before = getStat("syscalls");
+    for (int i = 0; i < 1000; i++) {
+        getpgid(0);
+    }
+    assert(getStat("syscalls") >= before + 1000);
+}
+
+static void testMemory(void) {
+    uintmax_t before = getStat("rss_bytes");
+    char* memory = mmap(NULL, SIZE, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert(memory != MAP_FAILED);
+    memset(memory, 1, SIZE);
+    assert(getStat("rss_bytes") >= before + SIZE);
+    assert(isMapped(memory, SIZE, "rw-"));
+
+    assert(munmap(memory, SIZE) == 0);
+    assert(!isMapped(memory, SIZE, "rw-"));
+}
+
+static void testSwitches(void) {
+    int toChild[2], toParent[2];
+    assert(pipe(toChild) == 0 && pipe(toParent) == 0);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        char c;
+        while (read(toChild[0], &c, 1) == 1) {
+            write(toParent[1], &c, 1);
+        }
+        _exit(0);
+    }
+    close(toChild[0]);
+    close(toParent[1]);
+
+    // Every round trip needs to wait for the child.
+    uintmax_t before = getStat("voluntary_switches");
+    for (int i = 0; i < 100; i++) {
+        char c = 'a';
+        assert(write(toChild[1], &c, 1) == 1);
+        assert(read(toParent[0], &c, 1) == 1);
+    }
+    assert(getStat("voluntary_switches") >= before + 100);
+
+    close(toChild[1]);
+    close(toParent[0]);
+    assert(waitpid(pid, NULL, 0) == pid);
+}
+
+int main(void) {
+    testIds();
+    testSyscalls();
+    testMemory();
+    testSwitches();
+}
@@ -0,0 +1,180 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/test-pthread.c
+ * Tests for threads and synchronization.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#define NUM_THREADS 4
+#define ITERATIONS 100000
+#define NUM_ITEMS 10000
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_key_t key;
+static unsigned long counter;
+static unsigned long values[2];
+static int queued;
+static int destructorCalls;
+
+static void runThreads(void* (*func)(void*)) {
+    pthread_t threads[NUM_THREADS];
+    for (uintptr_t i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_create(&threads[i], NULL, func, (void*) i) == 0);
+    }
+    for (uintptr_t i = 0; i < NUM_THREADS; i++) {
+        void* result;
+        assert(pthread_join(threads[i], &result) == 0);
+        assert(result == (void*) i);
+    }
+}
+
+static void* increment(void* arg) {
+    for (int i = 0; i < ITERATIONS; i++) {
+        pthread_mutex_lock(&mutex);
+        counter++;
+        pthread_mutex_unlock(&mutex);
+    }
+    return arg;
+}
+
+static void testMutex(void) {
+    counter = 0;
+    runThreads(increment);
+    assert(counter == NUM_THREADS * ITERATIONS);
+
+    pthread_mutexattr_t attr;
+    pthread_mutex_t recursive;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    assert(pthread_mutex_init(&recursive, &attr) == 0);
+    assert(pthread_mutex_lock(&recursive) == 0);
+    assert(pthread_mutex_trylock(&recursive) == 0);
+    assert(pthread_mutex_unlock(&recursive) == 0);
+    assert(pthread_mutex_unlock(&recursive) == 0);
+    pthread_mutex_destroy(&recursive);
+    pthread_mutexattr_destroy(&attr);
+
+    assert(pthread_mutex_lock(&mutex) == 0);
+    assert(pthread_mutex_trylock(&mutex) == EBUSY);
+    assert(pthread_mutex_unlock(&mutex) == 0);
+}
+
+static void* consume(void* arg) {
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        pthread_mutex_lock(&mutex);
+        while (queued == 0) {
+            pthread_cond_wait(&cond, &mutex);
+        }
+        queued--;
+        counter++;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+    return arg;
+}
+
+static void testCond(void) {
+    pthread_t thread;
+    counter = 0;
+    assert(pthread_create(&thread, NULL, consume, NULL) == 0);
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        pthread_mutex_lock(&mutex);
+        while (queued >= 16) {
+            pthread_cond_wait(&cond, &mutex);
+        }
+        queued++;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+    assert(pthread_join(thread, NULL) == 0);
+    assert(counter == NUM_ITEMS && queued == 0);
+
+    struct timespec timeout;
+    clock_gettime(CLOCK_REALTIME, &timeout);
+    timeout.tv_nsec += 10000000;
+    if (timeout.tv_nsec >= 1000000000) {
+        timeout.tv_sec++;
+        timeout.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&mutex);
+    assert(pthread_cond_timedwait(&cond, &mutex, &timeout) == ETIMEDOUT);
+    pthread_mutex_unlock(&mutex);
+}
+
+static void* readOrWrite(void* arg) {
+    for (int i = 0; i < ITERATIONS / 10; i++) {
+        if ((uintptr_t) arg == 0) {
+            pthread_rwlock_wrlock(&rwlock);
+            values[0]++;
+            values[1]++;
+        } else {
+            pthread_rwlock_rdlock(&rwlock);
+            assert(values[0] == values[1]);
+        }
+        pthread_rwlock_unlock(&rwlock);
+    }
+    return arg;
+}
+
+static void testRwlock(void) {
+    runThreads(readOrWrite);
+    assert(values[0] == ITERATIONS / 10);
+
+    assert(pthread_rwlock_rdlock(&rwlock) == 0);
+    assert(pthread_rwlock_tryrdlock(&rwlock) == 0);
+    assert(pthread_rwlock_trywrlock(&rwlock) == EBUSY);
+    pthread_rwlock_unlock(&rwlock);
+    pthread_rwlock_unlock(&rwlock);
+    assert(pthread_rwlock_trywrlock(&rwlock) == 0);
+    assert(pthread_rwlock_tryrdlock(&rwlock) == EBUSY);
+    pthread_rwlock_unlock(&rwlock);
+}
+
+static void destructor(void* value) {
+    assert(value);
+    pthread_mutex_lock(&mutex);
+    destructorCalls++;
+    pthread_mutex_unlock(&mutex);
+}
+
+static void* useKey(void* arg) {
+    assert(pthread_getspecific(key) == NULL);
+    assert(pthread_setspecific(key, &values[0]) == 0);
+    assert(pthread_getspecific(key) == &values[0]);
+    return arg;
+}
+
+static void testKeys(void) {
+    assert(pthread_key_create(&key, destructor) == 0);
+    runThreads(useKey);
+    assert(destructorCalls == NUM_THREADS);
+    assert(pthread_getspecific(key) == NULL);
+    assert(pthread_key_delete(key) == 0);
+}
+
+int main(void) {
+    testMutex();
+    testCond();
+    testRwlock();
+    testKeys();
+}
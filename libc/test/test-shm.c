@@ -0,0 +1,90 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/test-shm.c
+ * Tests for shared memory.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define SIZE (3 * 4096)
+
+static void testSharedWithChild(char* memory) {
+    memset(memory, 0, SIZE);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        memset(memory, 'a', SIZE);
+        _exit(0);
+    }
+
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    for (size_t i = 0; i < SIZE; i++) {
+        assert(memory[i] == 'a');
+    }
+}
+
+static void testAnonymous(void) {
+    char* memory = mmap(NULL, SIZE, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    assert(memory != MAP_FAILED);
+    testSharedWithChild(memory);
+    assert(munmap(memory, SIZE) == 0);
+}
+
+static void testObject(void) {
+    int fd = shm_open("/test-shm", O_RDWR | O_CREAT | O_EXCL, 0600);
+    assert(fd >= 0);
+    assert(ftruncate(fd, SIZE) == 0);
+
+    char* memory = mmap(NULL, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+            0);
+    assert(memory != MAP_FAILED);
+    testSharedWithChild(memory);
+
+    // A second mapping of the same object sees the same memory.
+    int fd2 = shm_open("/test-shm", O_RDONLY, 0);
+    assert(fd2 >= 0);
+    assert(shm_unlink("/test-shm") == 0);
+    const char* memory2 = mmap(NULL, SIZE, PROT_READ, MAP_SHARED, fd2, 0);
+    assert(memory2 != MAP_FAILED);
+    memory[SIZE - 1] = 'b';
+    assert(memory2[SIZE - 1] == 'b');
+
+    // Mappings beyond the end of the object fail.
+    assert(mmap(NULL, 2 * SIZE, PROT_READ, MAP_SHARED, fd, 0) == MAP_FAILED);
+    assert(mmap(NULL, SIZE, PROT_READ, MAP_SHARED, fd, 4 * 4096) ==
+            MAP_FAILED);
+
+    // Shared memory cannot be shrunk while it is mapped.
+    assert(ftruncate(fd, 4096) < 0);
+    assert(munmap((void*) memory2, SIZE) == 0);
+    assert(munmap(memory, SIZE) == 0);
+    assert(ftruncate(fd, 4096) == 0);
+    close(fd);
+    close(fd2);
+}
+
+int main(void) {
+    testAnonymous();
+    testObject();
+}
@@ -0,0 +1,269 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/test-string.c
+ * Tests for string and memory functions.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define PAGESIZE 4096
+#define MAX_ALIGNMENT 32
+#define MAX_SMALL_LENGTH 80
+
+static const size_t largeLengths[] = {
+    95, 96, 97, 127, 128, 129, 255, 256, 257, 1000, 2047, 2048, 2049, 4000
+};
+
+static unsigned char buffer1[2 * PAGESIZE];
+static unsigned char buffer2[2 * PAGESIZE];
+static unsigned char expected[2 * PAGESIZE];
+// Reading past the end of this memory faults.
+static unsigned char* guard;
+static int failures;
+
+static void fail(const char* function, size_t alignment, size_t length) {
+    fprintf(stderr, "%s failed: alignment %zu, length %zu\n", function,
+            alignment, length);
+    failures++;
+}
+
+static void fill(unsigned char* buffer, size_t size, unsigned int seed) {
+    for (size_t i = 0; i < size; i++) {
+        // Include bytes above 127 to test unsigned comparisons.
+        buffer[i] = (i * 7 + seed) % 251 + 1;
+    }
+}
+
+static const void* refMemchr(const void* s, int c, size_t size) {
+    const unsigned char* p = s;
+    for (size_t i = 0; i < size; i++) {
+        if (p[i] == (unsigned char) c) return p + i;
+    }
+    return NULL;
+}
+
+static int refMemcmp(const void* s1, const void* s2, size_t size) {
+    const unsigned char* p1 = s1;
+    const unsigned char* p2 = s2;
+    for (size_t i = 0; i < size; i++) {
+        if (p1[i] != p2[i]) return p1[i] < p2[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+static size_t refStrnlen(const char* s, size_t maxLength) {
+    size_t length = 0;
+    while (length < maxLength && s[length]) length++;
+    return length;
+}
+
+static const char* refStrchr(const char* s, int c) {
+    while (*s != (char) c) {
+        if (!*s) return NULL;
+        s++;
+    }
+    return s;
+}
+
+static int refStrcmp(const char* s1, const char* s2) {
+    const unsigned char* p1 = (const unsigned char*) s1;
+    const unsigned char* p2 = (const unsigned char*) s2;
+    while (*p1 && *p1 == *p2) {
+        p1++;
+        p2++;
+    }
+    return *p1 < *p2 ? -1 : *p1 > *p2;
+}
+
+static int sign(int value) {
+    return value < 0 ? -1 : value > 0;
+}
+
+static void testCopy(size_t alignment, size_t length) {
+    // Use different relative alignments for source and destination.
+    size_t srcAlignment = alignment * 7 % MAX_ALIGNMENT;
+    fill(buffer1, sizeof(buffer1), length);
+    memset(buffer2, 0xAA, sizeof(buffer2));
+    memcpy(expected, buffer2, sizeof(expected));
+    for (size_t i = 0; i < length; i++) {
+        expected[alignment + i] = buffer1[srcAlignment + i];
+    }
+    if (memcpy(buffer2 + alignment, buffer1 + srcAlignment, length) !=
+            buffer2 + alignment ||
+            refMemcmp(buffer2, expected, sizeof(expected)) != 0) {
+        fail("memcpy", alignment, length);
+    }
+
+    memset(expected, 0xAA, sizeof(expected));
+    memset(expected + alignment, 0x5C, length);
+    if (memset(buffer2 + alignment, 0x5C, length) != buffer2 + alignment ||
+            refMemcmp(buffer2, expected, sizeof(expected)) != 0) {
+        fail("memset", alignment, length);
+    }
+
+    static const size_t shifts[] = { 1, 15, 16, 17, 33 };
+    for (size_t i = 0; i < sizeof(shifts) / sizeof(shifts[0]); i++) {
+        unsigned char* base = buffer1 + MAX_ALIGNMENT * 2;
+        for (int direction = 0; direction < 2; direction++) {
+            unsigned char* dest = base + alignment;
+            unsigned char* src = dest + shifts[i];
+            if (direction) {
+                src = dest;
+                dest = src + shifts[i];
+            }
+
+            fill(buffer1, sizeof(buffer1), length + i);
+            memcpy(expected, buffer1, sizeof(expected));
+            unsigned char temp[PAGESIZE];
+            for (size_t j = 0; j < length; j++) {
+                temp[j] = src[j];
+            }
+            for (size_t j = 0; j < length; j++) {
+                expected[dest - buffer1 + j] = temp[j];
+            }
+            if (memmove(dest, src, length) != dest ||
+                    refMemcmp(buffer1, expected, sizeof(expected)) != 0) {
+                fail("memmove", alignment, length);
+            }
+        }
+    }
+}
+
+static void testCompare(const unsigned char* s1, unsigned char* s2,
+        size_t alignment, size_t length) {
+    if (memcmp(s1, s2, length) != 0) fail("memcmp", alignment, length);
+
+    // Change bytes at different positions in both directions.
+    size_t positions[] = { 0, length / 2, length - 1 };
+    for (size_t i = 0; length && i < 3; i++) {
+        unsigned char old = s2[positions[i]];
+        s2[positions[i]] = old + 128;
+        if (sign(memcmp(s1, s2, length)) != refMemcmp(s1, s2, length) ||
+                sign(memcmp(s2, s1, length)) != refMemcmp(s2, s1, length)) {
+            fail("memcmp", alignment, length);
+        }
+        s2[positions[i]] = old;
+    }
+}
+
+static void testSearch(unsigned char* s, size_t alignment, size_t length) {
+    // Search for bytes at different positions and for a missing byte.
+    size_t positions[] = { 0, length / 2, length - 1, length };
+    for (size_t i = 0; i < 4; i++) {
+        int c = i < 3 && length ? s[positions[i]] : 0;
+        if (memchr(s, c, length) != refMemchr(s, c, length)) {
+            fail("memchr", alignment, length);
+        }
+    }
+    for (size_t maxLength = length / 2; maxLength <= length + 1;
+            maxLength += length / 2 + 1) {
+        if (memchr(s, 0, maxLength < length ? maxLength : length) !=
+                refMemchr(s, 0, maxLength < length ? maxLength : length)) {
+            fail("memchr", alignment, length);
+        }
+    }
+}
+
+// Tests string functions on a string of the given length whose terminating
+// null byte is at s[length].
+static void testString(char* s, char* copy, size_t alignment, size_t length) {
+    if (strlen(s) != length) fail("strlen", alignment, length);
+    size_t maxLengths[] = { 0, length / 2, length, length + 1, (size_t) -1 };
+    for (size_t i = 0; i < 5; i++) {
+        if (strnlen(s, maxLengths[i]) != refStrnlen(s, maxLengths[i])) {
+            fail("strnlen", alignment, length);
+        }
+    }
+
+    int chars[] = { length ? s[0] : 1, length ? s[length - 1] : 1,
+            length ? s[length / 2] : 1, 0, 0x100 + (length ? s[0] : 1), 0xFF };
+    for (size_t i = 0; i < sizeof(chars) / sizeof(chars[0]); i++) {
+        if (strchr(s, chars[i]) != refStrchr(s, chars[i])) {
+            fail("strchr", alignment, length);
+        }
+    }
+
+    if (strcmp(s, copy) != 0) fail("strcmp", alignment, length);
+    size_t positions[] = { 0, length / 2, length };
+    for (size_t i = 0; i < 3; i++) {
+        char old = copy[positions[i]];
+        copy[positions[i]] = old ? old + 128 : 'x';
+        if (!copy[positions[i]]) copy[positions[i]] = 'y';
+        if (sign(strcmp(s, copy)) != refStrcmp(s, copy) ||
+                sign(strcmp(copy, s)) != refStrcmp(copy, s)) {
+            fail("strcmp", alignment, length);
+        }
+        copy[positions[i]] = old;
+    }
+}
+
+static void test(size_t alignment, size_t length) {
+    testCopy(alignment, length);
+
+    fill(buffer1, sizeof(buffer1), length);
+    memcpy(buffer2, buffer1, sizeof(buffer2));
+    testCompare(buffer1 + alignment, buffer2 + alignment, alignment, length);
+    testSearch(buffer1 + alignment, alignment, length);
+
+    buffer1[alignment + length] = '\0';
+    size_t copyAlignment = alignment * 7 % MAX_ALIGNMENT;
+    memcpy(buffer2 + copyAlignment, buffer1 + alignment, length + 1);
+    testString((char*) buffer1 + alignment, (char*) buffer2 + copyAlignment,
+            alignment, length);
+
+    // The same tests with data that ends at an unmapped page.
+    unsigned char* s = guard - length;
+    fill(s, length, length);
+    memcpy(buffer2, s, length);
+    testCompare(s, buffer2, (uintptr_t) s % MAX_ALIGNMENT, length);
+    testSearch(s, (uintptr_t) s % MAX_ALIGNMENT, length);
+
+    if (length > 0) {
+        s[length - 1] = '\0';
+        memcpy(buffer2, s, length);
+        testString((char*) s, (char*) buffer2, (uintptr_t) s % MAX_ALIGNMENT,
+                length - 1);
+    }
+}
+
+int main(void) {
+    unsigned char* pages = mmap(NULL, 2 * PAGESIZE, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    munmap(pages + PAGESIZE, PAGESIZE);
+    guard = pages + PAGESIZE;
+
+    for (size_t alignment = 0; alignment < MAX_ALIGNMENT; alignment++) {
+        for (size_t length = 0; length <= MAX_SMALL_LENGTH; length++) {
+            test(alignment, length);
+        }
+        for (size_t i = 0; i < sizeof(largeLengths) / sizeof(size_t); i++) {
+            test(alignment, largeLengths[i]);
+        }
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d tests failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* libc/test/test-trace.c
+ * Tests for kernel tracing and its overhead.
+ */
+
+#include <assert.h>
+#include <devctl.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <dennix/syscall.h>
+#include <dennix/trace.h>
+
+#define ITERATIONS 500
+#define BENCHMARK_ITERATIONS 100000
+
+static struct trace_event events[8192];
+
+static void setEvents(int fd, int mask) {
+    assert(posix_devctl(fd, TRACE_SET_EVENTS, &mask, sizeof(mask), NULL) == 0);
+}
+
+static size_t readEvents(int fd) {
+    size_t count = 0;
+    while (count < sizeof(events) / sizeof(events[0])) {
+        ssize_t size = read(fd, events + count,
+                sizeof(events) - count * sizeof(events[0]));
+        assert(size >= 0);
+        if (size == 0) break;
+        count += size / sizeof(events[0]);
+    }
+    return count;
+}
+
+static void testSyscallEvents(int fd) {
+    readEvents(fd);
+    setEvents(fd, 1 << TRACE_SYSCALL_ENTER | 1 << TRACE_SYSCALL_EXIT);
+    for (int i = 0; i < ITERATIONS; i++) {
+        getpgid(0);
+    }
+    setEvents(fd, 0);
+
+    struct trace_info info;
+    assert(posix_devctl(fd, TRACE_GET_INFO, &info, sizeof(info), NULL) == 0);
+    assert(info.ti_frequency > 0);
+
+    size_t count = readEvents(fd);
+    size_t enters = 0;
+    size_t exits = 0;
+    uint64_t lastTimestamp = 0;
+    for (size_t i = 0; i < count; i++) {
+        const struct trace_event* event = &events[i];
+        assert(event->te_type == TRACE_SYSCALL_ENTER ||
+                event->te_type == TRACE_SYSCALL_EXIT);
+        if (event->te_pid != getpid()) continue;
+        assert(event->te_timestamp >= lastTimestamp);
+        lastTimestamp = event->te_timestamp;
+
+        if (event->te_type == TRACE_SYSCALL_ENTER &&
+                event->te_arg0 == SYSCALL_GETPGID) {
+            enters++;
+        } else if (event->te_type == TRACE_SYSCALL_EXIT &&
+                event->te_arg0 == (unsigned long) getpgid(0)) {
+            exits++;
+        }
+    }
+    assert(enters >= ITERATIONS);
+    assert(exits >= ITERATIONS);
+
+    // No events are recorded while tracing is disabled.
+    getpgid(0);
+    assert(readEvents(fd) == 0);
+}
+
+static uint64_t measureSyscall(void) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        getpgid(0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t nanoseconds = (end.tv_sec - start.tv_sec) * 1000000000ULL +
+            end.tv_nsec - start.tv_nsec;
+    return nanoseconds / BENCHMARK_ITERATIONS;
+}
+
+static void benchmarkOverhead(int fd) {
+    uint64_t disabled = measureSyscall();
+    setEvents(fd, (1 << TRACE_NUM_EVENTS) - 1);
+    uint64_t enabled = measureSyscall();
+    setEvents(fd, 0);
+    readEvents(fd);
+    printf("syscall with tracing disabled: %" PRIu64 " ns\n", disabled);
+    printf("syscall with tracing enabled: %" PRIu64 " ns\n", enabled);
+}
+
+int main(void) {
+    int fd = open("/dev/trace", O_RDONLY);
+    assert(fd >= 0);
+    testSyscallEvents(fd);
+    benchmarkOverhead(fd);
+    close(fd);
+}
@@ -28,8 +28,8 @@ enum {
     GUI_MSG_CLOSE_WINDOW,
     GUI_MSG_CREATE_WINDOW,
     GUI_MSG_HIDE_WINDOW,
-    GUI_MSG_REDRAW_WINDOW,
-    GUI_MSG_REDRAW_WINDOW_PART,
+    GUI_MSG_SET_WINDOW_BUFFER,
+    GUI_MSG_UPDATE_WINDOW,
     GUI_MSG_SHOW_WINDOW,
     GUI_MSG_RESIZE_WINDOW,
     GUI_MSG_SET_WINDOW_BACKGROUND,
@@ -72,21 +72,21 @@ struct gui_msg_hide_window {
     unsigned int window_id;
 };
 
-struct gui_msg_redraw_window {
+/* The window contents are stored in a shared memory object whose file
+   descriptor is passed with this message using SCM_RIGHTS. */
+struct gui_msg_set_window_buffer {
     unsigned int window_id;
     unsigned int width;
     unsigned int height;
-    uint32_t lfb[];
 };
 
-struct gui_msg_redraw_window_part {
+/* Tells the compositor that a part of the window buffer has changed. */
+struct gui_msg_update_window {
     unsigned int window_id;
     unsigned int x;
     unsigned int y;
     unsigned int width;
     unsigned int height;
-    unsigned int pitch;
-    uint32_t lfb[];
 };
 
 struct gui_msg_show_window {
@@ -18,14 +18,23 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/guimsg.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
 #include "context.h"
 
+static dxui_color* allocateFramebuffer(dxui_context* context,
+        unsigned int id, dxui_dim dim);
 static void closeWindow(dxui_context* context, unsigned int id);
 static void createWindow(dxui_context* context, dxui_rect rect,
         const char* title, int flags);
+static void freeFramebuffer(dxui_context* context, dxui_color* lfb,
+        dxui_dim dim);
 static void hideWindow(dxui_context* context, unsigned int id);
 static void resizeWindow(dxui_context* context, unsigned int id, dxui_dim dim);
 static void setRelativeMouse(dxui_context* context, unsigned int id,
@@ -40,11 +49,19 @@ static void redrawWindow(dxui_context* context, unsigned int id, dxui_dim dim,
         dxui_color* lfb);
 static void redrawWindowPart(dxui_context* context, unsigned int id,
         unsigned int pitch, dxui_rect rect, dxui_color* lfb);
-static bool writeAll(int fd, const void* buffer, size_t size);
+static bool sendMessage(dxui_context* context, unsigned int type,
+        const void* msg, size_t msgSize, const void* data, size_t dataSize);
+static bool sendMessageWithFd(dxui_context* context, unsigned int type,
+        const void* msg, size_t msgSize, const void* data, size_t dataSize,
+        int fd);
+static void updateWindow(dxui_context* context, unsigned int id,
+        dxui_rect rect);
 
 const Backend dxui_compositorBackend = {
+    .allocateFramebuffer = allocateFramebuffer,
     .closeWindow = closeWindow,
     .createWindow = createWindow,
+    .freeFramebuffer = freeFramebuffer,
     .hideWindow = hideWindow,
     .resizeWindow = resizeWindow,
     .setRelativeMouse = setRelativeMouse,
@@ -56,15 +73,54 @@ const Backend dxui_compositorBackend = {
     .redrawWindowPart = redrawWindowPart,
 };
 
+static size_t getFramebufferSize(dxui_dim dim) {
+    size_t size = (size_t) dim.width * dim.height * sizeof(dxui_color);
+    // Empty mappings are not possible.
+    return size ? size : sizeof(dxui_color);
+}
+
+// The framebuffer is shared with the compositor. It reads the window contents
+// directly from there, so redrawing only needs to tell it what has changed.
+static dxui_color* allocateFramebuffer(dxui_context* context,
+        unsigned int id, dxui_dim dim) {
+    static unsigned int counter;
+    char name[32];
+    int fd;
+    do {
+        snprintf(name, sizeof(name), "/dxui-%jd-%u", (intmax_t) getpid(),
+                counter++);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    } while (fd < 0 && errno == EEXIST);
+    if (fd < 0) return NULL;
+    shm_unlink(name);
+
+    size_t size = getFramebufferSize(dim);
+    if (ftruncate(fd, size) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    dxui_color* lfb = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+            fd, 0);
+    if (lfb == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    struct gui_msg_set_window_buffer msg;
+    msg.window_id = id;
+    msg.width = dim.width;
+    msg.height = dim.height;
+    sendMessageWithFd(context, GUI_MSG_SET_WINDOW_BUFFER, &msg, sizeof(msg),
+            NULL, 0, fd);
+    close(fd);
+    return lfb;
+}
+
 static void closeWindow(dxui_context* context, unsigned int id) {
     struct gui_msg_close_window msg;
     msg.window_id = id;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_CLOSE_WINDOW;
-    header.length = sizeof(msg);
-
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
+    sendMessage(context, GUI_MSG_CLOSE_WINDOW, &msg, sizeof(msg), NULL, 0);
 }
 
 static void createWindow(dxui_context* context, dxui_rect rect,
@@ -78,23 +134,21 @@ static void createWindow(dxui_context* context, dxui_rect rect,
     if (flags & DXUI_WINDOW_NO_RESIZE) msg.flags |= GUI_WINDOW_NO_RESIZE;
     if (flags & DXUI_WINDOW_COMPOSITOR) msg.flags |= GUI_WINDOW_COMPOSITOR;
 
-    struct gui_msg_header header;
-    header.type = GUI_MSG_CREATE_WINDOW;
-    header.length = sizeof(msg) + strlen(title);
+    sendMessage(context, GUI_MSG_CREATE_WINDOW, &msg, sizeof(msg), title,
+            strlen(title));
+}
 
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
-    writeAll(context->socket, title, strlen(title));
+static void freeFramebuffer(dxui_context* context, dxui_color* lfb,
+        dxui_dim dim) {
+    (void) context;
+    if (!lfb) return;
+    munmap(lfb, getFramebufferSize(dim));
 }
 
 static void hideWindow(dxui_context* context, unsigned int id) {
     struct gui_msg_hide_window msg;
     msg.window_id = id;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_HIDE_WINDOW;
-    header.length = sizeof(msg);
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
+    sendMessage(context, GUI_MSG_HIDE_WINDOW, &msg, sizeof(msg), NULL, 0);
 }
 
 static void resizeWindow(dxui_context* context, unsigned int id, dxui_dim dim) {
@@ -102,11 +156,7 @@ static void resizeWindow(dxui_context* context, unsigned int id, dxui_dim dim) {
     msg.window_id = id;
     msg.width = dim.width;
     msg.height = dim.height;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_RESIZE_WINDOW;
-    header.length = sizeof(msg);
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
+    sendMessage(context, GUI_MSG_RESIZE_WINDOW, &msg, sizeof(msg), NULL, 0);
 }
 
 static void setWindowCursor(dxui_context* context, unsigned int id,
@@ -114,11 +164,7 @@ static void setWindowCursor(dxui_context* context, unsigned int id,
     struct gui_msg_set_window_cursor msg;
     msg.window_id = id;
     msg.cursor = cursor;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_SET_WINDOW_CURSOR;
-    header.length = sizeof(msg);
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
+    sendMessage(context, GUI_MSG_SET_WINDOW_CURSOR, &msg, sizeof(msg), NULL, 0);
 }
 
 static void setRelativeMouse(dxui_context* context, unsigned int id,
@@ -126,22 +172,14 @@ static void setRelativeMouse(dxui_context* context, unsigned int id,
     struct gui_msg_set_relative_mouse msg;
     msg.window_id = id;
     msg.relative = relative;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_SET_RELATIVE_MOUSE;
-    header.length = sizeof(msg);
-
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
+    sendMessage(context, GUI_MSG_SET_RELATIVE_MOUSE, &msg,
+            sizeof(msg), NULL, 0);
 }
 
 static void showWindow(dxui_context* context, unsigned int id) {
     struct gui_msg_show_window msg;
     msg.window_id = id;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_SHOW_WINDOW;
-    header.length = sizeof(msg);
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
+    sendMessage(context, GUI_MSG_SHOW_WINDOW, &msg, sizeof(msg), NULL, 0);
 }
 
 static void setWindowBackground(dxui_context* context, unsigned int id,
@@ -149,11 +187,8 @@ static void setWindowBackground(dxui_context* context, unsigned int id,
     struct gui_msg_set_window_background msg;
     msg.window_id = id;
     msg.color = color;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_SET_WINDOW_BACKGROUND;
-    header.length = sizeof(msg);
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
+    sendMessage(context, GUI_MSG_SET_WINDOW_BACKGROUND, &msg,
+            sizeof(msg), NULL, 0);
 }
 
 static void setWindowTitle(dxui_context* context, unsigned int id,
@@ -161,60 +196,78 @@ static void setWindowTitle(dxui_context* context, unsigned int id,
     size_t titleLength = strlen(title);
     struct gui_msg_set_window_title msg;
     msg.window_id = id;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_SET_WINDOW_TITLE;
-    header.length = sizeof(msg) + titleLength;
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
-    writeAll(context->socket, title, titleLength);
+    sendMessage(context, GUI_MSG_SET_WINDOW_TITLE, &msg, sizeof(msg),
+            title, titleLength);
 }
 
 static void redrawWindow(dxui_context* context, unsigned int id, dxui_dim dim,
         dxui_color* lfb) {
-    struct gui_msg_redraw_window msg;
-    msg.window_id = id;
-    msg.width = dim.width;
-    msg.height = dim.height;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_REDRAW_WINDOW;
-    size_t lfbSize = dim.width * dim.height * sizeof(uint32_t);
-    header.length = sizeof(msg) + lfbSize;
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
-    writeAll(context->socket, lfb, lfbSize);
+    (void) lfb;
+    dxui_rect rect;
+    rect.x = 0;
+    rect.y = 0;
+    rect.dim = dim;
+    updateWindow(context, id, rect);
 }
 
 static void redrawWindowPart(dxui_context* context, unsigned int id,
         unsigned int pitch, dxui_rect rect, dxui_color* lfb) {
+    (void) pitch; (void) lfb;
     if (rect.width == 0 || rect.height == 0) return;
+    updateWindow(context, id, rect);
+}
+
+static bool sendMessage(dxui_context* context, unsigned int type,
+        const void* msg, size_t msgSize, const void* data, size_t dataSize) {
+    return sendMessageWithFd(context, type, msg, msgSize, data, dataSize, -1);
+}
+
+static bool sendMessageWithFd(dxui_context* context, unsigned int type,
+        const void* msg, size_t msgSize, const void* data, size_t dataSize,
+        int fd) {
+    struct gui_msg_header header;
+    header.type = type;
+    header.length = msgSize + dataSize;
+
+    // Each message is sent as a single packet.
+    struct iovec iov[3];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void*) msg;
+    iov[1].iov_len = msgSize;
+    iov[2].iov_base = (void*) data;
+    iov[2].iov_len = dataSize;
+    struct msghdr msghdr = {0};
+    msghdr.msg_iov = iov;
+    msghdr.msg_iovlen = dataSize ? 3 : 2;
 
-    struct gui_msg_redraw_window_part msg;
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    if (fd >= 0) {
+        msghdr.msg_control = control.buffer;
+        msghdr.msg_controllen = sizeof(control.buffer);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msghdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    while (sendmsg(context->socket, &msghdr, 0) < 0) {
+        if (errno != EINTR) return false;
+    }
+    return true;
+}
+
+static void updateWindow(dxui_context* context, unsigned int id,
+        dxui_rect rect) {
+    struct gui_msg_update_window msg;
     msg.window_id = id;
-    msg.pitch = pitch;
     msg.x = rect.x;
     msg.y = rect.y;
     msg.width = rect.width;
     msg.height = rect.height;
-    struct gui_msg_header header;
-    header.type = GUI_MSG_REDRAW_WINDOW_PART;
-    size_t lfbSize = ((rect.height - 1) * pitch + rect.width) *
-            sizeof(uint32_t);
-    header.length = sizeof(msg) + lfbSize;
-    writeAll(context->socket, &header, sizeof(header));
-    writeAll(context->socket, &msg, sizeof(msg));
-    writeAll(context->socket, lfb + rect.y * pitch + rect.x, lfbSize);
-}
-
-static bool writeAll(int fd, const void* buffer, size_t size) {
-    const char* buf = buffer;
-    size_t written = 0;
-    while (written < size) {
-        ssize_t bytesWritten = write(fd, buf + written, size - written);
-        if (bytesWritten < 0) {
-            if (errno != EINTR) return false;
-        } else {
-            written += bytesWritten;
-        }
-    }
-    return true;
-};
+    sendMessage(context, GUI_MSG_UPDATE_WINDOW, &msg, sizeof(msg), NULL, 0);
+}
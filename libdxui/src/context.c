@@ -93,7 +93,7 @@ static dxui_context* initializeWithCompositor(int flags,
     addr.sun_family = AF_UNIX;
     strcpy(addr.sun_path, socketPath);
 
-    context->socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    context->socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
     if (context->socket < 0) {
         free(context);
         return NULL;
@@ -242,6 +242,7 @@ void dxui_shutdown(dxui_context* context) {
 
     if (context->socket != -1) {
         close(context->socket);
+        free(context->messageBuffer);
     } else {
         free(context->cursors);
         free(context->framebuffer);
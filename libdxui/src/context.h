@@ -24,9 +24,13 @@
 #include "window.h"
 
 typedef struct {
+    dxui_color* (*allocateFramebuffer)(dxui_context* context, unsigned int id,
+            dxui_dim dim);
     void (*closeWindow)(dxui_context* context, unsigned int id);
     void (*createWindow)(dxui_context* context, dxui_rect rect,
             const char* title, int flags);
+    void (*freeFramebuffer)(dxui_context* context, dxui_color* lfb,
+            dxui_dim dim);
     void (*hideWindow)(dxui_context* context, unsigned int id);
     void (*resizeWindow)(dxui_context* context, unsigned int id, dxui_dim dim);
     void (*setWindowCursor)(dxui_context* context, unsigned int id, int cursor);
@@ -56,6 +60,8 @@ struct dxui_context {
 
     // Used by the compositor backend:
     int socket;
+    char* messageBuffer;
+    size_t messageBufferSize;
 
     // Used by the standalone backend:
     int consoleFd;
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/guimsg.h>
+#include <sys/socket.h>
 #include <dennix/mouse.h>
 #include "context.h"
 
@@ -341,40 +342,38 @@ static void handleWindowResized(dxui_context* context, size_t length,
 }
 
 static bool receiveMessage(dxui_context* context) {
-    struct gui_msg_header headerBuffer;
-    size_t headerReceived = 0;
-
-    while (headerReceived < sizeof(struct gui_msg_header)) {
-        ssize_t bytesRead = read(context->socket,
-                (char*) &headerBuffer + headerReceived,
-                sizeof(struct gui_msg_header) - headerReceived);
-        if (bytesRead < 0) {
-            if (errno == EINTR) continue;
-            return false;
-        }
-        headerReceived += bytesRead;
+    // Each message is received as a single packet. Look at the header first
+    // to make sure that the buffer is large enough for the whole message.
+    struct gui_msg_header header;
+    ssize_t bytesRead;
+    do {
+        bytesRead = recv(context->socket, &header, sizeof(header), MSG_PEEK);
+    } while (bytesRead < 0 && errno == EINTR);
+    if (bytesRead < (ssize_t) sizeof(header)) return false;
+
+    if (header.length > context->messageBufferSize) {
+        char* newBuffer = realloc(context->messageBuffer, header.length);
+        if (!newBuffer) return false;
+        context->messageBuffer = newBuffer;
+        context->messageBufferSize = header.length;
     }
 
-    size_t length = headerBuffer.length;
-
-    char* messageBuffer = malloc(length);
-    if (!messageBuffer) return false;
-    size_t messageReceived = 0;
-
-    while (messageReceived < length) {
-        ssize_t bytesRead = read(context->socket,
-                messageBuffer + messageReceived, length - messageReceived);
-        if (bytesRead < 0) {
-            if (errno == EINTR) continue;
-            free(messageBuffer);
-            return false;
-        }
-        messageReceived += bytesRead;
-    }
-
-    handleMessage(context, headerBuffer.type, length, messageBuffer);
-    free(messageBuffer);
-
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = context->messageBuffer;
+    iov[1].iov_len = header.length;
+    struct msghdr msg = {0};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    do {
+        bytesRead = recvmsg(context->socket, &msg, 0);
+    } while (bytesRead < 0 && errno == EINTR);
+    if (bytesRead < (ssize_t) sizeof(header)) return false;
+
+    handleMessage(context, header.type, bytesRead - sizeof(header),
+            context->messageBuffer);
     return true;
 }
 
@@ -22,9 +22,13 @@
 #include <dennix/display.h>
 #include "context.h"
 
+static dxui_color* allocateFramebuffer(dxui_context* context,
+        unsigned int id, dxui_dim dim);
 static void closeWindow(dxui_context* context, unsigned int id);
 static void createWindow(dxui_context* context, dxui_rect rect,
         const char* title, int flags);
+static void freeFramebuffer(dxui_context* context, dxui_color* lfb,
+        dxui_dim dim);
 static void hideWindow(dxui_context* context, unsigned int id);
 static void resizeWindow(dxui_context* context, unsigned int id, dxui_dim dim);
 static void setRelativeMouse(dxui_context* context, unsigned int id,
@@ -41,8 +45,10 @@ static void redrawWindowPart(dxui_context* context, unsigned int id,
         unsigned int pitch, dxui_rect rect, dxui_color* lfb);
 
 const Backend dxui_standaloneBackend = {
+    .allocateFramebuffer = allocateFramebuffer,
     .closeWindow = closeWindow,
     .createWindow = createWindow,
+    .freeFramebuffer = freeFramebuffer,
     .hideWindow = hideWindow,
     .resizeWindow = resizeWindow,
     .setRelativeMouse = setRelativeMouse,
@@ -85,6 +91,12 @@ static void setActiveWindow(dxui_context* context, Window* window) {
     dxui_update(window);
 }
 
+static dxui_color* allocateFramebuffer(dxui_context* context,
+        unsigned int id, dxui_dim dim) {
+    (void) context; (void) id;
+    return malloc(dim.width * dim.height * sizeof(dxui_color));
+}
+
 static void closeWindow(dxui_context* context, unsigned int id) {
     Window* window = getWindow(context, id);
     if (window == context->activeWindow) {
@@ -106,6 +118,12 @@ static void createWindow(dxui_context* context, dxui_rect rect,
     }
 }
 
+static void freeFramebuffer(dxui_context* context, dxui_color* lfb,
+        dxui_dim dim) {
+    (void) context; (void) dim;
+    free(lfb);
+}
+
 static void hideWindow(dxui_context* context, unsigned int id) {
     Window* window = getWindow(context, id);
     if (window == context->activeWindow) {
@@ -73,7 +73,7 @@ void dxui_close(dxui_window* window) {
         win->next->prev = win->prev;
     }
 
-    free(win->lfb);
+    context->backend->freeFramebuffer(context, win->lfb, win->lfbDim);
     free(window);
 }
 
@@ -95,14 +95,6 @@ dxui_window* dxui_create_window(dxui_context* context, dxui_rect rect,
     window->container.class = &windowContainerClass;
     window->context = context;
     window->idAssigned = false;
-
-    window->lfbDim = rect.dim;
-    window->lfb = malloc(rect.width * rect.height * sizeof(dxui_color));
-    if (!window->lfb) {
-        free(window->control.text);
-        free(window);
-        return NULL;
-    }
     window->redraw = true;
 
     window->next = context->firstWindow;
@@ -117,6 +109,16 @@ dxui_window* dxui_create_window(dxui_context* context, dxui_rect rect,
         dxui_pump_events(context, DXUI_PUMP_ONCE, -1);
     }
 
+    // The framebuffer can only be allocated once the window has an id because
+    // the compositor needs to know which window it belongs to.
+    window->lfb = context->backend->allocateFramebuffer(context, window->id,
+            rect.dim);
+    if (!window->lfb) {
+        dxui_close(DXUI_AS_WINDOW(window));
+        return NULL;
+    }
+    window->lfbDim = rect.dim;
+
     dxui_update(window);
     return DXUI_AS_WINDOW(window);
 }
@@ -124,9 +126,11 @@ dxui_window* dxui_create_window(dxui_context* context, dxui_rect rect,
 dxui_color* dxui_get_framebuffer(dxui_window* window, dxui_dim dim) {
     Window* win = window->internal;
     if (dim.width != win->lfbDim.width || dim.height != win->lfbDim.height) {
-        dxui_color* lfb = malloc(dim.height * dim.width * sizeof(dxui_color));
+        dxui_context* context = win->context;
+        dxui_color* lfb = context->backend->allocateFramebuffer(context,
+                win->id, dim);
         if (!lfb) return NULL;
-        free(win->lfb);
+        context->backend->freeFramebuffer(context, win->lfb, win->lfbDim);
         win->lfb = lfb;
         win->lfbDim = dim;
     }
@@ -23,6 +23,7 @@
 #include <fcntl.h>
 #include <sched.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdnoreturn.h>
@@ -36,6 +37,8 @@
 #include "sh.h"
 #include "variables.h"
 
+extern char** environ;
+
 static volatile sig_atomic_t pipelineReady;
 
 static void sigusr1Handler(int signum) {
@@ -56,9 +59,12 @@ static int forkAndExecuteUtility(int argc, char** arguments,
         struct Redirection* redirections, size_t numRedirections,
         char** assignments, size_t numAssignments);
 static const char* getExecutablePath(const char* command);
+static char** makeEnvironment(char** assignments, size_t numAssignments);
 static bool performRedirections(struct Redirection* redirections,
         size_t numRedirections);
 static void resetSignals(void);
+static pid_t spawnUtility(char** arguments, struct Redirection* redirections,
+        size_t numRedirections, char** assignments, size_t numAssignments);
 static int waitForCommand(pid_t pid);
 
 int execute(struct CompleteCommand* command) {
@@ -388,7 +394,13 @@ static noreturn void executeUtility(int argc, char** arguments,
 static int forkAndExecuteUtility(int argc, char** arguments,
         struct Redirection* redirections, size_t numRedirections,
         char** assignments, size_t numAssignments) {
-    pid_t pid = fork();
+    pid_t pid = spawnUtility(arguments, redirections, numRedirections,
+            assignments, numAssignments);
+    if (pid > 0) return waitForCommand(pid);
+
+    // Fall back to forking. This is also needed for shell scripts and to
+    // print the right diagnostics when the command cannot be executed.
+    pid = fork();
 
     if (pid < 0) {
         err(1, "fork");
@@ -416,10 +428,7 @@ static const char* getExecutablePath(const char* command) {
     while (*path) {
         size_t length = strcspn(path, ":");
         char* buffer = malloc(commandLength + length + 2);
-        if (!buffer) {
-            warn("malloc");
-            _Exit(126);
-        }
+        if (!buffer) err(1, "malloc");
 
         memcpy(buffer, path, length);
         buffer[length] = '/';
@@ -437,6 +446,29 @@ static const char* getExecutablePath(const char* command) {
     return NULL;
 }
 
+static char** makeEnvironment(char** assignments, size_t numAssignments) {
+    size_t environSize = 0;
+    while (environ[environSize]) {
+        environSize++;
+    }
+
+    char** envp = calloc(environSize + numAssignments + 1, sizeof(char*));
+    if (!envp) err(1, "malloc");
+    memcpy(envp, environ, environSize * sizeof(char*));
+
+    for (size_t i = 0; i < numAssignments; i++) {
+        size_t nameLength = strcspn(assignments[i], "=") + 1;
+        size_t j;
+        for (j = 0; j < environSize; j++) {
+            if (strncmp(envp[j], assignments[i], nameLength) == 0) break;
+        }
+        envp[j] = assignments[i];
+        if (j == environSize) environSize++;
+    }
+
+    return envp;
+}
+
 static bool performRedirections(struct Redirection* redirections,
         size_t numRedirections) {
     for (size_t i = 0; i < numRedirections; i++) {
@@ -480,6 +512,81 @@ static void resetSignals(void) {
     signal(SIGTTOU, SIG_DFL);
 }
 
+static pid_t spawnUtility(char** arguments, struct Redirection* redirections,
+        size_t numRedirections, char** assignments, size_t numAssignments) {
+    // Spawning the utility is much cheaper than forking because the address
+    // space of the shell does not need to be copied. If anything goes wrong we
+    // return -1 and let the caller retry with fork.
+    const char* command = arguments[0];
+    if (!command) return -1;
+    if (!strchr(command, '/')) {
+        command = getExecutablePath(command);
+        if (!command) return -1;
+    }
+
+    pid_t pid = -1;
+    char** envp = NULL;
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init(&fileActions);
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    short flags = POSIX_SPAWN_SETSIGDEF;
+
+    if (shellOptions.monitor) {
+        flags |= POSIX_SPAWN_SETPGROUP;
+        posix_spawnattr_setpgroup(&attr, 0);
+        if (inputIsTerminal &&
+                posix_spawn_file_actions_addtcsetpgrp_np(&fileActions, 0)) {
+            goto cleanup;
+        }
+    }
+
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGINT);
+    sigaddset(&defaultSignals, SIGQUIT);
+    sigaddset(&defaultSignals, SIGTERM);
+    sigaddset(&defaultSignals, SIGTSTP);
+    sigaddset(&defaultSignals, SIGTTIN);
+    sigaddset(&defaultSignals, SIGTTOU);
+    posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+    posix_spawnattr_setflags(&attr, flags);
+
+    for (size_t i = 0; i < numRedirections; i++) {
+        struct Redirection redirection = redirections[i];
+        if (redirection.filenameIsFd) {
+            char* tail;
+            int fd = strtol(redirection.filename, &tail, 10);
+            if (*tail || posix_spawn_file_actions_adddup2(&fileActions, fd,
+                    redirection.fd)) {
+                goto cleanup;
+            }
+        } else if (posix_spawn_file_actions_addopen(&fileActions,
+                redirection.fd, redirection.filename, redirection.flags,
+                0666)) {
+            goto cleanup;
+        }
+    }
+
+    if (numAssignments > 0) {
+        envp = makeEnvironment(assignments, numAssignments);
+    }
+
+    if (posix_spawn(&pid, command, &fileActions, &attr, arguments,
+            envp ? envp : environ) != 0) {
+        pid = -1;
+    }
+
+cleanup:
+    if (command != arguments[0]) {
+        free((char*) command);
+    }
+    free(envp);
+    posix_spawn_file_actions_destroy(&fileActions);
+    posix_spawnattr_destroy(&attr);
+    return pid;
+}
+
 static int waitForCommand(pid_t pid) {
     int status;
     if (waitpid(pid, &status, 0) < 0) {
@@ -19,15 +19,44 @@
 
 #include "utils.h"
 #include <err.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/sendfile.h>
 
 static bool failed = false;
 
+// Lets the kernel copy the file to stdout. Returns false if this is not
+// supported for the given files.
+static bool copyInKernel(int fd, const char* path) {
+    bool first = true;
+    bool useSplice = false;
+
+    while (true) {
+        ssize_t size = useSplice ? splice(fd, NULL, 1, NULL, SSIZE_MAX, 0) :
+                sendfile(1, fd, NULL, SSIZE_MAX);
+        if (size < 0 && first && errno == EINVAL) {
+            if (useSplice) return false;
+            useSplice = true;
+            continue;
+        }
+
+        if (size < 0) {
+            warn("'%s'", path);
+            failed = true;
+            return true;
+        } else if (size == 0) {
+            return true;
+        }
+        first = false;
+    }
+}
+
 static void cat(const char* path) {
     int fd;
     if (strcmp(path, "-") == 0) {
@@ -41,6 +70,13 @@ static void cat(const char* path) {
         }
     }
 
+    if (copyInKernel(fd, path)) {
+        if (fd != 0) {
+            close(fd);
+        }
+        return;
+    }
+
     while (true) {
         char buffer[4096];
         ssize_t readSize = read(fd, buffer, sizeof(buffer));
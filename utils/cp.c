@@ -24,6 +24,7 @@
 #include <fcntl.h>
 #include <getopt.h>
 #include <libgen.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -161,8 +162,21 @@ int main(int argc, char* argv[]) {
 
 static bool copyFile(int sourceFd, const char* sourcePath, int destFd,
         const char* destPath) {
+    // Let the kernel copy the data if both files support it.
     while (true) {
-        char buffer[1024];
+        ssize_t bytesCopied = copy_file_range(sourceFd, NULL, destFd, NULL,
+                SSIZE_MAX, 0);
+        if (bytesCopied == 0) {
+            return true;
+        } else if (bytesCopied < 0) {
+            if (errno == EINVAL) break;
+            warn("copy: '%s' to '%s'", sourcePath, destPath);
+            return false;
+        }
+    }
+
+    while (true) {
+        char buffer[4096];
         ssize_t bytesAvailable = read(sourceFd, buffer, sizeof(buffer));
         if (bytesAvailable < 0) {
             warn("read: '%s'", sourcePath);
@@ -170,13 +184,15 @@ static bool copyFile(int sourceFd, const char* sourcePath, int destFd,
         } else if (bytesAvailable == 0) {
             return true;
         }
-        while (bytesAvailable) {
-            ssize_t bytesWritten = write(destFd, buffer, bytesAvailable);
+        size_t written = 0;
+        while (written < (size_t) bytesAvailable) {
+            ssize_t bytesWritten = write(destFd, buffer + written,
+                    bytesAvailable - written);
             if (bytesWritten < 0) {
                 warn("write: '%s'", destPath);
                 return false;
             }
-            bytesAvailable -= bytesWritten;
+            written += bytesWritten;
         }
     }
 }
@@ -29,4 +29,8 @@ int main(void) {
             "free:      %9zu KiB\ncached:    %9zu KiB\n",
             info.mem_total / 1024, used / 1024, info.mem_available / 1024,
             info.mem_free / 1024, cached / 1024);
+    if (info.swap_total) {
+        printf("swap:      %9zu KiB\nswap free: %9zu KiB\n",
+                info.swap_total / 1024, info.swap_free / 1024);
+    }
 }
@@ -0,0 +1,361 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* utils/ps.c
+ * Report process status.
+ */
+
+#ifndef TOP
+#  define TOP 0
+#endif
+
+#include "utils.h"
+#include <ctype.h>
+#include <dirent.h>
+#include <err.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+struct ProcessStat {
+    pid_t pid;
+    pid_t ppid;
+    char name[32];
+    char state;
+    char waitChannel[32];
+    unsigned long threads;
+    uint64_t cpuTime;
+    uint64_t residentSize;
+    uint64_t voluntarySwitches;
+    uint64_t involuntarySwitches;
+    uint64_t pageFaults;
+    uint64_t syscalls;
+    uint64_t blockReadBytes;
+    uint64_t blockWriteBytes;
+};
+
+static struct ProcessStat* readProcesses(size_t* count);
+static bool readStat(const char* pid, struct ProcessStat* stat);
+#if TOP
+static int compareCpu(const void* a, const void* b);
+static void printTop(const struct ProcessStat* processes, size_t count,
+        const struct ProcessStat* previous, size_t previousCount,
+        uint64_t elapsed);
+#else
+static void printLong(const struct ProcessStat* stat);
+static void printShort(const struct ProcessStat* stat);
+static void printTime(uint64_t nanoseconds);
+#endif
+
+int main(int argc, char* argv[]) {
+    struct option longopts[] = {
+#if TOP
+        { "delay", required_argument, 0, 'd' },
+        { "iterations", required_argument, 0, 'n' },
+#else
+        { "long", no_argument, 0, 'l' },
+#endif
+        { "help", no_argument, 0, 0 },
+        { "version", no_argument, 0, 1 },
+        { 0, 0, 0, 0 }
+    };
+
+#if TOP
+    const char* shortopts = "d:n:";
+    unsigned long delay = 2;
+    unsigned long iterations = 0;
+#else
+    const char* shortopts = "l";
+    bool longFormat = false;
+#endif
+
+    int c;
+    while ((c = getopt_long(argc, argv, shortopts, longopts, NULL)) != -1) {
+        switch (c) {
+        case 0:
+#if TOP
+            return help(argv[0], "[OPTIONS]\n"
+                    "  -d, --delay=SECONDS      time between updates\n"
+                    "  -n, --iterations=NUMBER  exit after NUMBER updates\n"
+                    "      --help               display this help\n"
+                    "      --version            display version info");
+#else
+            return help(argv[0], "[OPTIONS]\n"
+                    "  -l, --long               show accounting counters\n"
+                    "      --help               display this help\n"
+                    "      --version            display version info");
+#endif
+        case 1:
+            return version(argv[0]);
+#if TOP
+        case 'd':
+        case 'n': {
+            char* end;
+            errno = 0;
+            unsigned long value = strtoul(optarg, &end, 10);
+            if (errno || *end || !*optarg || (c == 'd' && value == 0)) {
+                errx(1, "invalid number '%s'", optarg);
+            }
+            if (c == 'd') {
+                delay = value;
+            } else {
+                iterations = value;
+            }
+        } break;
+#else
+        case 'l':
+            longFormat = true;
+            break;
+#endif
+        case '?':
+            return 1;
+        }
+    }
+
+    if (optind < argc) {
+        errx(1, "extra operand '%s'", argv[optind]);
+    }
+
+#if TOP
+    struct ProcessStat* previous = NULL;
+    size_t previousCount = 0;
+    struct timespec previousTime;
+    clock_gettime(CLOCK_MONOTONIC, &previousTime);
+
+    for (unsigned long i = 0; !iterations || i < iterations; i++) {
+        size_t count;
+        struct ProcessStat* processes = readProcesses(&count);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t elapsed = (uint64_t) (now.tv_sec - previousTime.tv_sec) *
+                1000000000 + now.tv_nsec - previousTime.tv_nsec;
+
+        printTop(processes, count, previous, previousCount, elapsed);
+
+        free(previous);
+        previous = processes;
+        previousCount = count;
+        previousTime = now;
+
+        if (!iterations || i + 1 < iterations) {
+            sleep(delay);
+        }
+    }
+    free(previous);
+#else
+    size_t count;
+    struct ProcessStat* processes = readProcesses(&count);
+
+    if (longFormat) {
+        puts("  PID  PPID S THR     TIME    RSS WCHAN        VCSW   IVCSW  "
+                "FAULTS   SYSCALLS   READ KiB  WRITE KiB COMMAND");
+    } else {
+        puts("  PID  PPID S THR     TIME    RSS WCHAN      COMMAND");
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (longFormat) {
+            printLong(&processes[i]);
+        } else {
+            printShort(&processes[i]);
+        }
+    }
+    free(processes);
+#endif
+}
+
+static struct ProcessStat* readProcesses(size_t* count) {
+    DIR* dir = opendir("/proc");
+    if (!dir) err(1, "'/proc'");
+
+    struct ProcessStat* processes = NULL;
+    size_t allocated = 0;
+    *count = 0;
+
+    errno = 0;
+    struct dirent* dirent;
+    while ((dirent = readdir(dir))) {
+        if (!isdigit((unsigned char) dirent->d_name[0])) continue;
+
+        if (*count == allocated) {
+            allocated = allocated ? 2 * allocated : 16;
+            processes = reallocarray(processes, allocated,
+                    sizeof(struct ProcessStat));
+            if (!processes) err(1, "realloc");
+        }
+
+        // Processes might exit while we are reading.
+        if (readStat(dirent->d_name, &processes[*count])) {
+            (*count)++;
+        }
+        errno = 0;
+    }
+
+    if (errno) err(1, "readdir: '/proc'");
+    closedir(dir);
+    return processes;
+}
+
+static bool readStat(const char* pid, struct ProcessStat* stat) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%s/stat", pid);
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    memset(stat, 0, sizeof(*stat));
+    bool found = false;
+    char* line = NULL;
+    size_t size = 0;
+    while (getline(&line, &size, file) > 0) {
+        char* value = strchr(line, ' ');
+        if (!value) continue;
+        *value++ = '\0';
+        value[strcspn(value, "\n")] = '\0';
+        uintmax_t number = strtoumax(value, NULL, 10);
+
+        if (strcmp(line, "name") == 0) {
+            strlcpy(stat->name, value, sizeof(stat->name));
+        } else if (strcmp(line, "pid") == 0) {
+            stat->pid = number;
+            found = true;
+        } else if (strcmp(line, "ppid") == 0) {
+            stat->ppid = number;
+        } else if (strcmp(line, "state") == 0) {
+            stat->state = *value;
+        } else if (strcmp(line, "wchan") == 0) {
+            strlcpy(stat->waitChannel, value, sizeof(stat->waitChannel));
+        } else if (strcmp(line, "threads") == 0) {
+            stat->threads = number;
+        } else if (strcmp(line, "utime_ns") == 0 ||
+                strcmp(line, "stime_ns") == 0) {
+            stat->cpuTime += number;
+        } else if (strcmp(line, "rss_bytes") == 0) {
+            stat->residentSize = number;
+        } else if (strcmp(line, "voluntary_switches") == 0) {
+            stat->voluntarySwitches = number;
+        } else if (strcmp(line, "involuntary_switches") == 0) {
+            stat->involuntarySwitches = number;
+        } else if (strcmp(line, "page_faults") == 0) {
+            stat->pageFaults = number;
+        } else if (strcmp(line, "syscalls") == 0) {
+            stat->syscalls = number;
+        } else if (strcmp(line, "block_read_bytes") == 0) {
+            stat->blockReadBytes = number;
+        } else if (strcmp(line, "block_write_bytes") == 0) {
+            stat->blockWriteBytes = number;
+        }
+    }
+
+    free(line);
+    fclose(file);
+    return found;
+}
+
+#if TOP
+static int compareCpu(const void* a, const void* b) {
+    const struct ProcessStat* stat1 = a;
+    const struct ProcessStat* stat2 = b;
+    // The cpu time field holds the time used since the previous update.
+    if (stat1->cpuTime != stat2->cpuTime) {
+        return stat1->cpuTime < stat2->cpuTime ? 1 : -1;
+    }
+    return stat1->pid < stat2->pid ? -1 : stat1->pid > stat2->pid;
+}
+
+static void printTop(const struct ProcessStat* processes, size_t count,
+        const struct ProcessStat* previous, size_t previousCount,
+        uint64_t elapsed) {
+    size_t running = 0;
+    uint64_t residentSize = 0;
+
+    // Turn all counters into differences to the previous update.
+    struct ProcessStat* deltas = reallocarray(NULL, count + 1,
+            sizeof(struct ProcessStat));
+    if (!deltas) err(1, "malloc");
+    memcpy(deltas, processes, count * sizeof(struct ProcessStat));
+    for (size_t i = 0; i < count; i++) {
+        struct ProcessStat* stat = &deltas[i];
+        if (stat->state == 'R') running++;
+        residentSize += stat->residentSize;
+
+        for (size_t j = 0; j < previousCount; j++) {
+            const struct ProcessStat* old = &previous[j];
+            if (old->pid != stat->pid) continue;
+            stat->cpuTime -= old->cpuTime;
+            stat->voluntarySwitches -= old->voluntarySwitches;
+            stat->involuntarySwitches -= old->involuntarySwitches;
+            stat->pageFaults -= old->pageFaults;
+            stat->syscalls -= old->syscalls;
+            stat->blockReadBytes -= old->blockReadBytes;
+            stat->blockWriteBytes -= old->blockWriteBytes;
+            break;
+        }
+    }
+
+    qsort(deltas, count, sizeof(struct ProcessStat), compareCpu);
+
+    printf("\e[H\e[2J");
+    printf("%zu processes, %zu running, %" PRIu64 " KiB resident\n\n",
+            count, running, residentSize / 1024);
+    puts("  PID S THR  CPU%    RSS WCHAN        VCSW   IVCSW SYSCALLS "
+            "  READ KiB  WRITE KiB COMMAND");
+
+    for (size_t i = 0; i < count; i++) {
+        const struct ProcessStat* stat = &deltas[i];
+        unsigned int permille = elapsed ? stat->cpuTime * 1000 / elapsed : 0;
+        printf("%5d %c %3lu %3u.%u %6" PRIu64 " %-10s %7" PRIu64 " %7"
+                PRIu64 " %8" PRIu64 " %10" PRIu64 " %10" PRIu64 " %s\n",
+                stat->pid, stat->state, stat->threads, permille / 10,
+                permille % 10, stat->residentSize / 1024, stat->waitChannel,
+                stat->voluntarySwitches, stat->involuntarySwitches,
+                stat->syscalls, stat->blockReadBytes / 1024,
+                stat->blockWriteBytes / 1024, stat->name);
+    }
+    fflush(stdout);
+    free(deltas);
+}
+#else
+static void printTime(uint64_t nanoseconds) {
+    uint64_t seconds = nanoseconds / 1000000000;
+    printf(" %5" PRIu64 ":%02" PRIu64, seconds / 60, seconds % 60);
+}
+
+static void printLong(const struct ProcessStat* stat) {
+    printf("%5d %5d %c %3lu", stat->pid, stat->ppid, stat->state,
+            stat->threads);
+    printTime(stat->cpuTime);
+    printf(" %6" PRIu64 " %-10s %7" PRIu64 " %7" PRIu64 " %7" PRIu64 " %10"
+            PRIu64 " %10" PRIu64 " %10" PRIu64 " %s\n",
+            stat->residentSize / 1024, stat->waitChannel,
+            stat->voluntarySwitches, stat->involuntarySwitches,
+            stat->pageFaults, stat->syscalls, stat->blockReadBytes / 1024,
+            stat->blockWriteBytes / 1024, stat->name);
+}
+
+static void printShort(const struct ProcessStat* stat) {
+    printf("%5d %5d %c %3lu", stat->pid, stat->ppid, stat->state,
+            stat->threads);
+    printTime(stat->cpuTime);
+    printf(" %6" PRIu64 " %-10s %s\n", stat->residentSize / 1024,
+            stat->waitChannel, stat->name);
+}
+#endif
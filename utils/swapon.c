@@ -0,0 +1,51 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* utils/swapon.c
+ * Enable swapping to a file or device.
+ */
+
+#include "utils.h"
+#include <err.h>
+#include <getopt.h>
+#include <sys/fs.h>
+
+int main(int argc, char* argv[]) {
+    struct option longopts[] = {
+        { "help", no_argument, 0, 0 },
+        { "version", no_argument, 0, 1 },
+        { 0, 0, 0, 0 }
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "", longopts, NULL)) != -1) {
+        switch (c) {
+        case 0:
+            return help(argv[0], "[OPTIONS] FILE\n"
+                    "      --help               display this help\n"
+                    "      --version            display version info");
+        case 1:
+            return version(argv[0]);
+        case '?':
+            return 1;
+        }
+    }
+
+    if (optind >= argc) errx(1, "missing file operand");
+
+    if (swapon(argv[optind]) < 0) {
+        err(1, "failed to enable swap on '%s'", argv[optind]);
+    }
+}
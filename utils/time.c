@@ -22,6 +22,7 @@
 #include <errno.h>
 #include <getopt.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -30,6 +31,8 @@
 #include <sys/resource.h>
 #include <sys/wait.h>
 
+extern char** environ;
+
 int main(int argc, char* argv[]) {
     struct option longopts[] = {
         { "help", no_argument, 0, 0 },
@@ -65,43 +68,47 @@ int main(int argc, char* argv[]) {
     sigset_t oldMask;
     sigprocmask(SIG_BLOCK, &sigset, &oldMask);
 
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &oldMask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
     struct timespec start;
     clock_gettime(CLOCK_MONOTONIC, &start);
-    pid_t pid = fork();
-    if (pid < 0) {
-        err(1, "fork");
-    } else if (pid == 0) {
-        sigprocmask(SIG_SETMASK, &oldMask, NULL);
-        execvp(argv[optind], argv + optind);
-        err(errno == ENOENT ? 127 : 126, "execvp: '%s'", argv[optind]);
-    } else {
-        int status;
-        waitpid(pid, &status, 0);
+    pid_t pid;
+    int error = posix_spawnp(&pid, argv[optind], NULL, &attr, argv + optind,
+            environ);
+    if (error) {
+        errno = error;
+        err(error == ENOENT ? 127 : 126, "posix_spawnp: '%s'", argv[optind]);
+    }
+    posix_spawnattr_destroy(&attr);
 
-        struct timespec end;
-        clock_gettime(CLOCK_MONOTONIC, &end);
-        struct timespec realTime;
-        realTime.tv_sec = end.tv_sec - start.tv_sec;
-        realTime.tv_nsec = end.tv_nsec - start.tv_nsec;
-        if (realTime.tv_nsec < 0) {
-            realTime.tv_sec--;
-            realTime.tv_nsec += 1000000000;
-        }
+    int status;
+    waitpid(pid, &status, 0);
 
-        struct rusage usage;
-        getrusage(RUSAGE_CHILDREN, &usage);
-        fprintf(stderr, "real %jd.%06ld\nuser %jd.%06ld\nsys %jd.%06ld\n",
-                (intmax_t) realTime.tv_sec, realTime.tv_nsec / 1000,
-                (intmax_t) usage.ru_utime.tv_sec, (long) usage.ru_utime.tv_usec,
-                (intmax_t) usage.ru_stime.tv_sec,
-                (long) usage.ru_stime.tv_usec);
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    struct timespec realTime;
+    realTime.tv_sec = end.tv_sec - start.tv_sec;
+    realTime.tv_nsec = end.tv_nsec - start.tv_nsec;
+    if (realTime.tv_nsec < 0) {
+        realTime.tv_sec--;
+        realTime.tv_nsec += 1000000000;
+    }
 
-        if (WIFEXITED(status)) {
-            return WEXITSTATUS(status);
-        } else {
-            sigprocmask(SIG_SETMASK, &oldMask, NULL);
-            signal(WTERMSIG(status), SIG_DFL);
-            raise(WTERMSIG(status));
-        }
+    struct rusage usage;
+    getrusage(RUSAGE_CHILDREN, &usage);
+    fprintf(stderr, "real %jd.%06ld\nuser %jd.%06ld\nsys %jd.%06ld\n",
+            (intmax_t) realTime.tv_sec, realTime.tv_nsec / 1000,
+            (intmax_t) usage.ru_utime.tv_sec, (long) usage.ru_utime.tv_usec,
+            (intmax_t) usage.ru_stime.tv_sec, (long) usage.ru_stime.tv_usec);
+
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    } else {
+        sigprocmask(SIG_SETMASK, &oldMask, NULL);
+        signal(WTERMSIG(status), SIG_DFL);
+        raise(WTERMSIG(status));
     }
 }
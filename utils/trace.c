@@ -0,0 +1,421 @@
+/* Copyright (c) 2026 Dennis Wölfing
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* utils/trace.c
+ * Record and summarize kernel trace events.
+ */
+
+#include "utils.h"
+#include <devctl.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <dennix/trace.h>
+
+extern char** environ;
+
+#define HISTOGRAM_BUCKETS 40
+#define MAX_IRQS 256
+#define MAX_SYSCALLS 128
+
+struct Histogram {
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+};
+
+struct PendingEvent {
+    unsigned long key;
+    uint64_t timestamp;
+    unsigned long value;
+};
+
+struct PendingList {
+    struct PendingEvent* events;
+    size_t count;
+    size_t allocated;
+};
+
+static const char* eventNames[TRACE_NUM_EVENTS] = {
+    [TRACE_SYSCALL_ENTER] = "syscall_enter",
+    [TRACE_SYSCALL_EXIT] = "syscall_exit",
+    [TRACE_SCHEDULE] = "schedule",
+    [TRACE_PAGE_FAULT] = "page_fault",
+    [TRACE_BLOCK_HIT] = "block_hit",
+    [TRACE_BLOCK_MISS] = "block_miss",
+    [TRACE_ATA_SUBMIT] = "ata_submit",
+    [TRACE_ATA_COMPLETE] = "ata_complete",
+    [TRACE_IRQ] = "irq",
+};
+
+static uint64_t eventCounts[TRACE_NUM_EVENTS];
+static uint64_t frequency;
+static uint64_t irqCounts[MAX_IRQS];
+static struct Histogram ataLatency;
+static struct PendingList pendingAta;
+static struct PendingList pendingSyscalls;
+static bool raw;
+static struct Histogram syscallLatency;
+static struct Histogram syscallLatencies[MAX_SYSCALLS];
+static volatile sig_atomic_t childExited;
+
+static void addToHistogram(struct Histogram* histogram, uint64_t value);
+static void handleEvent(const struct trace_event* event);
+static void onSigchld(int signo);
+static unsigned int parseEvents(char* list);
+static void printHistogram(const char* title, const struct Histogram* histogram);
+static void printSummary(uint64_t lost);
+static bool readEvents(int fd);
+static bool removePending(struct PendingList* list, unsigned long key,
+        struct PendingEvent* result);
+static void setPending(struct PendingList* list, unsigned long key,
+        uint64_t timestamp, unsigned long value);
+static uint64_t toNanoseconds(uint64_t cycles);
+
+int main(int argc, char* argv[]) {
+    struct option longopts[] = {
+        { "events", required_argument, 0, 'e' },
+        { "raw", no_argument, 0, 'r' },
+        { "time", required_argument, 0, 't' },
+        { "help", no_argument, 0, 0 },
+        { "version", no_argument, 0, 1 },
+        { 0, 0, 0, 0 }
+    };
+
+    unsigned int events = (1U << TRACE_NUM_EVENTS) - 1;
+    unsigned long seconds = 1;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "+e:rt:", longopts, NULL)) != -1) {
+        switch (c) {
+        case 0:
+            return help(argv[0], "[OPTIONS] [COMMAND [ARGUMENT...]]\n"
+                    "  -e, --events=LIST        trace only the given events\n"
+                    "  -r, --raw                print all events\n"
+                    "  -t, --time=SECONDS       trace for SECONDS if no "
+                    "command is given\n"
+                    "      --help               display this help\n"
+                    "      --version            display version info");
+        case 1:
+            return version(argv[0]);
+        case 'e':
+            events = parseEvents(optarg);
+            break;
+        case 'r':
+            raw = true;
+            break;
+        case 't': {
+            char* end;
+            errno = 0;
+            seconds = strtoul(optarg, &end, 10);
+            if (errno || *end || !*optarg) {
+                errx(1, "invalid number '%s'", optarg);
+            }
+        } break;
+        case '?':
+            return 1;
+        }
+    }
+
+    int fd = open("/dev/trace", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) err(1, "'/dev/trace'");
+
+    // Discard events from earlier traces.
+    while (true) {
+        struct trace_event buffer[64];
+        ssize_t size = read(fd, buffer, sizeof(buffer));
+        if (size < 0) err(1, "read");
+        if (size == 0) break;
+    }
+
+    struct trace_info info;
+    errno = posix_devctl(fd, TRACE_SET_EVENTS, &events, sizeof(events), NULL);
+    if (errno) err(1, "cannot enable tracing");
+    errno = posix_devctl(fd, TRACE_GET_INFO, &info, sizeof(info), NULL);
+    if (errno) err(1, "cannot get trace information");
+    frequency = info.ti_frequency;
+    uint64_t lostBefore = info.ti_lost;
+
+    // Read the buffer periodically so that it does not overflow.
+    struct timespec interval = { 0, 10000000 };
+    if (optind < argc) {
+        struct sigaction sa = {0};
+        sa.sa_handler = onSigchld;
+        sigaction(SIGCHLD, &sa, NULL);
+
+        pid_t pid;
+        errno = posix_spawnp(&pid, argv[optind], NULL, NULL, argv + optind,
+                environ);
+        if (errno) err(1, "posix_spawnp: '%s'", argv[optind]);
+
+        while (!childExited) {
+            if (!readEvents(fd)) break;
+            nanosleep(&interval, NULL);
+        }
+        waitpid(pid, NULL, 0);
+    } else {
+        struct timespec start;
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        do {
+            if (!readEvents(fd)) break;
+            nanosleep(&interval, NULL);
+            clock_gettime(CLOCK_MONOTONIC, &now);
+        } while ((unsigned long) (now.tv_sec - start.tv_sec) < seconds);
+    }
+
+    int disabled = 0;
+    posix_devctl(fd, TRACE_SET_EVENTS, &disabled, sizeof(disabled), NULL);
+    readEvents(fd);
+    errno = posix_devctl(fd, TRACE_GET_INFO, &info, sizeof(info), NULL);
+    if (errno) err(1, "cannot get trace information");
+    close(fd);
+
+    if (!raw) {
+        printSummary(info.ti_lost - lostBefore);
+    }
+    free(pendingAta.events);
+    free(pendingSyscalls.events);
+}
+
+static void addToHistogram(struct Histogram* histogram, uint64_t value) {
+    size_t bucket = 0;
+    while (bucket < HISTOGRAM_BUCKETS - 1 && value >> (bucket + 1)) {
+        bucket++;
+    }
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->total += value;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+static void handleEvent(const struct trace_event* event) {
+    if (event->te_type >= TRACE_NUM_EVENTS) return;
+    eventCounts[event->te_type]++;
+
+    if (raw) {
+        printf("%20" PRIu64 " %5d %5d %-13s 0x%lx 0x%lx\n",
+                toNanoseconds(event->te_timestamp), event->te_pid,
+                event->te_tid, eventNames[event->te_type], event->te_arg0,
+                event->te_arg1);
+        return;
+    }
+
+    struct PendingEvent pending;
+    switch (event->te_type) {
+    case TRACE_SYSCALL_ENTER:
+        setPending(&pendingSyscalls, event->te_tid, event->te_timestamp,
+                event->te_arg0);
+        break;
+    case TRACE_SYSCALL_EXIT:
+        // Syscalls that do not return are never paired with an exit.
+        if (removePending(&pendingSyscalls, event->te_tid, &pending)) {
+            uint64_t latency = toNanoseconds(event->te_timestamp -
+                    pending.timestamp);
+            addToHistogram(&syscallLatency, latency);
+            if (pending.value < MAX_SYSCALLS) {
+                addToHistogram(&syscallLatencies[pending.value], latency);
+            }
+        }
+        break;
+    case TRACE_ATA_SUBMIT:
+        setPending(&pendingAta, event->te_arg0, event->te_timestamp,
+                event->te_arg1);
+        break;
+    case TRACE_ATA_COMPLETE:
+        if (removePending(&pendingAta, event->te_arg0, &pending)) {
+            addToHistogram(&ataLatency, toNanoseconds(event->te_timestamp -
+                    pending.timestamp));
+        }
+        break;
+    case TRACE_IRQ:
+        if (event->te_arg0 < MAX_IRQS) {
+            irqCounts[event->te_arg0]++;
+        }
+        break;
+    }
+}
+
+static void onSigchld(int signo) {
+    (void) signo;
+    childExited = 1;
+}
+
+static unsigned int parseEvents(char* list) {
+    unsigned int events = 0;
+    char* name = strtok(list, ",");
+    while (name) {
+        size_t i;
+        for (i = 0; i < TRACE_NUM_EVENTS; i++) {
+            if (strcmp(name, eventNames[i]) == 0) break;
+        }
+
+        if (i < TRACE_NUM_EVENTS) {
+            events |= 1U << i;
+        } else if (strcmp(name, "syscall") == 0) {
+            events |= 1U << TRACE_SYSCALL_ENTER | 1U << TRACE_SYSCALL_EXIT;
+        } else if (strcmp(name, "block") == 0) {
+            events |= 1U << TRACE_BLOCK_HIT | 1U << TRACE_BLOCK_MISS;
+        } else if (strcmp(name, "ata") == 0) {
+            events |= 1U << TRACE_ATA_SUBMIT | 1U << TRACE_ATA_COMPLETE;
+        } else {
+            errx(1, "unknown event '%s'", name);
+        }
+        name = strtok(NULL, ",");
+    }
+    return events;
+}
+
+static void printHistogram(const char* title,
+        const struct Histogram* histogram) {
+    if (!histogram->count) return;
+
+    printf("\n%s: %" PRIu64 " samples, avg %" PRIu64 " ns, max %" PRIu64
+            " ns\n", title, histogram->count,
+            histogram->total / histogram->count, histogram->max);
+
+    uint64_t largest = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (histogram->buckets[i] > largest) {
+            largest = histogram->buckets[i];
+        }
+    }
+
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (!histogram->buckets[i]) continue;
+        int width = histogram->buckets[i] * 40 / largest;
+        printf("  %12" PRIu64 " ns |%-40.*s| %" PRIu64 "\n",
+                (uint64_t) 1 << i, width,
+                "########################################",
+                histogram->buckets[i]);
+    }
+}
+
+static void printSummary(uint64_t lost) {
+    puts("Event counts:");
+    for (size_t i = 0; i < TRACE_NUM_EVENTS; i++) {
+        printf("  %-13s %10" PRIu64 "\n", eventNames[i], eventCounts[i]);
+    }
+    if (lost) {
+        printf("  %-13s %10" PRIu64 "\n", "lost", lost);
+    }
+
+    uint64_t blockLookups = eventCounts[TRACE_BLOCK_HIT] +
+            eventCounts[TRACE_BLOCK_MISS];
+    if (blockLookups) {
+        printf("\nBlock cache hit rate: %" PRIu64 "%%\n",
+                eventCounts[TRACE_BLOCK_HIT] * 100 / blockLookups);
+    }
+
+    bool printedIrqs = false;
+    for (size_t i = 0; i < MAX_IRQS; i++) {
+        if (!irqCounts[i]) continue;
+        if (!printedIrqs) {
+            puts("\nInterrupts:");
+            printedIrqs = true;
+        }
+        printf("  irq %3zu %10" PRIu64 "\n", i, irqCounts[i]);
+    }
+
+    printHistogram("Syscall latency", &syscallLatency);
+    if (syscallLatency.count) {
+        puts("\n  syscall      count     avg ns     max ns");
+        for (size_t i = 0; i < MAX_SYSCALLS; i++) {
+            const struct Histogram* histogram = &syscallLatencies[i];
+            if (!histogram->count) continue;
+            printf("  %7zu %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", i,
+                    histogram->count, histogram->total / histogram->count,
+                    histogram->max);
+        }
+    }
+    printHistogram("ATA request latency", &ataLatency);
+}
+
+static bool readEvents(int fd) {
+    while (true) {
+        struct trace_event buffer[64];
+        ssize_t size = read(fd, buffer, sizeof(buffer));
+        if (size < 0) {
+            if (errno == EINTR) continue;
+            warn("read");
+            return false;
+        }
+        if (size == 0) return true;
+
+        for (size_t i = 0; i < size / sizeof(struct trace_event); i++) {
+            handleEvent(&buffer[i]);
+        }
+    }
+}
+
+static bool removePending(struct PendingList* list, unsigned long key,
+        struct PendingEvent* result) {
+    for (size_t i = 0; i < list->count; i++) {
+        if (list->events[i].key == key) {
+            *result = list->events[i];
+            list->events[i] = list->events[--list->count];
+            return true;
+        }
+    }
+    return false;
+}
+
+static void setPending(struct PendingList* list, unsigned long key,
+        uint64_t timestamp, unsigned long value) {
+    struct PendingEvent* event = NULL;
+    for (size_t i = 0; i < list->count; i++) {
+        if (list->events[i].key == key) {
+            event = &list->events[i];
+            break;
+        }
+    }
+
+    if (!event) {
+        if (list->count == list->allocated) {
+            size_t newSize = list->allocated ? 2 * list->allocated : 16;
+            struct PendingEvent* newEvents = reallocarray(list->events,
+                    newSize, sizeof(struct PendingEvent));
+            if (!newEvents) err(1, "realloc");
+            list->events = newEvents;
+            list->allocated = newSize;
+        }
+        event = &list->events[list->count++];
+    }
+
+    event->key = key;
+    event->timestamp = timestamp;
+    event->value = value;
+}
+
+static uint64_t toNanoseconds(uint64_t cycles) {
+    if (!frequency) return cycles;
+    return cycles / frequency * 1000000000 +
+            cycles % frequency * 1000000000 / frequency;
+}